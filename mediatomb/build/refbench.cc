@@ -0,0 +1,106 @@
+/*MT*
+
+    MediaTomb - http://www.mediatomb.cc/
+
+    refbench.cc - this file is part of MediaTomb.
+
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+
+    $Id$
+*/
+
+/// \file refbench.cc
+/// \brief Measures the Ref<> copy throughput of the zmm reference count.
+///
+/// Not built by default, run "make refbench" in the build directory.
+/// Usage: refbench [threads] [million copies per thread] [shared]
+/// With "shared" all threads copy references to the same object.
+
+#ifdef HAVE_CONFIG_H
+    #include "autoconfig.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "zmm/zmm.h"
+
+using namespace zmm;
+
+static long copies;
+static Ref<Object> sharedObject;
+
+static void *copyLoop(void *arg)
+{
+    Ref<Object> obj = (sharedObject != nil ? sharedObject : Ref<Object>(new Object()));
+    Ref<Object> copy;
+    for (long i = 0; i < copies; i++)
+        copy = obj;
+    return NULL;
+}
+
+static const char *implementation()
+{
+#if defined(ATOMIC_STD)
+    return "std::atomic";
+#elif defined(ATOMIC_BUILTIN)
+    return "atomic builtins";
+#elif defined(ATOMIC_X86_SMP) || defined(ATOMIC_X86)
+    return "x86 asm";
+#elif defined(ATOMIC_NEED_MUTEX)
+    return "pthread mutex";
+#else
+    return "not atomic";
+#endif
+}
+
+int main(int argc, char **argv)
+{
+    int threads = (argc > 1 ? atoi(argv[1]) : 1);
+    copies = (argc > 2 ? atol(argv[2]) : 50) * 1000000L;
+    if (threads < 1 || copies < 1)
+    {
+        fprintf(stderr, "usage: %s [threads] [million copies per thread] [shared]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 3 && ! strcmp(argv[3], "shared"))
+        sharedObject = Ref<Object>(new Object());
+
+    pthread_t *tids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+    for (int i = 0; i < threads; i++)
+        pthread_create(&tids[i], NULL, copyLoop, NULL);
+    for (int i = 0; i < threads; i++)
+        pthread_join(tids[i], NULL);
+    gettimeofday(&end, NULL);
+    free(tids);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+    printf("%s, sizeof(Object) %d, %d thread(s), %s object: %.1f Mcopies/s\n",
+        implementation(), (int)sizeof(Object), threads,
+        (sharedObject != nil ? "shared" : "own"),
+        threads * (copies / 1e6) / seconds);
+    return 0;
+}
@@ -23,6 +23,12 @@ CREATE TABLE `mt_cds_object` (
   `flags` int(11) unsigned NOT NULL default '1',
   `track_number` int(11) default NULL,
   `service_id` varchar(255) default NULL,
+  `child_containers` int(11) NOT NULL default '0',
+  `child_items` int(11) NOT NULL default '0',
+  `dc_date` varchar(255) default NULL,
+  `upnp_artist` varchar(255) default NULL,
+  `upnp_album` varchar(255) default NULL,
+  `res_size` bigint(20) default NULL,
   PRIMARY KEY  (`id`),
   KEY `cds_object_ref_id` (`ref_id`),
   KEY `cds_object_parent_id` (`parent_id`,`object_type`,`dc_title`),
@@ -30,13 +36,19 @@ CREATE TABLE `mt_cds_object` (
   KEY `location_parent` (`location_hash`,`parent_id`),
   KEY `cds_object_track_number` (`track_number`),
   KEY `cds_object_service_id` (`service_id`),
+  KEY `cds_object_sort_title` (`parent_id`,`dc_title`),
+  KEY `cds_object_sort_date` (`parent_id`,`dc_date`),
+  KEY `cds_object_sort_artist` (`parent_id`,`upnp_artist`),
+  KEY `cds_object_sort_album` (`parent_id`,`upnp_album`),
+  KEY `cds_object_sort_track` (`parent_id`,`track_number`),
+  KEY `cds_object_sort_size` (`parent_id`,`res_size`),
   CONSTRAINT `mt_cds_object_ibfk_1` FOREIGN KEY (`ref_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE,
   CONSTRAINT `mt_cds_object_ibfk_2` FOREIGN KEY (`parent_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE
 ) ENGINE=MyISAM CHARSET=utf8;
-INSERT INTO `mt_cds_object` VALUES (-1,NULL,-1,0,NULL,NULL,NULL,NULL,NULL,NULL,NULL,0,NULL,9,NULL,NULL);
-INSERT INTO `mt_cds_object` VALUES (0,NULL,-1,1,'object.container','Root',NULL,NULL,NULL,NULL,NULL,0,NULL,9,NULL,NULL);
+INSERT INTO `mt_cds_object` VALUES (-1,NULL,-1,0,NULL,NULL,NULL,NULL,NULL,NULL,NULL,0,NULL,9,NULL,NULL,1,0,NULL,NULL,NULL,NULL);
+INSERT INTO `mt_cds_object` VALUES (0,NULL,-1,1,'object.container','Root',NULL,NULL,NULL,NULL,NULL,0,NULL,9,NULL,NULL,1,0,NULL,NULL,NULL,NULL);
 UPDATE `mt_cds_object` SET `id`='0' WHERE `id`='1';
-INSERT INTO `mt_cds_object` VALUES (1,NULL,0,1,'object.container','PC Directory',NULL,NULL,NULL,NULL,NULL,0,NULL,9,NULL,NULL);
+INSERT INTO `mt_cds_object` VALUES (1,NULL,0,1,'object.container','PC Directory',NULL,NULL,NULL,NULL,NULL,0,NULL,9,NULL,NULL,0,0,NULL,NULL,NULL,NULL);
 CREATE TABLE `mt_cds_active_item` (
   `id` int(11) NOT NULL,
   `action` varchar(255) NOT NULL,
@@ -49,7 +61,7 @@ CREATE TABLE `mt_internal_setting` (
   `value` varchar(255) NOT NULL,
   PRIMARY KEY  (`key`)
 ) ENGINE=MyISAM CHARSET=utf8;
-INSERT INTO `mt_internal_setting` VALUES ('db_version','4');
+INSERT INTO `mt_internal_setting` VALUES ('db_version','8');
 CREATE TABLE `mt_autoscan` (
   `id` int(11) NOT NULL auto_increment,
   `obj_id` int(11) default NULL,
@@ -67,6 +79,14 @@ CREATE TABLE `mt_autoscan` (
   UNIQUE KEY `mt_autoscan_obj_id` (`obj_id`),
   CONSTRAINT `mt_autoscan_ibfk_1` FOREIGN KEY (`obj_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE
 ) ENGINE=MyISAM CHARSET=utf8;
+CREATE TABLE `mt_metadata` (
+  `item_id` int(11) NOT NULL,
+  `property_name` varchar(255) NOT NULL,
+  `property_value` text NOT NULL,
+  KEY `mt_metadata_item_id` (`item_id`),
+  KEY `mt_metadata_property` (`property_name`,`property_value`(255)),
+  CONSTRAINT `mt_metadata_ibfk_1` FOREIGN KEY (`item_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE
+) ENGINE=MyISAM CHARSET=utf8;
 /*!40101 SET SQL_MODE=@OLD_SQL_MODE */;
 /*!40014 SET FOREIGN_KEY_CHECKS=@OLD_FOREIGN_KEY_CHECKS */;
 /*!40014 SET UNIQUE_CHECKS=@OLD_UNIQUE_CHECKS */;
@@ -16,12 +16,18 @@ CREATE TABLE "mt_cds_object" (
   "flags" integer unsigned NOT NULL default '1',
   "track_number" integer default NULL,
   "service_id" varchar(255) default NULL,
+  "child_containers" integer NOT NULL default '0',
+  "child_items" integer NOT NULL default '0',
+  "dc_date" varchar(255) default NULL,
+  "upnp_artist" varchar(255) default NULL,
+  "upnp_album" varchar(255) default NULL,
+  "res_size" integer default NULL,
   CONSTRAINT "cds_object_ibfk_1" FOREIGN KEY ("ref_id") REFERENCES "cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
   CONSTRAINT "cds_object_ibfk_2" FOREIGN KEY ("parent_id") REFERENCES "cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE
 );
-INSERT INTO "mt_cds_object" VALUES(-1, NULL, -1, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0, NULL, 9, NULL, NULL);
-INSERT INTO "mt_cds_object" VALUES(0, NULL, -1, 1, 'object.container', 'Root', NULL, NULL, NULL, NULL, NULL, 0, NULL, 9, NULL, NULL);
-INSERT INTO "mt_cds_object" VALUES(1, NULL, 0, 1, 'object.container', 'PC Directory', NULL, NULL, NULL, NULL, NULL, 0, NULL, 9, NULL, NULL);
+INSERT INTO "mt_cds_object" VALUES(-1, NULL, -1, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0, NULL, 9, NULL, NULL, 1, 0, NULL, NULL, NULL, NULL);
+INSERT INTO "mt_cds_object" VALUES(0, NULL, -1, 1, 'object.container', 'Root', NULL, NULL, NULL, NULL, NULL, 0, NULL, 9, NULL, NULL, 1, 0, NULL, NULL, NULL, NULL);
+INSERT INTO "mt_cds_object" VALUES(1, NULL, 0, 1, 'object.container', 'PC Directory', NULL, NULL, NULL, NULL, NULL, 0, NULL, 9, NULL, NULL, 0, 0, NULL, NULL, NULL, NULL);
 CREATE TABLE "mt_cds_active_item" (
   "id" integer primary key,
   "action" varchar(255) NOT NULL,
@@ -32,7 +38,7 @@ CREATE TABLE "mt_internal_setting" (
   "key" varchar(40) primary key NOT NULL,
   "value" varchar(255) NOT NULL
 );
-INSERT INTO "mt_internal_setting" VALUES('db_version', '3');
+INSERT INTO "mt_internal_setting" VALUES('db_version', '7');
 CREATE TABLE "mt_autoscan" (
   "id" integer primary key,
   "obj_id" integer default NULL,
@@ -48,6 +54,12 @@ CREATE TABLE "mt_autoscan" (
   "touched" tinyint unsigned NOT NULL default '1',
   CONSTRAINT "mt_autoscan_id" FOREIGN KEY ("obj_id") REFERENCES "mt_cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE
 );
+CREATE TABLE "mt_metadata" (
+  "item_id" integer NOT NULL,
+  "property_name" varchar(255) NOT NULL,
+  "property_value" text NOT NULL,
+  CONSTRAINT "mt_metadata_ibfk_1" FOREIGN KEY ("item_id") REFERENCES "mt_cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE
+);
 CREATE INDEX mt_cds_object_ref_id ON mt_cds_object(ref_id);
 CREATE INDEX mt_cds_object_parent_id ON mt_cds_object(parent_id,object_type,dc_title);
 CREATE INDEX mt_object_type ON mt_cds_object(object_type);
@@ -56,4 +68,12 @@ CREATE INDEX mt_track_number ON mt_cds_object(track_number);
 CREATE INDEX mt_internal_setting_key ON mt_internal_setting(key);
 CREATE UNIQUE INDEX mt_autoscan_obj_id ON mt_autoscan(obj_id);
 CREATE INDEX mt_cds_object_service_id ON mt_cds_object(service_id);
+CREATE INDEX mt_metadata_item_id ON mt_metadata(item_id);
+CREATE INDEX mt_metadata_property ON mt_metadata(property_name,property_value);
+CREATE INDEX mt_cds_object_sort_title ON mt_cds_object(parent_id,dc_title);
+CREATE INDEX mt_cds_object_sort_date ON mt_cds_object(parent_id,dc_date);
+CREATE INDEX mt_cds_object_sort_artist ON mt_cds_object(parent_id,upnp_artist);
+CREATE INDEX mt_cds_object_sort_album ON mt_cds_object(parent_id,upnp_album);
+CREATE INDEX mt_cds_object_sort_track ON mt_cds_object(parent_id,track_number);
+CREATE INDEX mt_cds_object_sort_size ON mt_cds_object(parent_id,res_size);
 COMMIT;
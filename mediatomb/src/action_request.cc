@@ -47,13 +47,10 @@ ActionRequest::ActionRequest(Upnp_Action_Request *upnp_request) : Object()
     UDN = upnp_request->DevUDN;
     serviceID = upnp_request->ServiceID;
 
-    DOMString cxml = ixmlPrintDocument(upnp_request->ActionRequest);
-    String xml = cxml;
-    ixmlFreeDOMString(cxml);
-   
-    Ref<Parser> parser(new Parser());
-
-    request = parser->parseString(xml)->getRoot();
+    action = ixmlNode_getFirstChild((IXML_Node *)upnp_request->ActionRequest);
+    while ((action != NULL) && 
+           (ixmlNode_getNodeType(action) != eELEMENT_NODE))
+        action = ixmlNode_getNextSibling(action);
 }
 
 String ActionRequest::getActionName()
@@ -68,14 +65,51 @@ String ActionRequest::getServiceID()
 {
     return serviceID;
 }
-Ref<Element> ActionRequest::getRequest()
+String ActionRequest::getArgument(String name)
 {
-    return request;
+    if (action == NULL)
+        return nil;
+
+    IXML_Node *arg;
+    for (arg = ixmlNode_getFirstChild(action); arg != NULL;
+         arg = ixmlNode_getNextSibling(arg))
+    {
+        if ((ixmlNode_getNodeType(arg) == eELEMENT_NODE) &&
+            (name == ixmlNode_getNodeName(arg)))
+            break;
+    }
+    if (arg == NULL)
+        return nil;
+
+    // same as mxml::Element::getText(): all text children are joined,
+    // an argument without text is nil
+    Ref<StringBuffer> buf = nil;
+    for (IXML_Node *child = ixmlNode_getFirstChild(arg); child != NULL;
+         child = ixmlNode_getNextSibling(child))
+    {
+        unsigned short type = ixmlNode_getNodeType(child);
+        if ((type != eTEXT_NODE) && (type != eCDATA_SECTION_NODE))
+            continue;
+        if (buf == nil)
+            buf = Ref<StringBuffer>(new StringBuffer());
+        const char *value = ixmlNode_getNodeValue(child);
+        if (value != NULL)
+            *buf << value;
+    }
+    if (buf == nil)
+        return nil;
+    return buf->toString();
 }
 
 void ActionRequest::setResponse(Ref<Element> response)
 {
     this->response = response;
+    responseBuffer = nil;
+}
+void ActionRequest::setResponse(Ref<StringBuffer> response)
+{
+    this->response = nil;
+    responseBuffer = response;
 }
 void ActionRequest::setErrorCode(int errCode)
 {
@@ -104,6 +138,18 @@ void ActionRequest::update()
             upnp_request->ErrCode = errCode;    
         }
     }
+    else if (responseBuffer != nil)
+    {
+        // the SDK frees the string after sending the response
+        upnp_request->ActionResultString = strdup(responseBuffer->c_str());
+        if (upnp_request->ActionResultString == NULL)
+        {
+            log_error("ActionRequest::update(): could not allocate the response\n");
+            upnp_request->ErrCode = UPNP_E_OUTOF_MEMORY;
+        }
+        else
+            upnp_request->ErrCode = errCode;
+    }
     else
     {
         // ok, here there can be two cases
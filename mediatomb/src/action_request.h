@@ -67,16 +67,21 @@ protected:
     /// Returned by getServiceID()
     zmm::String serviceID;
 
-    /// \brief XML holding the request that comes to us.
+    /// \brief Action element of the request document, owned by the SDK.
     ///
-    /// Returned by getRequest()
-    zmm::Ref<mxml::Element> request;
+    /// The arguments are read by getArgument()
+    IXML_Node *action;
 
     /// \brief XML holding the response, we fill it in.
     ///
     /// Set by setResponse()
     zmm::Ref<mxml::Element> response;
 
+    /// \brief Serialized response, alternative to the XML response.
+    ///
+    /// Set by setResponse()
+    zmm::Ref<zmm::StringBuffer> responseBuffer;
+
 public:
     /// \brief The Constructor takes the values from the upnp_request and fills in internal variables.
     /// \param *upnp_request Pointer to the Upnp_Action_Request structure.
@@ -91,13 +96,25 @@ public:
     /// \brief Returns the ID of the service (the action is for this service id)
     zmm::String getServiceID();
 
-    /// \brief Returns the XML representation of the request.
-    zmm::Ref<mxml::Element> getRequest();
+    /// \brief Returns the value of an argument of the action.
+    /// \param name Name of the argument element.
+    /// \return Text of the argument or nil if the argument is missing or empty.
+    ///
+    /// The value is read from the iXML document the SDK has already parsed,
+    /// so no copy of the request has to be built.
+    zmm::String getArgument(zmm::String name);
 
     /// \brief Sets the response (XML created outside as the answer to the request)
     /// \param response XML holding the action response.
     void setResponse(zmm::Ref<mxml::Element> response);
 
+    /// \brief Sets an already serialized response.
+    /// \param response Buffer holding the printed action response element.
+    ///
+    /// The text is handed to the SDK as it is, so large responses do not
+    /// have to be converted into an iXML document first.
+    void setResponse(zmm::Ref<zmm::StringBuffer> response);
+
     /// \brief Set the error code for the SDK.
     /// \param errCode UPnP error code.
     ///
@@ -259,4 +259,16 @@ protected:
     zmm::Ref<zmm::Object> timer_parameter;
 };
 
+/// \brief Watches autoscan directories for changes and passes them on to
+/// the ContentManager.
+class AutoscanMonitor : public zmm::Object
+{
+public:
+    /// \brief Start monitoring a directory
+    virtual void monitor(zmm::Ref<AutoscanDirectory> dir) = 0;
+    
+    /// \brief Stop monitoring a directory
+    virtual void unmonitor(zmm::Ref<AutoscanDirectory> dir) = 0;
+};
+
 #endif
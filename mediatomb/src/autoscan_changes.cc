@@ -0,0 +1,238 @@
+/*MT*
+    
+    MediaTomb - http://www.mediatomb.cc/
+    
+    autoscan_changes.cc - this file is part of MediaTomb.
+    
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+    
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+    
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+    
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+    
+    $Id$
+*/
+
+/// \file autoscan_changes.cc
+
+#ifdef HAVE_CONFIG_H
+    #include "autoconfig.h"
+#endif
+
+#ifdef HAVE_INOTIFY
+
+#include "autoscan_changes.h"
+#include "content_manager.h"
+
+/// \brief milliseconds without a modification before a file that was not
+/// closed is imported
+#define AUTOSCAN_CHANGES_QUIET_PERIOD 2000
+
+/// \brief milliseconds after which the due changes are passed on while
+/// events keep coming in
+#define AUTOSCAN_CHANGES_BATCH_TIME 1000
+
+/// \brief number of pending changes that forces them all to be passed on
+#define AUTOSCAN_CHANGES_MAX 4096
+
+using namespace zmm;
+
+AutoscanChanges::AutoscanChanges()
+{
+    changes = Ref<DSOHash<Change> >(new DSOHash<Change>(hashCapacity(AUTOSCAN_CHANGES_MAX)));
+    changeList = Ref<Array<Change> >(new Array<Change>());
+    getTimespecNow(&lastFlush);
+    eventCount = 0;
+    importCount = 0;
+    removeCount = 0;
+    removeTaskCount = 0;
+}
+
+void AutoscanChanges::queue(String path, Ref<AutoscanDirectory> adir, autoscan_change_t type)
+{
+    Ref<Change> change = changes->get(path);
+    if (change == nil)
+    {
+        // a file that is closed without a pending modification was only
+        // opened for writing
+        if (type == AutoscanChangeClosed)
+            return;
+        if (changeList->size() >= AUTOSCAN_CHANGES_MAX)
+            flush(true);
+        change = Ref<Change>(new Change(path, adir));
+        changes->put(path, change);
+        changeList->append(change);
+    }
+    else
+        change->setAutoscanDirectory(adir);
+    
+    if (type == AutoscanChangeModified)
+    {
+        // the file is imported after it was closed or after the writes
+        // stopped for a while, not on every write
+        change->setRemove(true);
+        change->setAdd(true);
+        getTimespecAfterMillis(AUTOSCAN_CHANGES_QUIET_PERIOD, change->getDeadline());
+        return;
+    }
+    
+    if (type == AutoscanChangeAdded)
+        change->setAdd(true);
+    else if (type == AutoscanChangeWritten)
+    {
+        change->setRemove(true);
+        change->setAdd(true);
+    }
+    else if (type == AutoscanChangeRemoved)
+    {
+        change->setRemove(true);
+        change->setAdd(false);
+        
+        // the removal of a directory takes care of everything below it
+        if (path.charAt(path.length() - 1) == DIR_SEPARATOR)
+        {
+            for (int i = 0; i < changeList->size(); i++)
+            {
+                Ref<Change> child = changeList->get(i);
+                if (child != change && child->getPath().startsWith(path))
+                {
+                    child->setRemove(false);
+                    child->setAdd(false);
+                }
+            }
+        }
+    }
+    getTimespecNow(change->getDeadline());
+}
+
+void AutoscanChanges::flush(bool all)
+{
+    struct timespec now;
+    getTimespecNow(&now);
+    lastFlush = now;
+    
+    Ref<Array<Change> > due(new Array<Change>());
+    Ref<Array<Change> > waiting(new Array<Change>());
+    for (int i = 0; i < changeList->size(); i++)
+    {
+        Ref<Change> change = changeList->get(i);
+        if (all || getDeltaMillis(change->getDeadline(), &now) >= 0)
+            due->append(change);
+        else
+            waiting->append(change);
+    }
+    if (due->size() == 0)
+        return;
+    
+    changeList = waiting;
+    changes->clear();
+    for (int i = 0; i < changeList->size(); i++)
+        changes->put(changeList->get(i)->getPath(), changeList->get(i));
+    
+    Ref<ContentManager> cm = ContentManager::getInstance();
+    Ref<Storage> st = Storage::getInstance();
+    
+    // the removals are queued first, so that a modified file is removed
+    // before it is added again; the removed files go to a single task
+    Ref<DBRHash<int> > removeList = nil;
+    for (int i = 0; i < due->size(); i++)
+    {
+        Ref<Change> change = due->get(i);
+        if (! change->getRemove())
+            continue;
+        String path = change->getPath();
+        try
+        {
+            int objectID = st->findObjectIDByPath(path);
+            if (objectID == INVALID_OBJECT_ID)
+                continue;
+            if (path.charAt(path.length() - 1) == DIR_SEPARATOR)
+            {
+                cm->removeObject(objectID);
+                removeTaskCount++;
+            }
+            else
+            {
+                if (removeList == nil)
+                    removeList = Ref<DBRHash<int> >(new DBRHash<int>(hashCapacity(due->size()), due->size(), INVALID_OBJECT_ID, INVALID_OBJECT_ID_2));
+                removeList->put(objectID);
+            }
+            removeCount++;
+        }
+        catch (Exception e)
+        {
+            log_error("could not remove %s: %s\n", path.c_str(), e.getMessage().c_str());
+        }
+    }
+    if (removeList != nil)
+    {
+        cm->removeObjects(removeList);
+        removeTaskCount++;
+    }
+    
+    for (int i = 0; i < due->size(); i++)
+    {
+        Ref<Change> change = due->get(i);
+        if (! change->getAdd())
+            continue;
+        Ref<AutoscanDirectory> adir = change->getAutoscanDirectory();
+        log_debug("adding %s\n", change->getPath().c_str());
+        // path, recursive, async, hidden, low priority, cancellable
+        cm->addFile(change->getPath(), adir->getRecursive(), true, adir->getHidden(), true, false);
+        importCount++;
+    }
+    log_debug("%d changes passed on, %d pending; %ld events, %ld imports, %ld removals in %ld tasks so far\n",
+            due->size(), changeList->size(), eventCount, importCount, removeCount, removeTaskCount);
+}
+
+bool AutoscanChanges::isBatchDue()
+{
+    return (getDeltaMillis(&lastFlush) >= AUTOSCAN_CHANGES_BATCH_TIME);
+}
+
+int AutoscanChanges::getTimeout()
+{
+    if (changeList->size() == 0)
+        return -1;
+    
+    struct timespec now;
+    getTimespecNow(&now);
+    long timeout = -1;
+    for (int i = 0; i < changeList->size(); i++)
+    {
+        long left = getDeltaMillis(&now, changeList->get(i)->getDeadline());
+        if (left < 0)
+            left = 0;
+        if (timeout < 0 || left < timeout)
+            timeout = left;
+    }
+    return (int)timeout;
+}
+
+void AutoscanChanges::clear()
+{
+    changes->clear();
+    changeList = Ref<Array<Change> >(new Array<Change>());
+}
+
+void AutoscanChanges::logStats(const char *source)
+{
+    log_info("%s: %ld events, %ld imports, %ld removals in %ld tasks\n",
+            source, eventCount, importCount, removeCount, removeTaskCount);
+}
+
+#endif // HAVE_INOTIFY
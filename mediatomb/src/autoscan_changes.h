@@ -0,0 +1,128 @@
+/*MT*
+    
+    MediaTomb - http://www.mediatomb.cc/
+    
+    autoscan_changes.h - this file is part of MediaTomb.
+    
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+    
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+    
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+    
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+    
+    $Id$
+*/
+
+/// \file autoscan_changes.h
+#ifndef __AUTOSCAN_CHANGES_H__
+#define __AUTOSCAN_CHANGES_H__
+
+#include "zmmf/zmmf.h"
+#include "hash.h"
+#include "autoscan.h"
+
+/// \brief kind of a change reported by the filesystem
+enum autoscan_change_t
+{
+    /// \brief the file is being written
+    AutoscanChangeModified,
+    /// \brief the file was closed after writing, only counts if it was
+    /// modified before
+    AutoscanChangeClosed,
+    /// \brief the file was closed after writing, for sources that do not
+    /// report the modifications
+    AutoscanChangeWritten,
+    /// \brief the file or directory was moved into the watched tree
+    AutoscanChangeAdded,
+    /// \brief the file or directory was deleted or moved away
+    AutoscanChangeRemoved
+};
+
+/// \brief Collects the changes reported for the autoscan directories, so
+/// that a burst of events for a path results in one import or removal.
+class AutoscanChanges : public zmm::Object
+{
+public:
+    AutoscanChanges();
+    
+    /// \brief records a change of a path
+    /// \param path the changed path; directories end with a separator
+    void queue(zmm::String path, zmm::Ref<AutoscanDirectory> adir, autoscan_change_t change);
+    
+    /// \brief passes the changes that are due to the ContentManager
+    /// \param all pass all changes, whether they are due or not
+    void flush(bool all);
+    
+    /// \brief returns true if the due changes should be passed on although
+    /// the events keep coming in
+    bool isBatchDue();
+    
+    /// \brief returns the milliseconds until the next change is due, -1 if
+    /// there are no changes
+    int getTimeout();
+    
+    /// \brief drops the pending changes
+    void clear();
+    
+    void countEvent() { eventCount++; }
+    
+    /// \brief logs the statistics
+    /// \param source name of the event source for the log message
+    void logStats(const char *source);
+    
+protected:
+    class Change : public zmm::Object
+    {
+    public:
+        Change(zmm::String path, zmm::Ref<AutoscanDirectory> adir)
+        {
+            this->path = path;
+            this->adir = adir;
+            remove = false;
+            add = false;
+        }
+        zmm::String getPath() { return path; }
+        zmm::Ref<AutoscanDirectory> getAutoscanDirectory() { return adir; }
+        void setAutoscanDirectory(zmm::Ref<AutoscanDirectory> adir) { this->adir = adir; }
+        bool getRemove() { return remove; }
+        void setRemove(bool remove) { this->remove = remove; }
+        bool getAdd() { return add; }
+        void setAdd(bool add) { this->add = add; }
+        struct timespec *getDeadline() { return &deadline; }
+    private:
+        zmm::String path;
+        zmm::Ref<AutoscanDirectory> adir;
+        bool remove;
+        bool add;
+        struct timespec deadline;
+    };
+    
+    /// \brief pending changes by path
+    zmm::Ref<DSOHash<Change> > changes;
+    
+    /// \brief pending changes in the order of their first event
+    zmm::Ref<zmm::Array<Change> > changeList;
+    
+    struct timespec lastFlush;
+    
+    long eventCount;
+    long importCount;
+    long removeCount;
+    long removeTaskCount;
+};
+
+#endif // __AUTOSCAN_CHANGES_H__
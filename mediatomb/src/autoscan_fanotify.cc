@@ -0,0 +1,438 @@
+/*MT*
+    
+    MediaTomb - http://www.mediatomb.cc/
+    
+    autoscan_fanotify.cc - this file is part of MediaTomb.
+    
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+    
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+    
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+    
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+    
+    $Id$
+*/
+
+/// \file autoscan_fanotify.cc
+
+#ifdef HAVE_CONFIG_H
+    #include "autoconfig.h"
+#endif
+
+#ifdef HAVE_FANOTIFY
+
+#include "autoscan_fanotify.h"
+#include "content_manager.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <mntent.h>
+
+#define AUTOSCAN_FANOTIFY_INITIAL_QUEUE_SIZE 20
+
+#define AUTOSCAN_FANOTIFY_MOUNTS_FILE "/proc/self/mounts"
+
+using namespace zmm;
+
+AutoscanFanotify::AutoscanFanotify()
+{
+    mutex = Ref<Mutex>(new Mutex());
+    monitoredList = Ref<Array<Monitored> >(new Array<Monitored>());
+    rebuildMonitoredPaths();
+    changes = Ref<AutoscanChanges>(new AutoscanChanges());
+    shutdownFlag = true;
+    thread = 0;
+    monitorQueue = Ref<ObjectQueue<AutoscanDirectory> >(new ObjectQueue<AutoscanDirectory>(AUTOSCAN_FANOTIFY_INITIAL_QUEUE_SIZE));
+    unmonitorQueue = Ref<ObjectQueue<AutoscanDirectory> >(new ObjectQueue<AutoscanDirectory>(AUTOSCAN_FANOTIFY_INITIAL_QUEUE_SIZE));
+    // files that are created are reported by FAN_CLOSE_WRITE, FAN_CREATE
+    // is only needed for recreated autoscan directories
+    events = FAN_CLOSE_WRITE | FAN_CREATE | FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO | FAN_ONDIR;
+}
+
+void AutoscanFanotify::init()
+{
+    AUTOLOCK(mutex);
+    if (shutdownFlag)
+    {
+        shutdownFlag = false;
+        fanotify = Ref<Fanotify>(new Fanotify());
+        log_debug("starting fanotify thread...\n");
+        int ret = pthread_create(
+            &thread,
+            NULL,
+            AutoscanFanotify::staticThreadProc,
+            this
+        );
+        
+        if (ret)
+            throw _Exception(_("failed to start fanotify thread: ") + ret);
+    }
+}
+
+AutoscanFanotify::~AutoscanFanotify()
+{
+    shutdown();
+}
+
+void AutoscanFanotify::shutdown()
+{
+    AUTOLOCK(mutex);
+    if (! shutdownFlag)
+    {
+        log_debug("start\n");
+        shutdownFlag = true;
+        fanotify->stop();
+        AUTOUNLOCK();
+        if (thread)
+            pthread_join(thread, NULL);
+        thread = 0;
+        log_debug("fanotify thread died.\n");
+        // the marks are removed with the descriptor
+        fanotify = nil;
+        monitoredList = Ref<Array<Monitored> >(new Array<Monitored>());
+        rebuildMonitoredPaths();
+        // the rescan on the next start picks up the pending changes
+        changes->clear();
+        changes->logStats("fanotify");
+    }
+}
+
+void *AutoscanFanotify::staticThreadProc(void *arg)
+{
+    log_debug("started fanotify thread.\n");
+    AutoscanFanotify *inst = (AutoscanFanotify *)arg;
+    inst->threadProc();
+    Storage::getInstance()->threadCleanup();
+    log_debug("exiting fanotify thread...\n");
+    pthread_exit(NULL);
+    return NULL;
+}
+
+void AutoscanFanotify::threadProc()
+{
+    Ref<ContentManager> cm;
+    
+    try
+    {
+        cm = ContentManager::getInstance();
+    }
+    catch (Exception e)
+    {
+        log_error("Fanotify thread caught: %s\n", e.getMessage().c_str());
+        e.printStackTrace();
+        shutdownFlag = true;
+        fanotify = nil;
+    }
+    while (! shutdownFlag)
+    {
+        try
+        {
+            Ref<AutoscanDirectory> adir;
+            
+            AUTOLOCK(mutex);
+            while ((adir = unmonitorQueue->dequeue()) != nil)
+            {
+                AUTOUNLOCK();
+                unmonitorDirectory(adir);
+                AUTORELOCK();
+            }
+            
+            while ((adir = monitorQueue->dequeue()) != nil)
+            {
+                AUTOUNLOCK();
+                monitorDirectory(adir);
+                cm->rescanDirectory(adir->getObjectID(), adir->getScanID(), adir->getScanMode(), nil, false);
+                AUTORELOCK();
+            }
+            
+            AUTOUNLOCK();
+            
+            /* --- get event --- (blocking until a change is due) */
+            Ref<FanotifyEvent> event = fanotify->nextEvent(changes->getTimeout());
+            /* --- */
+            
+            if (event == nil || changes->isBatchDue())
+                changes->flush(false);
+            
+            if (event != nil)
+                handleEvent(event);
+        }
+        catch (Exception e)
+        {
+            log_error("Fanotify thread caught exception: %s\n", e.getMessage().c_str());
+            e.printStackTrace();
+        }
+    }
+}
+
+void AutoscanFanotify::handleEvent(Ref<FanotifyEvent> event)
+{
+    changes->countEvent();
+    int mask = event->getMask();
+    if (mask & FAN_Q_OVERFLOW)
+    {
+        log_warning("fanotify: events were lost, rescanning the autoscan directories\n");
+        changes->flush(true);
+        rescanAll();
+        return;
+    }
+    
+    String name = event->getName();
+    bool isDir = (mask & FAN_ONDIR);
+    log_debug("fanotify event: %x %s%s\n", mask, event->getPath().c_str(), name.c_str());
+    
+    Ref<Monitored> monitored = getMonitored(event->getPath(), name, isDir);
+    if (monitored == nil)
+        return;
+    
+    Ref<AutoscanDirectory> adir = monitored->getAutoscanDirectory();
+    
+    String path = event->getPath() + name;
+    if (isDir)
+        path = path + DIR_SEPARATOR;
+    // the objects are stored below the configured location, which may
+    // differ from the real path by symbolic links
+    path = monitored->getLocation() + path.substring(monitored->getRealLocation().length());
+    bool startPoint = (path == monitored->getLocation());
+    
+    // events of one entry may be merged, the removal comes first in that
+    // case
+    if (mask & (FAN_DELETE | FAN_MOVED_FROM))
+    {
+        if (startPoint && adir->persistent())
+            ContentManager::getInstance()->handlePeristentAutoscanRemove(adir->getScanID(), InotifyScanMode);
+        changes->queue(path, adir, AutoscanChangeRemoved);
+    }
+    
+    if (isDir)
+    {
+        if (mask & (FAN_CREATE | FAN_MOVED_TO))
+        {
+            if (startPoint && adir->getObjectID() == INVALID_OBJECT_ID)
+            {
+                log_debug("autoscan directory %s was recreated\n", path.c_str());
+                ContentManager::getInstance()->handlePersistentAutoscanRecreate(adir->getScanID(), adir->getScanMode());
+            }
+            // the files in a new directory are reported on their own
+            if ((mask & FAN_MOVED_TO) || startPoint)
+                changes->queue(path, adir, AutoscanChangeAdded);
+        }
+    }
+    else
+    {
+        if (mask & FAN_MOVED_TO)
+            changes->queue(path, adir, AutoscanChangeAdded);
+        // there is no modify event, a file is imported when it is closed
+        if (mask & FAN_CLOSE_WRITE)
+            changes->queue(path, adir, AutoscanChangeWritten);
+    }
+}
+
+Ref<AutoscanFanotify::Monitored> AutoscanFanotify::getMonitored(String path, String name, bool isDir)
+{
+    Ref<Monitored> monitored;
+    if (isDir)
+    {
+        // the autoscan directory itself
+        monitored = monitoredPaths->get(path + name + DIR_SEPARATOR);
+        if (monitored != nil)
+            return monitored;
+    }
+    
+    bool hidden = (name.charAt(0) == '.');
+    bool parent = true;
+    while (true)
+    {
+        monitored = monitoredPaths->get(path);
+        if (monitored != nil)
+        {
+            Ref<AutoscanDirectory> adir = monitored->getAutoscanDirectory();
+            if ((parent || adir->getRecursive()) && (! hidden || adir->getHidden()))
+                return monitored;
+        }
+        
+        if (path.length() <= 1)
+            return nil;
+        int pos = path.rindex(path.length() - 2, DIR_SEPARATOR);
+        if (pos < 0)
+            return nil;
+        if (path.charAt(pos + 1) == '.')
+            hidden = true;
+        path = path.substring(0, pos + 1);
+        parent = false;
+    }
+}
+
+void AutoscanFanotify::monitor(zmm::Ref<AutoscanDirectory> dir)
+{
+    if (shutdownFlag)
+        init();
+    assert(dir->getScanMode() == InotifyScanMode);
+    log_debug("---> INCOMING REQUEST TO MONITOR [%s]\n", 
+            dir->getLocation().c_str());
+    AUTOLOCK(mutex);
+    monitorQueue->enqueue(dir);
+    fanotify->stop();
+}
+
+void AutoscanFanotify::unmonitor(zmm::Ref<AutoscanDirectory> dir)
+{
+    // must not be persistent
+    assert(! dir->persistent());
+    
+    log_debug("---> INCOMING REQUEST TO UNMONITOR [%s]\n", 
+            dir->getLocation().c_str());
+    AUTOLOCK(mutex);
+    unmonitorQueue->enqueue(dir);
+    fanotify->stop();
+}
+
+void AutoscanFanotify::monitorDirectory(Ref<AutoscanDirectory> adir)
+{
+    String location;
+    try
+    {
+        location = normalizePath(adir->getLocation()) + DIR_SEPARATOR;
+    }
+    catch (Exception e)
+    {
+        log_error("%s\n", e.getMessage().c_str());
+        return;
+    }
+    
+    String realLocation = location;
+    char *real = realpath(location.c_str(), NULL);
+    if (real)
+    {
+        realLocation = String(real);
+        free(real);
+        if (realLocation.charAt(realLocation.length() - 1) != DIR_SEPARATOR)
+            realLocation = realLocation + DIR_SEPARATOR;
+    }
+    
+    for (int i = 0; i < monitoredList->size(); i++)
+    {
+        Ref<Monitored> monitored = monitoredList->get(i);
+        if (monitored->getLocation() == location)
+        {
+            monitored->setAutoscanDirectory(adir);
+            return;
+        }
+    }
+    
+    struct timespec start;
+    getTimespecNow(&start);
+    Ref<Monitored> monitored(new Monitored(adir, location, realLocation));
+    addMarks(monitored);
+    monitoredList->append(monitored);
+    rebuildMonitoredPaths();
+    log_info("fanotify: %s added %d filesystem marks in %ld ms\n",
+            adir->getLocation().c_str(), monitored->getMarks()->size(), getDeltaMillis(&start));
+}
+
+void AutoscanFanotify::unmonitorDirectory(Ref<AutoscanDirectory> adir)
+{
+    String location;
+    try
+    {
+        location = normalizePath(adir->getLocation()) + DIR_SEPARATOR;
+    }
+    catch (Exception e)
+    {
+        log_error("%s\n", e.getMessage().c_str());
+        return;
+    }
+    
+    for (int i = 0; i < monitoredList->size(); i++)
+    {
+        Ref<Monitored> monitored = monitoredList->get(i);
+        if (monitored->getLocation() != location)
+            continue;
+        
+        log_debug("removing fanotify marks of %s\n", location.c_str());
+        Ref<IntArray> marks = monitored->getMarks();
+        for (int j = 0; j < marks->size(); j++)
+            fanotify->removeMark(marks->get(j));
+        monitoredList->remove(i);
+        rebuildMonitoredPaths();
+        return;
+    }
+}
+
+void AutoscanFanotify::addMarks(Ref<Monitored> monitored)
+{
+    // a persistent autoscan directory may not exist yet, the mark of the
+    // nearest parent reports its creation
+    String path = monitored->getRealLocation();
+    while (! check_path(path, true))
+    {
+        int pos = path.rindex(path.length() - 2, DIR_SEPARATOR);
+        if (pos < 0)
+            return;
+        path = path.substring(0, pos + 1);
+    }
+    
+    int id = fanotify->addMark(path, events);
+    if (id >= 0)
+        monitored->getMarks()->append(id);
+    
+    if (! monitored->getAutoscanDirectory()->getRecursive())
+        return;
+    
+    // the mounts below a recursive autoscan directory need marks of their
+    // own
+    FILE *mounts = setmntent(AUTOSCAN_FANOTIFY_MOUNTS_FILE, "r");
+    if (! mounts)
+    {
+        log_warning("Cannot read %s: %s\n", AUTOSCAN_FANOTIFY_MOUNTS_FILE, strerror(errno));
+        return;
+    }
+    
+    struct mntent entry;
+    char buf[PATH_MAX * 2];
+    while (getmntent_r(mounts, &entry, buf, sizeof(buf)))
+    {
+        String mountPoint = String(entry.mnt_dir) + DIR_SEPARATOR;
+        if (mountPoint.length() <= path.length() || ! mountPoint.startsWith(path))
+            continue;
+        id = fanotify->addMark(mountPoint, events);
+        if (id >= 0)
+            monitored->getMarks()->append(id);
+    }
+    endmntent(mounts);
+}
+
+void AutoscanFanotify::rebuildMonitoredPaths()
+{
+    monitoredPaths = Ref<DSOHash<Monitored> >(new DSOHash<Monitored>(hashCapacity(monitoredList->size() * 2 + 1)));
+    for (int i = 0; i < monitoredList->size(); i++)
+        monitoredPaths->put(monitoredList->get(i)->getRealLocation(), monitoredList->get(i));
+}
+
+void AutoscanFanotify::rescanAll()
+{
+    Ref<ContentManager> cm = ContentManager::getInstance();
+    for (int i = 0; i < monitoredList->size(); i++)
+    {
+        Ref<AutoscanDirectory> adir = monitoredList->get(i)->getAutoscanDirectory();
+        if (adir->getObjectID() == INVALID_OBJECT_ID)
+            continue;
+        cm->rescanDirectory(adir->getObjectID(), adir->getScanID(), adir->getScanMode(), nil, false);
+    }
+}
+
+#endif // HAVE_FANOTIFY
@@ -0,0 +1,137 @@
+/*MT*
+    
+    MediaTomb - http://www.mediatomb.cc/
+    
+    autoscan_fanotify.h - this file is part of MediaTomb.
+    
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+    
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+    
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+    
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+    
+    $Id$
+*/
+
+/// \file autoscan_fanotify.h
+#ifndef __AUTOSCAN_FANOTIFY_H__
+#define __AUTOSCAN_FANOTIFY_H__
+
+#include "zmmf/zmmf.h"
+#include "sync.h"
+#include "hash.h"
+#include "autoscan.h"
+#include "autoscan_changes.h"
+#include "mt_fanotify.h"
+
+/// \brief Monitors the inotify mode autoscan directories with fanotify.
+///
+/// Instead of a watch per directory, one mark per filesystem reports the
+/// changes of all directories on it, the events are mapped back to the
+/// autoscan directories by their path.
+class AutoscanFanotify : public AutoscanMonitor
+{
+public:
+    AutoscanFanotify();
+    virtual ~AutoscanFanotify();
+    void init();
+    
+    /// \brief shutdown the fanotify thread
+    void shutdown();
+    
+    /// \brief Start monitoring a directory
+    virtual void monitor(zmm::Ref<AutoscanDirectory> dir);
+    
+    /// \brief Stop monitoring a directory
+    virtual void unmonitor(zmm::Ref<AutoscanDirectory> dir);
+    
+private:
+    static void *staticThreadProc(void *arg);
+    void threadProc();
+    
+    pthread_t thread;
+    
+    zmm::Ref<Fanotify> fanotify;
+    
+    zmm::Ref<Mutex> mutex;
+    
+    zmm::Ref<zmm::ObjectQueue<AutoscanDirectory> > monitorQueue;
+    zmm::Ref<zmm::ObjectQueue<AutoscanDirectory> > unmonitorQueue;
+    
+    // event mask with events to watch for (set by constructor);
+    int events;
+    
+    class Monitored : public zmm::Object
+    {
+    public:
+        Monitored(zmm::Ref<AutoscanDirectory> adir, zmm::String location, zmm::String realLocation)
+        {
+            this->adir = adir;
+            this->location = location;
+            this->realLocation = realLocation;
+            marks = zmm::Ref<zmm::IntArray>(new zmm::IntArray());
+        }
+        zmm::Ref<AutoscanDirectory> getAutoscanDirectory() { return adir; }
+        void setAutoscanDirectory(zmm::Ref<AutoscanDirectory> adir) { this->adir = adir; }
+        
+        /// \brief the normalized location, ends with a separator
+        zmm::String getLocation() { return location; }
+        
+        /// \brief the location with the symbolic links resolved, as the
+        /// events report it
+        zmm::String getRealLocation() { return realLocation; }
+        
+        /// \brief the ids of the fanotify marks taken for the directory
+        zmm::Ref<zmm::IntArray> getMarks() { return marks; }
+    private:
+        zmm::Ref<AutoscanDirectory> adir;
+        zmm::String location;
+        zmm::String realLocation;
+        zmm::Ref<zmm::IntArray> marks;
+    };
+    
+    /// \brief the monitored directories by their real location
+    zmm::Ref<DSOHash<Monitored> > monitoredPaths;
+    zmm::Ref<zmm::Array<Monitored> > monitoredList;
+    
+    /// \brief the changes that were not passed on yet
+    zmm::Ref<AutoscanChanges> changes;
+    
+    void monitorDirectory(zmm::Ref<AutoscanDirectory> adir);
+    void unmonitorDirectory(zmm::Ref<AutoscanDirectory> adir);
+    void rebuildMonitoredPaths();
+    
+    /// \brief marks the filesystems of the location and of the mount
+    /// points below it
+    void addMarks(zmm::Ref<Monitored> monitored);
+    
+    /// \brief returns the monitored directory an entry belongs to, nil if
+    /// the entry is not monitored
+    /// \param path the real path of the directory of the entry, ends with
+    /// a separator
+    zmm::Ref<Monitored> getMonitored(zmm::String path, zmm::String name, bool isDir);
+    
+    void handleEvent(zmm::Ref<FanotifyEvent> event);
+    
+    /// \brief rescans all monitored directories, when events were lost
+    void rescanAll();
+    
+    /// \brief is set to true by shutdown() if the fanotify thread should terminate
+    bool shutdownFlag;
+};
+
+#endif // __AUTOSCAN_FANOTIFY_H__
@@ -43,10 +43,11 @@
 
 #define AUTOSCAN_INOTIFY_INITIAL_QUEUE_SIZE 20
 
-// always use a prime!
-#define AUTOSCAN_INOTIFY_HASH_SIZE 30851
+/// \brief number of watches the hashes are created for, they grow as needed
+#define AUTOSCAN_INOTIFY_INITIAL_WATCHES 1000
 
 #define INOTIFY_MAX_USER_WATCHES_FILE "/proc/sys/fs/inotify/max_user_watches"
+
 using namespace zmm;
 
 AutoscanInotify::AutoscanInotify()
@@ -54,30 +55,28 @@ AutoscanInotify::AutoscanInotify()
     mutex = Ref<Mutex>(new Mutex());
     cond = Ref<Cond>(new Cond(mutex));
 
-    int hash_size = AUTOSCAN_INOTIFY_HASH_SIZE;
-
+    maxUserWatches = -1;
     if (check_path(_(INOTIFY_MAX_USER_WATCHES_FILE)))
     {
-        int max_watches = -1;
         try
         {
-            max_watches = trim_string(read_text_file(_(INOTIFY_MAX_USER_WATCHES_FILE))).toInt();
-            log_debug("Max watches on the system: %d\n", max_watches);
+            maxUserWatches = trim_string(read_text_file(_(INOTIFY_MAX_USER_WATCHES_FILE))).toInt();
+            log_debug("Max watches on the system: %d\n", maxUserWatches);
         }
         catch (Exception ex)
         {
             log_error("Could not determine maximum number of inotify user watches: %s\n", ex.getMessage().c_str());
         }
-
-        if (max_watches > 0)
-            hash_size = max_watches * 5;
     }
 
-    watches = Ref<DBOHash<int, Wd> >(new DBOHash<int, Wd>(hash_size, -1, -2));
+    watchList = NULL;
+    watchPathBytes = 0;
+    rebuildWatchHashes(AUTOSCAN_INOTIFY_INITIAL_WATCHES);
+    changes = Ref<AutoscanChanges>(new AutoscanChanges());
     shutdownFlag = true;
     monitorQueue = Ref<ObjectQueue<AutoscanDirectory> >(new ObjectQueue<AutoscanDirectory>(AUTOSCAN_INOTIFY_INITIAL_QUEUE_SIZE));
     unmonitorQueue = Ref<ObjectQueue<AutoscanDirectory> >(new ObjectQueue<AutoscanDirectory>(AUTOSCAN_INOTIFY_INITIAL_QUEUE_SIZE));
-    events = IN_MODIFY | IN_CREATE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT;
+    events = IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT;
 }
 
 void AutoscanInotify::init()
@@ -119,7 +118,13 @@ void AutoscanInotify::shutdown()
         thread = 0;
         log_debug("inotify thread died.\n");
         inotify = nil;
-        watches->clear();
+        // the Wd objects are released with the hashes
+        watchList = NULL;
+        watchPathBytes = 0;
+        rebuildWatchHashes(AUTOSCAN_INOTIFY_INITIAL_WATCHES);
+        // the rescan on the next start picks up the pending changes
+        changes->clear();
+        changes->logStats("inotify");
     }
 }
 
@@ -198,6 +203,9 @@ void AutoscanInotify::threadProc()
                     continue;
                 }
                 
+                struct timespec start;
+                getTimespecNow(&start);
+                int watchCount = watches->size();
                 if (adir->getRecursive())
                 {
                     log_debug("adding recursive watch: %s\n", location.c_str());
@@ -208,6 +216,12 @@ void AutoscanInotify::threadProc()
                     log_debug("adding non-recursive watch: %s\n", location.c_str());
                     monitorDirectory(location, adir, location, true);
                 }
+                log_info("inotify: %s added %d watches in %ld ms; %d watches using about %ld kB in total\n",
+                        location.c_str(), watches->size() - watchCount, getDeltaMillis(&start),
+                        watches->size(), getWatchMemory() / 1024);
+                if (maxUserWatches > 0 && watches->size() > maxUserWatches - maxUserWatches / 10)
+                    log_warning("inotify: %d of the %d watches allowed by %s are in use\n",
+                            watches->size(), maxUserWatches, INOTIFY_MAX_USER_WATCHES_FILE);
                 cm->rescanDirectory(adir->getObjectID(), adir->getScanID(), adir->getScanMode(), nil, false);
                 
                 AUTORELOCK();
@@ -215,12 +229,18 @@ void AutoscanInotify::threadProc()
             
             AUTOUNLOCK();
             
-            /* --- get event --- (blocking) */
-            event = inotify->nextEvent();
+            /* --- get event --- (blocking until a change is due) */
+            event = inotify->nextEvent(changes->getTimeout());
             /* --- */
             
+            // the changes are passed on when the events stop, or at
+            // least once per batch time while they keep coming in
+            if (! event || changes->isBatchDue())
+                changes->flush(false);
+            
             if (event)
             {
+                changes->countEvent();
                 int wd = event->wd;
                 int mask = event->mask;
                 String name = event->name;
@@ -240,6 +260,12 @@ void AutoscanInotify::threadProc()
                     *pathBuf << name;
                 String path = pathBuf->toString();
                 
+                // a renamed directory keeps its wd, its old path must not
+                // lead to it anymore; the watch is found under the new path
+                // by getWdByPath() or monitorDirectory()
+                if ((mask & IN_MOVED_FROM) && (mask & IN_ISDIR))
+                    unindexPath(path + DIR_SEPARATOR);
+                
                 Ref<AutoscanDirectory> adir;
                 Ref<WatchAutoscan> watchAs = getAppropriateAutoscan(wdObj, path);
                 if (watchAs != nil)
@@ -281,7 +307,7 @@ void AutoscanInotify::threadProc()
                     }
                 }
                 
-                if (adir != nil && mask & (IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO | IN_UNMOUNT))
+                if (adir != nil && mask & (IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_UNMOUNT))
                 {
                     String fullPath;
                     if (mask & IN_ISDIR)
@@ -289,7 +315,7 @@ void AutoscanInotify::threadProc()
                     else
                         fullPath = path;
                     
-                    if (! (mask & IN_MOVED_TO))
+                    if (! (mask & (IN_MOVED_TO | IN_CLOSE_WRITE)))
                     {
                         log_debug("deleting %s\n", fullPath.c_str());
                         
@@ -308,16 +334,19 @@ void AutoscanInotify::threadProc()
                             }
                         }
                         
-                        int objectID = st->findObjectIDByPath(fullPath);
-                        if (objectID != INVALID_OBJECT_ID)
-                            cm->removeObject(objectID);
                     }
+                    autoscan_change_t change;
+                    if (mask & IN_MODIFY)
+                        change = AutoscanChangeModified;
+                    else if (mask & IN_MOVED_TO)
+                        change = AutoscanChangeAdded;
+                    else if (mask & IN_CLOSE_WRITE)
+                        change = AutoscanChangeClosed;
+                    else
+                        change = AutoscanChangeRemoved;
+                    changes->queue(fullPath, adir, change);
                     if (mask & (IN_MODIFY | IN_MOVED_TO))
                     {
-                        log_debug("adding %s\n", path.c_str());
-                        // path, recursive, async, hidden, low priority, cancellable
-                        cm->addFile(fullPath, adir->getRecursive(), true, adir->getHidden(), true, false);
-                        
                         if (mask & IN_ISDIR)
                             monitorUnmonitorRecursive(path, false, adir, watchAs->getNormalizedAutoscanPath(), false);
                     }
@@ -326,7 +355,7 @@ void AutoscanInotify::threadProc()
                 {
                     removeWatchMoves(wd);
                     removeDescendants(wd);
-                    watches->remove(wd);
+                    removeWd(wd);
                 }
             }
         }
@@ -389,7 +418,7 @@ int AutoscanInotify::addMoveWatch(String path, int removeWd, int parentWd)
         if (wdObj == nil)
         {
             wdObj = Ref<Wd>(new Wd(path, wd, parentWd));
-            watches->put(wd, wdObj);
+            putWd(wdObj);
         }
         else
         {
@@ -567,16 +596,35 @@ void AutoscanInotify::removeNonexistingMonitor(int wd, Ref<Wd> wdObj, Ref<Array<
 
 void AutoscanInotify::monitorUnmonitorRecursive(String startPath, bool unmonitor, Ref<AutoscanDirectory> adir, String normalizedAutoscanPath, bool startPoint)
 {
-    String location;
     if (unmonitor)
-        unmonitorDirectory(startPath, adir);
-    else
     {
-        bool ok = (monitorDirectory(startPath, adir, normalizedAutoscanPath, startPoint) > 0);
-        if (! ok)
-            return;
+        // the watches of the autoscan know the directories that were added
+        // below them, the tree does not have to be walked again
+        Ref<Wd> wdObj = getWdByPath(startPath + DIR_SEPARATOR);
+        Ref<WatchAutoscan> watchAs = nil;
+        if (wdObj != nil)
+            watchAs = getAppropriateAutoscan(wdObj, adir);
+        if (watchAs != nil && watchAs->getDescendants() != nil)
+        {
+            Ref<IntArray> descendants = watchAs->getDescendants();
+            for (int i = 0; i < descendants->size(); i++)
+            {
+                Ref<Wd> descObj = watches->get(descendants->get(i));
+                if (descObj == nil)
+                    continue;
+                Ref<WatchAutoscan> descAs = getAppropriateAutoscan(descObj, adir);
+                if (descAs != nil)
+                    removeFromWdObj(descObj, descAs);
+            }
+        }
+        unmonitorDirectory(startPath, adir);
+        return;
     }
     
+    bool ok = (monitorDirectory(startPath, adir, normalizedAutoscanPath, startPoint) > 0);
+    if (! ok)
+        return;
+    
     struct dirent *dent;
     struct stat statbuf;
     
@@ -600,12 +648,17 @@ void AutoscanInotify::monitorUnmonitorRecursive(String startPath, bool unmonitor
         
         String fullPath = startPath + DIR_SEPARATOR + name;
         
-        if (stat(fullPath.c_str(), &statbuf) != 0)
-            continue;
+        bool isDir;
+#ifdef _DIRENT_HAVE_D_TYPE
+        if (dent->d_type != DT_UNKNOWN && dent->d_type != DT_LNK)
+            isDir = (dent->d_type == DT_DIR);
+        else
+#endif
+        isDir = (stat(fullPath.c_str(), &statbuf) == 0) && S_ISDIR(statbuf.st_mode);
         
-        if (S_ISDIR(statbuf.st_mode))
+        if (isDir)
         {
-            monitorUnmonitorRecursive(fullPath, unmonitor, adir, normalizedAutoscanPath, false);
+            monitorUnmonitorRecursive(fullPath, false, adir, normalizedAutoscanPath, false);
         }
     }
     
@@ -634,10 +687,14 @@ int AutoscanInotify::monitorDirectory(String pathOri, Ref<AutoscanDirectory> adi
         if (wdObj == nil)
         {
             wdObj = Ref<Wd>(new Wd(path, wd, parentWd));
-            watches->put(wd, wdObj);
+            putWd(wdObj);
         }
         else
         {
+            // the directory was renamed since the watch was created
+            if (wdObj->getPath() != path)
+                moveWd(wdObj, path);
+            
             if (parentWd >= 0 && wdObj->getParentWd() < 0)
             {
                 wdObj->setParentWd(parentWd);
@@ -660,7 +717,12 @@ int AutoscanInotify::monitorDirectory(String pathOri, Ref<AutoscanDirectory> adi
             
             if (! startPoint)
             {
-                int startPointWd = inotify->addWatch(normalizedAutoscanPath, events);
+                int startPointWd;
+                Ref<Wd> startPointObj = watchPaths->get(normalizedAutoscanPath + DIR_SEPARATOR);
+                if (startPointObj != nil)
+                    startPointWd = startPointObj->getWd();
+                else
+                    startPointWd = inotify->addWatch(normalizedAutoscanPath, events);
                 log_debug("getting start point for %s -> %s wd=%d\n", pathOri.c_str(), normalizedAutoscanPath.c_str(), startPointWd);
                 if (wd >= 0)
                     addDescendant(startPointWd, wd, adir);
@@ -674,24 +736,14 @@ void AutoscanInotify::unmonitorDirectory(String path, Ref<AutoscanDirectory> adi
 {
     path = path + DIR_SEPARATOR;
     
-    // maybe there is a faster method...
-    // we use addWatch, because it returns the wd to the filename
-    // this should not add a new watch, because it should be already watched
-    int wd = inotify->addWatch(path, events);
-    
-    if (wd < 0)
+    Ref<Wd> wdObj = getWdByPath(path);
+    if (wdObj == nil)
     {
         // doesn't seem to be monitored currently
         log_debug("unmonitorDirectory called, but it isn't monitored? (%s)\n", path.c_str());
         return;
     }
-    
-    Ref<Wd> wdObj = watches->get(wd);
-    if (wdObj == nil)
-    {
-        log_error("wd not found in watches!? (%d, %s)\n", wd, path.c_str());
-        return;
-    }
+    int wd = wdObj->getWd();
     
     Ref<WatchAutoscan> watchAs = getAppropriateAutoscan(wdObj, adir);
     if (watchAs == nil)
@@ -910,6 +962,123 @@ void AutoscanInotify::removeDescendants(int wd)
     }
 }
 
+void AutoscanInotify::putWd(Ref<Wd> wdObj)
+{
+    if (watches->size() + watchesRemovedCount >= watchesMaxSize)
+        rebuildWatchHashes(watches->size() * 2);
+    
+    wdObj->prev = NULL;
+    wdObj->next = watchList;
+    if (watchList != NULL)
+        watchList->prev = wdObj.getPtr();
+    watchList = wdObj.getPtr();
+    
+    watches->put(wdObj->getWd(), wdObj);
+    // a directory that was moved away can leave its watch behind, the
+    // directory that took its place takes over the path
+    watchPaths->put(wdObj->getPath(), wdObj);
+    watchPathBytes += wdObj->getPath().length();
+}
+
+void AutoscanInotify::removeWd(int wd)
+{
+    Ref<Wd> wdObj = watches->get(wd);
+    if (wdObj == nil)
+        return;
+    
+    if (wdObj->prev != NULL)
+        wdObj->prev->next = wdObj->next;
+    else
+        watchList = wdObj->next;
+    if (wdObj->next != NULL)
+        wdObj->next->prev = wdObj->prev;
+    
+    String path = wdObj->getPath();
+    if (watchPaths->get(path) == wdObj)
+        watchPaths->remove(path);
+    watchPathBytes -= path.length();
+    watches->remove(wd);
+    watchesRemovedCount++;
+}
+
+void AutoscanInotify::moveWd(Ref<Wd> wdObj, String path)
+{
+    String oldPath = wdObj->getPath();
+    log_debug("watch %d moved from %s to %s\n", wdObj->getWd(), oldPath.c_str(), path.c_str());
+    if (watchPaths->get(oldPath) == wdObj)
+        unindexPath(oldPath);
+    watchPathBytes += path.length() - oldPath.length();
+    wdObj->setPath(path);
+    if (watches->size() + watchesRemovedCount >= watchesMaxSize)
+        rebuildWatchHashes(watches->size() * 2);
+    watchPaths->put(path, wdObj);
+}
+
+void AutoscanInotify::unindexPath(String path)
+{
+    if (watchPaths->get(path) == nil)
+        return;
+    log_debug("watch of %s moved away\n", path.c_str());
+    watchPaths->remove(path);
+    watchesRemovedCount++;
+}
+
+Ref<AutoscanInotify::Wd> AutoscanInotify::getWdByPath(String path)
+{
+    Ref<Wd> wdObj = watchPaths->get(path);
+    if (wdObj != nil)
+        return wdObj;
+    
+    // the watch of a renamed directory is not in watchPaths until it is
+    // found again; addWatch() returns the wd of the current path
+    int wd = inotify->addWatch(path, events);
+    if (wd < 0)
+        return nil;
+    wdObj = watches->get(wd);
+    if (wdObj == nil)
+    {
+        // the directory wasn't watched, remove the watch we just added
+        inotify->removeWatch(wd);
+        return nil;
+    }
+    moveWd(wdObj, path);
+    return wdObj;
+}
+
+void AutoscanInotify::rebuildWatchHashes(int maxSize)
+{
+    if (maxSize < AUTOSCAN_INOTIFY_INITIAL_WATCHES)
+        maxSize = AUTOSCAN_INOTIFY_INITIAL_WATCHES;
+    watchesMaxSize = maxSize;
+    watchesHashCapacity = hashCapacity(maxSize);
+    watchesRemovedCount = 0;
+    
+    // the new hashes take over the references of the old ones
+    Ref<DBOHash<int, Wd> > oldWatches = watches;
+    watches = Ref<DBOHash<int, Wd> >(new DBOHash<int, Wd>(watchesHashCapacity, -1, -2));
+    watchPaths = Ref<DSOHash<Wd> >(new DSOHash<Wd>(watchesHashCapacity));
+    // the list is in reverse order of creation, so the newest watch of a
+    // path is put last
+    Wd *last = watchList;
+    while (last != NULL && last->next != NULL)
+        last = last->next;
+    for (Wd *wdObj = last; wdObj != NULL; wdObj = wdObj->prev)
+    {
+        Ref<Wd> ref(wdObj);
+        watches->put(wdObj->getWd(), ref);
+        watchPaths->put(wdObj->getPath(), ref);
+    }
+}
+
+long AutoscanInotify::getWatchMemory()
+{
+    // the objects of a directory watch, its path and the slots of both hashes
+    return (long)watches->size() * (sizeof(Wd) + sizeof(Array<Watch>) + sizeof(Watch *) +
+                                    sizeof(WatchAutoscan) + sizeof(StringBase))
+        + watchPathBytes
+        + (long)watchesHashCapacity * (sizeof(struct dbo_hash_slot<int, Wd>) + sizeof(struct dso_hash_slot<Wd>));
+}
+
 String AutoscanInotify::normalizePathNoEx(String path)
 {
     try
@@ -35,6 +35,7 @@
 #include "sync.h"
 #include "hash.h"
 #include "autoscan.h"
+#include "autoscan_changes.h"
 #include "mt_inotify.h"
 
 #define INOTIFY_ROOT -1
@@ -46,7 +47,7 @@ enum inotify_watch_type_t
     InotifyWatchTypeAutoscan
 };
 
-class AutoscanInotify : public zmm::Object
+class AutoscanInotify : public AutoscanMonitor
 {
 public:
     AutoscanInotify();
@@ -59,10 +60,10 @@ public:
     void shutdown();
     
     /// \brief Start monitoring a directory
-    void monitor(zmm::Ref<AutoscanDirectory> dir);
+    virtual void monitor(zmm::Ref<AutoscanDirectory> dir);
     
     /// \brief Stop monitoring a directory
-    void unmonitor(zmm::Ref<AutoscanDirectory> dir);
+    virtual void unmonitor(zmm::Ref<AutoscanDirectory> dir);
     
 private:
     static void *staticThreadProc(void *arg);
@@ -153,12 +154,19 @@ private:
             this->path = path;
             this->wd = wd;
             this->parentWd = parentWd;
+            prev = NULL;
+            next = NULL;
         }
         zmm::String getPath() { return path; }
+        void setPath(zmm::String path) { this->path = path; }
         int getWd() { return wd; }
         int getParentWd() { return parentWd; }
         void setParentWd(int parentWd) { this->parentWd = parentWd; }
         zmm::Ref<zmm::Array<Watch> > getWdWatches() { return wdWatches; }
+        
+        /// \brief list of all Wd objects, the watch hashes hold the references
+        Wd *prev;
+        Wd *next;
     private:
         zmm::Ref<zmm::Array<Watch> > wdWatches;
         zmm::String path;
@@ -166,8 +174,45 @@ private:
         int wd;
     };
     
+    /// \brief the watched directories by wd
     zmm::Ref<DBOHash<int, Wd> > watches;
     
+    /// \brief the watched directories by path, the paths end with a separator
+    zmm::Ref<DSOHash<Wd> > watchPaths;
+    
+    Wd *watchList;
+    
+    /// \brief number of watches the hashes were created for
+    int watchesMaxSize;
+    int watchesHashCapacity;
+    
+    /// \brief number of watches removed since the hashes were created
+    int watchesRemovedCount;
+    
+    /// \brief total length of the paths of the watches
+    long watchPathBytes;
+    
+    /// \brief max_user_watches of the system, -1 if unknown
+    int maxUserWatches;
+    
+    void putWd(zmm::Ref<Wd> wdObj);
+    void removeWd(int wd);
+    /// \brief moves a watch to the current path of its directory
+    void moveWd(zmm::Ref<Wd> wdObj, zmm::String path);
+    /// \brief removes a path from watchPaths when its directory was moved
+    /// away; the watch itself stays until its wd is removed
+    void unindexPath(zmm::String path);
+    /// \brief returns the watch of a directory, also if the directory was
+    /// renamed after the watch was created; nil if it isn't watched
+    zmm::Ref<Wd> getWdByPath(zmm::String path);
+    void rebuildWatchHashes(int maxSize);
+    
+    /// \brief returns the approximate memory used by the watches in bytes
+    long getWatchMemory();
+    
+    /// \brief the changes that were not passed on yet
+    zmm::Ref<AutoscanChanges> changes;
+    
     zmm::String normalizePathNoEx(zmm::String path);
     
     void monitorUnmonitorRecursive(zmm::String startPath, bool unmonitor, zmm::Ref<AutoscanDirectory> adir, zmm::String normalizedAutoscanPath, bool startPoint);
@@ -52,6 +52,7 @@ CdsObject::CdsObject() : Object()
     virt = 0;
     sortPriority = 0;
     objectFlags = OBJECT_FLAG_RESTRICTED;
+    atomic_set(&packedFields, 0);
 }
 
 void CdsObject::copyTo(Ref<CdsObject> obj)
@@ -63,6 +64,7 @@ void CdsObject::copyTo(Ref<CdsObject> obj)
     obj->setClass(upnpClass);
     obj->setLocation(location);
     obj->setVirtual(virt);
+    unpack();
     obj->setMetadata(metadata->clone());
     obj->setAuxData(auxdata->clone());
     obj->setFlags(objectFlags);
@@ -85,13 +87,13 @@ int CdsObject::equals(Ref<CdsObject> obj, bool exactly)
     if (! resourcesEqual(obj))
         return 0;
     
-    if (! metadata->equals(obj->getMetadata()))
+    if (! getMetadata()->equals(obj->getMetadata()))
         return 0;
     
     if (exactly && !
         (location == obj->getLocation() &&
          virt == obj->isVirtual() &&
-         auxdata->equals(obj->auxdata) &&
+         getAuxData()->equals(obj->getAuxData()) &&
          objectFlags == obj->getFlags()
         ))
         return 0;
@@ -100,6 +102,8 @@ int CdsObject::equals(Ref<CdsObject> obj, bool exactly)
 
 int CdsObject::resourcesEqual(Ref<CdsObject> obj)
 {
+    unpackResources();
+    obj->unpackResources();
     if (resources->size() != obj->resources->size())
         return 0;
     
@@ -312,8 +316,118 @@ void CdsContainer::validate()
 /*    if (!check_path(this->location, true))
         throw _Exception(_("CdsContainer: validation failed")); */
 }
+Ref<Mutex> CdsObject::unpackMutex = Ref<Mutex>(new Mutex());
+
+void CdsObject::setPackedData(String metadata, String auxdata, String resources)
+{
+    // empty columns need no decoding; the object is not shared yet
+    int fields = 0;
+    if (string_ok(metadata))
+    {
+        packedMetadata = metadata;
+        fields |= PACKED_METADATA;
+    }
+    if (string_ok(auxdata))
+    {
+        packedAuxData = auxdata;
+        fields |= PACKED_AUXDATA;
+    }
+    if (string_ok(resources))
+    {
+        packedResources = resources;
+        fields |= PACKED_RESOURCES;
+    }
+    atomic_set(&packedFields, fields);
+}
+
+void CdsObject::clearPacked(int field)
+{
+    // unpackMutex is held, so nobody else changes the bits; release makes
+    // the decoded field visible to everyone who sees the bit cleared in
+    // isPacked()
+    int fields = atomic_get(&packedFields) & ~field;
+#ifdef ATOMIC_NEED_MUTEX
+    atomic_set_release(&packedFields, fields, &mutex);
+#else
+    atomic_set_release(&packedFields, fields);
+#endif
+}
+
+void CdsObject::discardPacked(int field)
+{
+    AUTOLOCK(unpackMutex);
+    if (field == PACKED_METADATA)
+        packedMetadata = nil;
+    else if (field == PACKED_AUXDATA)
+        packedAuxData = nil;
+    else if (field == PACKED_RESOURCES)
+        packedResources = nil;
+    clearPacked(field);
+}
+
+/* the data is decoded outside of the lock, so threads decoding different
+ * objects don't wait for each other; if two threads decode the same field,
+ * the first one to finish wins */
+
+void CdsObject::_unpackMetadata()
+{
+    AUTOLOCK(unpackMutex);
+    if (! (atomic_get(&packedFields) & PACKED_METADATA))
+        return;
+    String data = packedMetadata;
+    AUTOUNLOCK();
+    Ref<Dictionary> dict(new Dictionary());
+    dict->unpack(data);
+    AUTORELOCK();
+    if (! (atomic_get(&packedFields) & PACKED_METADATA))
+        return;
+    metadata = dict;
+    packedMetadata = nil;
+    clearPacked(PACKED_METADATA);
+}
+
+void CdsObject::_unpackAuxData()
+{
+    AUTOLOCK(unpackMutex);
+    if (! (atomic_get(&packedFields) & PACKED_AUXDATA))
+        return;
+    String data = packedAuxData;
+    AUTOUNLOCK();
+    Ref<Dictionary> dict(new Dictionary());
+    dict->unpack(data);
+    AUTORELOCK();
+    if (! (atomic_get(&packedFields) & PACKED_AUXDATA))
+        return;
+    auxdata = dict;
+    packedAuxData = nil;
+    clearPacked(PACKED_AUXDATA);
+}
+
+void CdsObject::_unpackResources()
+{
+    AUTOLOCK(unpackMutex);
+    if (! (atomic_get(&packedFields) & PACKED_RESOURCES))
+        return;
+    String data = packedResources;
+    AUTOUNLOCK();
+    Ref<Array<CdsResource> > res = CdsResource::unpackList(data);
+    AUTORELOCK();
+    if (! (atomic_get(&packedFields) & PACKED_RESOURCES))
+        return;
+    resources = res;
+    packedResources = nil;
+    clearPacked(PACKED_RESOURCES);
+}
+
+String CdsObject::packResources()
+{
+    unpackResources();
+    return CdsResource::packList(resources);
+}
+
 void CdsObject::optimize()
 {
+    unpack();
     metadata->optimize();
     auxdata->optimize();
     resources->optimize();
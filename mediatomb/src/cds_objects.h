@@ -35,6 +35,7 @@
 #include "common.h"
 #include "dictionary.h"
 #include "cds_resource.h"
+#include "sync.h"
 
 // ATTENTION: These values need to be changed in web/js/items.js too.
 #define OBJECT_TYPE_CONTAINER           0x00000001
@@ -71,6 +72,10 @@
 #define OBJECT_AUTOSCAN_UI      1
 #define OBJECT_AUTOSCAN_CFG     2
 
+#define PACKED_METADATA         0x01
+#define PACKED_AUXDATA          0x02
+#define PACKED_RESOURCES        0x04
+
 int CdsObjectTitleComparator(void *arg1, void *arg2);
 
 /// \brief Generic object in the Content Directory.
@@ -111,6 +116,42 @@ protected:
     zmm::Ref<Dictionary> auxdata;
     zmm::Ref<zmm::Array<CdsResource> > resources;
     
+    /// \brief metadata, auxdata and resources as read from the database;
+    /// they are only decoded when they are accessed
+    zmm::String packedMetadata;
+    zmm::String packedAuxData;
+    zmm::String packedResources;
+    
+    /// \brief PACKED_ bits of the fields that are not decoded yet; cached
+    /// objects are shared between threads, so the bits are only changed
+    /// under unpackMutex, and cleared once the decoded field is in place
+    mt_atomic_t packedFields;
+    static zmm::Ref<Mutex> unpackMutex;
+    
+    inline bool isPacked(int field)
+    {
+#ifdef ATOMIC_NEED_MUTEX
+        // the mutex of this object, not a global one
+        return (atomic_get_acquire(&packedFields, &mutex) & field);
+#else
+        return (atomic_get_acquire(&packedFields) & field);
+#endif
+    }
+    void clearPacked(int field);
+    /// \brief Drops the packed data of a field that is being replaced,
+    /// without decoding it.
+    void discardPacked(int field);
+    
+    inline void unpackMetadata()
+    { if (isPacked(PACKED_METADATA)) _unpackMetadata(); }
+    inline void unpackAuxData()
+    { if (isPacked(PACKED_AUXDATA)) _unpackAuxData(); }
+    inline void unpackResources()
+    { if (isPacked(PACKED_RESOURCES)) _unpackResources(); }
+    void _unpackMetadata();
+    void _unpackAuxData();
+    void _unpackResources();
+    
 
 public:
     /// \brief Constructor. Sets the default values.
@@ -203,67 +244,93 @@ public:
     
     /// \brief Query single metadata value.
     inline zmm::String getMetadata(zmm::String key)
-    { return metadata->get(key); }
+    { unpackMetadata(); return metadata->get(key); }
 
     /// \brief Query entire metadata dictionary.
-    inline zmm::Ref<Dictionary> getMetadata() { return metadata; }
+    inline zmm::Ref<Dictionary> getMetadata() { unpackMetadata(); return metadata; }
     
     /// \brief Set entire metadata dictionary.
     inline void setMetadata(zmm::Ref<Dictionary> metadata)
-    { this->metadata = metadata; }
+    {
+        if (isPacked(PACKED_METADATA))
+            discardPacked(PACKED_METADATA);
+        this->metadata = metadata;
+    }
 
     /// \brief Set a single metadata value.
     inline void setMetadata(zmm::String key, zmm::String value)
-    { metadata->put(key, value); }
+    { unpackMetadata(); metadata->put(key, value); }
 
     /// \brief Removes metadata with the given key
     inline void removeMetadata(zmm::String key)
-    { metadata->remove(key); }
+    { unpackMetadata(); metadata->remove(key); }
     
 
     /// \brief Query single auxdata value.
     inline zmm::String getAuxData(zmm::String key)
-    { return auxdata->get(key); }
+    { unpackAuxData(); return auxdata->get(key); }
 
     /// \brief Query entire auxdata dictionary.
-    inline zmm::Ref<Dictionary> getAuxData() { return auxdata; }
+    inline zmm::Ref<Dictionary> getAuxData() { unpackAuxData(); return auxdata; }
 
     /// \brief Set a single auxdata value.
     inline void setAuxData(zmm::String key, zmm::String value)
-    { auxdata->put(key, value); }
+    { unpackAuxData(); auxdata->put(key, value); }
     
     /// \brief Set entire auxdata dictionary.
     inline void setAuxData(zmm::Ref<Dictionary> auxdata)
-    { this->auxdata = auxdata; }
+    {
+        if (isPacked(PACKED_AUXDATA))
+            discardPacked(PACKED_AUXDATA);
+        this->auxdata = auxdata;
+    }
 
     /// \brief Removes auxdata with the given key
     inline void removeAuxData(zmm::String key)
-    { auxdata->remove(key); }
+    { unpackAuxData(); auxdata->remove(key); }
     
     
     /// \brief Get number of resource tags
-    inline int getResourceCount() { return resources->size(); }
+    inline int getResourceCount() { unpackResources(); return resources->size(); }
 
     /// \brief Query resources
     inline zmm::Ref<zmm::Array<CdsResource> > getResources()
-    { return resources; }
+    { unpackResources(); return resources; }
  
     /// \brief Set resources
     inline void setResources(zmm::Ref<zmm::Array<CdsResource> > res) 
-    { resources = res; }
+    {
+        if (isPacked(PACKED_RESOURCES))
+            discardPacked(PACKED_RESOURCES);
+        resources = res;
+    }
     
     /// \brief Query resource tag with the given index
     inline zmm::Ref<CdsResource> getResource(int index)
-    { return resources->get(index); }
+    { unpackResources(); return resources->get(index); }
     
     /// \brief Add resource tag
     inline void addResource(zmm::Ref<CdsResource> resource)
-    { resources->append(resource); } 
+    { unpackResources(); resources->append(resource); } 
   
     /// \brief Insert resource tag at index
     inline void insertResource(int index, zmm::Ref<CdsResource> resource)
-    { resources->insert(index, resource); }
+    { unpackResources(); resources->insert(index, resource); }
+
+    /// \brief Set the metadata, auxdata and resources as stored in the
+    /// database; they are decoded on first access.
+    /// \param metadata packed or url encoded metadata, may be nil
+    /// \param auxdata packed or url encoded auxdata, may be nil
+    /// \param resources packed or legacy encoded resources, may be nil
+    void setPackedData(zmm::String metadata, zmm::String auxdata, zmm::String resources);
 
+    /// \brief Returns the packed encoding of the resources for the database.
+    zmm::String packResources();
+
+    /// \brief Decodes everything that was not accessed yet.
+    inline void unpack()
+    { unpackMetadata(); unpackAuxData(); unpackResources(); }
+    
     /// \brief Copies all object properties to another object.
     /// \param obj target object (clone)
     virtual void copyTo(zmm::Ref<CdsObject> obj);
@@ -38,6 +38,9 @@
 
 #define RESOURCE_PART_SEP '~'
 
+/// \brief separator of the url encoded resource lists of older versions
+#define RESOURCE_SEP '|'
+
 using namespace zmm;
 
 CdsResource::CdsResource(int handlerType) : Object()
@@ -178,6 +181,58 @@ Ref<CdsResource> CdsResource::decode(String serial)
     return resource;
 }
 
+// <handler type>:<attributes><parameters><options>
+void CdsResource::packTo(Ref<StringBuffer> buf)
+{
+    *buf << handlerType << ':';
+    attributes->packTo(buf);
+    parameters->packTo(buf);
+    options->packTo(buf);
+}
+
+Ref<CdsResource> CdsResource::unpackFrom(const char *data, int length, int *pos)
+{
+    int handlerType = Dictionary::unpackNumber(data, length, pos);
+    Ref<CdsResource> resource(new CdsResource(handlerType));
+    resource->attributes->unpackFrom(data, length, pos);
+    resource->parameters->unpackFrom(data, length, pos);
+    resource->options->unpackFrom(data, length, pos);
+    return resource;
+}
+
+// <format><count>:<resource>...
+String CdsResource::packList(Ref<Array<CdsResource> > resources)
+{
+    Ref<StringBuffer> buf(new StringBuffer());
+    *buf << PACKED_FORMAT_V1 << resources->size() << ':';
+    for (int i = 0; i < resources->size(); i++)
+        resources->get(i)->packTo(buf);
+    return buf->toString();
+}
+
+Ref<Array<CdsResource> > CdsResource::unpackList(String data)
+{
+    Ref<Array<CdsResource> > resources(new Array<CdsResource>());
+    if (! string_ok(data))
+        return resources;
+    if (data.charAt(0) != PACKED_FORMAT_V1)
+    {
+        Ref<Array<StringBase> > parts = split_string(data, RESOURCE_SEP);
+        for (int i = 0; i < parts->size(); i++)
+            resources->append(decode(parts->get(i)));
+        return resources;
+    }
+    const char *ptr = data.c_str();
+    int length = data.length();
+    int pos = 1;
+    int count = Dictionary::unpackNumber(ptr, length, &pos);
+    for (int i = 0; i < count; i++)
+        resources->append(unpackFrom(ptr, length, &pos));
+    if (pos != length)
+        throw _Exception(_("CdsResource::unpackList: trailing data"));
+    return resources;
+}
+
 void CdsResource::optimize()
 {
     attributes->optimize();
@@ -113,6 +113,24 @@ public:
     zmm::String encode();
     static zmm::Ref<CdsResource> decode(zmm::String serial);
 
+    /// \brief Appends the packed encoding of the resource, see
+    /// Dictionary::packTo()
+    void packTo(zmm::Ref<zmm::StringBuffer> buf);
+
+    /// \brief Reads a resource written by packTo().
+    /// \param data the packed data
+    /// \param length length of data
+    /// \param pos position to start at, set to the end of the resource
+    static zmm::Ref<CdsResource> unpackFrom(const char *data, int length, int *pos);
+
+    /// \brief Returns the packed encoding of a list of resources, used to
+    /// store the resources of an object in the database.
+    static zmm::String packList(zmm::Ref<zmm::Array<CdsResource> > resources);
+
+    /// \brief Decodes a list of resources written by packList(); the url
+    /// encoded lists written by older versions are accepted too.
+    static zmm::Ref<zmm::Array<CdsResource> > unpackList(zmm::String data);
+
     /// \brief Frees unnecessary memory
     void optimize();
 };
@@ -78,7 +78,7 @@ String CdsResourceManager::renderExtension(String contentType, String location)
     return nil;
 }
 
-void CdsResourceManager::addResources(Ref<CdsItem> item, Ref<Element> element)
+void CdsResourceManager::addResources(Ref<CdsItem> item, Ref<StringBuffer> buf)
 {
     Ref<UrlBase> urlBase = addResources_getUrlBase(item);
     Ref<ConfigManager> config = ConfigManager::getInstance();
@@ -381,19 +381,21 @@ void CdsResourceManager::addResources(Ref<CdsItem> item, Ref<Element> element)
                 rct = item->getResource(i)->getParameter(_(RESOURCE_CONTENT_TYPE));
             if (rct == ID3_ALBUM_ART)
             {
-                Ref<Element> aa(new Element(MetadataHandler::getMetaFieldName(M_ALBUMARTURI)));
-                aa->setText(url);
+                Ref<Dictionary> aa_attrs = nil;
 #ifdef EXTEND_PROTOCOLINFO
                 if (config->getBoolOption(CFG_SERVER_EXTEND_PROTOCOLINFO))
                 {
                     /// \todo clean this up, make sure to check the mimetype and
                     /// provide the profile correctly
-                    aa->setAttribute(_("xmlns:dlna"), 
-                                     _("urn:schemas-dlna-org:metadata-1-0"));
-                    aa->setAttribute(_("dlna:profileID"), _("JPEG_TN"));
+                    aa_attrs = Ref<Dictionary>(new Dictionary());
+                    aa_attrs->put(_("xmlns:dlna"), 
+                                  _("urn:schemas-dlna-org:metadata-1-0"));
+                    aa_attrs->put(_("dlna:profileID"), _("JPEG_TN"));
                 }
 #endif
-                element->appendElementChild(aa);
+                UpnpXML_DIDLAppendElement(buf, 
+                        MetadataHandler::getMetaFieldName(M_ALBUMARTURI),
+                        url, aa_attrs);
                 continue;
             }
         }
@@ -489,7 +491,7 @@ void CdsResourceManager::addResources(Ref<CdsItem> item, Ref<Element> element)
         if (!hide_original_resource || transcoded || 
            (hide_original_resource && (original_resource != i)))
 #endif
-            element->appendElementChild(UpnpXML_DIDLRenderResource(url, res_attrs));
+            UpnpXML_DIDLRenderResource(url, res_attrs, buf);
     }
 }
 
@@ -47,14 +47,14 @@ public:
 
     /// \brief Adds a resource tag to the item.
     /// \param item Item for which the resources should be added.
-    /// \param element Element in the XML to which the resource should be appended.
+    /// \param buf DIDL-Lite of the item, the resources are appended to it.
     ///
     /// This function figures out what resources should be added to what files.
     /// It looks at the server configuration to find out what it needs. For example,
     /// if you want to add another mime/type alias for an existing mime/type, this
     /// function would do it. Also, when transcoding will be implemented, the
     /// various transcoded streams will be identified here.
-    static void addResources(zmm::Ref<CdsItem> item, zmm::Ref<mxml::Element> element);
+    static void addResources(zmm::Ref<CdsItem> item, zmm::Ref<zmm::StringBuffer> buf);
     
     /// \brief Gets the URL of the first resource of the CfsItem.
     /// \param item Item for which the resources should be built.
@@ -48,6 +48,9 @@
 /// \brief UPnP specific error code.
 #define UPNP_E_NO_SUCH_ID               701
 #define UPNP_E_NOT_EXIST                706
+#define UPNP_E_INVALID_SEARCH_CRITERIA  708
+#define UPNP_E_INVALID_SORT_CRITERIA    709
+#define UPNP_E_NO_SUCH_CONTAINER        710
 
 // UPnP default classes
 #define UPNP_DEFAULT_CLASS_CONTAINER    "object.container"
@@ -232,6 +235,8 @@
 #define DEFAULT_WEB_DIR                 "web"
 #define DEFAULT_JS_DIR                  "js"
 #define DEFAULT_HIDDEN_FILES_VALUE      NO
+#define DEFAULT_METADATA_THREADS        4
+#define DEFAULT_WALKER_THREADS          2
 #define DEFAULT_UPNP_STRING_LIMIT       (-1)
 #define DEFAULT_SESSION_TIMEOUT         30
 #define SESSION_TIMEOUT_CHECK_INTERVAL  (5 * 60)
@@ -303,6 +308,7 @@
     #define URL_VALUE_TRANSCODE              "1"
 #endif
 #define DEFAULT_STORAGE_CACHING_ENABLED YES
+#define DEFAULT_STORAGE_CACHE_SIZE      20000
 #ifdef HAVE_SQLITE3
     #define MT_SQLITE_SYNC_FULL            2
     #define MT_SQLITE_SYNC_NORMAL          1 
@@ -311,6 +317,7 @@
     #define DEFAULT_SQLITE_RESTORE      "restore"
     #define DEFAULT_SQLITE_BACKUP_ENABLED NO
     #define DEFAULT_SQLITE_BACKUP_INTERVAL 600
+    #define DEFAULT_SQLITE_READ_CONNECTIONS 4
     #define DEFAULT_SQLITE_ENABLED      YES
     #define DEFAULT_STORAGE_DRIVER      "sqlite3"
 #else
@@ -322,6 +329,7 @@
     #define DEFAULT_MYSQL_HOST          "localhost"
     #define DEFAULT_MYSQL_DB            "mediatomb"
     #define DEFAULT_MYSQL_USER          "mediatomb"
+    #define DEFAULT_MYSQL_CONNECTIONS   4
 #ifdef HAVE_SQLITE3
     #define DEFAULT_MYSQL_ENABLED       NO
 #else
@@ -47,6 +47,9 @@
 #ifdef HAVE_INOTIFY
     #include "mt_inotify.h"
 #endif
+#ifdef HAVE_FANOTIFY
+    #include "mt_fanotify.h"
+#endif
 
 #ifdef YOUTUBE
     #include "youtube_service.h"
@@ -988,6 +991,14 @@ void ConfigManager::validate(String serverhome)
     NEW_BOOL_OPTION(temp == "yes" ? true : false);
     SET_BOOL_OPTION(CFG_SERVER_STORAGE_CACHING_ENABLED);
 
+    temp_int = getIntOption(_("/server/storage/attribute::cache-size"),
+            DEFAULT_STORAGE_CACHE_SIZE);
+    if (temp_int < 1)
+        throw _Exception(_("Error in config file: incorrect parameter "
+                    "for <storage cache-size=\"\" /> attribute"));
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_STORAGE_CACHE_SIZE);
+
     tmpEl = getElement(_("/server/storage/mysql"));
     if (tmpEl != nil)
     {
@@ -1053,6 +1064,14 @@ void ConfigManager::validate(String serverhome)
             NEW_OPTION(getOption(_("/server/storage/mysql/password")));
         }
         SET_OPTION(CFG_SERVER_STORAGE_MYSQL_PASSWORD);
+
+        temp_int = getIntOption(_("/server/storage/mysql/connections"),
+                DEFAULT_MYSQL_CONNECTIONS);
+        if (temp_int < 1)
+            throw _Exception(_("Error in config file: incorrect value for "
+                        "<connections> in mysql section"));
+        NEW_INT_OPTION(temp_int);
+        SET_INT_OPTION(CFG_SERVER_STORAGE_MYSQL_CONNECTIONS);
     }
 #else
     if (mysql_en == "yes")
@@ -1124,6 +1143,14 @@ void ConfigManager::validate(String serverhome)
                         "<backup interval=\"\" /> attribute"));
         NEW_INT_OPTION(temp_int);
         SET_INT_OPTION(CFG_SERVER_STORAGE_SQLITE_BACKUP_INTERVAL);
+
+        temp_int = getIntOption(_("/server/storage/sqlite3/read-connections"),
+                DEFAULT_SQLITE_READ_CONNECTIONS);
+        if (temp_int < 0)
+            throw _Exception(_("Error in config file: incorrect value for "
+                        "<read-connections> in sqlite3 section"));
+        NEW_INT_OPTION(temp_int);
+        SET_INT_OPTION(CFG_SERVER_STORAGE_SQLITE_READ_CONNECTIONS);
     }
 #else
     if (sqlite3_en == "yes")
@@ -1284,6 +1311,22 @@ void ConfigManager::validate(String serverhome)
     NEW_BOOL_OPTION(temp == "yes" ? true : false);
     SET_BOOL_OPTION(CFG_IMPORT_HIDDEN_FILES);
 
+    temp_int = getIntOption(_("/import/attribute::metadata-threads"),
+                            DEFAULT_METADATA_THREADS);
+    if (temp_int < 1)
+        throw _Exception(_("Error in config file: incorrect parameter for "
+                           "<import metadata-threads=\"\" /> attribute"));
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_IMPORT_METADATA_THREADS);
+
+    temp_int = getIntOption(_("/import/attribute::walker-threads"),
+                            DEFAULT_WALKER_THREADS);
+    if (temp_int < 1)
+        throw _Exception(_("Error in config file: incorrect parameter for "
+                           "<import walker-threads=\"\" /> attribute"));
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_IMPORT_WALKER_THREADS);
+
     temp = getOption(
             _("/import/mappings/extension-mimetype/attribute::ignore-unknown"),
             _(DEFAULT_IGNORE_UNKNOWN_EXTENSIONS));
@@ -1708,6 +1751,44 @@ void ConfigManager::validate(String serverhome)
         NEW_BOOL_OPTION(false);
         SET_BOOL_OPTION(CFG_IMPORT_AUTOSCAN_USE_INOTIFY);
     }
+
+    temp = getOption(_("/import/autoscan/attribute::use-fanotify"), _(NO));
+    if ((temp != "auto") && !validateYesNo(temp))
+        throw _Exception(_("Error in config file: incorrect parameter for "
+                           "\"<autoscan use-fanotify=\" attribute"));
+
+    bool fanotify_supported = false;
+    if (temp != _(NO))
+    {
+        if (! getBoolOption(CFG_IMPORT_AUTOSCAN_USE_INOTIFY))
+        {
+            if (temp == _(YES))
+                throw _Exception(_("You specified "
+                                   "\"yes\" in \"<autoscan use-fanotify=\"\">\""
+                                   " however inotify autoscan is disabled"));
+        }
+        else
+        {
+#ifdef HAVE_FANOTIFY
+            fanotify_supported = Fanotify::supported();
+            if (!fanotify_supported && (temp == _(YES)))
+                throw _Exception(_("You specified "
+                                   "\"yes\" in \"<autoscan use-fanotify=\"\">\""
+                                   " however your system does not have "
+                                   "fanotify support or MediaTomb does not "
+                                   "have the permission to use it"));
+#else
+            if (temp == _(YES))
+                throw _Exception(_("You specified"
+                                   " \"yes\" in \"<autoscan use-fanotify=\"\">\""
+                                   " however this version of MediaTomb was compiled "
+                                   "without fanotify support"));
+#endif
+        }
+    }
+
+    NEW_BOOL_OPTION(fanotify_supported);
+    SET_BOOL_OPTION(CFG_IMPORT_AUTOSCAN_USE_FANOTIFY);
 #endif
 
 #ifdef EXTERNAL_TRANSCODING
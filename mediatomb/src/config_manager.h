@@ -88,12 +88,14 @@ typedef enum
     CFG_SERVER_UI_SHOW_TOOLTIPS,
     CFG_SERVER_STORAGE_DRIVER,
     CFG_SERVER_STORAGE_CACHING_ENABLED,
+    CFG_SERVER_STORAGE_CACHE_SIZE,
 #ifdef HAVE_SQLITE3
     CFG_SERVER_STORAGE_SQLITE_DATABASE_FILE,
     CFG_SERVER_STORAGE_SQLITE_SYNCHRONOUS,
     CFG_SERVER_STORAGE_SQLITE_RESTORE,
     CFG_SERVER_STORAGE_SQLITE_BACKUP_ENABLED,
     CFG_SERVER_STORAGE_SQLITE_BACKUP_INTERVAL,
+    CFG_SERVER_STORAGE_SQLITE_READ_CONNECTIONS,
 #endif
 #ifdef HAVE_MYSQL
     CFG_SERVER_STORAGE_MYSQL_HOST,
@@ -102,6 +104,7 @@ typedef enum
     CFG_SERVER_STORAGE_MYSQL_SOCKET,
     CFG_SERVER_STORAGE_MYSQL_PASSWORD,
     CFG_SERVER_STORAGE_MYSQL_DATABASE,
+    CFG_SERVER_STORAGE_MYSQL_CONNECTIONS,
 #endif
 #if defined(HAVE_FFMPEG) && defined(HAVE_FFMPEGTHUMBNAILER)
     CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_ENABLED,
@@ -122,6 +125,8 @@ typedef enum
     CFG_SERVER_EXTOPTS_LASTFM_PASSWORD,
 #endif
     CFG_IMPORT_HIDDEN_FILES,
+    CFG_IMPORT_METADATA_THREADS,
+    CFG_IMPORT_WALKER_THREADS,
     CFG_IMPORT_FILESYSTEM_CHARSET,
     CFG_IMPORT_METADATA_CHARSET,
     CFG_IMPORT_PLAYLIST_CHARSET,
@@ -143,6 +148,7 @@ typedef enum
 #ifdef HAVE_INOTIFY
     CFG_IMPORT_AUTOSCAN_USE_INOTIFY,
     CFG_IMPORT_AUTOSCAN_INOTIFY_LIST,
+    CFG_IMPORT_AUTOSCAN_USE_FANOTIFY,
 #endif
     CFG_IMPORT_MAPPINGS_IGNORE_UNKNOWN_EXTENSIONS,
     CFG_IMPORT_MAPPINGS_EXTENSION_TO_MIMETYPE_CASE_SENSITIVE,
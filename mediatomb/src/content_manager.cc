@@ -51,6 +51,7 @@
 #include "timer.h"
 #include "layout/fallback_layout.h"
 #include "filesystem.h"
+#include "import_pipeline.h"
 
 #include <iostream>
 #include <string>
@@ -149,6 +150,12 @@ ContentManager::ContentManager() : TimerSubscriberSingleton<ContentManager>()
   
     extension_map_case_sensitive = cm->getBoolOption(CFG_IMPORT_MAPPINGS_EXTENSION_TO_MIMETYPE_CASE_SENSITIVE);
 
+    metadataThreads = cm->getIntOption(CFG_IMPORT_METADATA_THREADS);
+    walkerThreads = cm->getIntOption(CFG_IMPORT_WALKER_THREADS);
+#ifdef HAVE_MAGIC
+    magicMutex = Ref<Mutex>(new Mutex());
+#endif
+
     mimetype_upnpclass_map = 
        cm->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_UPNP_CLASS_LIST);
   
@@ -410,7 +417,12 @@ void ContentManager::init()
 #ifdef HAVE_INOTIFY
     if (ConfigManager::getInstance()->getBoolOption(CFG_IMPORT_AUTOSCAN_USE_INOTIFY))
     {
-        inotify = Ref<AutoscanInotify>(new AutoscanInotify());
+#ifdef HAVE_FANOTIFY
+        if (ConfigManager::getInstance()->getBoolOption(CFG_IMPORT_AUTOSCAN_USE_FANOTIFY))
+            inotify = Ref<AutoscanMonitor>(new AutoscanFanotify());
+        else
+#endif
+            inotify = Ref<AutoscanMonitor>(new AutoscanInotify());
         /// \todo change this (we need a new autoscan architecture)
         for (int i = 0; i < autoscan_inotify->size(); i++)
         {
@@ -733,6 +745,16 @@ void ContentManager::_removeObject(int objectID, bool all)
     //loadAccounting();
 }
 
+void ContentManager::_removeObjects(Ref<DBRHash<int> > list)
+{
+    Ref<Storage::ChangedContainers> changedContainers = Storage::getInstance()->removeObjects(list);
+    if (changedContainers != nil)
+    {
+        SessionManager::getInstance()->containerChangedUI(changedContainers->ui);
+        UpdateManager::getInstance()->containersChanged(changedContainers->upnp);
+    }
+}
+
 int ContentManager::ensurePathExistence(zmm::String path)
 {
     int updateID;
@@ -852,8 +874,22 @@ void ContentManager::_rescanDirectory(int containerID, int scanID, scan_mode_t s
         }
     }
 
-    // request only items if non-recursive scan is wanted
-    Ref<DBRHash<int> > list = storage->getObjects(containerID, !adir->getRecursive());
+    // request only items if non-recursive scan is wanted; the directory
+    // is compared against this snapshot, so unchanged entries cost no
+    // database queries
+    Ref<DBRHash<int> > list;
+    Ref<DSOHash<Storage::DirectoryEntry> > entries;
+    Ref<Storage::DirectoryContents> contents = storage->getDirectoryContents(containerID, !adir->getRecursive());
+    if (contents != nil)
+    {
+        list = contents->ids;
+        entries = contents->entries;
+    }
+
+    // the snapshot is keyed by the reduced path
+    String dirPath = location.reduce(DIR_SEPARATOR);
+    if (dirPath.charAt(dirPath.length() - 1) != DIR_SEPARATOR)
+        dirPath = dirPath + DIR_SEPARATOR;
 
     unsigned int thisTaskID;
     if (task != nil)
@@ -863,112 +899,149 @@ void ContentManager::_rescanDirectory(int containerID, int scanID, scan_mode_t s
     else
         thisTaskID = 0;
 
-    while (((dent = readdir(dir)) != NULL) && (!shutdownFlag) && (task == nil || ((task != nil) && task->isValid())))
+    storage->beginBulkImport();
+    try
     {
-        char *name = dent->d_name;
-        if (name[0] == '.')
+        while (((dent = readdir(dir)) != NULL) && (!shutdownFlag) && (task == nil || ((task != nil) && task->isValid())))
         {
-            if (name[1] == 0)
+            char *name = dent->d_name;
+            if (name[0] == '.')
             {
-                continue;
+                if (name[1] == 0)
+                {
+                    continue;
+                }
+                else if (name[1] == '.' && name[2] == 0)
+                {
+                    continue;
+                }
+                else if (!adir->getHidden())
+                {
+                    continue;    
+                }
             }
-            else if (name[1] == '.' && name[2] == 0)
-            {
+
+            path = location + DIR_SEPARATOR + name; 
+            bool isDir = false;
+#ifdef _DIRENT_HAVE_D_TYPE
+            // only files need the modification time and size, directories
+            // and special files are told apart by the type readdir reports
+            if (dent->d_type == DT_DIR)
+                isDir = true;
+            else if (dent->d_type != DT_REG && dent->d_type != DT_UNKNOWN && dent->d_type != DT_LNK)
                 continue;
-            }
-            else if (!adir->getHidden())
+#endif
+            if (! isDir)
             {
-                continue;    
+                ret = stat(path.c_str(), &statbuf);
+                if (ret != 0)
+                {
+                    log_error("Failed to stat %s, %s\n", path.c_str(), mt_strerror(errno).c_str());
+                    continue;
+                }
+                isDir = S_ISDIR(statbuf.st_mode);
             }
-        }
 
-        path = location + DIR_SEPARATOR + name; 
-        ret = stat(path.c_str(), &statbuf);
-        if (ret != 0)
-        {
-            log_error("Failed to stat %s, %s\n", path.c_str(), mt_strerror(errno).c_str());
-            continue;
-        }
+            // it is possible that someone hits remove while the container is being scanned
+            // in this case we will invalidate the autoscan entry
+            if (adir->getScanID() == INVALID_SCAN_ID)
+            {
+                storage->commitBulkImport();
+                closedir(dir);
+                return;
+            }
 
-        // it is possible that someone hits remove while the container is being scanned
-        // in this case we will invalidate the autoscan entry
-        if (adir->getScanID() == INVALID_SCAN_ID)
-        {
-            closedir(dir);
-            return;
-        }
+            Ref<Storage::DirectoryEntry> entry;
+            if (entries != nil)
+                entry = entries->get(dirPath + name);
 
-        if (S_ISREG(statbuf.st_mode))
-        {
-            int objectID = storage->findObjectIDByPath(String(path));
-            if (objectID > 0)
+            if (! isDir && S_ISREG(statbuf.st_mode))
             {
-                if (list != nil)
-                    list->remove(objectID);
-
-                if (scanLevel == FullScanLevel)
+                int objectID = INVALID_OBJECT_ID;
+                if (entry != nil && !entry->container)
+                    objectID = entry->id;
+                if (objectID > 0)
                 {
-                    // check modification time and update file if chagned
-                    if (last_modified_current_max < statbuf.st_mtime)
+                    if (list != nil)
+                        list->remove(objectID);
+
+                    if (scanLevel == FullScanLevel)
                     {
-                        // readd object - we have to do this in order to trigger
-                        // layout
-                        removeObject(objectID, false);
-                        addFileInternal(path, location, false, false, adir->getHidden());
-                        // update time variable
-                        last_modified_current_max = statbuf.st_mtime;
+                        // check modification time and size and update
+                        // file if changed
+                        if ((last_modified_current_max < statbuf.st_mtime) ||
+                            ((entry->size >= 0) && (entry->size != statbuf.st_size)))
+                        {
+                            // readd object - we have to do this in order to trigger
+                            // layout
+                            removeObject(objectID, false);
+                            addFileInternal(path, location, false, false, adir->getHidden());
+                            // update time variable
+                            if (last_modified_current_max < statbuf.st_mtime)
+                                last_modified_current_max = statbuf.st_mtime;
+                        }
                     }
+                    else if (scanLevel == BasicScanLevel)
+                        continue;
+                    else
+                        throw _Exception(_("Unsupported scan level!"));
+
                 }
-                else if (scanLevel == BasicScanLevel)
-                    continue;
                 else
-                    throw _Exception(_("Unsupported scan level!"));
-
-            }
-            else
-            {
-                // add file, not recursive, not async
-                // make sure not to add the current config.xml
-                if (ConfigManager::getInstance()->getConfigFilename() != path)
                 {
-                    addFileInternal(path, location, false, false, adir->getHidden());
-                    if (last_modified_current_max < statbuf.st_mtime)
-                        last_modified_current_max = statbuf.st_mtime;
+                    // add file, not recursive, not async
+                    // make sure not to add the current config.xml
+                    if (ConfigManager::getInstance()->getConfigFilename() != path)
+                    {
+                        addFileInternal(path, location, false, false, adir->getHidden());
+                        if (last_modified_current_max < statbuf.st_mtime)
+                            last_modified_current_max = statbuf.st_mtime;
+                    }
                 }
             }
-        }
-        else if (S_ISDIR(statbuf.st_mode) && (adir->getRecursive()))
-        {
-            int objectID = storage->findObjectIDByPath(path + DIR_SEPARATOR);
-            if (objectID > 0)
+            else if (isDir && (adir->getRecursive()))
             {
-                if (list != nil)
-                    list->remove(objectID);
-                // add a task to rescan the directory that was found
-                rescanDirectory(objectID, scanID, scanMode, path + DIR_SEPARATOR, task->isCancellable());
-            }
-            else
-            {
-                // we have to make sure that we will never add a path to the task list
-                // if it is going to be removed by a pending remove task.
-                // this lock will make sure that remove is not in the process of invalidating
-                // the AutocsanDirectories in the autoscan_timed list at the time when we
-                // are checking for validity.
-                AUTOLOCK(mutex);
-                
-                // it is possible that someone hits remove while the container is being scanned
-                // in this case we will invalidate the autoscan entry
-                if (adir->getScanID() == INVALID_SCAN_ID)
+                int objectID = INVALID_OBJECT_ID;
+                if (entry != nil && entry->container)
+                    objectID = entry->id;
+                if (objectID > 0)
                 {
-                    closedir(dir);
-                    return;
+                    if (list != nil)
+                        list->remove(objectID);
+                    // add a task to rescan the directory that was found
+                    rescanDirectory(objectID, scanID, scanMode, path + DIR_SEPARATOR, task->isCancellable());
                 }
+                else
+                {
+                    // we have to make sure that we will never add a path to the task list
+                    // if it is going to be removed by a pending remove task.
+                    // this lock will make sure that remove is not in the process of invalidating
+                    // the AutocsanDirectories in the autoscan_timed list at the time when we
+                    // are checking for validity.
+                    AUTOLOCK(mutex);
                 
-                // add directory, recursive, async, hidden flag, low priority
-                addFileInternal(path, location, true, true, adir->getHidden(), true, thisTaskID, task->isCancellable());
+                    // it is possible that someone hits remove while the container is being scanned
+                    // in this case we will invalidate the autoscan entry
+                    if (adir->getScanID() == INVALID_SCAN_ID)
+                    {
+                        storage->commitBulkImport();
+                        closedir(dir);
+                        return;
+                    }
+                
+                    // add directory, recursive, async, hidden flag, low priority
+                    addFileInternal(path, location, true, true, adir->getHidden(), true, thisTaskID, task->isCancellable());
+                }
             }
-        }
-    } // while
+        } // while
+    }
+    catch (Exception e)
+    {
+        storage->commitBulkImport();
+        closedir(dir);
+        throw e;
+    }
+    storage->commitBulkImport();
     
     closedir(dir);
 
@@ -999,110 +1072,71 @@ void ContentManager::addRecursive(String path, bool hidden, Ref<GenericTask> tas
             return;
     }
 
-    Ref<StringConverter> f2i = StringConverter::f2i();
-
-    Ref<UpdateManager> um = UpdateManager::getInstance();
-    Ref<Storage> storage = Storage::getInstance();
     DIR *dir = opendir(path.c_str());
     if (!dir)
     {
         throw _Exception(_("could not list directory ")+
                         path + " : " + strerror(errno));
     }
-    int parentID = storage->findObjectIDByPath(path + DIR_SEPARATOR);
-    struct dirent *dent;
+    closedir(dir);
+
+    // the pipeline walks the tree and extracts the metadata in its own
+    // threads, the objects are added and passed to the layout here in the
+    // order in which they were found
+    Ref<ImportPipeline> pipeline(new ImportPipeline(path, hidden, metadataThreads, walkerThreads));
+    pipeline->start();
+    
+    Ref<Storage> storage = Storage::getInstance();
+    storage->beginBulkImport();
+
+    Ref<ImportJob> job;
     // abort loop if either:
-    // no valid directory returned, server is about to shutdown, the task is there and was invalidated
+    // no more files, server is about to shutdown, the task is there and was invalidated
     if (task != nil)
     {
         log_debug("IS TASK VALID? [%d], taskoath: [%s]\n", task->isValid(), path.c_str());
     }
-    while (((dent = readdir(dir)) != NULL) && (!shutdownFlag) && (task == nil || ((task != nil) && task->isValid())))
+    while ((!shutdownFlag) && (task == nil || ((task != nil) && task->isValid())) && ((job = pipeline->next()) != nil))
     {
-        char *name = dent->d_name;
-        if (name[0] == '.')
+        String newPath = job->path;
+        try
         {
-            if (name[1] == 0)
-            {
-                continue;
-            }
-            else if (name[1] == '.' && name[2] == 0)
+            if (job->error != nil)
+                throw _Exception(job->error);
+
+            Ref<CdsObject> obj = job->obj;
+            if (obj == nil) // object ignored
             {
+                log_warning("file ignored: %s\n", newPath.c_str());
                 continue;
             }
-            else if (hidden == false)
-                continue;
-        }
-        String newPath = path + DIR_SEPARATOR + name;
 
-        if (ConfigManager::getInstance()->getConfigFilename() == newPath)
-            continue;
-
-        try
-        {
-            Ref<CdsObject> obj = nil;
-            if (parentID > 0)
-                obj = storage->findObjectByPath(String(newPath));
-            if (obj == nil) // create object
+            if (IS_CDS_ITEM(obj->getObjectType()))
             {
-                obj = createObjectFromFile(newPath);
-                
-                if (obj == nil) // object ignored
-                {
-                    log_warning("file ignored: %s\n", newPath.c_str());
-                }
-                else
-                {
-                    //obj->setParentID(parentID);
-                    if (IS_CDS_ITEM(obj->getObjectType()))
-                    {
-                        addObject(obj);
-                        parentID = obj->getParentID();
-                    }
-                }
-            }
-            if (obj != nil)
-            {
-//#ifdef HAVE_JS
-                if (IS_CDS_ITEM(obj->getObjectType()))
+                if (! job->existing)
+                    addObject(obj);
+
+                if (layout != nil)
                 {
-                    if (layout != nil)
-                    {
-                        try
-                        {
-                            String rootpath = nil;
-                            if (task != nil)
-                                rootpath = RefCast(task, CMAddFileTask)->getRootPath();
-                            layout->processCdsObject(obj, rootpath);
+                    String rootpath = nil;
+                    if (task != nil)
+                        rootpath = RefCast(task, CMAddFileTask)->getRootPath();
+                    layout->processCdsObject(obj, rootpath);
 #ifdef HAVE_JS
-                            Ref<Dictionary> mappings = ConfigManager::getInstance()->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
-                            String mimetype = RefCast(obj, CdsItem)->getMimeType();
-                            String content_type = mappings->get(mimetype);
-                           
-                            if ((playlist_parser_script != nil) &&
-                                (content_type == CONTENT_TYPE_PLAYLIST))
-                                playlist_parser_script->processPlaylistObject(obj, task);
+                    Ref<Dictionary> mappings = ConfigManager::getInstance()->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
+                    String mimetype = RefCast(obj, CdsItem)->getMimeType();
+                    String content_type = mappings->get(mimetype);
+
+                    if ((playlist_parser_script != nil) &&
+                        (content_type == CONTENT_TYPE_PLAYLIST))
+                        playlist_parser_script->processPlaylistObject(obj, task);
 #ifdef HAVE_LIBDVDNAV
-                            if ((dvd_import_script != nil) &&
-                                (content_type == CONTENT_TYPE_DVD))
-                                    dvd_import_script->processDVDObject(obj);
+                    if ((dvd_import_script != nil) &&
+                        (content_type == CONTENT_TYPE_DVD))
+                            dvd_import_script->processDVDObject(obj);
 #endif // DVD
 
 #endif // JS
-                        }
-                        catch (Exception e)
-                        {
-                            throw e;
-                        }
-                    }
-                    
-                    /// \todo Why was this statement here??? - It seems to be unnecessary
-                    //obj = createObjectFromFile(newPath);
-                }
-//#endif
-                if (IS_CDS_CONTAINER(obj->getObjectType()))
-                {
-                    addRecursive(newPath, hidden, task);
                 }
             }
         }
@@ -1111,7 +1145,8 @@ void ContentManager::addRecursive(String path, bool hidden, Ref<GenericTask> tas
             log_warning("skipping %s : %s\n", newPath.c_str(), e.getMessage().c_str());
         }
     }
-    closedir(dir);
+    pipeline->stop();
+    storage->commitBulkImport();
 }
 
 void ContentManager::updateObject(int objectID, Ref<Dictionary> parameters)
@@ -1390,6 +1425,7 @@ Ref<CdsObject> ContentManager::createObjectFromFile(String path, bool magic, boo
             if (ignore_unknown_extensions)
                 return nil; // item should be ignored
 #ifdef HAVE_MAGIC        
+            AUTOLOCK(magicMutex);
             mimetype = get_mime_type(ms, reMimetype, path);
 #endif
         }
@@ -1941,6 +1977,13 @@ void ContentManager::removeObject(int objectID, bool async, bool all)
     }
 }
 
+void ContentManager::removeObjects(Ref<DBRHash<int> > list)
+{
+    Ref<GenericTask> task(new CMRemoveObjectsTask(list));
+    task->setDescription(_("Removing ") + list->size() + " objects");
+    addTask(task);
+}
+
 void ContentManager::rescanDirectory(int objectID, int scanID, scan_mode_t scanMode, String descPath, bool cancellable)
 {
     // building container path for the description
@@ -2261,6 +2304,7 @@ void ContentManager::setAutoscanDirectory(Ref<AutoscanDirectory> dir)
 #ifdef HAVE_MAGIC
 zmm::String ContentManager::getMimeTypeFromBuffer(void *buffer, size_t length)
 {
+    AUTOLOCK(magicMutex);
     return get_mime_type_from_buffer(ms, reMimetype, buffer, length); 
 }
 #endif
@@ -2445,6 +2489,19 @@ void CMRemoveObjectTask::run()
     cm->_removeObject(objectID, all);
 }
 
+CMRemoveObjectsTask::CMRemoveObjectsTask(Ref<DBRHash<int> > list) : GenericTask(ContentManagerTask)
+{
+    this->list = list;
+    this->taskType = RemoveObject;
+    cancellable = false;
+}
+
+void CMRemoveObjectsTask::run()
+{
+    Ref<ContentManager> cm = ContentManager::getInstance();
+    cm->_removeObjects(list);
+}
+
 CMRescanDirectoryTask::CMRescanDirectoryTask(int objectID, int scanID, scan_mode_t scanMode, bool cancellable) : GenericTask(ContentManagerTask)
 {
     this->scanID = scanID;
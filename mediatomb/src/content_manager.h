@@ -54,6 +54,9 @@
 #ifdef HAVE_INOTIFY
     #include "autoscan_inotify.h"
 #endif
+#ifdef HAVE_FANOTIFY
+    #include "autoscan_fanotify.h"
+#endif
 
 #ifdef EXTERNAL_TRANSCODING
     #include "transcoding/transcoding.h"
@@ -101,6 +104,15 @@ public:
     virtual void run();
 };
 
+class CMRemoveObjectsTask : public GenericTask
+{
+protected:
+    zmm::Ref<DBRHash<int> > list;
+public:
+    CMRemoveObjectsTask(zmm::Ref<DBRHash<int> > list);
+    virtual void run();
+};
+
 class CMLoadAccountingTask : public GenericTask
 {
 public:
@@ -246,6 +258,11 @@ public:
 
     int ensurePathExistence(zmm::String path);
     void removeObject(int objectID, bool async=true, bool all=false);
+
+    /// \brief Removes several items with one task.
+    /// \param list IDs of the items, containers have to be removed with
+    /// removeObject()
+    void removeObjects(zmm::Ref<DBRHash<int> > list);
     void rescanDirectory(int objectID, int scanID, scan_mode_t scanMode,
                          zmm::String descPath = nil, bool cancellable = true);
 
@@ -386,6 +403,17 @@ protected:
 #endif
     
     zmm::Ref<RExp> reMimetype;
+#ifdef HAVE_MAGIC
+    /// \brief libmagic must not be used by several threads at once
+    zmm::Ref<Mutex> magicMutex;
+#endif
+
+    /// \brief number of threads that extract metadata during recursive imports
+    int metadataThreads;
+
+    /// \brief number of directories that are read concurrently during
+    /// recursive imports
+    int walkerThreads;
 
     bool ignore_unknown_extensions;
     bool extension_map_case_sensitive;
@@ -397,7 +425,8 @@ protected:
     zmm::Ref<AutoscanList> autoscan_timed;
 #ifdef HAVE_INOTIFY
     zmm::Ref<AutoscanList> autoscan_inotify;
-    zmm::Ref<AutoscanInotify> inotify;
+    /// \brief monitors the inotify mode directories, with inotify or fanotify
+    zmm::Ref<AutoscanMonitor> inotify;
 #endif
  
 #if defined(EXTERNAL_TRANSCODING) || defined(SOPCAST)
@@ -416,6 +445,7 @@ protected:
     int _addFile(zmm::String path, zmm::String rootpath, bool recursive=false, bool hidden=false, zmm::Ref<GenericTask> task=nil);
     //void _addFile2(zmm::String path, bool recursive=0);
     void _removeObject(int objectID, bool all);
+    void _removeObjects(zmm::Ref<DBRHash<int> > list);
     
     void _rescanDirectory(int containerID, int scanID, scan_mode_t scanMode, scan_level_t scanLevel, zmm::Ref<GenericTask> task=nil);
     /* for recursive addition */
@@ -485,6 +515,7 @@ protected:
 
     friend void CMAddFileTask::run();
     friend void CMRemoveObjectTask::run();
+    friend void CMRemoveObjectsTask::run();
     friend void CMRescanDirectoryTask::run();
 #ifdef ONLINE_SERVICES
     friend void CMFetchOnlineContentTask::run();
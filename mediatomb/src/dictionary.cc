@@ -40,15 +40,30 @@
 
 using namespace zmm;
 
+/// \brief dictionaries with fewer entries are searched linearly
+#define DICTIONARY_INDEX_MIN 8
+
+static inline bool keysEqual(StringBase *a, StringBase *b)
+{
+    // the well known keys are interned, so most lookups match by pointer
+    if (a == b)
+        return true;
+    if (! a || ! b)
+        return false;
+    return ! strcmp(a->data, b->data);
+}
+
 DictionaryElement::DictionaryElement(String key, String value) : Object()
 {
     this->key = key;
     this->value = value;
+    hash = (key == nil) ? 0 : stringHash(key);
 }
 
 void DictionaryElement::setKey(String key)
 {
     this->key = key;
+    hash = (key == nil) ? 0 : stringHash(key);
 }
 
 void DictionaryElement::setValue(String value)
@@ -71,34 +86,106 @@ String DictionaryElement::getValue()
 Dictionary::Dictionary() : Object()
 {
     elements = Ref<Array<DictionaryElement> >(new Array<DictionaryElement>());
+    index = NULL;
+    indexCapacity = 0;
 }
 
-void Dictionary::put(String key, String value)
+Dictionary::~Dictionary()
 {
-    for (int i = 0; i < elements->size(); i++)
+    if (index)
+        FREE(index);
+}
+
+int Dictionary::find(String key)
+{
+    StringBase *keyBase = key.getBase();
+    if (! index)
     {
-        Ref<DictionaryElement> el = elements->get(i);
-        if(el->getKey() == key)
+        for (int i = 0; i < elements->size(); i++)
         {
-            el->setValue(value);
-            return;
+            if (keysEqual(elementAt(i)->key.getBase(), keyBase))
+                return i;
         }
+        return -1;
+    }
+    unsigned int hash = (key == nil) ? 0 : stringHash(key);
+    int mask = indexCapacity - 1;
+    for (int slot = hash & mask; index[slot]; slot = (slot + 1) & mask)
+    {
+        DictionaryElement *el = elementAt(index[slot] - 1);
+        if (el->hash == hash && keysEqual(el->key.getBase(), keyBase))
+            return index[slot] - 1;
+    }
+    return -1;
+}
+
+void Dictionary::indexElement(int position)
+{
+    // keep the load factor at or below one half
+    if (! index || (elements->size() * 2 > indexCapacity))
+    {
+        rebuildIndex();
+        return;
+    }
+    int mask = indexCapacity - 1;
+    int slot = elementAt(position)->hash & mask;
+    while (index[slot])
+        slot = (slot + 1) & mask;
+    index[slot] = position + 1;
+}
+
+void Dictionary::rebuildIndex()
+{
+    int size = elements->size();
+    if (size < DICTIONARY_INDEX_MIN)
+    {
+        if (index)
+            FREE(index);
+        index = NULL;
+        indexCapacity = 0;
+        return;
+    }
+    int capacity = DICTIONARY_INDEX_MIN * 2;
+    while (capacity < size * 4)
+        capacity *= 2;
+    if (capacity != indexCapacity)
+    {
+        if (index)
+            FREE(index);
+        index = (int *)MALLOC(capacity * sizeof(int));
+        indexCapacity = capacity;
+    }
+    memset(index, 0, capacity * sizeof(int));
+    int mask = capacity - 1;
+    for (int i = 0; i < size; i++)
+    {
+        int slot = elementAt(i)->hash & mask;
+        while (index[slot])
+            slot = (slot + 1) & mask;
+        index[slot] = i + 1;
+    }
+}
+
+void Dictionary::put(String key, String value)
+{
+    int position = find(key);
+    if (position >= 0)
+    {
+        elementAt(position)->setValue(value);
+        return;
     }
     Ref<DictionaryElement> newEl(new DictionaryElement(key, value));
     elements->append(newEl);
+    if (index || elements->size() >= DICTIONARY_INDEX_MIN)
+        indexElement(elements->size() - 1);
 }
 
 String Dictionary::get(String key)
 {
-    for (int i = 0; i < elements->size(); i++)
-    {
-        Ref<DictionaryElement> el = elements->get(i);
-        if (el->getKey() == key)
-        {
-            return el->getValue();
-        }
-    }
-    return nil;
+    int position = find(key);
+    if (position < 0)
+        return nil;
+    return elementAt(position)->getValue();
 }
 
 int Dictionary::size()
@@ -108,15 +195,13 @@ int Dictionary::size()
 
 void Dictionary::remove(String key)
 {
-    for (int i = 0; i < elements->size(); i++)
-    {
-        Ref<DictionaryElement> el = elements->get(i);
-        if (el->getKey() == key)
-        {
-            elements->remove(i, 1);
-            return;
-        }
-    }
+    int position = find(key);
+    if (position < 0)
+        return;
+    elements->remove(position, 1);
+    // the positions behind the removed element have changed
+    if (index)
+        rebuildIndex();
 }
 
 String Dictionary::_encode(char sep1, char sep2)
@@ -197,9 +282,83 @@ void Dictionary::decodeSimple(String url)
     while (last_pos < url.length());
 }
 
+String Dictionary::pack()
+{
+    Ref<StringBuffer> buf(new StringBuffer());
+    *buf << PACKED_FORMAT_V1;
+    packTo(buf);
+    return buf->toString();
+}
+
+void Dictionary::unpack(String data)
+{
+    if (! string_ok(data))
+        return;
+    if (data.charAt(0) != PACKED_FORMAT_V1)
+    {
+        decode(data);
+        return;
+    }
+    int pos = 1;
+    unpackFrom(data.c_str(), data.length(), &pos);
+    if (pos != data.length())
+        throw _Exception(_("Dictionary::unpack: trailing data"));
+}
+
+// <count>:<key length>:<key><value length>:<value>...
+void Dictionary::packTo(Ref<StringBuffer> buf)
+{
+    int len = elements->size();
+    *buf << len << ':';
+    for (int i = 0; i < len; i++)
+    {
+        Ref<DictionaryElement> el = elements->get(i);
+        String key = el->getKey();
+        String value = el->getValue();
+        *buf << key.length() << ':' << key << value.length() << ':' << value;
+    }
+}
+
+void Dictionary::unpackFrom(const char *data, int length, int *pos)
+{
+    int count = unpackNumber(data, length, pos);
+    for (int i = 0; i < count; i++)
+    {
+        int keyLength = unpackNumber(data, length, pos);
+        if (keyLength > length - *pos)
+            throw _Exception(_("Dictionary::unpack: truncated data"));
+        String key(data + *pos, keyLength);
+        *pos += keyLength;
+        
+        int valueLength = unpackNumber(data, length, pos);
+        if (valueLength > length - *pos)
+            throw _Exception(_("Dictionary::unpack: truncated data"));
+        String value(data + *pos, valueLength);
+        *pos += valueLength;
+        
+        put(key, value);
+    }
+}
+
+int Dictionary::unpackNumber(const char *data, int length, int *pos)
+{
+    int ret = 0;
+    int start = *pos;
+    while (*pos < length && data[*pos] >= '0' && data[*pos] <= '9')
+    {
+        ret = ret * 10 + (data[*pos] - '0');
+        (*pos)++;
+    }
+    if (*pos == start || *pos >= length || data[*pos] != ':')
+        throw _Exception(_("Dictionary::unpack: invalid data"));
+    (*pos)++;
+    return ret;
+}
+
 void Dictionary::clear()
 {
     elements->remove(0, elements->size());
+    rebuildIndex();
 }
 
 Ref<Dictionary> Dictionary::clone()
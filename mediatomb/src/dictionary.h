@@ -35,6 +35,11 @@
 #include "zmmf/zmmf.h"
 #include "sync.h"
 
+/// \brief First character of the packed encoding that is used to store
+/// dictionaries and resources in the database. The url encoding that was
+/// used before never starts with a control character.
+#define PACKED_FORMAT_V1 '\x01'
+
 /// \brief This class should never be used directly, it is being used by the Dictionary class.
 class DictionaryElement : public zmm::Object
 {
@@ -56,9 +61,15 @@ public:
     /// \brief Returns the value for this DictionaryElement.
     zmm::String getValue();
 
+    /// \brief Returns the stringHash() of the key.
+    inline unsigned int getHash() { return hash; }
+
 protected:
     zmm::String key;
     zmm::String value;
+    unsigned int hash;
+
+    friend class Dictionary;
 };
 
 /// \brief This class stores key:value pairs of String data and provides functions to access them.
@@ -67,12 +78,37 @@ class Dictionary : public zmm::Object
 protected:
     /// \brief Array of DictionaryElements, representing our Dictionary.
     zmm::Ref<zmm::Array<DictionaryElement> > elements;
+
+    /// \brief Open addressing index into elements, only built for larger
+    /// dictionaries. A slot holds the element position + 1, 0 is empty.
+    int *index;
+
+    /// \brief number of slots in index, a power of two
+    int indexCapacity;
+
     /// \brief Allow to specify encoding separators
     zmm::String _encode(char sep1, char sep2);
+
+    inline DictionaryElement *elementAt(int position)
+    {
+        return (DictionaryElement *)elements->getObjectArray()[position];
+    }
+
+    /// \brief Returns the position of the key in elements or -1.
+    int find(zmm::String key);
+
+    /// \brief Adds the element at the given position of elements to the
+    /// index, the index is rebuilt if it gets too full.
+    void indexElement(int position);
+
+    /// \brief Rebuilds the index from elements, or drops it if the
+    /// dictionary became small.
+    void rebuildIndex();
 public:
 
     /// \brief Constructor, initializes the dictionary.
     Dictionary();
+    virtual ~Dictionary();
 
     /// \brief Adds a new key:value pair to the dictionary.
     void put(zmm::String key, zmm::String value);
@@ -102,6 +138,26 @@ public:
     /// \brief Makes a dictionary out of simplified url encoded data.
     void decodeSimple(zmm::String url);
 
+    /// \brief Returns a length prefixed encoding of the dictionary, which
+    /// needs no escaping; used to store the dictionary in the database.
+    zmm::String pack();
+
+    /// \brief Makes a dictionary out of data returned by pack(); url encoded
+    /// data as written by older versions is accepted too.
+    void unpack(zmm::String data);
+
+    /// \brief Appends the packed entries without the format marker.
+    void packTo(zmm::Ref<zmm::StringBuffer> buf);
+
+    /// \brief Reads entries written by packTo().
+    /// \param data the packed data
+    /// \param length length of data
+    /// \param pos position to start at, set to the end of the entries
+    void unpackFrom(const char *data, int length, int *pos);
+
+    /// \brief Reads a number terminated by ':' from packed data.
+    static int unpackNumber(const char *data, int length, int *pos);
+
     /// \brief Makes a shallow copy of the dictionary
     zmm::Ref<Dictionary> clone();
 
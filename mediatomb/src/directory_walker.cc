@@ -0,0 +1,304 @@
+/*MT*
+
+    MediaTomb - http://www.mediatomb.cc/
+
+    directory_walker.cc - this file is part of MediaTomb.
+
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+
+    $Id$
+*/
+
+
+/// \file directory_walker.cc
+
+#ifdef HAVE_CONFIG_H
+    #include "autoconfig.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+
+#include "directory_walker.h"
+#include "config_manager.h"
+
+/// \brief number of directories per thread that may be read ahead of
+/// the caller
+#define WALK_DIRECTORIES_PER_THREAD 16
+
+using namespace zmm;
+
+WalkEntry::WalkEntry(String path, walk_entry_type_t type) : Object()
+{
+    this->path = path;
+    this->type = type;
+}
+
+/// \brief A directory of the tree, read by one of the walker threads.
+class WalkDirectory : public Object
+{
+public:
+    WalkDirectory(String path) : Object()
+    {
+        this->path = path;
+        taken = false;
+        read = false;
+        entries = Ref<Array<WalkEntry> >(new Array<WalkEntry>());
+        directories = Ref<Array<WalkDirectory> >(new Array<WalkDirectory>());
+        position = 0;
+        dirPosition = 0;
+    }
+
+    String path;
+
+    /// \brief true once a thread started reading the directory
+    bool taken;
+
+    /// \brief true once entries and directories are complete
+    bool read;
+
+    /// \brief the contents in readdir() order
+    Ref<Array<WalkEntry> > entries;
+
+    /// \brief the subdirectories, in the order of their entries
+    Ref<Array<WalkDirectory> > directories;
+
+    /// \brief the next entry next() returns
+    int position;
+
+    /// \brief the next subdirectory next() enters
+    int dirPosition;
+};
+
+DirectoryWalker::DirectoryWalker(String path, bool hidden, int threadCount) : Object()
+{
+    this->path = path;
+    this->hidden = hidden;
+    if (threadCount < 1)
+        threadCount = 1;
+    this->threadCount = threadCount;
+    configFilename = ConfigManager::getInstance()->getConfigFilename();
+    pending = Ref<ObjectStack<WalkDirectory> >(new ObjectStack<WalkDirectory>(16));
+    stack = Ref<Array<WalkDirectory> >(new Array<WalkDirectory>());
+    root = Ref<WalkDirectory>(new WalkDirectory(path));
+    pending->push(root);
+    rootReturned = false;
+    wanted = nil;
+    readAhead = 0;
+    stopFlag = false;
+    started = false;
+    threads = NULL;
+    mutex = Ref<Mutex>(new Mutex());
+    cond = Ref<Cond>(new Cond(mutex));
+}
+
+DirectoryWalker::~DirectoryWalker()
+{
+    stop();
+}
+
+void DirectoryWalker::start()
+{
+    started = true;
+    threads = (pthread_t *)MALLOC(threadCount * sizeof(pthread_t));
+    for (int i = 0; i < threadCount; i++)
+    {
+        pthread_create(
+            &threads[i],
+            NULL,
+            DirectoryWalker::staticThreadProc,
+            this
+        );
+    }
+}
+
+void DirectoryWalker::stop()
+{
+    if (! started)
+        return;
+    AUTOLOCK(mutex);
+    stopFlag = true;
+    cond->broadcast();
+    AUTOUNLOCK();
+
+    for (int i = 0; i < threadCount; i++)
+        pthread_join(threads[i], NULL);
+    FREE(threads);
+    threads = NULL;
+    started = false;
+}
+
+Ref<WalkEntry> DirectoryWalker::next()
+{
+    AUTOLOCK(mutex);
+    if (! rootReturned)
+    {
+        rootReturned = true;
+        stack->append(root);
+        root = nil;
+        return Ref<WalkEntry>(new WalkEntry(path, WalkDirectoryEnter));
+    }
+
+    while (! stopFlag)
+    {
+        int depth = stack->size();
+        if (depth == 0)
+        {
+            // the walk is complete, let the threads exit
+            stopFlag = true;
+            cond->broadcast();
+            break;
+        }
+
+        Ref<WalkDirectory> dir = stack->get(depth - 1);
+        if (! dir->read)
+        {
+            wanted = dir;
+            cond->broadcast();
+            cond->wait();
+            continue;
+        }
+
+        if (dir->position < dir->entries->size())
+        {
+            Ref<WalkEntry> entry = dir->entries->get(dir->position);
+            // drop the reference, the entries are only returned once
+            dir->entries->set(nil, dir->position++);
+            if (entry->type == WalkDirectoryEnter)
+            {
+                stack->append(dir->directories->get(dir->dirPosition));
+                dir->directories->set(nil, dir->dirPosition++);
+            }
+            return entry;
+        }
+
+        stack->remove(depth - 1);
+        readAhead--;
+        // there is room to read another directory ahead
+        cond->broadcast();
+        return Ref<WalkEntry>(new WalkEntry(dir->path, WalkDirectoryLeave));
+    }
+    return nil;
+}
+
+void DirectoryWalker::readDirectory(Ref<WalkDirectory> walkDir)
+{
+    String dirPath = walkDir->path;
+    DIR *dir = opendir(dirPath.c_str());
+    if (! dir)
+    {
+        log_warning("skipping %s : could not list directory %s : %s\n",
+                dirPath.c_str(), dirPath.c_str(), strerror(errno));
+        return;
+    }
+
+    struct dirent *dent;
+    struct stat statbuf;
+    while (! stopFlag && ((dent = readdir(dir)) != NULL))
+    {
+        char *name = dent->d_name;
+        if (name[0] == '.')
+        {
+            if (name[1] == 0)
+                continue;
+            else if (name[1] == '.' && name[2] == 0)
+                continue;
+            else if (hidden == false)
+                continue;
+        }
+        String newPath = dirPath + DIR_SEPARATOR + name;
+
+        if (configFilename == newPath)
+            continue;
+
+        bool isDir;
+#ifdef _DIRENT_HAVE_D_TYPE
+        // symbolic links have to be followed, the import does not tell
+        // them apart from their targets
+        if (dent->d_type == DT_DIR)
+            isDir = true;
+        else if (dent->d_type != DT_UNKNOWN && dent->d_type != DT_LNK)
+            isDir = false;
+        else
+#endif
+        // everything that is not a directory is left to the caller,
+        // including the error handling for files that can't be stat'ed
+        isDir = (stat(newPath.c_str(), &statbuf) == 0) && S_ISDIR(statbuf.st_mode);
+
+        if (isDir)
+        {
+            walkDir->entries->append(Ref<WalkEntry>(new WalkEntry(newPath, WalkDirectoryEnter)));
+            walkDir->directories->append(Ref<WalkDirectory>(new WalkDirectory(newPath)));
+        }
+        else
+            walkDir->entries->append(Ref<WalkEntry>(new WalkEntry(newPath, WalkFile)));
+    }
+    closedir(dir);
+}
+
+void DirectoryWalker::threadProc()
+{
+    AUTOLOCK(mutex);
+    while (! stopFlag)
+    {
+        Ref<WalkDirectory> dir = nil;
+        if (wanted != nil && ! wanted->taken)
+            dir = wanted;
+        else
+        {
+            // read ahead in the order the caller walks the tree, but
+            // only as far as the limit allows
+            while (readAhead < threadCount * WALK_DIRECTORIES_PER_THREAD)
+            {
+                dir = pending->pop();
+                if (dir == nil || ! dir->taken)
+                    break;
+                dir = nil;
+            }
+        }
+        if (dir == nil)
+        {
+            cond->wait();
+            continue;
+        }
+
+        dir->taken = true;
+        readAhead++;
+        AUTOUNLOCK();
+        readDirectory(dir);
+        AUTORELOCK();
+        dir->read = true;
+
+        // the first subdirectory is walked first, so it is pushed last
+        for (int i = dir->directories->size() - 1; i >= 0; i--)
+            pending->push(dir->directories->get(i));
+        cond->broadcast();
+    }
+}
+
+void *DirectoryWalker::staticThreadProc(void *arg)
+{
+    DirectoryWalker *inst = (DirectoryWalker *)arg;
+    inst->threadProc();
+    pthread_exit(NULL);
+    return NULL;
+}
@@ -0,0 +1,127 @@
+/*MT*
+
+    MediaTomb - http://www.mediatomb.cc/
+
+    directory_walker.h - this file is part of MediaTomb.
+
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+
+    $Id$
+*/
+
+/// \file directory_walker.h
+/// \brief Definitions of the DirectoryWalker and WalkEntry classes.
+
+#ifndef __DIRECTORY_WALKER_H__
+#define __DIRECTORY_WALKER_H__
+
+#include <pthread.h>
+
+#include "common.h"
+#include "sync.h"
+
+typedef enum
+{
+    WalkFile = 0,
+    WalkDirectoryEnter,
+    WalkDirectoryLeave
+} walk_entry_type_t;
+
+/// \brief An entry returned by DirectoryWalker::next().
+class WalkEntry : public zmm::Object
+{
+public:
+    WalkEntry(zmm::String path, walk_entry_type_t type);
+
+    /// \brief full path of the file or directory
+    zmm::String path;
+
+    /// \brief WalkFile for everything that is not a directory,
+    /// WalkDirectoryEnter before and WalkDirectoryLeave after the
+    /// contents of a directory
+    walk_entry_type_t type;
+};
+
+class WalkDirectory;
+
+/// \brief Walks a directory tree with a pool of threads.
+///
+/// The threads list the directories ahead of the caller, sibling
+/// directories concurrently, and use the entry type reported by readdir()
+/// so only entries of unknown type and symbolic links have to be stat'ed.
+/// The caller still receives the entries in the order of a depth first
+/// walk. The number of threads caps the directory reads the walker has
+/// in flight, so a walk does not starve the streaming.
+class DirectoryWalker : public zmm::Object
+{
+public:
+    /// \param path the directory to walk
+    /// \param hidden true if hidden files and directories should be walked
+    /// \param threadCount number of directories that are read concurrently
+    DirectoryWalker(zmm::String path, bool hidden, int threadCount);
+    virtual ~DirectoryWalker();
+
+    /// \brief starts the threads
+    void start();
+
+    /// \brief stops the threads, may be called from any thread
+    void stop();
+
+    /// \brief returns the next entry in depth first order
+    /// \return the entry or nil if the walk is complete or was stopped
+    zmm::Ref<WalkEntry> next();
+
+protected:
+    zmm::String path;
+    bool hidden;
+    int threadCount;
+    zmm::String configFilename;
+
+    zmm::Ref<WalkDirectory> root;
+    bool rootReturned;
+
+    /// \brief directories that were not read yet, the last found first
+    zmm::Ref<zmm::ObjectStack<WalkDirectory> > pending;
+
+    /// \brief the directories the caller is in, the current one on top
+    zmm::Ref<zmm::Array<WalkDirectory> > stack;
+
+    /// \brief the directory the caller is waiting for
+    zmm::Ref<WalkDirectory> wanted;
+
+    /// \brief number of directories that were read but not yet returned
+    /// completely by next()
+    int readAhead;
+
+    bool stopFlag;
+    bool started;
+    zmm::Ref<Mutex> mutex;
+    zmm::Ref<Cond> cond;
+    pthread_t *threads;
+
+    /// \brief reads a directory, called without the mutex held
+    void readDirectory(zmm::Ref<WalkDirectory> dir);
+
+    void threadProc();
+    static void *staticThreadProc(void *arg);
+};
+
+#endif // __DIRECTORY_WALKER_H__
@@ -110,6 +110,22 @@ void FileIOHandler::seek(IN off_t offset, IN int whence)
     }
 }
 
+int FileIOHandler::getFd(OUT off_t *offset)
+{
+    struct stat statbuf;
+    int fd = fileno(f);
+
+    // sendfile() can't read from pipes or devices
+    if ((fstat(fd, &statbuf) != 0) || (! S_ISREG(statbuf.st_mode)))
+        return -1;
+
+    *offset = ftello(f);
+    if (*offset < 0)
+        return -1;
+
+    return fd;
+}
+
 void FileIOHandler::close()
 {
     if (fclose(f) != 0)
@@ -73,6 +73,10 @@ public:
 
     /// \brief Close a previously opened file.
     virtual void close();
+
+    /// \brief Returns the descriptor of the file if it is a regular file.
+    /// \param offset will be set to the current position in the file.
+    virtual int getFd(OUT off_t *offset);
 };
 
 
@@ -83,7 +83,7 @@ public:
     inline bool remove(KT key)
     {
         struct dbb_hash_slot<KT, VT> *slot;
-        if (! search(key, &slot))
+        if (! this->search(key, &slot))
             return false;
         slot->key = emptyKey;
         this->count--;
@@ -94,7 +94,7 @@ public:
     inline void put(KT key, VT value)
     {
         struct dbb_hash_slot<KT, VT> *slot;
-        bool found = search(key, &slot);
+        bool found = this->search(key, &slot);
         if (! found)
         {
             slot->key = key;
@@ -116,7 +116,7 @@ public:
     inline bool get(KT key, VT *value)
     {
         struct dbb_hash_slot<KT, VT> *slot;
-        bool found = search(key, &slot);
+        bool found = this->search(key, &slot);
         if (found)
             *value = slot->value;
         return found;
@@ -124,7 +124,7 @@ public:
     bool get(KT key, hash_slot_t *destSlot, VT *value)
     {
         struct dbb_hash_slot<KT, VT> **slot = (struct dbb_hash_slot<KT, VT> **)destSlot;
-        bool found = search(key, slot);
+        bool found = this->search(key, slot);
         if (found)
             *value = (*slot)->value;
         return found;
@@ -132,11 +132,11 @@ public:
     inline bool exists(KT key)
     {
         struct dbb_hash_slot<KT, VT> *slot;
-        return search(key, &slot);
+        return this->search(key, &slot);
     }
     inline bool exists(KT key, hash_slot_t *destSlot)
     {
-        return search(key, (struct dbb_hash_slot<KT, VT> **)destSlot);
+        return this->search(key, (struct dbb_hash_slot<KT, VT> **)destSlot);
     }
 };
 
@@ -0,0 +1,248 @@
+/*MT*
+
+    MediaTomb - http://www.mediatomb.cc/
+
+    import_pipeline.cc - this file is part of MediaTomb.
+
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+
+    $Id$
+*/
+
+/// \file import_pipeline.cc
+
+#ifdef HAVE_CONFIG_H
+    #include "autoconfig.h"
+#endif
+
+#include "import_pipeline.h"
+#include "content_manager.h"
+#include "config_manager.h"
+#include "storage.h"
+
+/// \brief number of jobs per worker that may be queued ahead of the caller
+#define IMPORT_JOBS_PER_WORKER 16
+
+using namespace zmm;
+
+ImportJob::ImportJob(String path, bool lookup) : Object()
+{
+    this->path = path;
+    this->lookup = lookup;
+    obj = nil;
+    existing = false;
+    error = nil;
+    done = false;
+}
+
+ImportPipeline::ImportPipeline(String path, bool hidden, int workerCount, int walkerThreads) : Object()
+{
+    this->path = path;
+    walker = Ref<DirectoryWalker>(new DirectoryWalker(path, hidden, walkerThreads));
+    if (workerCount < 1)
+        workerCount = 1;
+    this->workerCount = workerCount;
+    maxJobs = workerCount * IMPORT_JOBS_PER_WORKER;
+    // one more than maxJobs, so the queues never have to be resized
+    pendingJobs = Ref<ObjectQueue<ImportJob> >(new ObjectQueue<ImportJob>(maxJobs + 1));
+    jobs = Ref<ObjectQueue<ImportJob> >(new ObjectQueue<ImportJob>(maxJobs + 1));
+    walkerDone = false;
+    stopFlag = false;
+    started = false;
+    workerThreads = NULL;
+    mutex = Ref<Mutex>(new Mutex());
+    cond = Ref<Cond>(new Cond(mutex));
+}
+
+ImportPipeline::~ImportPipeline()
+{
+    stop();
+}
+
+void ImportPipeline::start()
+{
+    started = true;
+    walker->start();
+    workerThreads = (pthread_t *)MALLOC(workerCount * sizeof(pthread_t));
+    for (int i = 0; i < workerCount; i++)
+    {
+        pthread_create(
+            &workerThreads[i],
+            NULL,
+            ImportPipeline::staticWorkerProc,
+            this
+        );
+    }
+    pthread_create(
+        &walkerThread,
+        NULL,
+        ImportPipeline::staticWalkerProc,
+        this
+    );
+}
+
+void ImportPipeline::stop()
+{
+    if (! started)
+        return;
+    AUTOLOCK(mutex);
+    stopFlag = true;
+    cond->broadcast();
+    AUTOUNLOCK();
+
+    // wakes up the walker thread if it waits for a directory
+    walker->stop();
+    pthread_join(walkerThread, NULL);
+    for (int i = 0; i < workerCount; i++)
+        pthread_join(workerThreads[i], NULL);
+    FREE(workerThreads);
+    workerThreads = NULL;
+    started = false;
+}
+
+Ref<ImportJob> ImportPipeline::next()
+{
+    AUTOLOCK(mutex);
+    while (! stopFlag)
+    {
+        if (jobs->isEmpty())
+        {
+            if (walkerDone)
+                return nil;
+        }
+        else if (jobs->get(0)->done)
+        {
+            Ref<ImportJob> job = jobs->dequeue();
+            // wake up the walker, there is room for a new job
+            cond->broadcast();
+            return job;
+        }
+        cond->wait();
+    }
+    return nil;
+}
+
+void ImportPipeline::addJob(String filePath, bool lookup)
+{
+    Ref<ImportJob> job(new ImportJob(filePath, lookup));
+    AUTOLOCK(mutex);
+    while (! stopFlag && jobs->size() >= maxJobs)
+        cond->wait();
+    if (stopFlag)
+        return;
+    jobs->enqueue(job);
+    pendingJobs->enqueue(job);
+    cond->broadcast();
+}
+
+void ImportPipeline::walkerProc()
+{
+    Ref<Storage> storage = Storage::getInstance();
+    // lookup flags of the directories the walker is in, the current one last
+    Ref<IntArray> lookups(new IntArray());
+    Ref<WalkEntry> entry;
+    while (! stopFlag && ((entry = walker->next()) != nil))
+    {
+        if (entry->type == WalkDirectoryEnter)
+        {
+            // a failed lookup skips the files of the directory, but not
+            // its subdirectories
+            int lookup = -1;
+            try
+            {
+                lookup = (storage->findObjectIDByPath(entry->path + DIR_SEPARATOR) > 0);
+            }
+            catch (Exception e)
+            {
+                log_warning("skipping %s : %s\n", entry->path.c_str(), e.getMessage().c_str());
+            }
+            lookups->append(lookup);
+        }
+        else if (entry->type == WalkDirectoryLeave)
+            lookups->remove(lookups->size() - 1);
+        else
+        {
+            int lookup = lookups->get(lookups->size() - 1);
+            if (lookup >= 0)
+                addJob(entry->path, lookup > 0);
+        }
+    }
+
+    AUTOLOCK(mutex);
+    walkerDone = true;
+    cond->broadcast();
+}
+
+void ImportPipeline::workerProc()
+{
+    Ref<ContentManager> cm = ContentManager::getInstance();
+    Ref<Storage> storage = Storage::getInstance();
+
+    AUTOLOCK(mutex);
+    while (! stopFlag)
+    {
+        Ref<ImportJob> job = pendingJobs->dequeue();
+        if (job == nil)
+        {
+            if (walkerDone)
+                break;
+            cond->wait();
+            continue;
+        }
+        AUTOUNLOCK();
+        try
+        {
+            if (job->lookup)
+            {
+                job->obj = storage->findObjectByPath(job->path);
+                job->existing = (job->obj != nil);
+            }
+            if (job->obj == nil)
+                job->obj = cm->createObjectFromFile(job->path);
+        }
+        catch (Exception e)
+        {
+            job->obj = nil;
+            job->error = e.getMessage();
+        }
+        AUTORELOCK();
+        job->done = true;
+        cond->broadcast();
+    }
+}
+
+void *ImportPipeline::staticWalkerProc(void *arg)
+{
+    ImportPipeline *inst = (ImportPipeline *)arg;
+    inst->walkerProc();
+    Storage::getInstance()->threadCleanup();
+    pthread_exit(NULL);
+    return NULL;
+}
+
+void *ImportPipeline::staticWorkerProc(void *arg)
+{
+    ImportPipeline *inst = (ImportPipeline *)arg;
+    inst->workerProc();
+    Storage::getInstance()->threadCleanup();
+    pthread_exit(NULL);
+    return NULL;
+}
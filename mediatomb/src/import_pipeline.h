@@ -0,0 +1,130 @@
+/*MT*
+
+    MediaTomb - http://www.mediatomb.cc/
+
+    import_pipeline.h - this file is part of MediaTomb.
+
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+
+    $Id$
+*/
+
+/// \file import_pipeline.h
+/// \brief Definitions of the ImportPipeline and ImportJob classes.
+
+#ifndef __IMPORT_PIPELINE_H__
+#define __IMPORT_PIPELINE_H__
+
+#include <pthread.h>
+
+#include "common.h"
+#include "cds_objects.h"
+#include "sync.h"
+#include "directory_walker.h"
+
+/// \brief A file found by the directory walker of the ImportPipeline.
+class ImportJob : public zmm::Object
+{
+public:
+    ImportJob(zmm::String path, bool lookup);
+
+    /// \brief full path of the file
+    zmm::String path;
+
+    /// \brief true if the directory of the file is already in the database,
+    /// so the file has to be looked up before it is created
+    bool lookup;
+
+    /// \brief the object created by the worker, nil if the file is ignored
+    zmm::Ref<CdsObject> obj;
+
+    /// \brief true if obj was loaded from the database
+    bool existing;
+
+    /// \brief error message if the file could not be processed
+    zmm::String error;
+
+    /// \brief set by the worker when the job is finished
+    bool done;
+};
+
+/// \brief Walks a directory tree and creates the objects for the files in it.
+///
+/// A walker thread queues a job for every file a DirectoryWalker finds,
+/// a pool of worker threads runs createObjectFromFile() (stat, mime type
+/// detection, metadata extraction) on the jobs in parallel. The caller
+/// receives the finished jobs through next() in the order in which the
+/// walker found the files and does the database inserts and the layout
+/// processing on its own thread.
+class ImportPipeline : public zmm::Object
+{
+public:
+    /// \param path the directory to walk
+    /// \param hidden true if hidden files should be imported
+    /// \param workerCount number of metadata worker threads
+    /// \param walkerThreads number of directories that are read concurrently
+    ImportPipeline(zmm::String path, bool hidden, int workerCount, int walkerThreads);
+    virtual ~ImportPipeline();
+
+    /// \brief starts the walker and the worker threads
+    void start();
+
+    /// \brief stops all threads; unfinished jobs are discarded
+    void stop();
+
+    /// \brief returns the next finished job in walk order
+    /// \return the job or nil if the walk is complete or the pipeline was stopped
+    zmm::Ref<ImportJob> next();
+
+protected:
+    zmm::String path;
+    int workerCount;
+
+    zmm::Ref<DirectoryWalker> walker;
+
+    /// \brief maximum number of jobs that are not yet passed to next()
+    int maxJobs;
+
+    /// \brief jobs that no worker has picked up yet
+    zmm::Ref<zmm::ObjectQueue<ImportJob> > pendingJobs;
+
+    /// \brief all jobs that were not passed to next() yet, in walk order
+    zmm::Ref<zmm::ObjectQueue<ImportJob> > jobs;
+
+    bool walkerDone;
+    bool stopFlag;
+    bool started;
+
+    zmm::Ref<Mutex> mutex;
+    zmm::Ref<Cond> cond;
+
+    pthread_t walkerThread;
+    pthread_t *workerThreads;
+
+    void addJob(zmm::String filePath, bool lookup);
+
+    void walkerProc();
+    void workerProc();
+    static void *staticWalkerProc(void *arg);
+    static void *staticWorkerProc(void *arg);
+};
+
+#endif // __IMPORT_PIPELINE_H__
@@ -136,3 +136,8 @@ void IOHandler::seek(IN off_t offset, IN int whence)
 void IOHandler::close()
 {
 }
+
+int IOHandler::getFd(OUT off_t *offset)
+{
+    return -1;
+}
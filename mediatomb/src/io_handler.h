@@ -68,6 +68,12 @@ public:
 
     /// \brief Close/free previously opened/initialized data.
     virtual void close();
+
+    /// \brief Returns a file descriptor the web server can send the data from
+    /// without reading it through the handler.
+    /// \param offset will be set to the current position in the file.
+    /// \return the descriptor or -1 if the data does not come from a plain file.
+    virtual int getFd(off_t *offset);
 };
 
 
@@ -50,6 +50,7 @@
 #include "config_manager.h"
 #include "content_manager.h"
 #include "timer.h"
+#include "zmm/pool.h"
 #include "common.h"
 
 #include <sys/types.h>
@@ -715,6 +716,15 @@ For more information visit " DESC_MANUFACTURER_URL "\n\n");
         ret = EXIT_FAILURE;
     }
 
+#ifdef ZMM_POOL
+    pool_stats_t poolStats;
+    poolGetStats(&poolStats);
+    log_info("Object pool: %lld allocations (%lld large), %lld frees, %lld bytes in use, %lld bytes peak, %lld bytes reserved\n",
+             poolStats.allocations, poolStats.largeAllocations,
+             poolStats.frees, poolStats.bytesInUse,
+             poolStats.peakBytesInUse, poolStats.bytesReserved);
+#endif
+
     log_info("Server terminating\n");
     log_close();
 
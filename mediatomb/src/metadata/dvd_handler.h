@@ -69,6 +69,7 @@ class DVDHandler : public MetadataHandler
 public:
     DVDHandler();
     virtual void fillMetadata(zmm::Ref<CdsItem> item);
+    virtual bool isThreadSafe() { return false; }
     virtual zmm::Ref<IOHandler> serveContent(zmm::Ref<CdsItem> item, int resNum, off_t *data_size);
 
     /// \brief Helper function to construct the key names for DVD aux data
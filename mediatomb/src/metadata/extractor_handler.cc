@@ -282,7 +282,7 @@ static void addMetaField(metadata_fields_t field, EXTRACTOR_KeywordList *keyword
     
     if (string_ok(value))
     {
-        item->setMetadata(MT_KEYS[field].upnp, sc->convert(value));
+        item->setMetadata(MetadataHandler::getMetaFieldName(field), sc->convert(value));
 //        log_debug("Setting metadata on item: %d, %s\n", field, sc->convert(value).c_str());
     }
 }
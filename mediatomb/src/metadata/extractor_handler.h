@@ -43,6 +43,7 @@ class ExtractorHandler : public MetadataHandler
 public:
     ExtractorHandler();
     virtual void fillMetadata(zmm::Ref<CdsItem> item);
+    virtual bool isThreadSafe() { return false; }
     virtual zmm::Ref<IOHandler> serveContent(zmm::Ref<CdsItem> item, int resNum, off_t *data_size);
 };
 
@@ -92,43 +92,43 @@ static void addFfmpegMetadataFields(Ref<CdsItem> item, AVFormatContext *pFormatC
 	if (strlen(pFormatCtx->title) > 0) 
     {
 	    log_debug("Added metadata title: %s\n", pFormatCtx->title);
-        item->setMetadata(MT_KEYS[M_TITLE].upnp, 
+        item->setMetadata(MetadataHandler::getMetaFieldName(M_TITLE), 
                           sc->convert(pFormatCtx->title));
 	}
 	if (strlen(pFormatCtx->author) > 0) 
     {
 	    log_debug("Added metadata author: %s\n", pFormatCtx->author);
-        item->setMetadata(MT_KEYS[M_ARTIST].upnp, 
+        item->setMetadata(MetadataHandler::getMetaFieldName(M_ARTIST), 
                           sc->convert(pFormatCtx->author));
 	}
 	if (strlen(pFormatCtx->album) > 0) 
     {
 	    log_debug("Added metadata album: %s\n", pFormatCtx->album);
-        item->setMetadata(MT_KEYS[M_ALBUM].upnp, 
+        item->setMetadata(MetadataHandler::getMetaFieldName(M_ALBUM), 
                           sc->convert(pFormatCtx->album));
 	}
 	if (pFormatCtx->year > 0) 
     {
 	    log_debug("Added metadata year: %d\n", pFormatCtx->year);
-        item->setMetadata(MT_KEYS[M_DATE].upnp, 
+        item->setMetadata(MetadataHandler::getMetaFieldName(M_DATE), 
                           sc->convert(String::from(pFormatCtx->year)));
 	}
 	if (strlen(pFormatCtx->genre) > 0) 
     {
 	    log_debug("Added metadata genre: %s\n", pFormatCtx->genre);
-        item->setMetadata(MT_KEYS[M_GENRE].upnp, 
+        item->setMetadata(MetadataHandler::getMetaFieldName(M_GENRE), 
                           sc->convert(pFormatCtx->genre));
 	}
 	if (strlen(pFormatCtx->comment) > 0) 
     {
 	    log_debug("Added metadata comment: %s\n", pFormatCtx->comment);
-        item->setMetadata(MT_KEYS[M_DESCRIPTION].upnp, 
+        item->setMetadata(MetadataHandler::getMetaFieldName(M_DESCRIPTION), 
                           sc->convert(pFormatCtx->comment));
 	}
 	if (pFormatCtx->track > 0) 
     {
 	    log_debug("Added metadata track: %d\n", pFormatCtx->track);
-        item->setMetadata(MT_KEYS[M_TRACKNUMBER].upnp, 
+        item->setMetadata(MetadataHandler::getMetaFieldName(M_TRACKNUMBER), 
                           sc->convert(String::from(pFormatCtx->track)));
 	}
 }
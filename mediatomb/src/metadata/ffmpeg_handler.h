@@ -46,6 +46,7 @@ class FfmpegHandler : public MetadataHandler
 public:
     FfmpegHandler();
     virtual void fillMetadata(zmm::Ref<CdsItem> item);
+    virtual bool isThreadSafe() { return false; }
     virtual zmm::Ref<IOHandler> serveContent(zmm::Ref<CdsItem> item, int resNum, off_t *data_size);
     virtual zmm::String getMimeType();
 };
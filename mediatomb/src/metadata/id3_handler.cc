@@ -151,7 +151,7 @@ static void addID3Field(metadata_fields_t field, ID3_Tag *tag, Ref<CdsItem> item
     
     if (string_ok(value))
     {
-        item->setMetadata(MT_KEYS[field].upnp, sc->convert(value));
+        item->setMetadata(MetadataHandler::getMetaFieldName(field), sc->convert(value));
 //        log_debug("Setting metadata on item: %d, %s\n", field, sc->convert(value).c_str());
     }
 }
@@ -41,6 +41,7 @@ class Id3Handler : public MetadataHandler
 public:
     Id3Handler();
     virtual void fillMetadata(zmm::Ref<CdsItem> item);
+    virtual bool isThreadSafe() { return false; }
     virtual zmm::Ref<IOHandler> serveContent(zmm::Ref<CdsItem> item, int resNum, off_t *data_size);
 };
 
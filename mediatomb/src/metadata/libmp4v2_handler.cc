@@ -126,7 +126,7 @@ static void addMetaField(metadata_fields_t field, MP4FileHandle mp4, Ref<CdsItem
 
     if (string_ok(value))
     {
-        item->setMetadata(MT_KEYS[field].upnp, sc->convert(value));
+        item->setMetadata(MetadataHandler::getMetaFieldName(field), sc->convert(value));
         log_debug("mp4 handler: setting metadata on item: %d, %s\n", field, sc->convert(value).c_str());
     }
 }
@@ -149,7 +149,7 @@ static void addField(metadata_fields_t field, TagLib::Tag *tag, Ref<CdsItem> ite
     
     if (string_ok(value))
     {
-        item->setMetadata(MT_KEYS[field].upnp, sc->convert(value));
+        item->setMetadata(MetadataHandler::getMetaFieldName(field), sc->convert(value));
     }
 }
 
@@ -104,6 +104,8 @@ res_key RES_KEYS[] = {
 };
 
 
+Ref<Mutex> MetadataHandler::serialMutex = Ref<Mutex>(new Mutex());
+
 MetadataHandler::MetadataHandler() : Object()
 {
 }
@@ -245,17 +247,40 @@ void MetadataHandler::setMetadata(Ref<CdsItem> item)
 
     if (handler == nil)
         return;
-    handler->fillMetadata(item);
+    if (handler->isThreadSafe())
+    {
+        handler->fillMetadata(item);
+    }
+    else
+    {
+        AUTOLOCK(serialMutex);
+        handler->fillMetadata(item);
+    }
+}
+
+/// \brief Creates the String objects for a table of key names.
+///
+/// The names are created only once, so all metadata dictionaries share the
+/// same key strings and the lookups can compare them by pointer.
+template <class T>
+static String *internKeyNames(T *keys, int count)
+{
+    String *names = new String[count];
+    for (int i = 0; i < count; i++)
+        names[i] = _(keys[i].upnp);
+    return names;
 }
 
 String MetadataHandler::getMetaFieldName(metadata_fields_t field)
 {
-    return MT_KEYS[field].upnp;
+    static String *names = internKeyNames(MT_KEYS, M_MAX);
+    return names[field];
 }
 
 String MetadataHandler::getResAttrName(resource_attributes_t attr)
 {
-    return RES_KEYS[attr].upnp;
+    static String *names = internKeyNames(RES_KEYS, R_MAX);
+    return names[attr];
 }
 
 Ref<MetadataHandler> MetadataHandler::createHandler(int handlerType)
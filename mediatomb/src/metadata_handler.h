@@ -36,6 +36,7 @@
 #include "dictionary.h"
 #include "cds_objects.h"
 #include "io_handler.h"
+#include "sync.h"
 
 // content handler Id's
 #define CH_DEFAULT   0
@@ -144,6 +145,14 @@ public:
     virtual void fillMetadata(zmm::Ref<CdsItem> item) = 0;
     virtual zmm::Ref<IOHandler> serveContent(zmm::Ref<CdsItem> item, int resNum, off_t *data_size) = 0;
     virtual zmm::String getMimeType();
+    
+    /// \brief false if the library of the handler can't be used by
+    /// several threads at once
+    virtual bool isThreadSafe() { return true; }
+
+protected:
+    /// \brief serializes fillMetadata() of handlers that are not thread safe
+    static zmm::Ref<Mutex> serialMutex;
 };
 
 #endif // __METADATA_HANDLER_H__
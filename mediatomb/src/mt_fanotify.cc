@@ -0,0 +1,307 @@
+/*MT*
+    
+    MediaTomb - http://www.mediatomb.cc/
+    
+    mt_fanotify.cc - this file is part of MediaTomb.
+    
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+    
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+    
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+    
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+    
+    $Id$
+*/
+
+/// \file mt_fanotify.cc
+
+#ifdef HAVE_CONFIG_H
+    #include "autoconfig.h"
+#endif
+
+#ifdef HAVE_FANOTIFY
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/select.h>
+
+#include "mt_fanotify.h"
+#include "tools.h"
+
+#define FANOTIFY_INIT_FLAGS (FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_REPORT_DFID_NAME)
+
+#define FANOTIFY_BUFFER_SIZE 65536
+
+using namespace zmm;
+
+Fanotify::Fanotify()
+{
+    fanotify_fd = fanotify_init(FANOTIFY_INIT_FLAGS, O_RDONLY | O_LARGEFILE);
+    if (fanotify_fd < 0)
+        throw _Exception(_("Unable to initialize fanotify: ") + mt_strerror(errno));
+
+    if (pipe(stop_fds_pipe) < 0)
+    {
+        close(fanotify_fd);
+        throw _Exception(_("Unable to create pipe!\n"));
+    }
+
+    stop_fd_read = stop_fds_pipe[0];
+    stop_fd_write = stop_fds_pipe[1];
+
+    filesystems = Ref<Array<Filesystem> >(new Array<Filesystem>());
+    nextMarkId = 0;
+
+    buffer = (char *)MALLOC(FANOTIFY_BUFFER_SIZE);
+    bytes = 0;
+    first_byte = 0;
+}
+
+Fanotify::~Fanotify()
+{
+    // the marks go away with the descriptor
+    for (int i = 0; i < filesystems->size(); i++)
+        close(filesystems->get(i)->getMountFd());
+    close(fanotify_fd);
+    close(stop_fd_read);
+    close(stop_fd_write);
+    FREE(buffer);
+}
+
+bool Fanotify::supported()
+{
+    int test_fd = fanotify_init(FANOTIFY_INIT_FLAGS, O_RDONLY | O_LARGEFILE);
+    if (test_fd < 0)
+        return false;
+
+    // filesystem marks need CAP_SYS_ADMIN, which fanotify_init() does not
+    // check for this class
+    int ret = fanotify_mark(test_fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM,
+            FAN_MOVED_TO | FAN_ONDIR, AT_FDCWD, "/");
+    close(test_fd);
+    return (ret == 0);
+}
+
+int Fanotify::getFilesystemIndex(fsid_t *fsid)
+{
+    for (int i = 0; i < filesystems->size(); i++)
+    {
+        if (filesystems->get(i)->isFilesystem(fsid))
+            return i;
+    }
+    return -1;
+}
+
+int Fanotify::getFilesystemIndex(int id)
+{
+    for (int i = 0; i < filesystems->size(); i++)
+    {
+        if (filesystems->get(i)->getId() == id)
+            return i;
+    }
+    return -1;
+}
+
+int Fanotify::addMark(String path, int events)
+{
+    struct statfs info;
+    if (statfs(path.c_str(), &info) < 0)
+    {
+        log_warning("Cannot add fanotify mark for %s: %s\n", path.c_str(), strerror(errno));
+        return -1;
+    }
+
+    Ref<Filesystem> fs;
+    int index = getFilesystemIndex(&info.f_fsid);
+    if (index >= 0)
+        fs = filesystems->get(index);
+    else
+    {
+        if (fanotify_mark(fanotify_fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM,
+                    events, AT_FDCWD, path.c_str()) < 0)
+        {
+            log_warning("Cannot add fanotify mark for %s: %s\n", path.c_str(), strerror(errno));
+            return -1;
+        }
+
+        int mountFd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (mountFd < 0)
+        {
+            log_warning("Cannot open %s: %s\n", path.c_str(), strerror(errno));
+            fanotify_mark(fanotify_fd, FAN_MARK_REMOVE | FAN_MARK_FILESYSTEM,
+                    events, AT_FDCWD, path.c_str());
+            return -1;
+        }
+
+        fs = Ref<Filesystem>(new Filesystem(nextMarkId++, info.f_fsid, mountFd, events));
+        filesystems->append(fs);
+        log_debug("marked the filesystem of %s\n", path.c_str());
+    }
+    fs->setRefCount(fs->getRefCount() + 1);
+    return fs->getId();
+}
+
+void Fanotify::removeMark(int id)
+{
+    int index = getFilesystemIndex(id);
+    if (index < 0)
+        return;
+
+    Ref<Filesystem> fs = filesystems->get(index);
+    fs->setRefCount(fs->getRefCount() - 1);
+    if (fs->getRefCount() > 0)
+        return;
+
+    // the mount descriptor still refers to the filesystem when the marked
+    // path is gone
+    if (fanotify_mark(fanotify_fd, FAN_MARK_REMOVE | FAN_MARK_FILESYSTEM,
+                fs->getEvents(), fs->getMountFd(), NULL) < 0)
+    {
+        log_debug("Error removing fanotify mark: %s\n", strerror(errno));
+    }
+    close(fs->getMountFd());
+    filesystems->removeUnordered(index);
+}
+
+String Fanotify::resolveHandle(fsid_t *fsid, struct file_handle *handle)
+{
+    int index = getFilesystemIndex(fsid);
+    if (index < 0)
+        return nil;
+
+    int fd = open_by_handle_at(filesystems->get(index)->getMountFd(), handle, O_PATH | O_CLOEXEC);
+    if (fd < 0)
+        return nil;
+
+    char link[32];
+    char path[PATH_MAX + 1];
+    snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+    ssize_t len = readlink(link, path, PATH_MAX);
+    close(fd);
+    if (len <= 0)
+        return nil;
+
+    // only the root directory ends with a separator already
+    if (path[len - 1] != DIR_SEPARATOR)
+        path[len++] = DIR_SEPARATOR;
+    return String(path, len);
+}
+
+Ref<FanotifyEvent> Fanotify::nextEvent(int timeout)
+{
+    if (first_byte >= bytes)
+    {
+        first_byte = 0;
+        bytes = 0;
+
+        fd_set read_fds;
+        struct timeval tv;
+
+        FD_ZERO(&read_fds);
+        FD_SET(fanotify_fd, &read_fds);
+        FD_SET(stop_fd_read, &read_fds);
+        int fd_max = (stop_fd_read > fanotify_fd) ? stop_fd_read : fanotify_fd;
+
+        if (timeout >= 0)
+        {
+            tv.tv_sec = timeout / 1000;
+            tv.tv_usec = (timeout % 1000) * 1000;
+        }
+        int rc = select(fd_max + 1, &read_fds, NULL, NULL,
+                (timeout >= 0) ? &tv : NULL);
+        if (rc <= 0)
+            return nil;
+
+        if (FD_ISSET(stop_fd_read, &read_fds))
+        {
+            char buf;
+            read(stop_fd_read, &buf, 1);
+        }
+
+        if (! FD_ISSET(fanotify_fd, &read_fds))
+            return nil;
+
+        bytes = read(fanotify_fd, buffer, FANOTIFY_BUFFER_SIZE);
+        if (bytes <= 0)
+        {
+            bytes = 0;
+            return nil;
+        }
+    }
+
+    while (first_byte < bytes)
+    {
+        struct fanotify_event_metadata *meta = (struct fanotify_event_metadata *)(buffer + first_byte);
+        if (! FAN_EVENT_OK(meta, bytes - first_byte))
+        {
+            log_error("fanotify returned an incomplete event\n");
+            first_byte = bytes;
+            return nil;
+        }
+        first_byte += meta->event_len;
+
+        if (meta->vers != FANOTIFY_METADATA_VERSION)
+        {
+            log_error("fanotify metadata version %d is not supported\n", meta->vers);
+            continue;
+        }
+
+        if (meta->fd >= 0)
+            close(meta->fd);
+
+        if (meta->mask & FAN_Q_OVERFLOW)
+            return Ref<FanotifyEvent>(new FanotifyEvent(FAN_Q_OVERFLOW, nil, nil));
+
+        char *info = (char *)(meta + 1);
+        char *end = (char *)meta + meta->event_len;
+        while (info < end)
+        {
+            struct fanotify_event_info_fid *fid = (struct fanotify_event_info_fid *)info;
+            if (fid->hdr.len == 0)
+                break;
+            info += fid->hdr.len;
+            if (fid->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME)
+                continue;
+
+            struct file_handle *handle = (struct file_handle *)fid->handle;
+            char *name = (char *)handle->f_handle + handle->handle_bytes;
+
+            fsid_t fsid;
+            memcpy(&fsid, &fid->fsid, sizeof(fsid_t));
+            String path = resolveHandle(&fsid, handle);
+            if (path == nil)
+            {
+                // the directory was removed before the event was read,
+                // the removal is reported in its parent
+                log_debug("fanotify: directory of %s is gone\n", name);
+                break;
+            }
+            return Ref<FanotifyEvent>(new FanotifyEvent(meta->mask, path, String(name)));
+        }
+    }
+    return nil;
+}
+
+void Fanotify::stop()
+{
+    char stop = 's';
+    write(stop_fd_write, &stop, 1);
+}
+
+#endif // HAVE_FANOTIFY
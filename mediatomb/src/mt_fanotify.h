@@ -0,0 +1,154 @@
+/*MT*
+    
+    MediaTomb - http://www.mediatomb.cc/
+    
+    mt_fanotify.h - this file is part of MediaTomb.
+    
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+    
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+    
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+    
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+    
+    $Id$
+*/
+
+/// \file mt_fanotify.h
+#ifndef __MT_FANOTIFY_H__
+#define __MT_FANOTIFY_H__
+
+#include "zmmf/zmmf.h"
+
+#include <sys/fanotify.h>
+#include <sys/statfs.h>
+
+/// \brief A directory entry event reported by fanotify.
+class FanotifyEvent : public zmm::Object
+{
+public:
+    FanotifyEvent(int mask, zmm::String path, zmm::String name)
+    {
+        this->mask = mask;
+        this->path = path;
+        this->name = name;
+    }
+    int getMask() { return mask; }
+    
+    /// \brief the directory of the entry, ends with a separator; nil for
+    /// a queue overflow
+    zmm::String getPath() { return path; }
+    
+    zmm::String getName() { return name; }
+private:
+    int mask;
+    zmm::String path;
+    zmm::String name;
+};
+
+/// \brief fanotify interface, reporting the directory entry events of
+/// whole filesystems.
+class Fanotify : public zmm::Object
+{
+public:
+    Fanotify();
+    virtual ~Fanotify();
+    
+    /// \brief Puts the filesystem containing the path on the watch list.
+    ///
+    /// One mark covers the whole filesystem; marking a filesystem again
+    /// only counts the references.
+    /// \param path an existing file or directory on the filesystem
+    /// \param events fanotify event mask
+    /// \return id of the mark or a negative value if the filesystem could
+    /// not be marked
+    int addMark(zmm::String path, int events);
+    
+    /// \brief Releases a reference taken by addMark(), the mark is removed
+    /// with the last one.
+    /// \param id the id returned by addMark()
+    void removeMark(int id);
+    
+    /// \brief Returns the next fanotify event.
+    ///
+    /// Blocks like Inotify::nextEvent() until an event occurs, the timeout
+    /// expires or stop() is called. Events of directories that do not
+    /// exist any more are skipped.
+    /// \param timeout maximum time to wait in milliseconds, -1 waits
+    /// indefinitely
+    /// \return the event or nil
+    zmm::Ref<FanotifyEvent> nextEvent(int timeout = -1);
+    
+    /// \brief Unblock the nextEvent function.
+    void stop();
+    
+    /// \brief Checks if filesystem marks with directory entry events are
+    /// supported and permitted.
+    static bool supported();
+    
+private:
+    class Filesystem : public zmm::Object
+    {
+    public:
+        Filesystem(int id, fsid_t fsid, int mountFd, int events)
+        {
+            this->id = id;
+            this->fsid = fsid;
+            this->mountFd = mountFd;
+            this->events = events;
+            refCount = 0;
+        }
+        int getId() { return id; }
+        bool isFilesystem(fsid_t *fsid)
+        {
+            return (this->fsid.__val[0] == fsid->__val[0] &&
+                    this->fsid.__val[1] == fsid->__val[1]);
+        }
+        /// \brief a directory on the filesystem to resolve the handles with
+        int getMountFd() { return mountFd; }
+        int getEvents() { return events; }
+        int getRefCount() { return refCount; }
+        void setRefCount(int refCount) { this->refCount = refCount; }
+    private:
+        int id;
+        fsid_t fsid;
+        int mountFd;
+        int events;
+        int refCount;
+    };
+    
+    /// \brief the marked filesystems
+    zmm::Ref<zmm::Array<Filesystem> > filesystems;
+    int nextMarkId;
+    
+    int getFilesystemIndex(fsid_t *fsid);
+    int getFilesystemIndex(int id);
+    
+    /// \brief returns the path of a directory handle, nil if the
+    /// directory is gone
+    zmm::String resolveHandle(fsid_t *fsid, struct file_handle *handle);
+    
+    int fanotify_fd;
+    int stop_fds_pipe[2];
+    int stop_fd_read;
+    int stop_fd_write;
+    
+    char *buffer;
+    ssize_t bytes;
+    int first_byte;
+};
+
+#endif // __MT_FANOTIFY_H__
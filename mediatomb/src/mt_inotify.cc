@@ -134,7 +134,7 @@ void Inotify::removeWatch(int wd)
     }
 }
 
-struct inotify_event *Inotify::nextEvent()
+struct inotify_event *Inotify::nextEvent(int timeout)
 {
     static struct inotify_event event[MAX_EVENTS];
     static struct inotify_event * ret;
@@ -169,7 +169,7 @@ struct inotify_event *Inotify::nextEvent()
             // how much of the event do we have?
             bytes = (char *)&event[0] + bytes - (char *)ret;
             memcpy( &event[0], ret, bytes );
-            return nextEvent();
+            return nextEvent(timeout);
         }
         return ret;
 
@@ -183,6 +183,7 @@ struct inotify_event *Inotify::nextEvent()
     static unsigned int bytes_to_read;
     static int rc;
     static fd_set read_fds;
+    static struct timeval tv;
 
     FD_ZERO(&read_fds);
  
@@ -195,8 +196,13 @@ struct inotify_event *Inotify::nextEvent()
     if (stop_fd_read >fd_max)
         fd_max = stop_fd_read;
 
+    if (timeout >= 0)
+    {
+        tv.tv_sec = timeout / 1000;
+        tv.tv_usec = (timeout % 1000) * 1000;
+    }
     rc = select(fd_max + 1, &read_fds,
-            NULL, NULL, NULL);
+            NULL, NULL, (timeout >= 0) ? &tv : NULL);
     if ( rc < 0 ) {
         return NULL;
     }
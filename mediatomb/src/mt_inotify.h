@@ -60,9 +60,12 @@ public:
     /// \brief Returns the next inotify event.
     ///
     /// This function will return the next inotify event that occurs, in case
-    /// that there are no events the function will block indefinetely. It can
-    /// be unblocked by the stop function.
-    struct inotify_event * nextEvent();
+    /// that there are no events the function will block until the timeout
+    /// expires. It can be unblocked by the stop function.
+    /// \param timeout maximum time to wait in milliseconds, -1 waits
+    /// indefinetely
+    /// \return the event or NULL on timeout and when stop() was called
+    struct inotify_event * nextEvent(int timeout = -1);
 
     /// \brief Unblock the next_event function.
     void stop();
@@ -417,7 +417,9 @@ void Element::print_internal(Ref<StringBuffer> buf, int indent)
         {
             *buf << ' ';
             Ref<Attribute> attr = attributes->get(i);
-            *buf << attr->name << "=\"" << escape(attr->value) << '"';
+            *buf << attr->name << "=\"";
+            escape(buf, attr->value.c_str());
+            *buf << '"';
         }
     }
     
@@ -50,30 +50,47 @@ String Node::print()
 String Node::escape(String str)
 {
     Ref<StringBuffer> buf(new StringBuffer(str.length()));
-    signed char *ptr = (signed char *)str.c_str();
-    while (ptr && *ptr)
+    escape(buf, str.c_str());
+    return buf->toString();
+}
+
+void Node::escape(Ref<StringBuffer> buf, const char *str)
+{
+    if (str == NULL)
+        return;
+    signed char *ptr = (signed char *)str;
+    signed char *plain = ptr;
+    while (*ptr)
     {
+        const char *replacement;
         switch (*ptr)
         {
-            case '<' : *buf << "&lt;"; break;
-            case '>' : *buf << "&gt;"; break;
-            case '&' : *buf << "&amp;"; break;
-            case '"' : *buf << "&quot;"; break;
-            case '\'' : *buf << "&apos;"; break;
+            case '<' : replacement = "&lt;"; break;
+            case '>' : replacement = "&gt;"; break;
+            case '&' : replacement = "&amp;"; break;
+            case '"' : replacement = "&quot;"; break;
+            case '\'' : replacement = "&apos;"; break;
                        // handle control codes
             default  : if (((*ptr >= 0x00) && (*ptr <= 0x1f) && 
                             (*ptr != 0x09) && (*ptr != 0x0d) && 
                             (*ptr != 0x0a)) || (*ptr == 0x7f))
-                       {
-                           *buf << '.';
-                       }
+                           replacement = ".";
                        else
-                           *buf << *ptr;
+                           replacement = NULL;
                        break;
         }
+        if (replacement != NULL)
+        {
+            // characters that need no escaping are copied in one go
+            if (ptr > plain)
+                buf->concat((char *)plain, ptr - plain);
+            *buf << replacement;
+            plain = ptr + 1;
+        }
         ptr++;
     }
-    return buf->toString();
+    if (ptr > plain)
+        buf->concat((char *)plain, ptr - plain);
 }
 
 /*
@@ -61,6 +61,10 @@ public:
     virtual zmm::String print();
 
     virtual void print_internal(zmm::Ref<zmm::StringBuffer> buf, int indent) = 0;
+    
+    /// \brief appends the string to the buffer, escaped as XML text or
+    /// attribute value
+    static void escape(zmm::Ref<zmm::StringBuffer> buf, const char *str);
 protected:
     static zmm::String escape(zmm::String str);
 };
@@ -55,5 +55,5 @@ Text::Text(String text, enum mxml_value_type vtype) : Node()
 
 void Text::print_internal(Ref<StringBuffer> buf, int indent)
 {
-    *buf << escape(text);
+    escape(buf, text.c_str());
 }
@@ -674,7 +674,7 @@ Ref<CdsObject> Script::jsObject2cdsObject(JSObject *js, zmm::Ref<CdsObject> pcd)
                     int j = val.toInt();
                     if (j > 0)
                     {
-                        obj->setMetadata(MT_KEYS[i].upnp, val);
+                        obj->setMetadata(MetadataHandler::getMetaFieldName((metadata_fields_t)i), val);
                         RefCast(obj, CdsItem)->setTrackNumber(j);
                     }
                     else
@@ -683,7 +683,7 @@ Ref<CdsObject> Script::jsObject2cdsObject(JSObject *js, zmm::Ref<CdsObject> pcd)
                 else
                 {
                     val = sc->convert(val);
-                    obj->setMetadata(MT_KEYS[i].upnp, val);
+                    obj->setMetadata(MetadataHandler::getMetaFieldName((metadata_fields_t)i), val);
                 }
             }
         }
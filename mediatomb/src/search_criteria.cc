@@ -0,0 +1,267 @@
+/*MT*
+
+    MediaTomb - http://www.mediatomb.cc/
+
+    search_criteria.cc - this file is part of MediaTomb.
+
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+
+    $Id$
+*/
+
+/// \file search_criteria.cc
+
+#ifdef HAVE_CONFIG_H
+    #include "autoconfig.h"
+#endif
+
+#include "search_criteria.h"
+#include "tools.h"
+
+using namespace zmm;
+
+/// \brief recursive descent parser for the SearchCriteria grammar;
+/// "and" binds tighter than "or"
+class SearchCriteriaParser
+{
+public:
+    SearchCriteriaParser(String criteria)
+    {
+        this->criteria = criteria;
+        pos = criteria.c_str();
+    }
+
+    Ref<SearchExpression> parse()
+    {
+        skipSpace();
+        Ref<SearchExpression> exp;
+        // an empty criteria string is treated like "*"
+        if (*pos == '*' || *pos == 0)
+        {
+            if (*pos)
+                pos++;
+            exp = Ref<SearchExpression>(new SearchExpression(SEARCH_ALL));
+        }
+        else
+            exp = parseOr();
+        skipSpace();
+        if (*pos)
+            error(_("unexpected input"));
+        return exp;
+    }
+
+protected:
+    String criteria;
+    const char *pos;
+
+    void error(String message)
+    {
+        throw _Exception(_("invalid search criteria \"") + criteria + "\": "
+                + message + " at position " + (int)(pos - criteria.c_str()));
+    }
+
+    static bool isSpace(char c)
+    {
+        return (c == ' ' || c == '\t' || c == '\n' || c == '\r' ||
+                c == '\v' || c == '\f');
+    }
+
+    void skipSpace()
+    {
+        while (isSpace(*pos))
+            pos++;
+    }
+
+    /// \brief reads everything up to the next white space or parenthesis
+    String nextToken()
+    {
+        skipSpace();
+        const char *start = pos;
+        while (*pos && ! isSpace(*pos) && *pos != '(' && *pos != ')')
+            pos++;
+        return String(start, pos - start);
+    }
+
+    /// \brief consumes the logical operator if it is next in the input
+    bool acceptKeyword(const char *keyword)
+    {
+        skipSpace();
+        int len = strlen(keyword);
+        if (strncasecmp(pos, keyword, len) != 0)
+            return false;
+        char next = pos[len];
+        if (! isSpace(next) && next != '(')
+            return false;
+        pos += len;
+        return true;
+    }
+
+    Ref<SearchExpression> parseOr()
+    {
+        Ref<SearchExpression> exp = parseAnd();
+        while (acceptKeyword("or"))
+        {
+            Ref<SearchExpression> orExp(new SearchExpression(SEARCH_OR));
+            orExp->left = exp;
+            orExp->right = parseAnd();
+            exp = orExp;
+        }
+        return exp;
+    }
+
+    Ref<SearchExpression> parseAnd()
+    {
+        Ref<SearchExpression> exp = parsePrimary();
+        while (acceptKeyword("and"))
+        {
+            Ref<SearchExpression> andExp(new SearchExpression(SEARCH_AND));
+            andExp->left = exp;
+            andExp->right = parsePrimary();
+            exp = andExp;
+        }
+        return exp;
+    }
+
+    Ref<SearchExpression> parsePrimary()
+    {
+        skipSpace();
+        if (*pos == '(')
+        {
+            pos++;
+            Ref<SearchExpression> exp = parseOr();
+            skipSpace();
+            if (*pos != ')')
+                error(_("missing ')'"));
+            pos++;
+            return exp;
+        }
+        return parseRelation();
+    }
+
+    Ref<SearchExpression> parseRelation()
+    {
+        Ref<SearchExpression> exp(new SearchExpression(SEARCH_RELATION));
+        exp->property = nextToken();
+        if (! string_ok(exp->property))
+            error(_("property expected"));
+
+        String op = nextToken();
+        if (op == "=")
+            exp->op = SEARCH_OP_EQ;
+        else if (op == "!=")
+            exp->op = SEARCH_OP_NE;
+        else if (op == "<")
+            exp->op = SEARCH_OP_LT;
+        else if (op == "<=")
+            exp->op = SEARCH_OP_LE;
+        else if (op == ">")
+            exp->op = SEARCH_OP_GT;
+        else if (op == ">=")
+            exp->op = SEARCH_OP_GE;
+        else if (op == "contains")
+            exp->op = SEARCH_OP_CONTAINS;
+        else if (op == "doesNotContain")
+            exp->op = SEARCH_OP_DOES_NOT_CONTAIN;
+        else if (op == "derivedfrom")
+            exp->op = SEARCH_OP_DERIVED_FROM;
+        else if (op == "exists")
+            exp->op = SEARCH_OP_EXISTS;
+        else
+            error(_("unknown operator \"") + op + "\"");
+
+        if (exp->op == SEARCH_OP_EXISTS)
+        {
+            exp->value = nextToken();
+            if (exp->value != "true" && exp->value != "false")
+                error(_("\"true\" or \"false\" expected"));
+        }
+        else
+            exp->value = parseQuotedValue();
+        return exp;
+    }
+
+    /// \brief reads a double quoted string, \\" and \\\\ are unescaped
+    String parseQuotedValue()
+    {
+        skipSpace();
+        if (*pos != '"')
+            error(_("quoted value expected"));
+        pos++;
+        Ref<StringBuffer> buf(new StringBuffer());
+        while (*pos != '"')
+        {
+            if (*pos == 0)
+                error(_("unterminated quoted value"));
+            if (*pos == '\\' && (pos[1] == '"' || pos[1] == '\\'))
+                pos++;
+            *buf << *pos;
+            pos++;
+        }
+        pos++;
+        return buf->toString();
+    }
+};
+
+SearchExpression::SearchExpression(search_expression_t type) : Object()
+{
+    this->type = type;
+    op = SEARCH_OP_EQ;
+}
+
+Ref<SearchExpression> SearchExpression::parse(String criteria)
+{
+    if (criteria == nil)
+        criteria = _("");
+    SearchCriteriaParser parser(criteria);
+    return parser.parse();
+}
+
+SortCriterion::SortCriterion(String property, bool ascending) : Object()
+{
+    this->property = property;
+    this->ascending = ascending;
+}
+
+Ref<Array<SortCriterion> > SortCriterion::parse(String criteria)
+{
+    Ref<Array<SortCriterion> > ret(new Array<SortCriterion>());
+    if (! string_ok(criteria))
+        return ret;
+    Ref<Array<StringBase> > parts = split_string(criteria, ',');
+    for (int i = 0; i < parts->size(); i++)
+    {
+        String part = trim_string(String(parts->get(i)));
+        if (part.length() == 0)
+            continue;
+        // the sign is mandatory according to the specification, but some
+        // control points leave it out for ascending order
+        bool ascending = true;
+        if (part.charAt(0) == '+' || part.charAt(0) == '-')
+        {
+            ascending = (part.charAt(0) == '+');
+            part = trim_string(part.substring(1));
+        }
+        if (part.length() == 0)
+            throw _Exception(_("invalid sort criteria \"") + criteria + "\": property expected");
+        ret->append(Ref<SortCriterion>(new SortCriterion(part, ascending)));
+    }
+    return ret;
+}
@@ -0,0 +1,105 @@
+/*MT*
+
+    MediaTomb - http://www.mediatomb.cc/
+
+    search_criteria.h - this file is part of MediaTomb.
+
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+
+    $Id$
+*/
+
+/// \file search_criteria.h
+/// \brief Definitions of the SearchExpression and SortCriterion classes.
+
+#ifndef __SEARCH_CRITERIA_H__
+#define __SEARCH_CRITERIA_H__
+
+#include "common.h"
+
+typedef enum
+{
+    /// \brief "*", matches every object
+    SEARCH_ALL = 0,
+    SEARCH_AND,
+    SEARCH_OR,
+    /// \brief property, operator and value
+    SEARCH_RELATION
+} search_expression_t;
+
+typedef enum
+{
+    SEARCH_OP_EQ = 0,
+    SEARCH_OP_NE,
+    SEARCH_OP_LT,
+    SEARCH_OP_LE,
+    SEARCH_OP_GT,
+    SEARCH_OP_GE,
+    SEARCH_OP_CONTAINS,
+    SEARCH_OP_DOES_NOT_CONTAIN,
+    SEARCH_OP_DERIVED_FROM,
+    SEARCH_OP_EXISTS
+} search_operator_t;
+
+/// \brief A parsed UPnP SearchCriteria string.
+///
+/// The expression is a tree: SEARCH_AND and SEARCH_OR nodes have a left
+/// and a right operand, SEARCH_RELATION nodes compare a property with
+/// a value. For SEARCH_OP_EXISTS the value is "true" or "false".
+class SearchExpression : public zmm::Object
+{
+public:
+    SearchExpression(search_expression_t type);
+
+    /// \brief parses a SearchCriteria string as defined by the
+    /// ContentDirectory service specification
+    /// \param criteria the string to parse
+    /// \return the expression tree, throws an exception on syntax errors
+    static zmm::Ref<SearchExpression> parse(zmm::String criteria);
+
+    search_expression_t type;
+
+    zmm::Ref<SearchExpression> left;
+    zmm::Ref<SearchExpression> right;
+
+    zmm::String property;
+    search_operator_t op;
+    zmm::String value;
+};
+
+/// \brief One property of a parsed UPnP SortCriteria string.
+class SortCriterion : public zmm::Object
+{
+public:
+    SortCriterion(zmm::String property, bool ascending);
+
+    /// \brief parses a comma separated SortCriteria string, every property
+    /// is prefixed with '+' (ascending) or '-' (descending)
+    /// \param criteria the string to parse, may be nil or empty
+    /// \return the sort properties in order of precedence, throws an
+    /// exception on syntax errors
+    static zmm::Ref<zmm::Array<SortCriterion> > parse(zmm::String criteria);
+
+    zmm::String property;
+    bool ascending;
+};
+
+#endif // __SEARCH_CRITERIA_H__
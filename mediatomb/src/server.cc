@@ -390,6 +390,11 @@ int Server::upnp_callback(Upnp_EventType eventtype, void *event, void *cookie)
             {
                 ret = upnp_e.getErrorCode();
                 ((struct Upnp_Action_Request *)event)->ErrCode = ret;
+                // the SDK only reports our error code if there is a
+                // description, otherwise it sends "501 Action Failed"
+                strncpy(((struct Upnp_Action_Request *)event)->ErrStr,
+                        upnp_e.getMessage().c_str(), LINE_SIZE - 1);
+                ((struct Upnp_Action_Request *)event)->ErrStr[LINE_SIZE - 1] = '\0';
             }
             catch(Exception e)
             {
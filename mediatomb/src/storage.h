@@ -39,6 +39,7 @@
 #include "sync.h"
 #include "hash.h"
 #include "autoscan.h"
+#include "search_criteria.h"
 
 #define BROWSE_DIRECT_CHILDREN      0x00000001
 #define BROWSE_ITEMS                0x00000002
@@ -55,6 +56,7 @@ protected:
     
     int startingIndex;
     int requestedCount;
+    zmm::Ref<zmm::Array<SortCriterion> > sortCriteria;
     
     // output parameters
     int totalMatches;
@@ -66,6 +68,7 @@ public:
         this->flags = flags;
         startingIndex = 0;
         requestedCount = 0;
+        sortCriteria = nil;
     }
     
     inline int getFlags() { return flags; }
@@ -91,6 +94,12 @@ public:
     inline int getStartingIndex() { return startingIndex; }
     inline int getRequestedCount() { return requestedCount; }
     
+    /// \brief sort order requested by the client, nil or empty for the
+    /// default order
+    inline void setSortCriteria(zmm::Ref<zmm::Array<SortCriterion> > sortCriteria)
+    { this->sortCriteria = sortCriteria; }
+    inline zmm::Ref<zmm::Array<SortCriterion> > getSortCriteria() { return sortCriteria; }
+    
     inline int getTotalMatches() { return totalMatches; }
     
     inline void setTotalMatches(int totalMatches)
@@ -98,6 +107,57 @@ public:
     
 };
 
+class SearchParam : public zmm::Object
+{
+protected:
+    int containerID;
+    zmm::Ref<SearchExpression> criteria;
+    bool hideFsRoot;
+    
+    int startingIndex;
+    int requestedCount;
+    zmm::Ref<zmm::Array<SortCriterion> > sortCriteria;
+    
+    // output parameters
+    int totalMatches;
+    
+public:
+    inline SearchParam(int containerID, zmm::Ref<SearchExpression> criteria)
+    {
+        this->containerID = containerID;
+        this->criteria = criteria;
+        hideFsRoot = false;
+        startingIndex = 0;
+        requestedCount = 0;
+        sortCriteria = nil;
+        totalMatches = 0;
+    }
+    
+    inline int getContainerID() { return containerID; }
+    inline zmm::Ref<SearchExpression> getCriteria() { return criteria; }
+    
+    inline void setHideFsRoot(bool hideFsRoot) { this->hideFsRoot = hideFsRoot; }
+    inline bool getHideFsRoot() { return hideFsRoot; }
+    
+    inline void setRange(int startingIndex, int requestedCount)
+    {
+        this->startingIndex = startingIndex;
+        this->requestedCount = requestedCount;
+    }
+    
+    inline int getStartingIndex() { return startingIndex; }
+    inline int getRequestedCount() { return requestedCount; }
+    
+    inline void setSortCriteria(zmm::Ref<zmm::Array<SortCriterion> > sortCriteria)
+    { this->sortCriteria = sortCriteria; }
+    inline zmm::Ref<zmm::Array<SortCriterion> > getSortCriteria() { return sortCriteria; }
+    
+    inline int getTotalMatches() { return totalMatches; }
+    
+    inline void setTotalMatches(int totalMatches)
+    { this->totalMatches = totalMatches; }
+};
+
 class Storage : public Singleton<Storage>
 {
 public:
@@ -135,6 +195,20 @@ public:
     virtual void updateObject(zmm::Ref<CdsObject> object, int *changedContainer) = 0;
     
     virtual zmm::Ref<zmm::Array<CdsObject> > browse(zmm::Ref<BrowseParam> param) = 0;
+    
+    /// \brief Returns the objects below a container that match the search
+    /// criteria, the whole tree is searched if the container is the root.
+    /// \param param container, criteria and range of the search; the
+    /// total number of matches is set in it
+    virtual zmm::Ref<zmm::Array<CdsObject> > search(zmm::Ref<SearchParam> param) = 0;
+    
+    /// \brief Returns the search capabilities as reported by the
+    /// GetSearchCapabilities action.
+    virtual zmm::String getSearchCapabilities() = 0;
+    
+    /// \brief Returns the properties that browse() and search() can sort
+    /// by, as reported by the GetSortCapabilities action.
+    virtual zmm::String getSortCapabilities() = 0;
     virtual zmm::Ref<zmm::Array<zmm::StringBase> > getMimeTypes() = 0;
     
     //virtual zmm::Ref<zmm::Array<CdsObject> > selectObjects(zmm::Ref<SelectParam> param) = 0;
@@ -162,10 +236,29 @@ public:
     ///  "id,update_id"
     virtual zmm::String incrementUpdateIDs(int *ids, int size) = 0;
     
+    /// \brief Starts a bulk import session.
+    ///
+    /// Until the matching commitBulkImport() the added objects are written
+    /// in large transactions and the update ids of the changed containers
+    /// are not incremented; the UpdateManager gets all of them at once when
+    /// the session is committed. Sessions may be nested, only the outermost
+    /// commitBulkImport() ends the session.
+    virtual void beginBulkImport() = 0;
+    
+    /// \brief Ends a bulk import session started by beginBulkImport().
+    virtual void commitBulkImport() = 0;
+    
     /* utility methods */
     virtual zmm::Ref<CdsObject> loadObject(int objectID) = 0;
     virtual int getChildCount(int contId, bool containers = true, bool items = true, bool hideFsRoot = false) = 0;
     
+    /// \brief Fetches the first item (in browse order) of each of the given
+    /// containers with a constant number of queries.
+    /// \param containerIDs ids of the containers
+    /// \return hash mapping the container id to its first item; containers
+    /// without items are not contained
+    virtual zmm::Ref<DBOHash<int, CdsObject> > getFirstChildItems(zmm::Ref<zmm::IntArray> containerIDs) = 0;
+    
     class ChangedContainers : public Object
     {
     public:
@@ -190,11 +283,32 @@ public:
     /// \return changed container ids
     virtual zmm::Ref<ChangedContainers> removeObject(int objectID, bool all) = 0;
     
-    /// \brief Get all objects under the given parentID.
+    /// \brief A child of a filesystem container as stored in the database.
+    class DirectoryEntry : public Object
+    {
+    public:
+        int id;
+        bool container;
+        /// \brief size of the first resource, -1 if it is not known
+        off_t size;
+    };
+    
+    class DirectoryContents : public Object
+    {
+    public:
+        /// \brief ids of all children
+        zmm::Ref<DBRHash<int> > ids;
+        /// \brief the children with a file or directory location, keyed by
+        /// their path; directories without the trailing separator
+        zmm::Ref<DSOHash<DirectoryEntry> > entries;
+    };
+    
+    /// \brief Loads all children of a filesystem container with a single
+    /// query, so a rescan can compare them with the directory in memory.
     /// \param parentID parent container
-    /// \param withoutContainer if false: all children are returned; if true: only items are returned
-    /// \return DBHash containing the objectID's - nil if there are none! 
-    virtual zmm::Ref<DBRHash<int> > getObjects(int parentID, bool withoutContainer) = 0;
+    /// \param withoutContainer if true only items are returned
+    /// \return the children - nil if there are none!
+    virtual zmm::Ref<DirectoryContents> getDirectoryContents(int parentID, bool withoutContainer) = 0;
     
     /// \brief Remove all objects found in list
     /// \param list a DBHash containing objectIDs that have to be removed
@@ -50,6 +50,10 @@ CacheObject::CacheObject()
     knowObjectType = false;
     virtualObj = true;
     knowVirtualObj = false;
+    cacheID = INVALID_OBJECT_ID;
+    cacheSegment = 0;
+    lruPrev = NULL;
+    lruNext = NULL;
 }
 
 
@@ -85,6 +85,13 @@ private:
     bool knowVirtualObj;
     
     zmm::String location;
+    
+    /* maintained by the StorageCache */
+    friend class StorageCache;
+    int cacheID;
+    int cacheSegment;
+    CacheObject *lruPrev;
+    CacheObject *lruNext;
 };
 
 #endif // __CACHE_OBJECT_H_
@@ -34,81 +34,93 @@
 
 #ifndef __MYSQL_CREATE_SQL_H__
 #define __MYSQL_CREATE_SQL_H__
-#define MS_CREATE_SQL_INFLATED_SIZE 3820
-#define MS_CREATE_SQL_DEFLATED_SIZE 1031
+#define MS_CREATE_SQL_INFLATED_SIZE 4897
+#define MS_CREATE_SQL_DEFLATED_SIZE 1210
 
 /* begin binary data: */
-const unsigned char mysql_create_sql[] = /* 1031 */
-{0x78,0x9C,0xBD,0x57,0x51,0x8F,0x9B,0x38,0x10,0x7E,0xDF,0x5F,0xE1,0x7B,0x82
-,0x54,0xDC,0x2D,0xAC,0xB6,0x52,0x4F,0xD5,0x4A,0xCB,0x11,0xB7,0x8D,0x4A,0x60
-,0x0B,0xE4,0x4E,0xBD,0x17,0xE3,0x80,0xB3,0xE1,0x96,0x40,0x04,0x26,0xBA,0xFC
-,0xFB,0x1B,0x43,0x08,0x10,0x9C,0x34,0x91,0x4E,0x7D,0x49,0x60,0xF8,0xFC,0xF9
-,0xF3,0x78,0x3C,0x9E,0xB9,0x7F,0xF7,0xCB,0xA3,0x6E,0xE8,0x06,0xF2,0x71,0x80
-,0x9E,0x5D,0x7B,0x4A,0xAC,0x2F,0xA6,0x67,0x5A,0x01,0xF6,0x08,0x98,0x88,0x65
-,0xCF,0xB0,0x13,0x3C,0x3D,0x3F,0xCB,0xCC,0xE8,0xDD,0xFD,0xC7,0xBB,0xFB,0x1F
-,0x30,0x78,0xD8,0x5F,0xD8,0x81,0x3F,0xA2,0x38,0xD8,0xCF,0x71,0xB8,0xB6,0x6D
-,0x06,0x33,0xD7,0x81,0x27,0xC7,0xC1,0x96,0x78,0x14,0x14,0x12,0xF3,0x98,0xC1
-,0x31,0xE7,0xD8,0x47,0x15,0x5F,0x7D,0xE8,0xBE,0xE9,0xC6,0x63,0xC7,0xBE,0x70
-,0x66,0xDF,0x16,0x18,0x84,0x62,0xEB,0xAB,0x50,0x36,0x78,0xD7,0xD0,0xF0,0xB3
-,0x7E,0x86,0xE4,0x93,0xEB,0xE1,0xD9,0x67,0x87,0x7C,0xC5,0xDF,0x3B,0xA6,0xB1
-,0x51,0x43,0x12,0xA0,0x7E,0x66,0xD9,0xFE,0x37,0x9B,0xCC,0xDD,0x29,0x06,0xA6
-,0xF6,0x51,0x43,0x47,0xA3,0xE2,0xB8,0xC4,0x5C,0x04,0x2E,0xF9,0xD3,0xB4,0x41
-,0x1F,0x78,0xE1,0x6F,0xEC,0xB9,0x4A,0x8F,0xCB,0x38,0xE1,0x72,0xDC,0x00,0xFB
-,0x07,0xB2,0xFA,0xB9,0x61,0x6B,0xCC,0x8D,0x08,0xCB,0xC3,0x66,0x80,0x51,0x60
-,0xFE,0x61,0x63,0x14,0x6E,0x38,0x89,0xE2,0x92,0xE4,0xCB,0x7F,0x58,0xC4,0x43
-,0xA4,0xDE,0x21,0x14,0x26,0x71,0x88,0x92,0x8C,0xAB,0x86,0x31,0x41,0x30,0x12
-,0x39,0x0B,0xDB,0x46,0xB4,0xE2,0x39,0x49,0xB2,0xA8,0x60,0x1B,0x96,0x71,0x4D
-,0xE0,0x0A,0xB6,0x22,0x7D,0x6C,0xCC,0x56,0xB4,0x4A,0x79,0x8D,0xAF,0x01,0x5B
-,0x5A,0x00,0x96,0x48,0xF9,0x5A,0xB0,0xA2,0x2B,0x35,0xB6,0x51,0x40,0xF8,0x7E
-,0xCB,0x42,0xC4,0x93,0x6C,0x2F,0x46,0x3C,0x4E,0x50,0x95,0x95,0xC9,0x6B,0xC6
-,0xE2,0xE3,0xC8,0x1A,0x5D,0x6D,0xB3,0x2D,0x89,0x52,0x5A,0x96,0x21,0xDA,0xD1
-,0x22,0x5A,0xD3,0x42,0xFD,0xA0,0x4B,0x24,0xC4,0x11,0xE1,0x09,0x4F,0x59,0x07
-,0x7B,0x78,0xFF,0x5E,0x82,0x4B,0xF3,0x88,0xF2,0x24,0xCF,0x42,0xB4,0x4C,0xF3
-,0xE5,0xC0,0x44,0xD6,0xB4,0x5C,0x77,0x2B,0x38,0x0A,0x1A,0x71,0x6C,0x18,0xA7
-,0x31,0xE5,0xB4,0xC7,0x41,0xAB,0x7F,0x4F,0x2C,0x05,0x2B,0xF3,0xAA,0x88,0x58
-,0xD9,0xB3,0x55,0x5B,0x00,0xB1,0xEB,0xFC,0xB4,0x49,0x36,0xEC,0xE0,0xA5,0x76
-,0x45,0x8F,0xB2,0x85,0xAF,0x52,0xFA,0x5A,0x4A,0x54,0x8F,0x89,0x8D,0x86,0x98
-,0x17,0x34,0x7A,0x23,0x59,0xB5,0x59,0xB2,0xE2,0xC2,0x9E,0x96,0xAC,0xD8,0x25
-,0x51,0x23,0xF6,0xA2,0x4B,0x5F,0xBC,0xD9,0xDC,0xF4,0xBE,0x23,0x38,0x05,0x08
-,0xA9,0x22,0xA8,0x26,0xC2,0x2C,0x5E,0xC3,0x2E,0xE4,0x48,0x1B,0x44,0x6A,0x1B
-,0x4E,0x52,0x54,0x2F,0x92,0xD4,0x5E,0x58,0x69,0x83,0xB0,0xD1,0xBA,0xDD,0x96
-,0x92,0x0C,0x42,0x4C,0x1D,0x0C,0xED,0xF0,0xC7,0x5D,0x6F,0x66,0x11,0xC0,0x61
-,0x20,0x68,0xBD,0xF9,0xA5,0xD3,0x0C,0x1D,0xA9,0x0E,0x1D,0x2B,0x1D,0xD1,0xF7
-,0xA9,0xDA,0xF7,0x70,0x8D,0x86,0xCC,0xE7,0x07,0x9E,0x39,0x83,0xFC,0x3B,0x3C
-,0xAE,0x24,0x59,0xAE,0xDE,0x88,0x11,0xB6,0x09,0xA7,0xE6,0xED,0xFC,0x88,0x3C
-,0xFC,0x09,0x7B,0xD8,0xB1,0x20,0x37,0x8E,0xCE,0x79,0xBD,0x1F,0x08,0x92,0xE9
-,0x14,0xDB,0x18,0xD2,0x81,0x65,0xFA,0x96,0x39,0xC5,0xC2,0xB2,0x78,0x99,0x9A
-,0x9D,0xE5,0x0A,0x05,0x0F,0xA7,0x0A,0x7A,0x0E,0xFA,0x7F,0x44,0xDC,0x4D,0x10
-,0x76,0x3E,0xCF,0x1C,0xFC,0x34,0xDF,0xCF,0x7C,0x73,0x8E,0xC4,0xD5,0x02,0x89
-,0xEF,0x49,0xE4,0xFC,0x8F,0x77,0x33,0xC7,0xC7,0x5E,0x80,0x40,0x9F,0x3B,0x9A
-,0xA4,0x4E,0x9D,0x3E,0x52,0x7F,0x35,0xB4,0x3A,0x32,0xE1,0x5F,0x6F,0x9E,0x2E
-,0xFF,0x1C,0x40,0xBF,0x77,0xA6,0xC9,0x75,0x13,0xE9,0xC7,0x79,0x0C,0x4D,0x69
-,0x3E,0xFE,0x16,0xE5,0x19,0xA7,0x49,0xC6,0x0A,0x45,0x53,0xBC,0x3C,0xE7,0xCA
-,0x8D,0xF3,0x1E,0xBC,0x71,0x3A,0xA5,0x48,0xFD,0xC2,0x87,0x4F,0x90,0x1C,0xD0
-,0x5F,0x5F,0xC0,0xCF,0x87,0x57,0x43,0xB9,0x4E,0xAB,0xD1,0xCE,0x29,0x97,0xFA
-,0x62,0xA1,0x69,0x52,0x80,0x35,0x2F,0xF6,0xB7,0x4A,0x96,0x5E,0x33,0x34,0xE2
-,0xC9,0x0E,0x22,0x9B,0xB3,0xCD,0x85,0xBB,0xA6,0xC9,0x9C,0x51,0x93,0x8E,0x07
-,0x39,0x66,0x80,0x28,0x39,0x24,0xCD,0x0B,0x80,0x33,0x09,0x48,0x12,0xCC,0x3D
-,0x59,0x67,0xCE,0xD4,0x4F,0x0B,0xE5,0x91,0xDB,0xC0,0x39,0xAC,0xC8,0x68,0x0A
-,0x49,0x82,0xC3,0xB5,0xF8,0x7A,0xF0,0xDB,0x1B,0xDB,0x0F,0x2F,0x80,0x81,0x6B
-,0x76,0x34,0xAD,0x6E,0x70,0x8D,0x20,0x9B,0xDC,0x78,0xC6,0xC6,0xBA,0xDA,0xA0
-,0x52,0xE2,0x25,0xD9,0xB1,0xA2,0x84,0xED,0x83,0x18,0x7A,0x54,0x64,0xC1,0x20
-,0xAA,0x89,0x32,0xA2,0xD9,0x8D,0x15,0x07,0xB8,0xFB,0x72,0xC5,0x21,0x38,0x49
-,0xCA,0x76,0x2C,0x0D,0x11,0x83,0x94,0xAB,0x2A,0x4B,0x5A,0x26,0x11,0xE8,0x58
-,0x55,0x69,0xAA,0x9C,0x46,0x90,0x40,0x6F,0xF2,0x98,0xB5,0x60,0x0E,0x97,0x6B
-,0x0C,0xE0,0x24,0xCB,0x79,0xB2,0xDA,0x9F,0xE2,0xE1,0x28,0x54,0xB0,0xAE,0xDD
-,0x35,0x15,0xCA,0x3A,0x89,0x63,0x96,0x5D,0x01,0xAC,0x1D,0x09,0x1B,0x76,0x4D
-,0x85,0x01,0x05,0x0F,0x17,0x82,0x93,0x55,0xC2,0xC0,0x0D,0xCB,0xE4,0x55,0x8C
-,0x79,0xD0,0x2F,0x8D,0xD9,0x8A,0xAD,0x28,0x79,0x7D,0x97,0x5D,0x12,0x33,0xAA
-,0x34,0x24,0x25,0xD1,0x96,0xF2,0x35,0x6C,0x40,0xBF,0x76,0xE1,0x79,0x15,0xAD
-,0x85,0x98,0xEB,0xB8,0x9B,0x62,0xA3,0x1F,0x7F,0x61,0x73,0xEB,0xB5,0xC7,0xB3
-,0xA9,0xC5,0x9B,0x2F,0xBD,0x40,0x21,0xED,0xD6,0xAB,0x6D,0x10,0xC8,0x0E,0xF3
-,0x11,0x2D,0x3F,0xC5,0xED,0xC8,0x9F,0x72,0x92,0x07,0xC5,0x7E,0x57,0xE7,0xF7
-,0xAB,0xFE,0x71,0xA3,0x21,0xEB,0x31,0xE4,0xBD,0xC7,0x78,0xEC,0x49,0x93,0x33
-,0xEA,0x7B,0xC6,0x2D,0x88,0xBC,0xF5,0x3B,0xD7,0x14,0xFE,0x68,0xFC,0xB1,0xF1
-,0x3B,0xDB,0x13,0x4A,0x18,0xA4,0x6D,0xDF,0xB9,0x86,0x70,0xDC,0xF8,0xF4,0x7A
-,0x9E,0x41,0x0B,0x54,0x23,0xFF,0x03,0x84,0xD2,0x7F,0xB7};
-/* end binary data. size = 1031 bytes */
+const unsigned char mysql_create_sql[] = /* 1210 */
+{0x78,0x9C,0xC5,0x58,0xDF,0x6F,0xA3,0x38,0x10,0x7E,0xEF,0x5F,0xE1,0x7B,0x82
+,0xAC,0xB8,0x6B,0xA8,0xBA,0x52,0x4F,0xAB,0x4A,0xE5,0x12,0xEF,0x6E,0xB4,0x94
+,0x74,0x81,0xDC,0x69,0xEF,0xC5,0x38,0xE0,0x34,0xBE,0x12,0x88,0xC0,0x44,0x9B
+,0xFB,0xEB,0xCF,0x86,0xF0,0xC3,0xC1,0xA4,0x54,0x5A,0xED,0xBD,0xB4,0x30,0x7C
+,0x33,0xFE,0x3C,0x9E,0xF1,0x4C,0xE6,0xFA,0xDD,0x2F,0xB7,0x53,0x73,0x6A,0x02
+,0x0F,0xFA,0xE0,0x61,0x69,0xCF,0xD1,0xEC,0xB3,0xE5,0x5A,0x33,0x1F,0xBA,0x88
+,0x8B,0xD0,0xCC,0x5E,0x40,0xC7,0xBF,0x7F,0x78,0x50,0x89,0xC1,0xBB,0xEB,0x0F
+,0x57,0xD7,0xAF,0x58,0x70,0xA1,0xB7,0xB2,0x7D,0xAF,0x67,0xE2,0x24,0x1F,0xB2
+,0xB1,0xB4,0x6D,0xCB,0x5F,0x2C,0x1D,0xFE,0xE4,0x38,0x70,0x26,0x1E,0x85,0x09
+,0x85,0xB8,0x6F,0xC1,0xB1,0x1E,0xA1,0x07,0x0A,0xB6,0xB9,0x6B,0xBF,0x4D,0xCD
+,0xDB,0xD6,0xFA,0xCA,0x59,0x7C,0x5D,0x41,0x4E,0x14,0xCE,0xBE,0x08,0x66,0xD2
+,0xBB,0x01,0xE4,0xCF,0xD3,0x01,0x23,0x1F,0x97,0x2E,0x5C,0x7C,0x72,0xD0,0x17
+,0xF8,0xAD,0xB5,0xD4,0x17,0x1A,0x40,0x01,0x9C,0x0E,0x6C,0xDB,0xFB,0x6A,0xA3
+,0xC7,0xE5,0x1C,0x72,0x4B,0xF5,0xA3,0x01,0x1A,0xA1,0xE6,0x2C,0x91,0xB5,0xF2
+,0x97,0xE8,0x4F,0xCB,0xE6,0xFC,0xB8,0x17,0xFE,0x86,0xEE,0x52,0xEB,0xD8,0x32
+,0xCF,0x6C,0x39,0x4B,0x1F,0x7A,0x27,0x63,0xE5,0x73,0x65,0xAD,0x12,0x57,0x24
+,0x66,0x2E,0xB4,0x7C,0x08,0x7C,0xEB,0x0F,0x1B,0x82,0x60,0xC7,0x50,0x18,0xE5
+,0x28,0x5D,0xFF,0x43,0x42,0x16,0x00,0xFD,0x0A,0x80,0x80,0x46,0x01,0xA0,0x09
+,0xD3,0x4D,0x73,0x02,0xB8,0x26,0x70,0x56,0xB6,0x0D,0x70,0xC1,0x52,0x44,0x93
+,0x30,0x23,0x3B,0x92,0x30,0x43,0xE0,0x32,0xB2,0x41,0x5D,0x6C,0x44,0x36,0xB8
+,0x88,0x59,0x89,0x2F,0x01,0x7B,0x9C,0x71,0x2C,0x52,0xDA,0xAB,0xC1,0xDA,0x54
+,0x2B,0xB1,0x15,0x03,0xC4,0x8E,0x7B,0x12,0x00,0x46,0x93,0xA3,0xD0,0xB8,0x9D
+,0x80,0x22,0xC9,0xE9,0x73,0x42,0xA2,0x46,0xB3,0x44,0x17,0xFB,0x64,0x8F,0xC2
+,0x18,0xE7,0x79,0x00,0x0E,0x38,0x0B,0xB7,0x38,0xD3,0xEF,0xA6,0x0A,0x0A,0x51
+,0x88,0x18,0x65,0x31,0x69,0x61,0x37,0xEF,0xDF,0x2B,0x70,0x71,0x1A,0x62,0x46
+,0xD3,0x24,0x00,0xEB,0x38,0x5D,0x4B,0x22,0xB4,0xC5,0xF9,0xB6,0xDD,0x41,0x43
+,0xA8,0x67,0x63,0x47,0x18,0x8E,0x30,0xC3,0x1D,0x1B,0xB8,0xF8,0x7E,0x26,0xC9
+,0x48,0x9E,0x16,0x59,0x48,0xF2,0x8E,0xAC,0xD8,0x73,0x10,0x19,0xE7,0xA7,0x1D
+,0xDD,0x91,0x93,0x97,0xEA,0x1D,0xDD,0xAA,0x36,0xBE,0x89,0xF1,0x73,0xAE,0x60
+,0xDD,0x37,0x6C,0x56,0x86,0x59,0x86,0xC3,0x17,0x94,0x14,0xBB,0x35,0xC9,0x2E
+,0x9C,0x69,0x4E,0xB2,0x03,0x0D,0x2B,0xB2,0x97,0x5D,0x1A,0x6E,0x69,0x1C,0xA1
+,0x30,0x4D,0x18,0xA6,0x09,0xC9,0xF2,0x11,0x9B,0xAB,0x54,0x28,0x23,0xBB,0x31
+,0x68,0x7E,0xB6,0xC2,0x6F,0xAF,0xF1,0x28,0x63,0x05,0x67,0x8C,0xE6,0x6C,0x1C
+,0x34,0x5E,0x17,0xBB,0xD7,0x90,0xFC,0x18,0x51,0x4E,0xFF,0xE5,0x8B,0xAF,0xE9
+,0xB3,0x60,0x7A,0xA3,0x38,0x84,0x27,0x77,0xF1,0x68,0xB9,0xDF,0x00,0xBF,0x08
+,0x00,0xD0,0x45,0x5E,0x4D,0x84,0x58,0xBC,0x06,0x6D,0xD6,0xA1,0x3A,0x8F,0xF4
+,0x3A,0xA3,0x94,0xA8,0x4E,0x32,0xE9,0x9D,0xCC,0x32,0xA4,0xCC,0x31,0xDA,0x80
+,0x57,0x1A,0x91,0xB2,0x4C,0x97,0x54,0x5B,0x7C,0x13,0xF8,0xD5,0x2A,0x02,0x28
+,0xE7,0x82,0xD1,0x59,0x5F,0xB9,0x8C,0x1C,0x4B,0xBA,0x1C,0x5B,0x4A,0x8D,0x6E
+,0x58,0xE9,0xDD,0x20,0x53,0xA3,0xD3,0x8C,0xD5,0x79,0x2D,0x3B,0xE3,0xF2,0xF6
+,0x4B,0xBD,0x2A,0x66,0x7A,0x6A,0xA5,0x78,0x58,0xAB,0x0E,0x20,0x59,0xAF,0x1B
+,0x5B,0x17,0x74,0xAB,0x88,0x52,0xA9,0x96,0x5F,0x2E,0xEC,0x51,0x38,0xEE,0x5C
+,0x73,0x84,0x37,0x85,0x6E,0x15,0x9E,0xB2,0x6A,0x13,0xB6,0xA5,0x1A,0xAF,0xA9
+,0x9E,0xEF,0x5A,0x0B,0x5E,0xD9,0xE5,0x42,0x80,0xE8,0x7A,0xF3,0x82,0xCC,0xA0
+,0x2E,0x65,0xE5,0x02,0x6D,0x78,0x02,0x17,0x7E,0x84,0x2E,0x74,0x66,0xBC,0xEA
+,0xF6,0x2A,0x48,0x19,0xE6,0x80,0x97,0xE9,0x39,0xB4,0x21,0x2F,0x34,0x33,0xCB
+,0x9B,0x59,0x73,0x28,0x24,0xAB,0xA7,0xB9,0xD5,0x4A,0x46,0x30,0xB8,0x39,0x67
+,0xD0,0x89,0xBB,0x1F,0x43,0xE2,0x6A,0x02,0xA0,0xF3,0x69,0xE1,0xC0,0xFB,0xC7
+,0xE3,0xC2,0xB3,0x1E,0x81,0x68,0x5A,0x78,0x49,0xBD,0x17,0xDD,0xC4,0x87,0xAB
+,0x85,0xE3,0x41,0xD7,0x07,0x9C,0xDF,0xB2,0xB7,0x48,0x59,0x94,0x3D,0xA0,0xFF
+,0x6A,0x1A,0x65,0xC2,0xF3,0xFF,0xD3,0xEA,0xE9,0xF2,0x9F,0x13,0xE8,0xF7,0x8E
+,0x68,0x40,0x73,0x32,0x8E,0xC0,0xB4,0x59,0xDF,0x34,0xB4,0xEA,0xE3,0x6F,0xCD
+,0xB5,0xAB,0x19,0x9A,0x9B,0xA6,0x4C,0xFB,0x41,0x7C,0x4E,0xDE,0x3B,0xA7,0x22
+,0x9A,0x10,0xE1,0xF3,0x7B,0x7E,0x37,0x83,0xBF,0x3E,0xF3,0x73,0x39,0xBD,0x9A
+,0xDA,0xB8,0x3D,0x98,0x35,0x17,0xF5,0x16,0x9E,0x66,0x60,0x4E,0x33,0x2E,0x4D
+,0xB3,0xE3,0xDB,0xB6,0x32,0x1D,0xDC,0x8A,0xB2,0x11,0xC2,0x21,0xA3,0x07,0x52
+,0x96,0xA0,0x0B,0xDD,0x50,0x55,0xDB,0xC3,0xAA,0x61,0x90,0x0A,0x85,0x84,0xC8
+,0x59,0xBF,0x3C,0x75,0x01,0x03,0xF5,0x41,0x91,0x14,0x1D,0x5A,0x03,0xB9,0xF9
+,0xD3,0x52,0xA2,0xE7,0x36,0xEE,0x1C,0x92,0x25,0x38,0xE6,0x77,0x38,0xE3,0x8D
+,0xDB,0xF3,0xC9,0x6F,0x2F,0xE4,0x28,0xB7,0x28,0x92,0x6B,0x0E,0x38,0x2E,0xDE
+,0xE0,0x1A,0x61,0x6C,0xF2,0xC6,0x5C,0xED,0xF3,0xAA,0x83,0x4D,0x8B,0xD6,0xE8
+,0xC0,0x3B,0x12,0x7E,0x7C,0x3C,0xB6,0xEE,0x34,0x55,0x30,0x88,0x7E,0x37,0x0F
+,0x71,0xF2,0xC6,0x9E,0x98,0xBB,0xFB,0x72,0x4F,0x2C,0x6C,0xA2,0x98,0x1C,0x48
+,0x1C,0x00,0xC2,0xEF,0x70,0x5D,0x5B,0xE3,0x9C,0x86,0x9C,0xC7,0xA6,0x88,0x63
+,0xED,0x3C,0x82,0x04,0x7A,0x97,0x46,0xA4,0x06,0x33,0xDE,0xFE,0x45,0x1C,0x4C
+,0x93,0x94,0xD1,0xCD,0xF1,0x1C,0xCF,0x53,0xA4,0xE0,0xFB,0x3A,0x8C,0xE9,0xA1
+,0xB7,0x34,0x8A,0x48,0x32,0x02,0x58,0x3A,0x92,0x1F,0xD8,0x98,0x1E,0x98,0xB7
+,0xE4,0x4C,0x10,0xA6,0x1B,0x4A,0x22,0xA9,0x39,0x1A,0xD6,0xD9,0x8B,0xA3,0xC8
+,0x59,0xD9,0x6A,0x5C,0x22,0xD3,0x6B,0x00,0x15,0x4D,0xFB,0x1E,0xB3,0x2D,0x3F
+,0x80,0x6E,0x77,0xCD,0xD2,0x22,0xDC,0x0A,0x32,0xE3,0x6C,0x57,0xED,0x70,0x37
+,0xFE,0x82,0xAA,0x29,0xA9,0xD3,0xB3,0xFA,0xB5,0x58,0x7D,0xE9,0x04,0x0A,0xAA
+,0x8F,0x5E,0xAF,0x83,0x40,0x95,0xCC,0x0D,0x5A,0x9D,0xC5,0xB5,0xE6,0xFF,0x93
+,0xC9,0xED,0x0F,0x98,0x2A,0xE6,0xCB,0xDB,0x66,0xE8,0xFA,0xDB,0x67,0x29,0x3F
+,0x38,0x76,0x44,0x09,0xDE,0x5D,0xCA,0xE4,0x16,0x78,0xCA,0x79,0x46,0xBE,0x33
+,0x09,0x51,0x7B,0xB2,0x5E,0x1E,0x35,0x0B,0xEB,0x0D,0x87,0x89,0x12,0x58,0x9B
+,0x2E,0xDB,0x1C,0x89,0x8F,0x71,0xBE,0x6C,0x49,0x4C,0x75,0x22,0xED,0xAA,0xEA
+,0x7B,0xB5,0x26,0xF0,0x53,0x8E,0x44,0x9A,0x10,0xB4,0xC3,0x81,0xEE,0xA8,0xA0
+,0x3F,0x9D,0x50,0x0D,0x26,0xD4,0x03,0x8B,0xBE,0xEE,0xD9,0x64,0xA4,0x37,0x2C
+,0xE9,0xCF,0x2D,0xD4,0xF3,0xA2,0xA1,0x49,0xD2,0x6B,0xFA,0xCD,0xB4,0x68,0x70
+,0x90,0xA4,0xB0,0xA0,0x9C,0x15,0x0D,0x4D,0x91,0xFA,0xD3,0x92,0xCE,0xA0,0x44
+,0x9A,0x9B,0x94,0xC8,0xFF,0x00,0x65,0xCF,0xE1,0x6D};
+/* end binary data. size = 1210 bytes */
 
 #endif // __MYSQL_CREATE_SQL_H__
 
@@ -67,6 +67,30 @@
 #define MYSQL_UPDATE_3_4_2 "ALTER TABLE `mt_cds_object` ADD KEY `cds_object_service_id` (`service_id`)"
 #define MYSQL_UPDATE_3_4_3 "UPDATE `mt_internal_setting` SET `value`='4' WHERE `key`='db_version' AND `value`='3'"
 
+// updates 4->5
+#define MYSQL_UPDATE_4_5_1 "ALTER TABLE `mt_cds_object` ADD `child_containers` int(11) NOT NULL default '0' AFTER `service_id`, ADD `child_items` int(11) NOT NULL default '0' AFTER `child_containers`"
+#define MYSQL_UPDATE_4_5_2 "UPDATE `mt_cds_object` `p` JOIN (SELECT `parent_id`, SUM(`object_type`=1) AS `c`, SUM((`object_type` & 2)=2) AS `i` FROM `mt_cds_object` GROUP BY `parent_id`) `x` ON `x`.`parent_id`=`p`.`id` SET `p`.`child_containers`=`x`.`c`, `p`.`child_items`=`x`.`i`"
+#define MYSQL_UPDATE_4_5_3 "UPDATE `mt_internal_setting` SET `value`='5' WHERE `key`='db_version' AND `value`='4'"
+
+// updates 5->6; the metadata table is filled by SQLStorage::dbReady()
+#define MYSQL_UPDATE_5_6_1 "CREATE TABLE `mt_metadata` ( `item_id` int(11) NOT NULL, `property_name` varchar(255) NOT NULL, `property_value` text NOT NULL, KEY `mt_metadata_item_id` (`item_id`), KEY `mt_metadata_property` (`property_name`,`property_value`(255)), CONSTRAINT `mt_metadata_ibfk_1` FOREIGN KEY (`item_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE ) ENGINE=MyISAM CHARSET=utf8"
+#define MYSQL_UPDATE_5_6_2 "INSERT INTO `mt_internal_setting` VALUES('metadata_rebuild','1')"
+#define MYSQL_UPDATE_5_6_3 "UPDATE `mt_internal_setting` SET `value`='6' WHERE `key`='db_version' AND `value`='5'"
+
+// updates 6->7; the sort columns are filled by SQLStorage::dbReady()
+#define MYSQL_UPDATE_6_7_1 "ALTER TABLE `mt_cds_object` ADD `dc_date` varchar(255) default NULL AFTER `child_items`, ADD `upnp_artist` varchar(255) default NULL AFTER `dc_date`, ADD `upnp_album` varchar(255) default NULL AFTER `upnp_artist`, ADD `res_size` bigint(20) default NULL AFTER `upnp_album`"
+#define MYSQL_UPDATE_6_7_2 "ALTER TABLE `mt_cds_object` ADD KEY `cds_object_sort_title` (`parent_id`,`dc_title`), ADD KEY `cds_object_sort_date` (`parent_id`,`dc_date`), ADD KEY `cds_object_sort_artist` (`parent_id`,`upnp_artist`), ADD KEY `cds_object_sort_album` (`parent_id`,`upnp_album`), ADD KEY `cds_object_sort_track` (`parent_id`,`track_number`), ADD KEY `cds_object_sort_size` (`parent_id`,`res_size`)"
+#define MYSQL_UPDATE_6_7_3 "INSERT INTO `mt_internal_setting` VALUES('sort_rebuild','1')"
+#define MYSQL_UPDATE_6_7_4 "UPDATE `mt_internal_setting` SET `value`='7' WHERE `key`='db_version' AND `value`='6'"
+
+// updates 7->8; the object data is converted by SQLStorage::dbReady()
+#define MYSQL_UPDATE_7_8_1 "INSERT INTO `mt_internal_setting` VALUES('pack_rebuild','1')"
+#define MYSQL_UPDATE_7_8_2 "UPDATE `mt_internal_setting` SET `value`='8' WHERE `key`='db_version' AND `value`='7'"
+
+// maximum number of prepared statements per connection
+#define MYSQL_MAX_STATEMENTS 64
+#define MYSQL_STATEMENT_HASH_CAPACITY 149
+
 
 using namespace zmm;
 using namespace mxml;
@@ -79,12 +103,23 @@ MysqlStorage::MysqlStorage() : SQLStorage()
     table_quote_begin = '`';
     table_quote_end = '`';
     insertBuffer = nil;
+    extraConnections = NULL;
+    extraConnectionCount = 0;
+    freeConnections = NULL;
+    freeConnectionCount = 0;
+    streamingConnections = NULL;
+    streamingConnectionCount = 0;
+    statementCaches = nil;
+    poolOpen = false;
+    poolMutex = Ref<Mutex>(new Mutex());
+    poolCond = Ref<Cond>(new Cond(poolMutex));
 }
 MysqlStorage::~MysqlStorage()
 {
     AUTOLOCK(mysqlMutex);    // just to ensure, that we don't close while another thread 
                     // is executing a query
     
+    closeConnections();
     if(mysql_connection)
     {
         mysql_close(&db);
@@ -141,43 +176,9 @@ void MysqlStorage::init()
     
     Ref<ConfigManager> config = ConfigManager::getInstance();
     
-    String dbHost = config->getOption(CFG_SERVER_STORAGE_MYSQL_HOST);
-    String dbName = config->getOption(CFG_SERVER_STORAGE_MYSQL_DATABASE);
-    String dbUser = config->getOption(CFG_SERVER_STORAGE_MYSQL_USERNAME);
-    int dbPort = config->getIntOption(CFG_SERVER_STORAGE_MYSQL_PORT);
-    String dbPass = config->getOption(CFG_SERVER_STORAGE_MYSQL_PASSWORD);
-    String dbSock = config->getOption(CFG_SERVER_STORAGE_MYSQL_SOCKET);
-    
-    MYSQL *res_mysql;
-    
-    res_mysql = mysql_init(&db);
-    if(! res_mysql)
-    {
-        throw _Exception(_("mysql_init failed"));
-    }
-    
     mysql_init_key_initialized = true;
     
-    mysql_options(&db, MYSQL_SET_CHARSET_NAME, "utf8");
-    
-    #ifdef HAVE_MYSQL_OPT_RECONNECT
-        my_bool my_bool_var = true;
-        mysql_options(&db, MYSQL_OPT_RECONNECT, &my_bool_var);
-    #endif
-    
-    res_mysql = mysql_real_connect(&db,
-        dbHost.c_str(),
-        dbUser.c_str(),
-        (dbPass == nil ? NULL : dbPass.c_str()),
-        dbName.c_str(),
-        dbPort, // port
-        (dbSock == nil ? NULL : dbSock.c_str()), // socket
-        0 // flags
-    );
-    if(! res_mysql)
-    {
-        throw _Exception(_("The connection to the MySQL database has failed: ") + getError(&db));
-    }
+    connect(&db);
     
     /*
     int res = mysql_real_query(&db, MYSQL_SET_NAMES, strlen(MYSQL_SET_NAMES));
@@ -251,12 +252,12 @@ void MysqlStorage::init()
     if (dbVersion == "1")
     {
         log_info("Doing an automatic database upgrade from database version 1 to version 2...\n");
-        _exec(MYSQL_UPDATE_1_2_1);
-        _exec(MYSQL_UPDATE_1_2_2);
-        _exec(MYSQL_UPDATE_1_2_3);
-        _exec(MYSQL_UPDATE_1_2_4);
-        _exec(MYSQL_UPDATE_1_2_5);
-        _exec(MYSQL_UPDATE_1_2_6);
+        _exec(&db, MYSQL_UPDATE_1_2_1);
+        _exec(&db, MYSQL_UPDATE_1_2_2);
+        _exec(&db, MYSQL_UPDATE_1_2_3);
+        _exec(&db, MYSQL_UPDATE_1_2_4);
+        _exec(&db, MYSQL_UPDATE_1_2_5);
+        _exec(&db, MYSQL_UPDATE_1_2_6);
         log_info("database upgrade successful.\n");
         dbVersion = _("2");
     }
@@ -264,10 +265,10 @@ void MysqlStorage::init()
     if (dbVersion == "2")
     {
         log_info("Doing an automatic database upgrade from database version 2 to version 3...\n");
-        _exec(MYSQL_UPDATE_2_3_1);
-        _exec(MYSQL_UPDATE_2_3_2);
-        _exec(MYSQL_UPDATE_2_3_3);
-        _exec(MYSQL_UPDATE_2_3_4);
+        _exec(&db, MYSQL_UPDATE_2_3_1);
+        _exec(&db, MYSQL_UPDATE_2_3_2);
+        _exec(&db, MYSQL_UPDATE_2_3_3);
+        _exec(&db, MYSQL_UPDATE_2_3_4);
         log_info("database upgrade successful.\n");
         dbVersion = _("3");
     }
@@ -275,18 +276,60 @@ void MysqlStorage::init()
     if (dbVersion == "3")
     {
         log_info("Doing an automatic database upgrade from database version 3 to version 4...\n");
-        _exec(MYSQL_UPDATE_3_4_1);
-        _exec(MYSQL_UPDATE_3_4_2);
-        _exec(MYSQL_UPDATE_3_4_3);
+        _exec(&db, MYSQL_UPDATE_3_4_1);
+        _exec(&db, MYSQL_UPDATE_3_4_2);
+        _exec(&db, MYSQL_UPDATE_3_4_3);
         log_info("database upgrade successful.\n");
         dbVersion = _("4");
     }
     
+    if (dbVersion == "4")
+    {
+        log_info("Doing an automatic database upgrade from database version 4 to version 5...\n");
+        _exec(&db, MYSQL_UPDATE_4_5_1);
+        _exec(&db, MYSQL_UPDATE_4_5_2);
+        _exec(&db, MYSQL_UPDATE_4_5_3);
+        log_info("database upgrade successful.\n");
+        dbVersion = _("5");
+    }
+    
+    if (dbVersion == "5")
+    {
+        log_info("Doing an automatic database upgrade from database version 5 to version 6...\n");
+        _exec(&db, MYSQL_UPDATE_5_6_1);
+        _exec(&db, MYSQL_UPDATE_5_6_2);
+        _exec(&db, MYSQL_UPDATE_5_6_3);
+        log_info("database upgrade successful.\n");
+        dbVersion = _("6");
+    }
+    
+    if (dbVersion == "6")
+    {
+        log_info("Doing an automatic database upgrade from database version 6 to version 7...\n");
+        _exec(&db, MYSQL_UPDATE_6_7_1);
+        _exec(&db, MYSQL_UPDATE_6_7_2);
+        _exec(&db, MYSQL_UPDATE_6_7_3);
+        _exec(&db, MYSQL_UPDATE_6_7_4);
+        log_info("database upgrade successful.\n");
+        dbVersion = _("7");
+    }
+    
+    if (dbVersion == "7")
+    {
+        log_info("Doing an automatic database upgrade from database version 7 to version 8...\n");
+        _exec(&db, MYSQL_UPDATE_7_8_1);
+        _exec(&db, MYSQL_UPDATE_7_8_2);
+        log_info("database upgrade successful.\n");
+        dbVersion = _("8");
+    }
+    
     /* --- --- ---*/
     
-    if (! string_ok(dbVersion) || dbVersion != "4")
+    if (! string_ok(dbVersion) || dbVersion != "8")
         throw _Exception(_("The database seems to be from a newer version (database version ") + dbVersion + ")!");
     
+    openConnections(config->getIntOption(CFG_SERVER_STORAGE_MYSQL_CONNECTIONS));
+    
     AUTOUNLOCK();
     
     log_debug("end\n");
@@ -294,6 +337,145 @@ void MysqlStorage::init()
     dbReady();
 }
 
+void MysqlStorage::connect(MYSQL *conn)
+{
+    Ref<ConfigManager> config = ConfigManager::getInstance();
+    
+    String dbHost = config->getOption(CFG_SERVER_STORAGE_MYSQL_HOST);
+    String dbName = config->getOption(CFG_SERVER_STORAGE_MYSQL_DATABASE);
+    String dbUser = config->getOption(CFG_SERVER_STORAGE_MYSQL_USERNAME);
+    int dbPort = config->getIntOption(CFG_SERVER_STORAGE_MYSQL_PORT);
+    String dbPass = config->getOption(CFG_SERVER_STORAGE_MYSQL_PASSWORD);
+    String dbSock = config->getOption(CFG_SERVER_STORAGE_MYSQL_SOCKET);
+    
+    MYSQL *res_mysql;
+    
+    res_mysql = mysql_init(conn);
+    if(! res_mysql)
+    {
+        throw _Exception(_("mysql_init failed"));
+    }
+    
+    mysql_options(conn, MYSQL_SET_CHARSET_NAME, "utf8");
+    
+    #ifdef HAVE_MYSQL_OPT_RECONNECT
+        my_bool my_bool_var = true;
+        mysql_options(conn, MYSQL_OPT_RECONNECT, &my_bool_var);
+    #endif
+    
+    res_mysql = mysql_real_connect(conn,
+        dbHost.c_str(),
+        dbUser.c_str(),
+        (dbPass == nil ? NULL : dbPass.c_str()),
+        dbName.c_str(),
+        dbPort, // port
+        (dbSock == nil ? NULL : dbSock.c_str()), // socket
+        0 // flags
+    );
+    if(! res_mysql)
+    {
+        String myError = getError(conn);
+        mysql_close(conn);
+        throw _Exception(_("The connection to the MySQL database has failed: ") + myError);
+    }
+}
+
+void MysqlStorage::openConnections(int count)
+{
+    // the config manager rejects smaller values already
+    if (count < 1)
+        count = 1;
+    AUTOLOCK(poolMutex);
+    freeConnections = (MYSQL **)MALLOC(count * sizeof(MYSQL *));
+    streamingConnections = (bool *)MALLOC(count * sizeof(bool));
+    memset(streamingConnections, 0, count * sizeof(bool));
+    extraConnections = new MYSQL[count - 1];
+    statementCaches = Ref<Array<MysqlStatementCache> >(new Array<MysqlStatementCache>(count));
+    statementCaches->append(Ref<MysqlStatementCache>(new MysqlStatementCache()));
+    freeConnections[freeConnectionCount++] = &db;
+    for (int i = 0; i < count - 1; i++)
+    {
+        try
+        {
+            connect(&extraConnections[i]);
+        }
+        catch (Exception e)
+        {
+            log_warning("could only open %d of %d mysql connections: %s\n",
+                freeConnectionCount, count, e.getMessage().c_str());
+            break;
+        }
+        extraConnectionCount++;
+        statementCaches->append(Ref<MysqlStatementCache>(new MysqlStatementCache()));
+        freeConnections[freeConnectionCount++] = &extraConnections[i];
+    }
+    poolOpen = true;
+    log_debug("opened %d mysql connections\n", freeConnectionCount);
+}
+
+void MysqlStorage::closeConnections()
+{
+    AUTOLOCK(poolMutex);
+    if (! poolOpen)
+        return;
+    // wait for the queries and streaming results that are still running
+    while (freeConnectionCount < extraConnectionCount + 1)
+        poolCond->wait();
+    poolOpen = false;
+    // the statements have to be closed before their connections
+    for (int i = 0; i < statementCaches->size(); i++)
+        statementCaches->get(i)->clear();
+    statementCaches = nil;
+    for (int i = 0; i < extraConnectionCount; i++)
+        mysql_close(&extraConnections[i]);
+    delete [] extraConnections;
+    extraConnections = NULL;
+    extraConnectionCount = 0;
+    FREE(freeConnections);
+    freeConnections = NULL;
+    freeConnectionCount = 0;
+    FREE(streamingConnections);
+    streamingConnections = NULL;
+    streamingConnectionCount = 0;
+}
+
+MYSQL *MysqlStorage::checkoutConnection(bool streaming)
+{
+    AUTOLOCK(poolMutex);
+    // init() runs the first queries before the pool is opened
+    if (! poolOpen)
+        return &db;
+    // streaming results leave one connection to the queries that are run
+    // while their rows are read; those don't hold a connection while they
+    // wait for another one, so the last connection always comes back
+    while (freeConnectionCount == 0 ||
+           (streaming && streamingConnectionCount >= extraConnectionCount))
+        poolCond->wait();
+    MYSQL *conn = freeConnections[--freeConnectionCount];
+    if (streaming)
+    {
+        streamingConnections[connectionIndex(conn)] = true;
+        streamingConnectionCount++;
+    }
+    return conn;
+}
+
+void MysqlStorage::checkinConnection(MYSQL *conn)
+{
+    AUTOLOCK(poolMutex);
+    if (! poolOpen)
+        return;
+    int index = connectionIndex(conn);
+    if (streamingConnections[index])
+    {
+        streamingConnections[index] = false;
+        streamingConnectionCount--;
+    }
+    freeConnections[freeConnectionCount++] = conn;
+    // streaming and plain queries wait for different conditions
+    poolCond->broadcast();
+}
+
 String MysqlStorage::quote(String value)
 {
     /* note: mysql_real_escape_string returns a maximum of (length * 2 + 1)
@@ -303,6 +485,8 @@ String MysqlStorage::quote(String value)
      */
     char *q = (char *)MALLOC(value.length() * 2 + 2);
     *q = '\'';
+    // only the character set of the connection is used here, so it doesn't
+    // matter if another thread is running a query on it
     long size = mysql_real_escape_string(&db, q + 1, value.c_str(), value.length());
     q[size + 1] = '\'';
     String ret(q, size + 2);
@@ -320,6 +504,16 @@ String MysqlStorage::getError(MYSQL *db)
 }
 
 Ref<SQLResult> MysqlStorage::select(const char *query, int length)
+{
+    return _select(query, length, false);
+}
+
+Ref<SQLResult> MysqlStorage::selectStreaming(const char *query, int length)
+{
+    return _select(query, length, true);
+}
+
+Ref<SQLResult> MysqlStorage::_select(const char *query, int length, bool streaming)
 {
 #ifdef MYSQL_SELECT_DEBUG
     log_debug("%s\n", query);
@@ -329,21 +523,34 @@ Ref<SQLResult> MysqlStorage::select(const char *query, int length)
     int res;
     
     checkMysqlThreadInit();
-    AUTOLOCK(mysqlMutex);
-    res = mysql_real_query(&db, query, length);
+    if (streaming && ! streamingPossible())
+        streaming = false;
+    MYSQL *conn = checkoutConnection(streaming);
+    res = mysql_real_query(conn, query, length);
     if (res)
     {
-        String myError = getError(&db);
+        String myError = getError(conn);
+        checkinConnection(conn);
         throw _StorageException(myError, _("Mysql: mysql_real_query() failed: ") + myError + "; query: " + query);
     }
     
     MYSQL_RES *mysql_res;
-    mysql_res = mysql_store_result(&db);
+    if (streaming)
+        mysql_res = mysql_use_result(conn);
+    else
+        mysql_res = mysql_store_result(conn);
     if(! mysql_res)
     {
-        String myError = getError(&db);
+        String myError = getError(conn);
+        checkinConnection(conn);
         throw _StorageException(myError, _("Mysql: mysql_store_result() failed: ") + myError + "; query: " + query);
     }
+    
+    // a streaming result returns the connection when it is read or freed
+    if (streaming)
+        return Ref<SQLResult> (new MysqlResult(mysql_res, this, conn));
+    
+    checkinConnection(conn);
     return Ref<SQLResult> (new MysqlResult(mysql_res));
 }
 
@@ -357,19 +564,151 @@ int MysqlStorage::exec(const char *query, int length, bool getLastInsertId)
     int res;
     
     checkMysqlThreadInit();
-    AUTOLOCK(mysqlMutex);
-    res = mysql_real_query(&db, query, length);
+    MYSQL *conn = checkoutConnection();
+    res = mysql_real_query(conn, query, length);
     if(res)
     {
-        String myError = getError(&db);
+        String myError = getError(conn);
+        checkinConnection(conn);
         throw _StorageException(myError, _("Mysql: mysql_real_query() failed: ") + myError + "; query: " + query);
     }
     int insert_id=-1;
-    if (getLastInsertId) insert_id = mysql_insert_id(&db);
+    if (getLastInsertId) insert_id = mysql_insert_id(conn);
+    checkinConnection(conn);
     return insert_id;
     
 }
 
+Ref<SQLResult> MysqlStorage::selectPrepared(const char *query, Ref<SQLParams> params, bool streaming)
+{
+#ifdef MYSQL_SELECT_DEBUG
+    log_debug("%s\n", query);
+    print_backtrace();
+#endif
+    
+    checkMysqlThreadInit();
+    if (streaming && ! streamingPossible())
+        streaming = false;
+    MYSQL *conn = checkoutConnection(streaming);
+    // init() runs before the pool and the statement caches exist
+    if (statementCaches == nil)
+    {
+        checkinConnection(conn);
+        return SQLStorage::selectPrepared(query, params, streaming);
+    }
+    
+    Ref<SQLResult> res;
+    try
+    {
+        MYSQL_STMT *stmt = _executePrepared(conn, query, params);
+        MysqlStmtResult *stmtRes = new MysqlStmtResult(stmt, this, conn);
+        res = Ref<SQLResult>(stmtRes);
+        stmtRes->init();
+        // a streaming result returns the connection when it is read or freed
+        if (! streaming)
+            stmtRes->fetchAll();
+    }
+    catch (...)
+    {
+        // the result returns the connection itself once it exists
+        if (res == nil)
+            checkinConnection(conn);
+        throw;
+    }
+    return res;
+}
+
+int MysqlStorage::execPrepared(const char *query, Ref<SQLParams> params, bool getLastInsertId)
+{
+#ifdef MYSQL_EXEC_DEBUG
+    log_debug("%s\n", query);
+    print_backtrace();
+#endif
+    
+    checkMysqlThreadInit();
+    MYSQL *conn = checkoutConnection();
+    if (statementCaches == nil)
+    {
+        checkinConnection(conn);
+        return SQLStorage::execPrepared(query, params, getLastInsertId);
+    }
+    
+    int insert_id = -1;
+    try
+    {
+        MYSQL_STMT *stmt = _executePrepared(conn, query, params);
+        if (getLastInsertId)
+            insert_id = mysql_stmt_insert_id(stmt);
+    }
+    catch (...)
+    {
+        checkinConnection(conn);
+        throw;
+    }
+    checkinConnection(conn);
+    return insert_id;
+}
+
+MYSQL_STMT *MysqlStorage::_executePrepared(MYSQL *conn, const char *query, Ref<SQLParams> params)
+{
+    Ref<MysqlStatementCache> cache = statementCaches->get(connectionIndex(conn));
+    MYSQL_STMT *stmt = cache->get(conn, query, this);
+    
+    int count = params->size();
+    MYSQL_BIND *binds = NULL;
+    long long *values = NULL;
+    if (count > 0)
+    {
+        binds = (MYSQL_BIND *)MALLOC(count * sizeof(MYSQL_BIND));
+        values = (long long *)MALLOC(count * sizeof(long long));
+        memset(binds, 0, count * sizeof(MYSQL_BIND));
+        for (int i = 0; i < count; i++)
+        {
+            switch (params->getType(i))
+            {
+                case SQL_PARAM_INT:
+                    values[i] = params->getInt(i);
+                    binds[i].buffer_type = MYSQL_TYPE_LONGLONG;
+                    binds[i].buffer = &values[i];
+                    break;
+                case SQL_PARAM_UINT:
+                    values[i] = params->getUInt(i);
+                    binds[i].buffer_type = MYSQL_TYPE_LONGLONG;
+                    binds[i].buffer = &values[i];
+                    break;
+                case SQL_PARAM_STRING:
+                {
+                    String val = params->getString(i);
+                    binds[i].buffer_type = MYSQL_TYPE_STRING;
+                    binds[i].buffer = val.c_str();
+                    binds[i].buffer_length = val.length();
+                    break;
+                }
+                default:
+                    binds[i].buffer_type = MYSQL_TYPE_NULL;
+            }
+        }
+    }
+    
+    bool ok = (count == 0 || ! mysql_stmt_bind_param(stmt, binds));
+    if (ok)
+        ok = (mysql_stmt_execute(stmt) == 0);
+    if (binds != NULL)
+    {
+        FREE(binds);
+        FREE(values);
+    }
+    if (! ok)
+    {
+        String myError = _("mysql_stmt_error (") + (int)mysql_stmt_errno(stmt) + "): \"" + mysql_stmt_error(stmt) + "\"";
+        // the statement may be invalid after a reconnect, it is prepared
+        // again next time
+        cache->remove(query);
+        throw _StorageException(myError, _("Mysql: mysql_stmt_execute() failed: ") + myError + "; query: " + query);
+    }
+    return stmt;
+}
+
 void MysqlStorage::shutdownDriver()
 {
 }
@@ -384,11 +723,11 @@ void MysqlStorage::storeInternalSetting(String key, String value)
     SQLStorage::exec(q);
 }
 
-void MysqlStorage::_exec(const char *query, int length)
+void MysqlStorage::_exec(MYSQL *conn, const char *query, int length)
 {
-    if (mysql_real_query(&db, query, (length > 0 ? length : strlen(query))))
+    if (mysql_real_query(conn, query, (length > 0 ? length : strlen(query))))
     {
-        String myError = getError(&db);
+        String myError = getError(conn);
         throw _StorageException(myError, _("Mysql: error while updating db: ") + myError);
     }
 }
@@ -411,22 +750,243 @@ void MysqlStorage::_flushInsertBuffer()
     insertBuffer->append(_("COMMIT"));
     
     checkMysqlThreadInit();
-    AUTOLOCK(mysqlMutex);
-    for (int i=0; i < insertBuffer->size(); i++)
+    // the whole transaction has to run on the same connection
+    MYSQL *conn = checkoutConnection();
+    try
+    {
+        for (int i=0; i < insertBuffer->size(); i++)
+        {
+            _exec(conn, insertBuffer->get(i)->data, insertBuffer->get(i)->len);
+        }
+    }
+    catch (...)
     {
-        _exec(insertBuffer->get(i)->data, insertBuffer->get(i)->len);
+        checkinConnection(conn);
+        throw;
     }
-    AUTOUNLOCK();
+    checkinConnection(conn);
     insertBuffer->clear();
     insertBuffer->append(_("BEGIN"));
 }
 
 
+/* MysqlStatementCache */
+
+MysqlStatementCache::MysqlStatementCache() : Object()
+{
+    statements = Ref<DSOHash<MysqlStatement> >(new DSOHash<MysqlStatement>(MYSQL_STATEMENT_HASH_CAPACITY));
+}
+
+MYSQL_STMT *MysqlStatementCache::get(MYSQL *conn, const char *query, MysqlStorage *storage)
+{
+    String key(query);
+    Ref<MysqlStatement> statement = statements->get(key);
+    if (statement != nil)
+        return statement->stmt;
+    
+    MYSQL_STMT *stmt = mysql_stmt_init(conn);
+    if (stmt == NULL)
+    {
+        String myError = storage->getError(conn);
+        throw _StorageException(myError, _("Mysql: mysql_stmt_init() failed: ") + myError);
+    }
+    if (mysql_stmt_prepare(stmt, query, strlen(query)))
+    {
+        String myError = _("mysql_stmt_error (") + (int)mysql_stmt_errno(stmt) + "): \"" + mysql_stmt_error(stmt) + "\"";
+        mysql_stmt_close(stmt);
+        throw _StorageException(myError, _("Mysql: mysql_stmt_prepare() failed: ") + myError + "; query: " + query);
+    }
+    
+    if (statements->size() >= MYSQL_MAX_STATEMENTS)
+    {
+        log_debug("mysql statement cache full, clearing it\n");
+        statements->clear();
+    }
+    statements->put(key, Ref<MysqlStatement>(new MysqlStatement(stmt)));
+    return stmt;
+}
+
+void MysqlStatementCache::remove(const char *query)
+{
+    statements->remove(String(query));
+}
+
+void MysqlStatementCache::clear()
+{
+    statements->clear();
+}
+
+/* MysqlStmtResult */
+
+MysqlStmtResult::MysqlStmtResult(MYSQL_STMT *stmt, MysqlStorage *storage, MYSQL *conn) : SQLResult()
+{
+    this->stmt = stmt;
+    this->storage = storage;
+    this->conn = conn;
+    ncolumn = 0;
+    binds = NULL;
+    lengths = NULL;
+    nulls = NULL;
+    rows = nil;
+    curRow = 0;
+    row = NULL;
+    numRows = 0;
+}
+
+MysqlStmtResult::~MysqlStmtResult()
+{
+    finish();
+    if (rows != nil)
+    {
+        for (int i = 0; i < rows->size(); i++)
+            freeRow(rows->get(i));
+    }
+    if (row != NULL)
+        freeRow(row);
+    if (binds != NULL)
+    {
+        FREE(binds);
+        FREE(lengths);
+        FREE(nulls);
+    }
+}
+
+void MysqlStmtResult::init()
+{
+    MYSQL_RES *meta = mysql_stmt_result_metadata(stmt);
+    if (meta == NULL)
+        throw _StorageException(nil, _("Mysql: prepared statement did not return a result set"));
+    ncolumn = mysql_num_fields(meta);
+    mysql_free_result(meta);
+    
+    // the columns are bound without buffers, fetchRow() gets every value
+    // with mysql_stmt_fetch_column() once its length is known
+    binds = (MYSQL_BIND *)MALLOC(ncolumn * sizeof(MYSQL_BIND));
+    lengths = (unsigned long *)MALLOC(ncolumn * sizeof(unsigned long));
+    nulls = (my_bool *)MALLOC(ncolumn * sizeof(my_bool));
+    memset(binds, 0, ncolumn * sizeof(MYSQL_BIND));
+    for (int i = 0; i < ncolumn; i++)
+    {
+        binds[i].buffer_type = MYSQL_TYPE_STRING;
+        binds[i].length = &lengths[i];
+        binds[i].is_null = &nulls[i];
+    }
+    if (mysql_stmt_bind_result(stmt, binds))
+    {
+        String myError = _("mysql_stmt_error (") + (int)mysql_stmt_errno(stmt) + "): \"" + mysql_stmt_error(stmt) + "\"";
+        throw _StorageException(myError, _("Mysql: mysql_stmt_bind_result() failed: ") + myError);
+    }
+}
+
+void MysqlStmtResult::fetchAll()
+{
+    rows = Ref<BaseArray<char **> >(new BaseArray<char **>());
+    char **r;
+    while ((r = fetchRow()) != NULL)
+        rows->append(r);
+    numRows = rows->size();
+    finish();
+}
+
+char **MysqlStmtResult::fetchRow()
+{
+    int ret = mysql_stmt_fetch(stmt);
+    if (ret == MYSQL_NO_DATA)
+        return NULL;
+    if (ret != 0 && ret != MYSQL_DATA_TRUNCATED)
+    {
+        String myError = _("mysql_stmt_error (") + (int)mysql_stmt_errno(stmt) + "): \"" + mysql_stmt_error(stmt) + "\"";
+        throw _StorageException(myError, _("Mysql: mysql_stmt_fetch() failed: ") + myError);
+    }
+    
+    char **r = (char **)MALLOC(ncolumn * sizeof(char *));
+    for (int i = 0; i < ncolumn; i++)
+    {
+        if (nulls[i])
+        {
+            r[i] = NULL;
+            continue;
+        }
+        r[i] = (char *)MALLOC(lengths[i] + 1);
+        if (lengths[i] > 0)
+        {
+            MYSQL_BIND bind;
+            memset(&bind, 0, sizeof(MYSQL_BIND));
+            bind.buffer_type = MYSQL_TYPE_STRING;
+            bind.buffer = r[i];
+            bind.buffer_length = lengths[i];
+            if (mysql_stmt_fetch_column(stmt, &bind, i, 0))
+            {
+                for (int j = i + 1; j < ncolumn; j++)
+                    r[j] = NULL;
+                freeRow(r);
+                throw _StorageException(nil, _("Mysql: mysql_stmt_fetch_column() failed"));
+            }
+        }
+        r[i][lengths[i]] = '\0';
+    }
+    return r;
+}
+
+void MysqlStmtResult::freeRow(char **r)
+{
+    for (int i = 0; i < ncolumn; i++)
+    {
+        if (r[i] != NULL)
+            FREE(r[i]);
+    }
+    FREE(r);
+}
+
+void MysqlStmtResult::finish()
+{
+    if (conn == NULL)
+        return;
+    // read out the rest, the connection can't be used before
+    int ret;
+    do
+    {
+        ret = mysql_stmt_fetch(stmt);
+    }
+    while (ret == 0 || ret == MYSQL_DATA_TRUNCATED);
+    mysql_stmt_free_result(stmt);
+    storage->checkinConnection(conn);
+    conn = NULL;
+}
+
+Ref<SQLRow> MysqlStmtResult::nextRow()
+{
+    if (rows != nil)
+    {
+        if (curRow >= rows->size())
+            return nil;
+        return Ref<SQLRow>(new MysqlStmtRow(rows->get(curRow++), Ref<SQLResult>(this)));
+    }
+    
+    if (row != NULL)
+    {
+        freeRow(row);
+        row = NULL;
+    }
+    if (conn == NULL)
+        return nil;
+    row = fetchRow();
+    if (row == NULL)
+    {
+        finish();
+        return nil;
+    }
+    numRows++;
+    return Ref<SQLRow>(new MysqlStmtRow(row, Ref<SQLResult>(this)));
+}
+
 /* MysqlResult */
 
-MysqlResult::MysqlResult(MYSQL_RES *mysql_res) : SQLResult()
+MysqlResult::MysqlResult(MYSQL_RES *mysql_res, MysqlStorage *storage, MYSQL *conn) : SQLResult()
 {
     this->mysql_res = mysql_res;
+    this->storage = storage;
+    this->conn = conn;
     nullRead = false;
 }
 
@@ -442,10 +1002,21 @@ MysqlResult::~MysqlResult()
         mysql_free_result(mysql_res);
         mysql_res = NULL;
     }
+    releaseConnection();
+}
+
+void MysqlResult::releaseConnection()
+{
+    if (conn == NULL)
+        return;
+    storage->checkinConnection(conn);
+    conn = NULL;
 }
 
 Ref<SQLRow> MysqlResult::nextRow()
 {   
+    if (mysql_res == NULL)
+        return nil;
     MYSQL_ROW mysql_row;
     mysql_row = mysql_fetch_row(mysql_res);
     if(mysql_row)
@@ -453,8 +1024,14 @@ Ref<SQLRow> MysqlResult::nextRow()
         return Ref<SQLRow>(new MysqlRow(mysql_row, Ref<SQLResult>(this)));
     }
     nullRead = true;
+    String myError = nil;
+    if (conn != NULL && mysql_errno(conn))
+        myError = storage->getError(conn);
     mysql_free_result(mysql_res);
     mysql_res = NULL;
+    releaseConnection();
+    if (myError != nil)
+        throw _StorageException(myError, _("Mysql: mysql_fetch_row() failed: ") + myError);
     return nil;
 }
 
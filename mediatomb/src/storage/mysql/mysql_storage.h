@@ -39,6 +39,44 @@
 #include "sync.h"
 #include <mysql.h>
 
+// MySQL 8 dropped the my_bool type
+#if MYSQL_VERSION_ID >= 80000 && ! defined(MARIADB_BASE_VERSION)
+typedef bool my_bool;
+#endif
+
+class MysqlStorage;
+
+/// \brief A prepared mysql statement, closed when it is released.
+class MysqlStatement : public zmm::Object
+{
+public:
+    MysqlStatement(MYSQL_STMT *stmt) : Object() { this->stmt = stmt; }
+    virtual ~MysqlStatement() { mysql_stmt_close(stmt); }
+    MYSQL_STMT *stmt;
+};
+
+/// \brief The prepared statements of one mysql connection, by query.
+///
+/// A cache may only be used while its connection is checked out.
+class MysqlStatementCache : public zmm::Object
+{
+public:
+    MysqlStatementCache();
+    
+    /// \brief returns the prepared statement for the query, the statement
+    /// is prepared if it is not in the cache yet
+    MYSQL_STMT *get(MYSQL *conn, const char *query, MysqlStorage *storage);
+    
+    /// \brief closes the statement of the query, used after errors
+    void remove(const char *query);
+    
+    /// \brief closes all statements; has to be called before the
+    /// connection is closed
+    void clear();
+protected:
+    zmm::Ref<DSOHash<MysqlStatement> > statements;
+};
+
 class MysqlStorage : private SQLStorage
 {
 private:
@@ -56,11 +94,20 @@ private:
     virtual inline zmm::String quote(bool val) { return zmm::String(val ? '1' : '0'); }
     virtual inline zmm::String quote(char val) { return quote(zmm::String(val)); }
     virtual zmm::Ref<SQLResult> select(const char *query, int length);
+    virtual zmm::Ref<SQLResult> selectStreaming(const char *query, int length);
     virtual int exec(const char *query, int length, bool getLastInsertId = false);
+    virtual zmm::Ref<SQLResult> selectPrepared(const char *query, zmm::Ref<SQLParams> params, bool streaming = false);
+    virtual int execPrepared(const char *query, zmm::Ref<SQLParams> params, bool getLastInsertId = false);
     virtual void storeInternalSetting(zmm::String key, zmm::String value);
     
-    void _exec(const char *query, int lenth = -1);
+    zmm::Ref<SQLResult> _select(const char *query, int length, bool streaming);
     
+    /// \brief prepares (or takes from the cache), binds and executes a
+    /// statement on the given connection
+    MYSQL_STMT *_executePrepared(MYSQL *conn, const char *query, zmm::Ref<SQLParams> params);
+    void _exec(MYSQL *conn, const char *query, int lenth = -1);
+    
+    /// \brief the first connection; used by init() and for quoting
     MYSQL db;
     
     bool mysql_connection;
@@ -69,6 +116,40 @@ private:
     
     zmm::Ref<Mutex> mysqlMutex;
     
+    /* connection pool; every query checks out a connection and returns it
+     * when it is done, streaming results keep it until they are read. At
+     * most all but one connection are held by streaming results, so the
+     * queries run while their rows are read get a connection of their own;
+     * with a single connection the results are not streamed. */
+    void connect(MYSQL *conn);
+    void openConnections(int count);
+    void closeConnections();
+    MYSQL *checkoutConnection(bool streaming = false);
+    void checkinConnection(MYSQL *conn);
+    inline bool streamingPossible() { return extraConnectionCount > 0; }
+    
+    /// \brief the connections that are opened in addition to db
+    MYSQL *extraConnections;
+    int extraConnectionCount;
+    
+    /// \brief stack of the connections that are not in use
+    MYSQL **freeConnections;
+    int freeConnectionCount;
+    
+    /// \brief the connections held by streaming results, by connection index
+    bool *streamingConnections;
+    int streamingConnectionCount;
+    
+    /// \brief the prepared statements of every connection, by connection
+    /// index; nil until the pool is opened
+    zmm::Ref<zmm::Array<MysqlStatementCache> > statementCaches;
+    inline int connectionIndex(MYSQL *conn)
+        { return (conn == &db ? 0 : (int)(conn - extraConnections) + 1); }
+    
+    bool poolOpen;
+    zmm::Ref<Mutex> poolMutex;
+    zmm::Ref<Cond> poolCond;
+    
     virtual void threadCleanup();
     virtual bool threadCleanupRequired() { return true; }
     
@@ -80,22 +161,92 @@ private:
     zmm::Ref<zmm::Array<zmm::StringBase> > insertBuffer;
     virtual void _addToInsertBuffer(zmm::Ref<zmm::StringBuffer> query);
     virtual void _flushInsertBuffer();
+    
+    friend class MysqlResult;
+    friend class MysqlStmtResult;
+    friend class MysqlStatementCache;
 };
 
 class MysqlResult : private SQLResult
 {
 private:
     int nullRead;
-    MysqlResult(MYSQL_RES *mysql_res);
+    MysqlResult(MYSQL_RES *mysql_res, MysqlStorage *storage = NULL, MYSQL *conn = NULL);
     virtual ~MysqlResult();
     virtual zmm::Ref<SQLRow> nextRow();
     virtual unsigned long long getNumRows() { return mysql_num_rows(mysql_res); }
     MYSQL_RES *mysql_res;
     
+    /// \brief returns the connection of a streaming result to the pool
+    void releaseConnection();
+    
+    /* set for results of mysql_use_result(), which need the connection
+     * until all rows are fetched */
+    MysqlStorage *storage;
+    MYSQL *conn;
+    
     friend class MysqlRow;
     friend class MysqlStorage;
 };
 
+/// \brief The result of a prepared statement. Results that are not
+/// streaming are read completely when they are created; streaming results
+/// keep the connection until all rows are fetched.
+class MysqlStmtResult : private SQLResult
+{
+private:
+    MysqlStmtResult(MYSQL_STMT *stmt, MysqlStorage *storage, MYSQL *conn);
+    virtual ~MysqlStmtResult();
+    virtual zmm::Ref<SQLRow> nextRow();
+    virtual unsigned long long getNumRows() { return numRows; }
+    
+    /// \brief binds the result columns, has to be called before the rows
+    /// are fetched
+    void init();
+    
+    /// \brief reads all rows and returns the connection to the pool
+    void fetchAll();
+    
+    /// \brief fetches the next row of the statement
+    /// \return the row, NULL if there are no more rows
+    char **fetchRow();
+    void freeRow(char **row);
+    
+    /// \brief frees the statement result and returns the connection
+    void finish();
+    
+    MYSQL_STMT *stmt;
+    MysqlStorage *storage;
+    MYSQL *conn;
+    
+    int ncolumn;
+    MYSQL_BIND *binds;
+    unsigned long *lengths;
+    my_bool *nulls;
+    
+    /// \brief the rows of a result that was read by fetchAll()
+    zmm::Ref<zmm::BaseArray<char **> > rows;
+    int curRow;
+    
+    /// \brief the current row of a streaming result
+    char **row;
+    
+    unsigned long long numRows;
+    
+    friend class MysqlStorage;
+};
+
+class MysqlStmtRow : private SQLRow
+{
+private:
+    MysqlStmtRow(char **row, zmm::Ref<SQLResult> sqlResult) : SQLRow(sqlResult) { this->row = row; }
+    inline virtual char* col_c_str(int index) { return row[index]; }
+    
+    char **row;
+    
+    friend class MysqlStmtResult;
+};
+
 class MysqlRow : private SQLRow
 {
 private:
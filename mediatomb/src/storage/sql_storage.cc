@@ -40,15 +40,20 @@
 #include "string_converter.h"
 #include "config_manager.h"
 #include "filesystem.h"
+#include "metadata_handler.h"
 
 using namespace zmm;
 
 #define MAX_REMOVE_SIZE     10000
 #define MAX_REMOVE_RECURSION 500
 
-#define SQL_NULL             "NULL"
+/* number of objects that are added in one transaction during a bulk import */
+#define BULK_IMPORT_TRANSACTION_SIZE 2000
+/* number of update ids that may be held back during a bulk import */
+#define MAX_BULK_UPDATE_IDS 1000
+#define BULK_UPDATE_ID_HASH_CAPACITY 3109
 
-#define RESOURCE_SEP '|'
+#define SQL_NULL             "NULL"
 
 enum
 {
@@ -75,7 +80,38 @@ enum
     _ref_resources,
     _ref_mime_type,
     _ref_service_id,
-    _as_persistent
+    _as_persistent,
+    _child_containers,
+    _child_items
+};
+
+/* properties that browse() and search() can sort by */
+static const struct
+{
+    const char *property;
+    const char *column;
+} sortColumns[] =
+{
+    { "dc:title", "dc_title" },
+    { "dc:date", "dc_date" },
+    { "upnp:artist", "upnp_artist" },
+    { "upnp:album", "upnp_album" },
+    { "upnp:originalTrackNumber", "track_number" },
+    { "res@size", "res_size" },
+    { NULL, NULL }
+};
+
+/* sort columns that are copied from the metadata of an item */
+static const struct
+{
+    metadata_fields_t field;
+    const char *column;
+} sortMetadataColumns[] =
+{
+    { M_DATE, "dc_date" },
+    { M_ARTIST, "upnp_artist" },
+    { M_ALBUM, "upnp_album" },
+    { M_MAX, NULL }
 };
 
 /* table quote */
@@ -114,7 +150,9 @@ enum
     SEL_EQ_SP_RFQ_DT_BQ "resources" \
     SEL_EQ_SP_RFQ_DT_BQ "mime_type" \
     SEL_EQ_SP_RFQ_DT_BQ "service_id" << QTE \
-    << ',' << TQD("as","persistent")
+    << ',' << TQD("as","persistent") \
+    << ',' << TQD('f',"child_containers") \
+    << ',' << TQD('f',"child_items")
     
 #define SQL_QUERY_FOR_STRINGBUFFER "SELECT " << SELECT_DATA_FOR_STRINGBUFFER << \
     " FROM " << TQ(CDS_OBJECT_TABLE) << ' ' << TQ('f') << " LEFT JOIN " \
@@ -141,10 +179,34 @@ void SQLStorage::init()
     Ref<StringBuffer> buf(new StringBuffer());
     *buf << SQL_QUERY_FOR_STRINGBUFFER;
     this->sql_query = buf->toString();
+    
+    buf->clear();
+    *buf << sql_query << " WHERE " << TQD('f',"id") << "=?";
+    sql_load_object = buf->toString();
+    
+    buf->clear();
+    *buf << "SELECT " << TQ("object_type")
+        << " FROM " << TQ(CDS_OBJECT_TABLE)
+        << " WHERE " << TQ("id") << "=?";
+    sql_object_type = buf->toString();
+    
+    buf->clear();
+    *buf << "SELECT " << TQ("child_containers") << ',' << TQ("child_items")
+        << " FROM " << TQ(CDS_OBJECT_TABLE)
+        << " WHERE " << TQ("id") << "=?";
+    sql_child_count = buf->toString();
+    
+    buf->clear();
+    *buf << sql_query
+        << " WHERE " << TQD('f',"location_hash") << "=?"
+        << " AND " << TQD('f',"location") << "=?"
+        << " AND " << TQD('f',"ref_id") << " IS NULL "
+        "LIMIT 1";
+    sql_find_by_location = buf->toString();
    
     if (ConfigManager::getInstance()->getBoolOption(CFG_SERVER_STORAGE_CACHING_ENABLED))
     {
-        cache = Ref<StorageCache>(new StorageCache());
+        cache = Ref<StorageCache>(new StorageCache(ConfigManager::getInstance()->getIntOption(CFG_SERVER_STORAGE_CACHE_SIZE)));
         insertBufferOn = true;
     }
     else
@@ -153,11 +215,21 @@ void SQLStorage::init()
         insertBufferOn = false;
     }
     
+    containerIndex = Ref<VirtualContainerIndex>(new VirtualContainerIndex());
+    
     insertBufferEmpty = true;
     insertBufferMutex = Ref<Mutex>(new Mutex());
     insertBufferStatementCount = 0;
     insertBufferByteCount = 0;
     
+    bulkImportDepth = 0;
+    bulkImportObjectCount = 0;
+    bulkUpdateIDs = Ref<DBRHash<int> >(new DBRHash<int>(BULK_UPDATE_ID_HASH_CAPACITY, MAX_BULK_UPDATE_IDS + 1, INVALID_OBJECT_ID, INVALID_OBJECT_ID_2));
+    bulkImportMutex = Ref<Mutex>(new Mutex());
+    
+    childCountsDirty = false;
+    childCountMutex = Ref<Mutex>(new Mutex());
+    
     //log_debug("using SQL: %s\n", this->sql_query.c_str());
     
     //objectTitleCache = Ref<DSOHash<CdsObject> >(new DSOHash<CdsObject>(OBJECT_CACHE_CAPACITY));
@@ -186,11 +258,38 @@ void SQLStorage::dbReady()
 {
     nextIDMutex = Ref<Mutex>(new Mutex());;
     loadLastID();
+    if (getInternalSetting(_("child_count_check")) == "1")
+        _checkChildCounts();
+    if (getInternalSetting(_("metadata_rebuild")) == "1")
+        _fillMetadataTable();
+    if (getInternalSetting(_("sort_rebuild")) == "1")
+        _fillSortColumns();
+    if (getInternalSetting(_("pack_rebuild")) == "1")
+        _packObjectData();
 }
 
 void SQLStorage::shutdown()
 {
     flushInsertBuffer();
+    AUTOLOCK(bulkImportMutex);
+    if (bulkImportDepth > 0)
+    {
+        log_warning("bulk import still running on shutdown, committing it\n");
+        bulkImportDepth = 0;
+        _restartBulkTransaction(true, false);
+    }
+    AUTOUNLOCK();
+    // everything is written, the child counts don't need a check next time
+    AUTOLOCK_NO_DEFINE(childCountMutex);
+    if (childCountsDirty)
+    {
+        Ref<StringBuffer> qb(new StringBuffer());
+        *qb << "DELETE FROM " << TQ(INTERNAL_SETTINGS_TABLE)
+            << " WHERE " << TQ("key") << '=' << quote(_("child_count_check"));
+        exec(qb);
+        childCountsDirty = false;
+    }
+    AUTOUNLOCK();
     shutdownDriver();
 }
 
@@ -200,6 +299,51 @@ SQLStorage::~SQLStorage()
 }
 */
 
+Ref<SQLResult> SQLStorage::selectPrepared(const char *query, Ref<SQLParams> params, bool streaming)
+{
+    Ref<StringBuffer> qb = bindParams(query, params);
+    if (streaming)
+        return selectStreaming(qb);
+    return select(qb);
+}
+
+int SQLStorage::execPrepared(const char *query, Ref<SQLParams> params, bool getLastInsertId)
+{
+    return exec(bindParams(query, params), getLastInsertId);
+}
+
+Ref<StringBuffer> SQLStorage::bindParams(const char *query, Ref<SQLParams> params)
+{
+    Ref<StringBuffer> qb(new StringBuffer());
+    int index = 0;
+    const char *start = query;
+    const char *pos;
+    while ((pos = strchr(start, '?')) != NULL)
+    {
+        if (index >= params->size())
+            throw _Exception(_("not enough parameters for query: ") + query);
+        qb->concat((char *)start, pos - start);
+        switch (params->getType(index))
+        {
+            case SQL_PARAM_INT:
+                *qb << quote(params->getInt(index));
+                break;
+            case SQL_PARAM_UINT:
+                *qb << quote(params->getUInt(index));
+                break;
+            case SQL_PARAM_STRING:
+                *qb << quote(params->getString(index));
+                break;
+            default:
+                *qb << SQL_NULL;
+        }
+        index++;
+        start = pos + 1;
+    }
+    *qb << start;
+    return qb;
+}
+
 Ref<CdsObject> SQLStorage::checkRefID(Ref<CdsObject> obj)
 {
     if (! obj->isVirtual()) throw _Exception(_("checkRefID called for a non-virtual object"));
@@ -301,7 +445,7 @@ Ref<Array<SQLStorage::AddUpdateTable> > SQLStorage::_addUpdateObject(Ref<CdsObje
     {
         if (! hasReference || ! refObj->getMetadata()->equals(obj->getMetadata()))
         {
-            cdsObjectSql->put(_("metadata"), quote(dict->encode()));
+            cdsObjectSql->put(_("metadata"), quote(dict->pack()));
         }
     }
     
@@ -310,22 +454,13 @@ Ref<Array<SQLStorage::AddUpdateTable> > SQLStorage::_addUpdateObject(Ref<CdsObje
     dict = obj->getAuxData();
     if (dict->size() > 0 && (! hasReference || ! refObj->getAuxData()->equals(obj->getAuxData())))
     {
-        cdsObjectSql->put(_("auxdata"), quote(obj->getAuxData()->encode()));
+        cdsObjectSql->put(_("auxdata"), quote(obj->getAuxData()->pack()));
     }
     
     if (! hasReference || (! obj->getFlag(OBJECT_FLAG_USE_RESOURCE_REF) && ! refObj->resourcesEqual(obj)))
     {
-        // encode resources
-        Ref<StringBuffer> resBuf(new StringBuffer());
-        for (int i = 0; i < obj->getResourceCount(); i++)
-        {
-            if (i > 0)
-                *resBuf << RESOURCE_SEP;
-            *resBuf << obj->getResource(i)->encode();
-        }
-        String resStr = resBuf->toString();
-        if (string_ok(resStr))
-            cdsObjectSql->put(_("resources"), quote(resStr));
+        if (obj->getResourceCount() > 0)
+            cdsObjectSql->put(_("resources"), quote(obj->packResources()));
         else
             cdsObjectSql->put(_("resources"), _(SQL_NULL));
     }
@@ -389,6 +524,8 @@ Ref<Array<SQLStorage::AddUpdateTable> > SQLStorage::_addUpdateObject(Ref<CdsObje
                 cdsObjectSql->put(_("track_number"), _(SQL_NULL));
         }
         
+        _putSortColumns(item, cdsObjectSql, isUpdate);
+        
         if (string_ok(item->getServiceID()))
         {
             if (! hasReference || RefCast(refObj,CdsItem)->getServiceID() != item->getServiceID())
@@ -509,6 +646,21 @@ void SQLStorage::addObject(Ref<CdsObject> obj, int *changedContainer)
             addToInsertBuffer(qb);
     }
     
+    if (_storesMetadata(data))
+        _addMetadataRows(obj->getID(), obj->getMetadata(), true);
+    
+    _changeChildCount(obj->getParentID(), obj->getObjectType(), 1, true);
+    
+    /* start a new transaction from time to time during bulk imports */
+    AUTOLOCK(bulkImportMutex);
+    if (bulkImportDepth > 0 && ++bulkImportObjectCount >= BULK_IMPORT_TRANSACTION_SIZE)
+    {
+        log_debug("committing %d objects of bulk import\n", bulkImportObjectCount);
+        bulkImportObjectCount = 0;
+        _restartBulkTransaction(true, true);
+    }
+    AUTOUNLOCK();
+    
     /* add to cache */
     if (cacheOn())
     {
@@ -543,6 +695,20 @@ void SQLStorage::updateObject(zmm::Ref<CdsObject> obj, int *changedContainer)
         if (data == nil)
             return;
     }
+    
+    // keep the stored child counts in sync if the object is moved
+    int oldParentID = INVALID_OBJECT_ID;
+    if (obj->getID() != CDS_ID_FS_ROOT)
+    {
+        Ref<StringBuffer> qb(new StringBuffer());
+        *qb << "SELECT " << TQ("parent_id") << " FROM " << TQ(CDS_OBJECT_TABLE)
+            << " WHERE " << TQ("id") << '=' << obj->getID();
+        Ref<SQLResult> res = select(qb);
+        Ref<SQLRow> row;
+        if (res != nil && (row = res->nextRow()) != nil)
+            oldParentID = row->col(0).toInt();
+    }
+    
     for (int i = 0; i < data->size(); i++)
     {
         Ref<AddUpdateTable> addUpdateTable = data->get(i);
@@ -569,6 +735,31 @@ void SQLStorage::updateObject(zmm::Ref<CdsObject> obj, int *changedContainer)
         
         exec(qb);
     }
+    
+    if (obj->getID() != CDS_ID_FS_ROOT)
+    {
+        Ref<StringBuffer> qb(new StringBuffer());
+        *qb << "DELETE FROM " << TQ(METADATA_TABLE)
+            << " WHERE " << TQ("item_id") << '=' << obj->getID();
+        exec(qb);
+        if (_storesMetadata(data))
+            _addMetadataRows(obj->getID(), obj->getMetadata(), false);
+    }
+    
+    if (oldParentID != INVALID_OBJECT_ID && oldParentID != obj->getParentID())
+    {
+        _changeChildCount(oldParentID, obj->getObjectType(), -1);
+        _changeChildCount(obj->getParentID(), obj->getObjectType(), 1);
+    }
+    
+    /* the location of a virtual container may have changed */
+    if (IS_CDS_CONTAINER(obj->getObjectType()) && obj->isVirtual())
+    {
+        AUTOLOCK(containerIndex->getMutex());
+        if (containerIndex->isLoaded())
+            containerIndex->add(obj->getID(), addLocationPrefix(LOC_VIRT_PREFIX, obj->getLocation()));
+    }
+    
     /* add to cache */
     addObjectToCache(obj);
     /* ------------ */
@@ -596,13 +787,9 @@ Ref<CdsObject> SQLStorage::loadObject(int objectID)
         return obj;
     throw _Exception(_("Object not found: ") + objectID);
 */
-    Ref<StringBuffer> qb(new StringBuffer());
-    
-    //log_debug("sql_query = %s\n",sql_query.c_str());
-    
-    *qb << SQL_QUERY << " WHERE " << TQD('f',"id") << '=' << objectID;
-
-    Ref<SQLResult> res = select(qb);
+    Ref<SQLParams> params(new SQLParams());
+    *params << objectID;
+    Ref<SQLResult> res = selectPrepared(sql_load_object.c_str(), params);
     Ref<SQLRow> row;
     if (res != nil && (row = res->nextRow()) != nil)
     {
@@ -682,12 +869,11 @@ Ref<Array<CdsObject> > SQLStorage::browse(Ref<BrowseParam> param)
     /* ----------- */
     
     Ref<StringBuffer> qb(new StringBuffer());
+    Ref<SQLParams> params(new SQLParams());
+    *params << objectID;
     if (! haveObjectType)
     {
-        *qb << "SELECT " << TQ("object_type")
-            << " FROM " << TQ(CDS_OBJECT_TABLE)
-            << " WHERE " << TQ("id") << '=' << objectID;
-        res = select(qb);
+        res = selectPrepared(sql_object_type.c_str(), params);
         if(res != nil && (row = res->nextRow()) != nil)
         {
             objectType = row->col(0).toInt();
@@ -726,9 +912,16 @@ Ref<Array<CdsObject> > SQLStorage::browse(Ref<BrowseParam> param)
     
     // order by code..
     qb->clear();
-    if (param->getFlag(BROWSE_TRACK_SORT))
-        *qb << TQD('f',"track_number") << ',';
-    *qb << TQD('f',"dc_title");
+    Ref<Array<SortCriterion> > sortCriteria = param->getSortCriteria();
+    bool clientSort = (sortCriteria != nil && sortCriteria->size() > 0);
+    if (clientSort)
+        *qb << _orderBy(sortCriteria);
+    else
+    {
+        if (param->getFlag(BROWSE_TRACK_SORT))
+            *qb << TQD('f',"track_number") << ',';
+        *qb << TQD('f',"dc_title");
+    }
     String orderByCode = qb->toString();
     
     qb->clear();
@@ -746,7 +939,7 @@ Ref<Array<CdsObject> > SQLStorage::browse(Ref<BrowseParam> param)
                 doLimit = false;
         }
         
-        *qb << TQD('f',"parent_id") << '=' << objectID;
+        *qb << TQD('f',"parent_id") << "=?";
         
         if (objectID == CDS_ID_ROOT && hideFsRoot)
             *qb << " AND " << TQD('f',"id") << "!="
@@ -769,6 +962,12 @@ Ref<Array<CdsObject> > SQLStorage::browse(Ref<BrowseParam> param)
                 << quote(OBJECT_TYPE_ITEM)
                 << " ORDER BY " << orderByCode;
         }
+        else if (clientSort)
+        {
+            // containers are not forced to the top, so the order can be
+            // read from the (parent_id, sort column) index
+            *qb << " ORDER BY " << orderByCode;
+        }
         else
         {
             *qb << " ORDER BY ("
@@ -776,20 +975,34 @@ Ref<Array<CdsObject> > SQLStorage::browse(Ref<BrowseParam> param)
             << ") DESC, " << orderByCode;
         }
         if (doLimit)
-            *qb << " LIMIT " << count << " OFFSET " << param->getStartingIndex();
+        {
+            *qb << " LIMIT ? OFFSET ?";
+            *params << count << param->getStartingIndex();
+        }
     }
     else // metadata
     {
-        *qb << TQD('f',"id") << '=' << objectID << " LIMIT 1";
+        *qb << TQD('f',"id") << "=? LIMIT 1";
     }
     log_debug("QUERY: %s\n", qb->toString().c_str());
-    res = select(qb);
+    res = selectPrepared(qb->c_str(), params, true);
     
     Ref<Array<CdsObject> > arr(new Array<CdsObject>());
     
     while((row = res->nextRow()) != nil)
     {
         Ref<CdsObject> obj = createObjectFromRow(row);
+        
+        // update childCount field
+        if (IS_CDS_CONTAINER(obj->getObjectType()))
+        {
+            Ref<CdsContainer> cont = RefCast(obj, CdsContainer);
+            cont->setChildCount(_childCount(cont->getID(),
+                row->col(_child_containers).toInt(),
+                row->col(_child_items).toInt(),
+                getContainers, getItems, hideFsRoot));
+        }
+        
         arr->append(obj);
         row = nil;
     }
@@ -797,20 +1010,407 @@ Ref<Array<CdsObject> > SQLStorage::browse(Ref<BrowseParam> param)
     row = nil;
     res = nil;
     
-    // update childCount fields
-    for (int i = 0; i < arr->size(); i++)
+    return arr;
+}
+
+Ref<Array<CdsObject> > SQLStorage::search(Ref<SearchParam> param)
+{
+    flushInsertBuffer();
+    
+    int containerID = param->getContainerID();
+    
+    Ref<StringBuffer> where(new StringBuffer());
+    *where << TQD('f',"id") << '>' << CDS_ID_ROOT;
+    if (containerID != CDS_ID_ROOT)
+        *where << " AND " << TQD('f',"parent_id") << " IN (" << _searchScope(containerID) << ')';
+    else if (param->getHideFsRoot())
+    {
+        // everything below the PC Directory has a directory or file location
+        *where << " AND " << TQD('f',"id") << "!=" << CDS_ID_FS_ROOT
+            << " AND (" << TQD('f',"location") << " IS NULL OR SUBSTR("
+            << TQD('f',"location") << ",1,1) NOT IN ("
+            << quote(LOC_DIR_PREFIX) << ',' << quote(LOC_FILE_PREFIX) << "))";
+    }
+    *where << " AND ";
+    _searchCondition(param->getCriteria(), where);
+    
+    Ref<StringBuffer> qb(new StringBuffer());
+    *qb << "SELECT COUNT(*) FROM " << TQ(CDS_OBJECT_TABLE) << ' ' << TQ('f')
+        << " LEFT JOIN " << TQ(CDS_OBJECT_TABLE) << ' ' << TQ("rf")
+        << " ON " << TQD('f',"ref_id") << '=' << TQD("rf","id")
+        << " WHERE " << where;
+    log_debug("QUERY: %s\n", qb->c_str());
+    Ref<SQLResult> res = select(qb);
+    Ref<SQLRow> row;
+    if (res == nil || (row = res->nextRow()) == nil)
+        throw _StorageException(nil, _("sql error"));
+    param->setTotalMatches(row->col(0).toInt());
+    row = nil;
+    res = nil;
+    
+    Ref<Array<CdsObject> > arr(new Array<CdsObject>());
+    if (param->getTotalMatches() <= param->getStartingIndex())
+        return arr;
+    
+    qb->clear();
+    *qb << SQL_QUERY << " WHERE " << where << " ORDER BY ";
+    Ref<Array<SortCriterion> > sortCriteria = param->getSortCriteria();
+    if (sortCriteria != nil && sortCriteria->size() > 0)
+        *qb << _orderBy(sortCriteria);
+    else
+        *qb << TQD('f',"id");
+    if (param->getRequestedCount() > 0 || param->getStartingIndex() > 0)
     {
-        Ref<CdsObject> obj = arr->get(i);
+        int count = param->getRequestedCount();
+        if (count <= 0)
+            count = INT_MAX;
+        *qb << " LIMIT " << count << " OFFSET " << param->getStartingIndex();
+    }
+    log_debug("QUERY: %s\n", qb->c_str());
+    res = selectStreaming(qb);
+    if (res == nil)
+        throw _StorageException(nil, _("sql error"));
+    
+    while ((row = res->nextRow()) != nil)
+    {
+        Ref<CdsObject> obj = createObjectFromRow(row);
         if (IS_CDS_CONTAINER(obj->getObjectType()))
         {
             Ref<CdsContainer> cont = RefCast(obj, CdsContainer);
-            cont->setChildCount(getChildCount(cont->getID(), getContainers, getItems, hideFsRoot));
+            cont->setChildCount(_childCount(cont->getID(),
+                row->col(_child_containers).toInt(),
+                row->col(_child_items).toInt(),
+                true, true, false));
         }
+        arr->append(obj);
+        row = nil;
     }
     
     return arr;
 }
 
+String SQLStorage::getSearchCapabilities()
+{
+    Ref<StringBuffer> caps(new StringBuffer());
+    *caps << "@id,@parentID,@refID,dc:title,upnp:class";
+    // all other properties are looked up in the metadata table
+    for (int i = 0; i < M_MAX; i++)
+    {
+        if (i != M_TITLE)
+            *caps << ',' << MetadataHandler::getMetaFieldName((metadata_fields_t)i);
+    }
+    return caps->toString();
+}
+
+String SQLStorage::getSortCapabilities()
+{
+    Ref<StringBuffer> caps(new StringBuffer());
+    for (int i = 0; sortColumns[i].property != NULL; i++)
+    {
+        if (i > 0)
+            *caps << ',';
+        *caps << sortColumns[i].property;
+    }
+    return caps->toString();
+}
+
+String SQLStorage::_orderBy(Ref<Array<SortCriterion> > sortCriteria)
+{
+    Ref<StringBuffer> buf(new StringBuffer());
+    bool ascending = true;
+    for (int i = 0; i < sortCriteria->size(); i++)
+    {
+        Ref<SortCriterion> criterion = sortCriteria->get(i);
+        int c;
+        for (c = 0; sortColumns[c].property != NULL; c++)
+        {
+            if (criterion->property == sortColumns[c].property)
+                break;
+        }
+        if (sortColumns[c].property == NULL)
+            throw _Exception(_("unsupported sort property: ") + criterion->property);
+        ascending = criterion->ascending;
+        *buf << TQD('f',sortColumns[c].column) << (ascending ? " ASC," : " DESC,");
+    }
+    // the id makes the order stable across pages; it follows the direction
+    // of the last column, so the index can still be scanned in one direction
+    *buf << TQD('f',"id") << (ascending ? " ASC" : " DESC");
+    return buf->toString();
+}
+
+void SQLStorage::_putSortColumns(Ref<CdsItem> item, Ref<Dictionary> columns, bool isUpdate)
+{
+    Ref<Dictionary> meta = item->getMetadata();
+    for (int i = 0; sortMetadataColumns[i].column != NULL; i++)
+    {
+        String value = meta->get(MetadataHandler::getMetaFieldName(sortMetadataColumns[i].field));
+        if (string_ok(value))
+            columns->put(_(sortMetadataColumns[i].column), quote(value));
+        else if (isUpdate)
+            columns->put(_(sortMetadataColumns[i].column), _(SQL_NULL));
+    }
+    
+    String size;
+    if (item->getResourceCount() > 0)
+        size = item->getResource(0)->getAttribute(MetadataHandler::getResAttrName(R_SIZE));
+    if (string_ok(size))
+        columns->put(_("res_size"), quote(size.toLong()));
+    else if (isUpdate)
+        columns->put(_("res_size"), _(SQL_NULL));
+}
+
+String SQLStorage::_searchScope(int containerID)
+{
+    Ref<SQLParams> params(new SQLParams());
+    *params << containerID;
+    Ref<SQLResult> res = selectPrepared(sql_object_type.c_str(), params);
+    Ref<SQLRow> row;
+    if (res == nil || (row = res->nextRow()) == nil ||
+        ! IS_CDS_CONTAINER(row->col(0).toInt()))
+        throw _ObjectNotFoundException(_("Container not found: ") + containerID);
+    row = nil;
+    res = nil;
+    
+    // collect the IDs of all containers below the container, one level
+    // at a time; the objects in the scope are the children of these
+    Ref<StringBuffer> scope(new StringBuffer());
+    *scope << containerID;
+    Ref<StringBuffer> level(new StringBuffer());
+    *level << containerID;
+    Ref<StringBuffer> qb(new StringBuffer());
+    while (level->length() > 0)
+    {
+        qb->clear();
+        *qb << "SELECT " << TQ("id") << " FROM " << TQ(CDS_OBJECT_TABLE)
+            << " WHERE " << TQ("parent_id") << " IN (" << level << ')'
+            << " AND " << TQ("object_type") << '=' << OBJECT_TYPE_CONTAINER;
+        res = select(qb);
+        if (res == nil)
+            throw _StorageException(nil, _("sql error"));
+        level->clear();
+        while ((row = res->nextRow()) != nil)
+        {
+            if (level->length() > 0)
+                *level << ',';
+            *level << row->col_c_str(0);
+            *scope << ',' << row->col_c_str(0);
+        }
+        row = nil;
+        res = nil;
+    }
+    return scope->toString();
+}
+
+void SQLStorage::_searchCondition(Ref<SearchExpression> exp, Ref<StringBuffer> qb)
+{
+    switch (exp->type)
+    {
+        case SEARCH_ALL:
+            *qb << "1=1";
+            break;
+        case SEARCH_AND:
+        case SEARCH_OR:
+            *qb << '(';
+            _searchCondition(exp->left, qb);
+            *qb << (exp->type == SEARCH_AND ? " AND " : " OR ");
+            _searchCondition(exp->right, qb);
+            *qb << ')';
+            break;
+        case SEARCH_RELATION:
+            _searchRelation(exp, qb);
+            break;
+    }
+}
+
+void SQLStorage::_searchRelation(Ref<SearchExpression> exp, Ref<StringBuffer> qb)
+{
+    Ref<StringBuffer> column(new StringBuffer());
+    bool numeric = false;
+    if (exp->property == "dc:title")
+        *column << TQD('f',"dc_title");
+    else if (exp->property == "upnp:class")
+    {
+        // virtual objects only store a class that differs from the one
+        // of the referenced object
+        *column << "COALESCE(" << TQD('f',"upnp_class") << ','
+            << TQD("rf","upnp_class") << ')';
+    }
+    else if (exp->property == "@id")
+    {
+        *column << TQD('f',"id");
+        numeric = true;
+    }
+    else if (exp->property == "@parentID")
+    {
+        *column << TQD('f',"parent_id");
+        numeric = true;
+    }
+    else if (exp->property == "@refID")
+    {
+        *column << TQD('f',"ref_id");
+        numeric = true;
+    }
+    
+    if (column->length() > 0)
+    {
+        String value = exp->value;
+        if (numeric && exp->op != SEARCH_OP_EXISTS)
+            value = String::from(value.toInt());
+        _searchComparison(column->toString(), exp->op, value, qb);
+        return;
+    }
+    
+    // metadata property; the negative operators select the objects that
+    // have no matching entry
+    search_operator_t op = exp->op;
+    bool negate = false;
+    if (op == SEARCH_OP_NE)
+    {
+        op = SEARCH_OP_EQ;
+        negate = true;
+    }
+    else if (op == SEARCH_OP_DOES_NOT_CONTAIN)
+    {
+        op = SEARCH_OP_CONTAINS;
+        negate = true;
+    }
+    else if (op == SEARCH_OP_EXISTS && exp->value == "false")
+        negate = true;
+    
+    Ref<StringBuffer> sub(new StringBuffer());
+    *sub << "SELECT " << TQ("item_id") << " FROM " << TQ(METADATA_TABLE)
+        << " WHERE " << TQ("property_name") << '=' << quote(exp->property);
+    if (op != SEARCH_OP_EXISTS)
+    {
+        column->clear();
+        *column << TQ("property_value");
+        *sub << " AND ";
+        _searchComparison(column->toString(), op, exp->value, sub);
+    }
+    
+    // objects without metadata of their own use the one of the
+    // referenced object
+    if (negate)
+        *qb << "NOT ";
+    *qb << '(' << TQD('f',"id") << " IN (" << sub << ") OR ("
+        << TQD('f',"metadata") << " IS NULL AND "
+        << TQD('f',"ref_id") << " IS NOT NULL AND "
+        << TQD('f',"ref_id") << " IN (" << sub << ")))";
+}
+
+void SQLStorage::_searchComparison(String column, search_operator_t op, String value, Ref<StringBuffer> qb)
+{
+    switch (op)
+    {
+        case SEARCH_OP_EQ:
+            *qb << column << '=' << quote(value);
+            break;
+        case SEARCH_OP_NE:
+            *qb << column << "!=" << quote(value);
+            break;
+        case SEARCH_OP_LT:
+            *qb << column << '<' << quote(value);
+            break;
+        case SEARCH_OP_LE:
+            *qb << column << "<=" << quote(value);
+            break;
+        case SEARCH_OP_GT:
+            *qb << column << '>' << quote(value);
+            break;
+        case SEARCH_OP_GE:
+            *qb << column << ">=" << quote(value);
+            break;
+        case SEARCH_OP_CONTAINS:
+            *qb << column << " LIKE " << quote(_likePattern(value, true, true))
+                << " ESCAPE " << quote(_("\\"));
+            break;
+        case SEARCH_OP_DOES_NOT_CONTAIN:
+            *qb << column << " NOT LIKE " << quote(_likePattern(value, true, true))
+                << " ESCAPE " << quote(_("\\"));
+            break;
+        case SEARCH_OP_DERIVED_FROM:
+            *qb << '(' << column << '=' << quote(value) << " OR "
+                << column << " LIKE " << quote(_likePattern(value + '.', false, true))
+                << " ESCAPE " << quote(_("\\")) << ')';
+            break;
+        case SEARCH_OP_EXISTS:
+            *qb << column << (value == "true" ? " IS NOT NULL" : " IS NULL");
+            break;
+    }
+}
+
+String SQLStorage::_likePattern(String value, bool anyPrefix, bool anySuffix)
+{
+    Ref<StringBuffer> buf(new StringBuffer(value.length() + 2));
+    if (anyPrefix)
+        *buf << '%';
+    const char *ptr = value.c_str();
+    for (int i = 0; i < value.length(); i++)
+    {
+        if (ptr[i] == '\\' || ptr[i] == '%' || ptr[i] == '_')
+            *buf << '\\';
+        *buf << ptr[i];
+    }
+    if (anySuffix)
+        *buf << '%';
+    return buf->toString();
+}
+
+Ref<DBOHash<int, CdsObject> > SQLStorage::getFirstChildItems(Ref<IntArray> containerIDs)
+{
+    int capacity = containerIDs->size() * 5 + 1;
+    if (capacity < 31)
+        capacity = 31;
+    Ref<DBOHash<int, CdsObject> > ret(new DBOHash<int, CdsObject>(capacity, INVALID_OBJECT_ID, INVALID_OBJECT_ID_2));
+    if (containerIDs->size() <= 0)
+        return ret;
+    
+    flushInsertBuffer();
+    
+    // first query: the id of the first item of every container, in browse order
+    Ref<StringBuffer> qb(new StringBuffer());
+    *qb << "SELECT " << TQD('p',"id") << ",(SELECT " << TQD('c',"id")
+        << " FROM " << TQ(CDS_OBJECT_TABLE) << ' ' << TQ('c')
+        << " WHERE " << TQD('c',"parent_id") << '=' << TQD('p',"id")
+        << " AND (" << TQD('c',"object_type") << " & " << OBJECT_TYPE_ITEM
+        << ") = " << OBJECT_TYPE_ITEM
+        << " ORDER BY " << TQD('c',"dc_title") << " LIMIT 1)"
+        << " FROM " << TQ(CDS_OBJECT_TABLE) << ' ' << TQ('p')
+        << " WHERE " << TQD('p',"id") << " IN (" << containerIDs->toCSV() << ')';
+    Ref<SQLResult> res = select(qb);
+    if (res == nil)
+        throw _Exception(_("db error"));
+    
+    Ref<StringBuffer> itemIDs(new StringBuffer());
+    Ref<SQLRow> row;
+    while ((row = res->nextRow()) != nil)
+    {
+        String itemID = row->col(1);
+        if (string_ok(itemID))
+            *itemIDs << ',' << itemID;
+    }
+    res = nil;
+    
+    if (itemIDs->length() <= 0)
+        return ret;
+    
+    // second query: the items themselves
+    qb->clear();
+    *qb << SQL_QUERY << " WHERE " << TQD('f',"id") << " IN (";
+    qb->concat(itemIDs, 1);
+    *qb << ')';
+    res = select(qb);
+    if (res == nil)
+        throw _Exception(_("db error"));
+    
+    while ((row = res->nextRow()) != nil)
+    {
+        Ref<CdsObject> obj = createObjectFromRow(row);
+        ret->put(obj->getParentID(), obj);
+    }
+    return ret;
+}
+
 int SQLStorage::getChildCount(int contId, bool containers, bool items, bool hideFsRoot)
 {
     if (! containers && ! items)
@@ -834,22 +1434,13 @@ int SQLStorage::getChildCount(int contId, bool containers, bool items, bool hide
     
     Ref<SQLRow> row;
     Ref<SQLResult> res;
-    Ref<StringBuffer> qb(new StringBuffer());
-    *qb << "SELECT COUNT(*) FROM " << TQ(CDS_OBJECT_TABLE)
-        << " WHERE " << TQ("parent_id") << '=' << contId;
-    if (containers && ! items)
-        *qb << " AND " << TQ("object_type") << '=' << OBJECT_TYPE_CONTAINER;
-    else if (items && ! containers)
-        *qb << " AND (" << TQ("object_type") << " & " << OBJECT_TYPE_ITEM
-            << ") = " << OBJECT_TYPE_ITEM;
-    if (contId == CDS_ID_ROOT && hideFsRoot)
-    {
-        *qb << " AND " << TQ("id") << "!=" << quote (CDS_ID_FS_ROOT);
-    }
-    res = select(qb);
+    Ref<SQLParams> params(new SQLParams());
+    *params << contId;
+    res = selectPrepared(sql_child_count.c_str(), params);
     if (res != nil && (row = res->nextRow()) != nil)
     {
-        int childCount = row->col(0).toInt();
+        int childCount = _childCount(contId, row->col(0).toInt(),
+            row->col(1).toInt(), containers, items, hideFsRoot);
         
         /* add to cache */
         if (cacheOn() && containers && items && ! (contId == CDS_ID_ROOT && hideFsRoot))
@@ -866,6 +1457,347 @@ int SQLStorage::getChildCount(int contId, bool containers, bool items, bool hide
     return 0;
 }
 
+int SQLStorage::_childCount(int contId, int containerCount, int itemCount, bool containers, bool items, bool hideFsRoot)
+{
+    int childCount = 0;
+    if (containers)
+    {
+        childCount += containerCount;
+        // the fs root is always a container child of the root container
+        if (contId == CDS_ID_ROOT && hideFsRoot && containerCount > 0)
+            childCount--;
+    }
+    if (items)
+        childCount += itemCount;
+    return childCount;
+}
+
+void SQLStorage::_markChildCountsDirty()
+{
+    AUTOLOCK(childCountMutex);
+    if (childCountsDirty)
+        return;
+    // written right away, the count updates may sit in the insert buffer;
+    // shutdown() removes the setting again
+    storeInternalSetting(_("child_count_check"), _("1"));
+    childCountsDirty = true;
+}
+
+void SQLStorage::_changeChildCount(int parentID, int objectType, int delta, bool buffered)
+{
+    _markChildCountsDirty();
+    Ref<StringBuffer> qb(new StringBuffer());
+    const char *column = (IS_CDS_CONTAINER(objectType) ? "child_containers" : "child_items");
+    *qb << "UPDATE " << TQ(CDS_OBJECT_TABLE)
+        << " SET " << TQ(column) << '=' << TQ(column)
+        << (delta < 0 ? " - " : " + ") << (delta < 0 ? -delta : delta)
+        << " WHERE " << TQ("id") << '=' << parentID;
+    if (buffered && doInsertBuffering())
+        addToInsertBuffer(qb);
+    else
+        exec(qb);
+}
+
+bool SQLStorage::_storesMetadata(Ref<Array<AddUpdateTable> > data)
+{
+    String metadata = data->get(0)->getDict()->get(_("metadata"));
+    return (metadata != nil && metadata != SQL_NULL);
+}
+
+void SQLStorage::_addMetadataRows(int objectID, Ref<Dictionary> metadata, bool buffered)
+{
+    Ref<Array<DictionaryElement> > elements = metadata->getElements();
+    for (int i = 0; i < elements->size(); i++)
+    {
+        Ref<DictionaryElement> el = elements->get(i);
+        Ref<StringBuffer> qb(new StringBuffer(128));
+        *qb << "INSERT INTO " << TQ(METADATA_TABLE) << " ("
+            << TQ("item_id") << ',' << TQ("property_name") << ','
+            << TQ("property_value") << ") VALUES (" << objectID << ','
+            << quote(el->getKey()) << ',' << quote(el->getValue()) << ')';
+        if (buffered && doInsertBuffering())
+            addToInsertBuffer(qb);
+        else
+            exec(qb);
+    }
+}
+
+void SQLStorage::_fillMetadataTable()
+{
+    log_info("building the metadata table, this may take a while...\n");
+    
+    // this runs from init() with the Storage singleton mutex held, so the
+    // bulk import and the insert buffer, which take the same mutex, can't
+    // be used; nothing else accesses the database yet
+    _beginTransaction();
+    Ref<StringBuffer> qb(new StringBuffer());
+    *qb << "DELETE FROM " << TQ(METADATA_TABLE);
+    exec(qb);
+    
+    int lastObjectID = INT_MIN;
+    int count = 0;
+    bool more = true;
+    while (more)
+    {
+        qb->clear();
+        *qb << "SELECT " << TQ("id") << ',' << TQ("metadata")
+            << " FROM " << TQ(CDS_OBJECT_TABLE)
+            << " WHERE " << TQ("id") << '>' << lastObjectID
+            << " AND " << TQ("metadata") << " IS NOT NULL"
+            << " ORDER BY " << TQ("id") << " LIMIT " << BULK_IMPORT_TRANSACTION_SIZE;
+        Ref<SQLResult> res = select(qb);
+        if (res == nil)
+            throw _Exception(_("db error"));
+        more = false;
+        Ref<SQLRow> row;
+        while ((row = res->nextRow()) != nil)
+        {
+            more = true;
+            lastObjectID = row->col(0).toInt();
+            Ref<Dictionary> metadata(new Dictionary());
+            metadata->unpack(row->col(1));
+            _addMetadataRows(lastObjectID, metadata, false);
+            count++;
+        }
+    }
+    
+    qb->clear();
+    *qb << "DELETE FROM " << TQ(INTERNAL_SETTINGS_TABLE)
+        << " WHERE " << TQ("key") << '=' << quote(_("metadata_rebuild"));
+    exec(qb);
+    _commitTransaction();
+    
+    log_info("metadata table built for %d objects\n", count);
+}
+
+void SQLStorage::_fillSortColumns()
+{
+    log_info("filling the sort columns, this may take a while...\n");
+    
+    // see _fillMetadataTable() for why there is no bulk import
+    _beginTransaction();
+    
+    int lastObjectID = INT_MIN;
+    int count = 0;
+    bool more = true;
+    Ref<StringBuffer> qb(new StringBuffer());
+    while (more)
+    {
+        qb->clear();
+        *qb << SQL_QUERY << " WHERE " << TQD('f',"id") << '>' << lastObjectID
+            << " AND (" << TQD('f',"object_type") << " & " << OBJECT_TYPE_ITEM
+            << ") = " << OBJECT_TYPE_ITEM
+            << " ORDER BY " << TQD('f',"id") << " LIMIT " << BULK_IMPORT_TRANSACTION_SIZE;
+        Ref<SQLResult> res = select(qb);
+        if (res == nil)
+            throw _Exception(_("db error"));
+        more = false;
+        Ref<SQLRow> row;
+        while ((row = res->nextRow()) != nil)
+        {
+            more = true;
+            Ref<CdsObject> obj = createObjectFromRow(row);
+            lastObjectID = obj->getID();
+            
+            Ref<Dictionary> columns(new Dictionary());
+            _putSortColumns(RefCast(obj, CdsItem), columns, false);
+            if (columns->size() == 0)
+                continue;
+            
+            Ref<Array<DictionaryElement> > elements = columns->getElements();
+            qb->clear();
+            *qb << "UPDATE " << TQ(CDS_OBJECT_TABLE) << " SET ";
+            for (int i = 0; i < elements->size(); i++)
+            {
+                if (i > 0)
+                    *qb << ',';
+                *qb << TQ(elements->get(i)->getKey()) << '='
+                    << elements->get(i)->getValue();
+            }
+            *qb << " WHERE " << TQ("id") << '=' << lastObjectID;
+            exec(qb);
+            count++;
+        }
+    }
+    
+    qb->clear();
+    *qb << "DELETE FROM " << TQ(INTERNAL_SETTINGS_TABLE)
+        << " WHERE " << TQ("key") << '=' << quote(_("sort_rebuild"));
+    exec(qb);
+    _commitTransaction();
+    
+    log_info("sort columns filled for %d items\n", count);
+}
+
+void SQLStorage::_packObjectData()
+{
+    log_info("converting the object data to the packed format, this may take a while...\n");
+    
+    // see _fillMetadataTable() for why there is no bulk import
+    _beginTransaction();
+    
+    int lastObjectID = INT_MIN;
+    int count = 0;
+    bool more = true;
+    Ref<StringBuffer> qb(new StringBuffer());
+    while (more)
+    {
+        qb->clear();
+        *qb << "SELECT " << TQ("id") << ',' << TQ("metadata") << ','
+            << TQ("auxdata") << ',' << TQ("resources")
+            << " FROM " << TQ(CDS_OBJECT_TABLE)
+            << " WHERE " << TQ("id") << '>' << lastObjectID
+            << " ORDER BY " << TQ("id") << " LIMIT " << BULK_IMPORT_TRANSACTION_SIZE;
+        Ref<SQLResult> res = select(qb);
+        if (res == nil)
+            throw _Exception(_("db error"));
+        more = false;
+        Ref<SQLRow> row;
+        while ((row = res->nextRow()) != nil)
+        {
+            more = true;
+            lastObjectID = row->col(0).toInt();
+            
+            qb->clear();
+            const char *columns[] = { "metadata", "auxdata", "resources" };
+            for (int i = 0; i < 3; i++)
+            {
+                String data = row->col(i + 1);
+                if (! string_ok(data) || data.charAt(0) == PACKED_FORMAT_V1)
+                    continue;
+                if (i == 2)
+                    data = CdsResource::packList(CdsResource::unpackList(data));
+                else
+                {
+                    Ref<Dictionary> dict(new Dictionary());
+                    dict->unpack(data);
+                    data = dict->pack();
+                }
+                *qb << (qb->length() > 0 ? "," : "")
+                    << TQ(columns[i]) << '=' << quote(data);
+            }
+            if (qb->length() == 0)
+                continue;
+            
+            Ref<StringBuffer> update(new StringBuffer());
+            *update << "UPDATE " << TQ(CDS_OBJECT_TABLE) << " SET " << qb
+                << " WHERE " << TQ("id") << '=' << lastObjectID;
+            exec(update);
+            count++;
+        }
+    }
+    
+    qb->clear();
+    *qb << "DELETE FROM " << TQ(INTERNAL_SETTINGS_TABLE)
+        << " WHERE " << TQ("key") << '=' << quote(_("pack_rebuild"));
+    exec(qb);
+    _commitTransaction();
+    
+    log_info("converted the data of %d objects\n", count);
+}
+
+void SQLStorage::_checkChildCounts()
+{
+    log_debug("start\n");
+    
+    Ref<StringBuffer> qb(new StringBuffer());
+    *qb << "SELECT " << TQ("id") << ',' << TQ("child_containers") << ','
+        << TQ("child_items") << " FROM " << TQ(CDS_OBJECT_TABLE)
+        << " WHERE " << TQ("object_type") << '=' << OBJECT_TYPE_CONTAINER;
+    Ref<SQLResult> stored = select(qb);
+    if (stored == nil)
+        throw _Exception(_("db error"));
+    
+    qb->clear();
+    *qb << "SELECT " << TQ("parent_id") << ','
+        << TQ("object_type") << "=" << OBJECT_TYPE_CONTAINER << ", COUNT(*)"
+        << " FROM " << TQ(CDS_OBJECT_TABLE)
+        << " WHERE " << TQ("object_type") << '=' << OBJECT_TYPE_CONTAINER
+        << " OR (" << TQ("object_type") << " & " << OBJECT_TYPE_ITEM << ") = "
+        << OBJECT_TYPE_ITEM
+        << " GROUP BY " << TQ("parent_id") << ','
+        << TQ("object_type") << "=" << OBJECT_TYPE_CONTAINER;
+    Ref<SQLResult> actual = select(qb);
+    if (actual == nil)
+        throw _Exception(_("db error"));
+    
+    int capacity = stored->getNumRows() * 5 + 1;
+    if (capacity < 521)
+        capacity = 521;
+    Ref<DBBHash<int, int> > containerCounts(new DBBHash<int, int>(capacity, INVALID_OBJECT_ID));
+    Ref<DBBHash<int, int> > itemCounts(new DBBHash<int, int>(capacity, INVALID_OBJECT_ID));
+    
+    Ref<SQLRow> row;
+    while ((row = actual->nextRow()) != nil)
+    {
+        int parentID = row->col(0).toInt();
+        if (remapBool(row->col(1)))
+            containerCounts->put(parentID, row->col(2).toInt());
+        else
+            itemCounts->put(parentID, row->col(2).toInt());
+    }
+    actual = nil;
+    
+    // see _fillMetadataTable() for why there is no bulk import; the
+    // corrections are written with one UPDATE per MAX_BULK_UPDATE_IDS
+    // containers, MySQL has no transaction over several queries here
+    _beginTransaction();
+    Ref<StringBuffer> ids(new StringBuffer());
+    Ref<StringBuffer> containerCase(new StringBuffer());
+    Ref<StringBuffer> itemCase(new StringBuffer());
+    int batched = 0;
+    int fixed = 0;
+    do
+    {
+        row = stored->nextRow();
+        if (row != nil)
+        {
+            int id = row->col(0).toInt();
+            int containerCount = 0;
+            int itemCount = 0;
+            containerCounts->get(id, &containerCount);
+            itemCounts->get(id, &itemCount);
+            if (row->col(1).toInt() != containerCount || row->col(2).toInt() != itemCount)
+            {
+                *ids << ',' << id;
+                *containerCase << " WHEN " << id << " THEN " << containerCount;
+                *itemCase << " WHEN " << id << " THEN " << itemCount;
+                batched++;
+            }
+        }
+        
+        if (batched >= MAX_BULK_UPDATE_IDS || (row == nil && batched > 0))
+        {
+            qb->clear();
+            *qb << "UPDATE " << TQ(CDS_OBJECT_TABLE)
+                << " SET " << TQ("child_containers") << "=CASE " << TQ("id")
+                << containerCase << " END,"
+                << TQ("child_items") << "=CASE " << TQ("id")
+                << itemCase << " END"
+                << " WHERE " << TQ("id") << " IN (";
+            qb->concat(ids, 1);
+            *qb << ')';
+            exec(qb);
+            fixed += batched;
+            batched = 0;
+            ids->clear();
+            containerCase->clear();
+            itemCase->clear();
+        }
+    }
+    while (row != nil);
+    
+    qb->clear();
+    *qb << "DELETE FROM " << TQ(INTERNAL_SETTINGS_TABLE)
+        << " WHERE " << TQ("key") << '=' << quote(_("child_count_check"));
+    exec(qb);
+    _commitTransaction();
+    
+    if (fixed > 0)
+        log_warning("fixed the stored child counts of %d containers\n", fixed);
+    log_debug("end\n");
+}
+
 Ref<Array<StringBase> > SQLStorage::getMimeTypes()
 {
     flushInsertBuffer();
@@ -929,16 +1861,12 @@ Ref<CdsObject> SQLStorage::_findObjectByPath(String fullpath)
     }
     /* ----------- */
     
-    Ref<StringBuffer> qb(new StringBuffer());
-    *qb << SQL_QUERY
-            << " WHERE " << TQD('f',"location_hash") << '=' << quote(stringHash(dbLocation))
-            << " AND " << TQD('f',"location") << '=' << quote(dbLocation)
-            << " AND " << TQD('f',"ref_id") << " IS NULL "
-            "LIMIT 1";
+    Ref<SQLParams> params(new SQLParams());
+    *params << stringHash(dbLocation) << dbLocation;
     
-    Ref<SQLResult> res = select(qb);
+    Ref<SQLResult> res = selectPrepared(sql_find_by_location.c_str(), params);
     if (res == nil)
-        throw _Exception(_("error while doing select: ") + qb->toString());
+        throw _Exception(_("error while doing select: ") + sql_find_by_location);
     
     
     Ref<SQLRow> row = res->nextRow();
@@ -1025,6 +1953,7 @@ int SQLStorage::createContainer(int parentID, String name, String path, bool isV
         << ')';
         
     exec(qb);
+    _changeChildCount(parentID, OBJECT_TYPE_CONTAINER, 1);
     
     /* inform cache */
     if (cacheOn())
@@ -1043,6 +1972,13 @@ int SQLStorage::createContainer(int parentID, String name, String path, bool isV
     }
     /* ------------ */
     
+    if (isVirtual)
+    {
+        AUTOLOCK(containerIndex->getMutex());
+        if (containerIndex->isLoaded())
+            containerIndex->add(newID, dbLocation);
+    }
+    
     return newID;
     
     //return exec(qb, true);
@@ -1078,22 +2014,17 @@ void SQLStorage::addContainerChain(String path, String lastClass, int lastRefID,
         *containerID = CDS_ID_ROOT;
         return;
     }
-    Ref<StringBuffer> qb(new StringBuffer());
     String dbLocation = addLocationPrefix(LOC_VIRT_PREFIX, path);
-    *qb << "SELECT " << TQ("id") << " FROM " << TQ(CDS_OBJECT_TABLE)
-            << " WHERE " << TQ("location_hash") << '=' << quote(stringHash(dbLocation))
-            << " AND " << TQ("location") << '=' << quote(dbLocation)
-            << " LIMIT 1";
-    Ref<SQLResult> res = select(qb);
-    if (res != nil)
-    {
-        Ref<SQLRow> row = res->nextRow();
-        if (row != nil)
-        {
-            if (containerID != NULL)
-                *containerID = row->col(0).toInt();
-            return;
-        }
+    AUTOLOCK(containerIndex->getMutex());
+    if (! containerIndex->isLoaded())
+        _loadContainerIndex();
+    int id = containerIndex->getID(dbLocation);
+    AUTOUNLOCK();
+    if (id != INVALID_OBJECT_ID)
+    {
+        if (containerID != NULL)
+            *containerID = id;
+        return;
     }
     int parentContainerID;
     String newpath, container;
@@ -1104,6 +2035,27 @@ void SQLStorage::addContainerChain(String path, String lastClass, int lastRefID,
     *containerID = createContainer(parentContainerID, container, path, true, lastClass, lastRefID);
 }
 
+void SQLStorage::_loadContainerIndex()
+{
+#ifdef TOMBDEBUG
+    assert(containerIndex->getMutex()->isLocked());
+#endif
+    Ref<StringBuffer> qb(new StringBuffer());
+    *qb << "SELECT " << TQ("id") << ',' << TQ("location")
+        << " FROM " << TQ(CDS_OBJECT_TABLE)
+        << " WHERE " << TQ("object_type") << '=' << OBJECT_TYPE_CONTAINER
+        << " AND " << TQ("location") << " LIKE " << quote(String(LOC_VIRT_PREFIX) + '%')
+        << " ORDER BY " << TQ("id");
+    Ref<SQLResult> res = selectStreaming(qb);
+    if (res == nil)
+        throw _StorageException(nil, _("could not load the virtual containers"));
+    Ref<SQLRow> row;
+    while ((row = res->nextRow()) != nil)
+        containerIndex->add(row->col(0).toInt(), row->col(1));
+    containerIndex->setLoaded();
+    log_debug("loaded %d virtual containers\n", containerIndex->size());
+}
+
 String SQLStorage::addLocationPrefix(char prefix, String path)
 {
     return String(prefix) + path;
@@ -1141,29 +2093,13 @@ Ref<CdsObject> SQLStorage::createObjectFromRow(Ref<SQLRow> row)
     obj->setClass(fallbackString(row->col(_upnp_class), row->col(_ref_upnp_class)));
     obj->setFlags(row->col(_flags).toUInt());
     
-    String metadataStr = fallbackString(row->col(_metadata), row->col(_ref_metadata));
-    Ref<Dictionary> meta(new Dictionary());
-    meta->decode(metadataStr);
-    obj->setMetadata(meta);
-    
-    String auxdataStr = fallbackString(row->col(_auxdata), row->col(_ref_auxdata));
-    Ref<Dictionary> aux(new Dictionary());
-    aux->decode(auxdataStr);
-    obj->setAuxData(aux);
-    
+    // metadata, auxdata and resources are only decoded when accessed,
+    // most objects of a browse are rendered without touching all of them
     String resources_str = fallbackString(row->col(_resources), row->col(_ref_resources));
-    bool resource_zero_ok = false;
-    if (string_ok(resources_str))
-    {
-        Ref<Array<StringBase> > resources = split_string(resources_str,
-                                                    RESOURCE_SEP);
-        for (int i = 0; i < resources->size(); i++)
-        {
-            if (i == 0)
-                resource_zero_ok = true;
-            obj->addResource(CdsResource::decode(resources->get(i)));
-        }
-    }
+    bool resource_zero_ok = string_ok(resources_str);
+    obj->setPackedData(fallbackString(row->col(_metadata), row->col(_ref_metadata)),
+                       fallbackString(row->col(_auxdata), row->col(_ref_auxdata)),
+                       resources_str);
     
     if ( (obj->getRefID() && IS_CDS_PURE_ITEM(objectType)) ||
         (IS_CDS_ITEM(objectType) && ! IS_CDS_PURE_ITEM(objectType)) )
@@ -1275,6 +2211,66 @@ String SQLStorage::incrementUpdateIDs(int *ids, int size)
 {
     if (size <= 0)
         return nil;
+    
+    // during bulk imports the containers are only remembered, they are
+    // passed to the UpdateManager again when the import is committed
+    AUTOLOCK(bulkImportMutex);
+    if (bulkImportDepth > 0 && bulkUpdateIDs->size() + size <= MAX_BULK_UPDATE_IDS)
+    {
+        for (int i = 0; i < size; i++)
+            bulkUpdateIDs->put(ids[i]);
+        return nil;
+    }
+    AUTOUNLOCK();
+    
+    return _incrementUpdateIDs(ids, size);
+}
+
+void SQLStorage::beginBulkImport()
+{
+    AUTOLOCK(bulkImportMutex);
+    if (bulkImportDepth++ > 0)
+        return;
+    log_debug("starting bulk import\n");
+    bulkImportObjectCount = 0;
+    _restartBulkTransaction(false, true);
+}
+
+void SQLStorage::commitBulkImport()
+{
+    AUTOLOCK(bulkImportMutex);
+    if (bulkImportDepth <= 0)
+        throw _Exception(_("commitBulkImport() without beginBulkImport()"));
+    if (--bulkImportDepth > 0)
+        return;
+    log_debug("committing bulk import\n");
+    
+    Ref<IntArray> changedContainers(new IntArray());
+    hash_data_array_t<int> hash_data_array;
+    bulkUpdateIDs->getAll(&hash_data_array);
+    for (int i = 0; i < hash_data_array.size; i++)
+        changedContainers->append(hash_data_array.data[i]);
+    bulkUpdateIDs->clear();
+    
+    _restartBulkTransaction(true, false);
+    AUTOUNLOCK();
+    
+    if (changedContainers->size() > 0)
+        UpdateManager::getInstance()->containersChanged(changedContainers, FLUSH_ASAP);
+}
+
+void SQLStorage::_restartBulkTransaction(bool commit, bool begin)
+{
+    AUTOLOCK(mutex);
+    flushInsertBuffer(true);
+    if (commit)
+        _commitTransaction();
+    if (begin)
+        _beginTransaction();
+}
+
+String SQLStorage::_incrementUpdateIDs(int *ids, int size)
+{
     Ref<StringBuffer> inBuf(new StringBuffer()); // ??? what was that: size * sizeof(int)));
     *inBuf << "IN (" << ids[0];
     for (int i = 1; i < size; i++)
@@ -1340,34 +2336,51 @@ Ref<Array<CdsObject> > SQLStorage::selectObjects(Ref<SelectParam> param)
 }
 */
 
-Ref<DBRHash<int> > SQLStorage::getObjects(int parentID, bool withoutContainer)
+Ref<Storage::DirectoryContents> SQLStorage::getDirectoryContents(int parentID, bool withoutContainer)
 {
     flushInsertBuffer();
     
     Ref<StringBuffer> q(new StringBuffer());
-    *q << "SELECT " << TQ("id") << " FROM " << TQ(CDS_OBJECT_TABLE) << " WHERE ";
+    *q << "SELECT " << TQ("id") << ',' << TQ("object_type")
+        << ',' << TQ("location") << ',' << TQ("res_size")
+        << " FROM " << TQ(CDS_OBJECT_TABLE) << " WHERE ";
     if (withoutContainer)
         *q << TQ("object_type") << " != " << OBJECT_TYPE_CONTAINER << " AND ";
-    *q << TQ("parent_id") << '=';
-    *q << parentID;
+    *q << TQ("parent_id") << '=' << parentID;
     Ref<SQLResult> res = select(q);
     if (res == nil)
         throw _Exception(_("db error"));
-    Ref<SQLRow> row;
     
-    if (res->getNumRows() <= 0)
+    int count = res->getNumRows();
+    if (count <= 0)
         return nil;
-    int capacity = res->getNumRows() * 5 + 1;
+    int capacity = count * 5 + 1;
     if (capacity < 521)
         capacity = 521;
     
-    Ref<DBRHash<int> > ret(new DBRHash<int>(capacity, res->getNumRows(), INVALID_OBJECT_ID, INVALID_OBJECT_ID_2));
+    Ref<DirectoryContents> contents(new DirectoryContents());
+    contents->ids = Ref<DBRHash<int> >(new DBRHash<int>(capacity, count, INVALID_OBJECT_ID, INVALID_OBJECT_ID_2));
+    contents->entries = Ref<DSOHash<DirectoryEntry> >(new DSOHash<DirectoryEntry>(hashCapacity(count)));
     
+    Ref<SQLRow> row;
     while ((row = res->nextRow()) != nil)
     {
-        ret->put(row->col(0).toInt());
-    }
-    return ret;
+        int id = row->col(0).toInt();
+        contents->ids->put(id);
+        
+        char prefix;
+        String path = stripLocationPrefix(&prefix, row->col(2));
+        if (! string_ok(path) || (prefix != LOC_FILE_PREFIX && prefix != LOC_DIR_PREFIX))
+            continue;
+        
+        Ref<DirectoryEntry> entry(new DirectoryEntry());
+        entry->id = id;
+        entry->container = IS_CDS_CONTAINER(row->col(1).toInt());
+        String size = row->col(3);
+        entry->size = string_ok(size) ? size.toOFF_T() : -1;
+        contents->entries->put(path, entry);
+    }
+    return contents;
 }
 
 Ref<Storage::ChangedContainers> SQLStorage::removeObjects(zmm::Ref<DBRHash<int> > list, bool all)
@@ -1462,6 +2475,32 @@ void SQLStorage::_removeObjects(Ref<StringBuffer> objectIDs, int offset)
         }
     }
     
+    // collect the child count changes of the parents
+    q->clear();
+    *q << "SELECT " << TQ("parent_id") << ','
+        << TQ("object_type") << '=' << OBJECT_TYPE_CONTAINER << ", COUNT(*)"
+        << " FROM " << TQ(CDS_OBJECT_TABLE)
+        << " WHERE " << TQ("id") << " IN (";
+    q->concat(objectIDs, offset);
+    *q << ") GROUP BY " << TQ("parent_id") << ','
+        << TQ("object_type") << '=' << OBJECT_TYPE_CONTAINER;
+    res = select(q);
+    if (res == nil)
+        throw _StorageException(nil, _("sql error"));
+    Ref<StringBuffer> parents(new StringBuffer());
+    Ref<StringBuffer> containerCase(new StringBuffer());
+    Ref<StringBuffer> itemCase(new StringBuffer());
+    Ref<SQLRow> row;
+    while ((row = res->nextRow()) != nil)
+    {
+        *parents << ',' << row->col_c_str(0);
+        if (remapBool(row->col(1)))
+            *containerCase << " WHEN " << row->col_c_str(0) << " THEN " << row->col_c_str(2);
+        else
+            *itemCase << " WHEN " << row->col_c_str(0) << " THEN " << row->col_c_str(2);
+    }
+    res = nil;
+    
     q->clear();
     *q << "DELETE FROM " << TQ(CDS_ACTIVE_ITEM_TABLE)
         << " WHERE " << TQ("id") << " IN (";
@@ -1469,12 +2508,58 @@ void SQLStorage::_removeObjects(Ref<StringBuffer> objectIDs, int offset)
     *q << ')';
     exec(q);
     
+    q->clear();
+    *q << "DELETE FROM " << TQ(METADATA_TABLE)
+        << " WHERE " << TQ("item_id") << " IN (";
+    q->concat(objectIDs, offset);
+    *q << ')';
+    exec(q);
+    
     q->clear();
     *q << "DELETE FROM " << TQ(CDS_OBJECT_TABLE)
         << " WHERE " << TQ("id") << " IN (";
     q->concat(objectIDs, offset);
     *q << ')';
     exec(q);
+    
+    AUTOLOCK(containerIndex->getMutex());
+    if (containerIndex->isLoaded())
+    {
+        char *ids = objectIDs->c_str() + offset;
+        char *end;
+        while (*ids)
+        {
+            int id = (int)strtol(ids, &end, 10);
+            if (end == ids)
+                break;
+            containerIndex->remove(id);
+            ids = (*end == ',') ? end + 1 : end;
+        }
+    }
+    AUTOUNLOCK();
+    
+    if (parents->length() > 0)
+    {
+        _markChildCountsDirty();
+        q->clear();
+        *q << "UPDATE " << TQ(CDS_OBJECT_TABLE) << " SET ";
+        if (containerCase->length() > 0)
+        {
+            *q << TQ("child_containers") << '=' << TQ("child_containers")
+                << " - CASE " << TQ("id") << containerCase << " ELSE 0 END";
+            if (itemCase->length() > 0)
+                *q << ',';
+        }
+        if (itemCase->length() > 0)
+        {
+            *q << TQ("child_items") << '=' << TQ("child_items")
+                << " - CASE " << TQ("id") << itemCase << " ELSE 0 END";
+        }
+        *q << " WHERE " << TQ("id") << " IN (";
+        q->concat(parents, 1);
+        *q << ')';
+        exec(q);
+    }
 }
 
 Ref<Storage::ChangedContainers> SQLStorage::removeObject(int objectID, bool all)
@@ -1675,16 +2760,14 @@ Ref<Storage::ChangedContainers> SQLStorage::_purgeEmptyContainers(Ref<ChangedCon
         return changedContainers;
     
     Ref<StringBuffer> bufSelUI(new StringBuffer());
-    *bufSelUI << "SELECT " << TQD('a',"id")
-        << ", COUNT(" << TQD('b',"parent_id") 
-        << ")," << TQD('a',"parent_id") << ',' << TQD('a',"flags")
-        << " FROM " << TQ(CDS_OBJECT_TABLE) << ' ' << TQ('a')
-        << " LEFT JOIN " << TQ(CDS_OBJECT_TABLE) << ' ' << TQ('b')
-        << " ON " << TQD('a',"id") << '=' << TQD('b',"parent_id") 
-        << " WHERE " << TQD('a',"object_type") << '=' << quote(1)
-        << " AND " << TQD('a',"id") << " IN (";  //(a.flags & " << OBJECT_FLAG_PERSISTENT_CONTAINER << ") = 0 AND
+    *bufSelUI << "SELECT " << TQ("id")
+        << ',' << TQ("child_containers") << " + " << TQ("child_items")
+        << ',' << TQ("parent_id") << ',' << TQ("flags")
+        << " FROM " << TQ(CDS_OBJECT_TABLE)
+        << " WHERE " << TQ("object_type") << '=' << quote(1)
+        << " AND " << TQ("id") << " IN (";  //(a.flags & " << OBJECT_FLAG_PERSISTENT_CONTAINER << ") = 0 AND
     int bufSelLen = bufSelUI->length();
-    String strSel2 = _(") GROUP BY a.id"); // HAVING COUNT(b.parent_id)=0");
+    String strSel2 = _(")");
     
     Ref<StringBuffer> bufSelUpnp(new StringBuffer());
     *bufSelUpnp << bufSelUI;
@@ -2396,3 +3479,36 @@ void SQLStorage::clearFlagInDB(int flag)
         << "&" << flag;
     exec(qb);
 }
+
+/* SQLParams */
+
+SQLParams::SQLParams() : Object()
+{
+    types = Ref<IntArray>(new IntArray());
+    ints = Ref<IntArray>(new IntArray());
+    strings = Ref<Array<StringBase> >(new Array<StringBase>());
+}
+
+SQLParams &SQLParams::operator<<(int val)
+{
+    types->append(SQL_PARAM_INT);
+    ints->append(val);
+    strings->append(_(""));
+    return *this;
+}
+
+SQLParams &SQLParams::operator<<(unsigned int val)
+{
+    types->append(SQL_PARAM_UINT);
+    ints->append((int)val);
+    strings->append(_(""));
+    return *this;
+}
+
+SQLParams &SQLParams::operator<<(String val)
+{
+    types->append(val == nil ? SQL_PARAM_NULL : SQL_PARAM_STRING);
+    ints->append(0);
+    strings->append(val == nil ? _("") : val);
+    return *this;
+}
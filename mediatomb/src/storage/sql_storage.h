@@ -39,6 +39,7 @@
 #include "hash.h"
 #include "sync.h"
 #include "storage_cache.h"
+#include "virtual_container_index.h"
 
 #define QTB                 table_quote_begin
 #define QTE                 table_quote_end
@@ -47,6 +48,7 @@
 #define CDS_ACTIVE_ITEM_TABLE       "mt_cds_active_item"
 #define INTERNAL_SETTINGS_TABLE     "mt_internal_setting"
 #define AUTOSCAN_TABLE              "mt_autoscan"
+#define METADATA_TABLE              "mt_metadata"
 
 class SQLResult;
 
@@ -70,6 +72,34 @@ public:
     virtual unsigned long long getNumRows() = 0;
 };
 
+#define SQL_PARAM_INT       0
+#define SQL_PARAM_UINT      1
+#define SQL_PARAM_STRING    2
+#define SQL_PARAM_NULL      3
+
+/// \brief The parameters of a prepared statement. Every '?' in the query
+/// is bound to one parameter, in the order in which they were added.
+class SQLParams : public zmm::Object
+{
+public:
+    SQLParams();
+    
+    SQLParams &operator<<(int val);
+    SQLParams &operator<<(unsigned int val);
+    /// \brief adds a string parameter; nil is bound as NULL
+    SQLParams &operator<<(zmm::String val);
+    
+    int size() { return types->size(); }
+    int getType(int index) { return types->get(index); }
+    int getInt(int index) { return ints->get(index); }
+    unsigned int getUInt(int index) { return (unsigned int)ints->get(index); }
+    zmm::String getString(int index) { return strings->get(index); }
+protected:
+    zmm::Ref<zmm::IntArray> types;
+    zmm::Ref<zmm::IntArray> ints;
+    zmm::Ref<zmm::Array<zmm::StringBase> > strings;
+};
+
 class SQLStorage : protected Storage
 {
 public:
@@ -84,11 +114,29 @@ public:
     virtual zmm::Ref<SQLResult> select(const char *query, int length) = 0;
     virtual int exec(const char *query, int length, bool getLastInsertId = false) = 0;
     
+    /* like select(), but drivers may fetch the rows from the server while
+     * they are read; the result should be read to the end quickly and
+     * getNumRows() is not reliable until then. The loop reading the rows
+     * may run other queries, but must not start another streaming select:
+     * the MySQL driver keeps one connection free of streaming results for
+     * the queries that are run while their rows are read. */
+    virtual zmm::Ref<SQLResult> selectStreaming(const char *query, int length)
+        { return select(query, length); }
+    
+    /* prepared statements: the drivers parse every query only once per
+     * connection and bind the parameters as values; the query must not
+     * contain '?' other than the placeholders. The default implementation
+     * quotes the parameters into the query. */
+    virtual zmm::Ref<SQLResult> selectPrepared(const char *query, zmm::Ref<SQLParams> params, bool streaming = false);
+    virtual int execPrepared(const char *query, zmm::Ref<SQLParams> params, bool getLastInsertId = false);
+    
     void dbReady();
     
     /* wrapper functions for select and exec */
     zmm::Ref<SQLResult> select(zmm::Ref<zmm::StringBuffer> buf)
         { return select(buf->c_str(), buf->length()); }
+    zmm::Ref<SQLResult> selectStreaming(zmm::Ref<zmm::StringBuffer> buf)
+        { return selectStreaming(buf->c_str(), buf->length()); }
     int exec(zmm::Ref<zmm::StringBuffer> buf, bool getLastInsertId = false)
         { return exec(buf->c_str(), buf->length(), getLastInsertId); }
     
@@ -97,10 +145,11 @@ public:
     
     virtual zmm::Ref<CdsObject> loadObject(int objectID);
     virtual int getChildCount(int contId, bool containers, bool items, bool hideFsRoot);
+    virtual zmm::Ref<DBOHash<int, CdsObject> > getFirstChildItems(zmm::Ref<zmm::IntArray> containerIDs);
     
     //virtual zmm::Ref<zmm::Array<CdsObject> > selectObjects(zmm::Ref<SelectParam> param);
     
-    virtual zmm::Ref<DBRHash<int> > getObjects(int parentID, bool withoutContainer);
+    virtual zmm::Ref<DirectoryContents> getDirectoryContents(int parentID, bool withoutContainer);
     
     virtual zmm::Ref<ChangedContainers> removeObject(int objectID, bool all);
     virtual zmm::Ref<ChangedContainers> removeObjects(zmm::Ref<DBRHash<int> > list, bool all = false);
@@ -112,6 +161,9 @@ public:
     virtual int getTotalFiles();
     
     virtual zmm::Ref<zmm::Array<CdsObject> > browse(zmm::Ref<BrowseParam> param);
+    virtual zmm::Ref<zmm::Array<CdsObject> > search(zmm::Ref<SearchParam> param);
+    virtual zmm::String getSearchCapabilities();
+    virtual zmm::String getSortCapabilities();
     virtual zmm::Ref<zmm::Array<zmm::StringBase> > getMimeTypes();
     
     //virtual zmm::Ref<CdsObject> findObjectByTitle(zmm::String title, int parentID);
@@ -119,6 +171,9 @@ public:
     virtual int findObjectIDByPath(zmm::String fullpath);
     virtual zmm::String incrementUpdateIDs(int *ids, int size);
     
+    virtual void beginBulkImport();
+    virtual void commitBulkImport();
+    
     virtual zmm::String buildContainerPath(int parentID, zmm::String title);
     virtual void addContainerChain(zmm::String path, zmm::String lastClass,
             int lastRefID, int *containerID, int *updateID);
@@ -157,6 +212,12 @@ protected:
     char table_quote_begin;
     char table_quote_end;
     
+    /* transaction functions for bulk imports, to be overriden by drivers
+     * that support transactions; they are called with the insert buffer
+     * flushed and the storage mutex locked */
+    virtual void _beginTransaction() {}
+    virtual void _commitTransaction() {}
+    
 private:
     
     class ChangedContainersStr : public Object
@@ -173,6 +234,15 @@ private:
     
     zmm::String sql_query;
     
+    /* prepared queries of the hot paths, built by init() */
+    zmm::String sql_load_object;
+    zmm::String sql_object_type;
+    zmm::String sql_child_count;
+    zmm::String sql_find_by_location;
+    
+    /* helper for the default selectPrepared() and execPrepared() */
+    zmm::Ref<zmm::StringBuffer> bindParams(const char *query, zmm::Ref<SQLParams> params);
+    
     /* helper for createObjectFromRow() */
     zmm::String getRealLocation(int parentID, zmm::String location);
     
@@ -183,6 +253,14 @@ private:
     
     int _ensurePathExistence(zmm::String path, int *changedContainer);
     
+    /* helpers for the stored child counts */
+    int _childCount(int contId, int containerCount, int itemCount, bool containers, bool items, bool hideFsRoot);
+    void _changeChildCount(int parentID, int objectType, int delta, bool buffered = false);
+    /* the stored child counts are only checked on startup if they were
+     * changed without a clean shutdown afterwards */
+    void _markChildCountsDirty();
+    void _checkChildCounts();
+    
     /* helper class and helper function for addObject and updateObject */
     class AddUpdateTable : public Object
     {
@@ -200,6 +278,30 @@ private:
     };
     zmm::Ref<zmm::Array<AddUpdateTable> > _addUpdateObject(zmm::Ref<CdsObject> obj, bool isUpdate, int *changedContainer);
     
+    /* helpers for the metadata table, which holds one row per metadata
+     * entry of every object that stores its own metadata */
+    bool _storesMetadata(zmm::Ref<zmm::Array<AddUpdateTable> > data);
+    void _addMetadataRows(int objectID, zmm::Ref<Dictionary> metadata, bool buffered);
+    void _fillMetadataTable();
+    
+    /* helpers for search() */
+    void _searchCondition(zmm::Ref<SearchExpression> exp, zmm::Ref<zmm::StringBuffer> qb);
+    void _searchRelation(zmm::Ref<SearchExpression> exp, zmm::Ref<zmm::StringBuffer> qb);
+    void _searchComparison(zmm::String column, search_operator_t op, zmm::String value, zmm::Ref<zmm::StringBuffer> qb);
+    zmm::String _likePattern(zmm::String value, bool anyPrefix, bool anySuffix);
+    zmm::String _searchScope(int containerID);
+    
+    /* helpers for the typed sort columns, which hold a copy of the sortable
+     * properties of every item so that sorted pages can be read from an
+     * index */
+    void _putSortColumns(zmm::Ref<CdsItem> item, zmm::Ref<Dictionary> columns, bool isUpdate);
+    zmm::String _orderBy(zmm::Ref<zmm::Array<SortCriterion> > sortCriteria);
+    void _fillSortColumns();
+    
+    /* converts metadata, auxdata and resources written by older versions
+     * to the packed encoding */
+    void _packObjectData();
+    
     /* helper for removeObject(s) */
     void _removeObjects(zmm::Ref<zmm::StringBuffer> objectIDs, int offset);
     zmm::Ref<ChangedContainersStr> _recursiveRemove(zmm::Ref<zmm::StringBuffer> items, zmm::Ref<zmm::StringBuffer> containers, bool all);
@@ -238,6 +340,10 @@ private:
     inline bool cacheOn() { return cache != nil; }
     void addObjectToCache(zmm::Ref<CdsObject> object, bool dontLock = false);
     
+    /* index of the virtual containers, used by addContainerChain */
+    zmm::Ref<VirtualContainerIndex> containerIndex;
+    void _loadContainerIndex();
+    
     inline bool doInsertBuffering() { return insertBufferOn; }
     void addToInsertBuffer(zmm::Ref<zmm::StringBuffer> query);
     void flushInsertBuffer(bool dontLock = false);
@@ -251,6 +357,18 @@ private:
     int insertBufferStatementCount;
     int insertBufferByteCount;
     zmm::Ref<Mutex> insertBufferMutex;
+    
+    /* bulk import session state, protected by bulkImportMutex */
+    void _restartBulkTransaction(bool commit, bool begin);
+    zmm::String _incrementUpdateIDs(int *ids, int size);
+    int bulkImportDepth;
+    int bulkImportObjectCount;
+    zmm::Ref<DBRHash<int> > bulkUpdateIDs;
+    zmm::Ref<Mutex> bulkImportMutex;
+    
+    /// \brief child_count_check is set, protected by childCountMutex
+    bool childCountsDirty;
+    zmm::Ref<Mutex> childCountMutex;
 };
 
 #endif // __SQL_STORAGE_H__
@@ -34,63 +34,75 @@
 
 #ifndef __SQLITE3_CREATE_SQL_H__
 #define __SQLITE3_CREATE_SQL_H__
-#define SL3_CREATE_SQL_INFLATED_SIZE 2933
-#define SL3_CREATE_SQL_DEFLATED_SIZE 760
+#define SL3_CREATE_SQL_INFLATED_SIZE 4145
+#define SL3_CREATE_SQL_DEFLATED_SIZE 933
 
 /* begin binary data: */
-const unsigned char sqlite3_create_sql[] = /* 760 */
-{0x78,0x9C,0xB5,0x56,0x5B,0x6F,0xDA,0x30,0x14,0x7E,0xE7,0x57,0x58,0x79,0x09
-,0x95,0xD8,0x04,0xDD,0x2A,0x6D,0xEA,0x53,0x1A,0xDC,0x2A,0x1A,0x4D,0xBA,0x10
-,0xA6,0xED,0xC9,0x32,0x89,0x01,0xAF,0xB9,0xC9,0x71,0xA2,0xF2,0xEF,0x67,0x27
-,0x90,0x0B,0xB9,0x90,0x4D,0x9D,0x84,0x10,0x9C,0xF3,0x9D,0x8B,0xCF,0xF9,0x7C
-,0x8E,0x1F,0xE0,0x93,0x61,0x02,0xC7,0xD6,0xCC,0xB5,0xA6,0x3B,0x86,0x65,0xDE
-,0x4F,0x74,0x1B,0x6A,0x0E,0x04,0x8E,0xF6,0xB0,0x82,0x40,0x09,0x38,0x72,0xBD
-,0x04,0x45,0xDB,0xDF,0xC4,0xE5,0x0A,0x98,0x4E,0x00,0x50,0xA8,0xA7,0x00,0x1A
-,0x72,0xB2,0x27,0x0C,0xC4,0x8C,0x06,0x98,0x1D,0xC1,0x2B,0x39,0xCE,0xA4,0x8E
-,0x91,0x1D,0xAA,0xEB,0x3D,0xB2,0xC3,0xA9,0xCF,0x81,0xB9,0x59,0xAD,0x72,0x40
-,0x8C,0x19,0x09,0x79,0x03,0x63,0x5A,0x4E,0xAE,0x2F,0xC1,0xEA,0x5C,0xCD,0xB1
-,0x45,0x54,0xC4,0x8F,0x31,0x51,0x00,0xA7,0xE1,0x51,0x58,0x80,0x34,0x4C,0xE8
-,0x3E,0x24,0x5E,0x69,0x96,0x43,0xD3,0x38,0x8C,0x91,0xEB,0xE3,0x24,0x51,0x40
-,0x86,0x99,0x7B,0xC0,0x6C,0xFA,0x65,0x7E,0xD3,0x8E,0xEF,0xB9,0x88,0x53,0xEE
-,0x93,0x0A,0x76,0x7B,0x77,0xD7,0x81,0xF3,0x23,0x17,0x73,0x1A,0x85,0x22,0x30
-,0x79,0xE3,0xFD,0x7A,0x74,0xC0,0xC9,0xA1,0x3A,0x4B,0x99,0x5D,0xCB,0x20,0x20
-,0x1C,0x7B,0x98,0xE3,0x3E,0x87,0x38,0x7D,0x1B,0x52,0x33,0x92,0x44,0x29,0x73
-,0x49,0xD2,0x07,0x48,0x63,0x61,0x4E,0xC6,0x15,0x36,0xA0,0x01,0x39,0x95,0xF5
-,0x5C,0x85,0xCF,0x5D,0xC5,0xDA,0xF9,0x78,0x9F,0x74,0x1C,0xAE,0xED,0x78,0x51
-,0x38,0xE6,0x0C,0xBB,0xAF,0x28,0x4C,0x83,0x2D,0x61,0x03,0x24,0x48,0x08,0xCB
-,0xA8,0x5B,0x24,0x3B,0xD8,0x06,0xDD,0x32,0xD7,0x82,0x9D,0x86,0xE9,0x00,0xA5
-,0xE2,0x21,0xA2,0xDB,0xDD,0x2B,0x5A,0x28,0xE0,0xD1,0xB2,0xA1,0xF1,0x64,0x82
-,0x6F,0xF0,0x17,0x98,0x9E,0xB9,0x77,0x03,0x6C,0xF8,0x08,0x6D,0x68,0xEA,0x70
-,0x5D,0xB7,0x12,0xEC,0x55,0x72,0xB5,0x65,0x82,0x25,0x5C,0x41,0x41,0x72,0x5D
-,0x5B,0xEB,0xDA,0x12,0x4A,0xC9,0xE6,0x65,0xA9,0x55,0x92,0x6B,0xB1,0x6F,0x2F
-,0x63,0x57,0xB4,0x7E,0x8F,0xF0,0x93,0x9B,0xFB,0x89,0x61,0xAE,0xA1,0xED,0x00
-,0x11,0xDE,0x6A,0x5D,0xC3,0x1F,0xDA,0x6A,0x03,0xD7,0xD3,0x0F,0x8B,0x59,0x51
-,0x29,0x20,0x7F,0xCD,0xCF,0x7F,0xC6,0x7C,0x97,0xE0,0xAF,0x75,0xF9,0xB8,0xB0
-,0xF3,0x7A,0x54,0xF1,0x51,0x0B,0xFD,0x47,0x37,0x0A,0x39,0xA6,0x21,0x61,0xAA
-,0x90,0xD9,0x51,0xC4,0xD5,0xFF,0x99,0xC5,0xA2,0xE6,0xA4,0x2F,0x89,0x17,0x1D
-,0x2C,0x29,0x13,0xE2,0x88,0x1D,0xFF,0x3D,0x99,0xCE,0x89,0x88,0x5D,0x4E,0x33
-,0xC1,0x60,0x4E,0x82,0x11,0x63,0x51,0xA2,0xE5,0x2C,0x69,0x90,0xBD,0x31,0xC0
-,0x12,0x2E,0x6E,0xEF,0x00,0xA0,0xCE,0xC6,0x76,0x0A,0x3D,0x37,0xA2,0x45,0xC7
-,0xCB,0x71,0xFE,0x57,0x8C,0x6C,0xD5,0x41,0x9E,0x96,0x85,0xD8,0x47,0x09,0xE1
-,0x62,0x3C,0xEF,0x4F,0x85,0x10,0x87,0x6E,0xCE,0x95,0x5A,0x35,0x9A,0x87,0xCE
-,0xB0,0x9F,0xF6,0x1D,0xBA,0xEB,0x0E,0xB4,0x03,0x9E,0xC8,0xA0,0x7A,0x5B,0x94
-,0x11,0x96,0x88,0x22,0xCB,0xBE,0x7F,0x52,0xBB,0xD2,0xC5,0x29,0x8F,0x12,0x17
-,0x87,0x23,0xFA,0x25,0x0A,0x34,0xBC,0xC6,0xA4,0x1F,0xE4,0x93,0x8C,0xF8,0x55
-,0xFA,0x8B,0xF9,0x65,0x4F,0x25,0x28,0x88,0x3C,0x32,0x80,0x11,0xEC,0x4C,0x45
-,0xDE,0xD9,0xD5,0x0D,0x77,0xA0,0x9E,0x47,0xC2,0x6B,0xA8,0xBC,0x42,0xA2,0xAC
-,0x63,0x36,0x92,0xD8,0x96,0x5C,0xA6,0x47,0x77,0x94,0x78,0x63,0x0C,0x62,0x59
-,0xE1,0x84,0x8B,0x41,0x37,0x90,0x46,0x6B,0xD9,0x5C,0xDB,0xA4,0x31,0xE6,0x07
-,0x51,0xEC,0xDE,0xC5,0xC6,0xA3,0xD4,0x3D,0xC8,0x04,0x47,0x84,0x2C,0xD6,0xD0
-,0xC5,0x5D,0x39,0xF7,0x3D,0xEF,0x68,0xF3,0x82,0x9C,0xFA,0xFC,0xFE,0x97,0xC4
-,0x30,0x97,0xF0,0x27,0x68,0x78,0x42,0xC5,0x7E,0x92,0x66,0x0D,0xF9,0xB4,0x90
-,0x0F,0xDB,0x96,0xFB,0xA5,0x6D,0x5E,0xAA,0x66,0xB5,0xF7,0xD2,0xEC,0xFC,0xCE
-,0xE9,0x70,0x5B,0x83,0xB5,0xBD,0xD5,0x94,0x1D,0xA6,0xE5,0xAB,0xA7,0x08,0xDA
-,0x36,0x6F,0x3C,0x8B,0x66,0x65,0x6A,0x1D,0xAE,0xEA,0x4F,0x85,0xB6,0x9F,0xBA
-,0xB6,0xC3,0xF8,0x72,0x10,0x20,0x39,0x5A,0x0A,0x27,0x97,0xAA,0xA9,0x50,0x55
-,0x1E,0x36,0xA6,0xF1,0x7D,0x53,0x73,0x54,0x72,0xA3,0x60,0xC2,0xC9,0xC7,0x59
-,0x3A,0x2D,0xA4,0xC3,0xAD,0xA9,0x1E,0x33,0xED,0x63,0x54,0x3A,0xE9,0xC3,0x7A
-,0x7E,0x36,0x9C,0xFB,0xC9,0x1F,0x6D,0x27,0x91,0x85};
-/* end binary data. size = 760 bytes */
+const unsigned char sqlite3_create_sql[] = /* 933 */
+{0x78,0x9C,0xC5,0x57,0x5B,0x6F,0xDA,0x30,0x14,0x7E,0xE7,0x57,0x58,0xBC,0x40
+,0x25,0x36,0x41,0xB5,0x6A,0x9B,0xFA,0x94,0x82,0x5B,0xA1,0xD1,0xD0,0x41,0x98
+,0xB6,0x27,0xCB,0x24,0xA6,0x78,0xCD,0x05,0x39,0x0E,0x2A,0xFB,0xF5,0xB3,0xE3
+,0xDC,0x2F,0x4E,0x36,0x75,0x9A,0x54,0x55,0xED,0xB9,0x7C,0xE7,0xF8,0xF8,0x7C
+,0xC7,0x27,0x77,0xF0,0x61,0x69,0x02,0x6B,0x63,0x98,0x5B,0x63,0x6E,0x2D,0xD7
+,0xE6,0xED,0x60,0xBE,0x81,0x86,0x05,0x81,0x65,0xDC,0xAD,0x20,0x18,0x7A,0x1C
+,0xD9,0x4E,0x88,0x82,0xFD,0x4F,0x62,0xF3,0x21,0x18,0x0F,0x00,0x18,0x52,0x67
+,0x08,0xA8,0xCF,0xC9,0x33,0x61,0xE0,0xC4,0xA8,0x87,0xD9,0x05,0xBC,0x90,0xCB
+,0x44,0xEA,0x18,0x39,0xA0,0xA2,0xDE,0x21,0x07,0x1C,0xB9,0x1C,0x98,0xBB,0xD5
+,0x2A,0x36,0x38,0x61,0x46,0x7C,0x5E,0xB2,0x31,0xD7,0x56,0xAC,0xCF,0x8C,0x47
+,0xD3,0x51,0x6C,0xAB,0xA2,0x22,0x7E,0x39,0x91,0x21,0xE0,0xD4,0xBF,0x08,0x0F
+,0x10,0xF9,0x21,0x7D,0xF6,0x89,0x93,0xB9,0xC5,0xA6,0xD1,0xC9,0x3F,0x21,0xDB
+,0xC5,0x61,0x38,0x04,0x67,0xCC,0xEC,0x23,0x66,0xE3,0x4F,0xD3,0xAB,0x7A,0x7C
+,0xC7,0x46,0x9C,0x72,0x97,0xE4,0x66,0xD7,0x37,0x37,0x0D,0x76,0x6E,0x60,0x63
+,0x4E,0x03,0x5F,0x04,0x26,0xAF,0xBC,0x5D,0x8F,0x8E,0x38,0x3C,0xE6,0x67,0xC9
+,0xB2,0xAB,0x39,0x78,0x84,0x63,0x07,0x73,0xDC,0x06,0x88,0xA3,0x57,0x9D,0x9A
+,0x91,0x30,0x88,0x98,0x4D,0xC2,0x36,0x83,0xE8,0x24,0xDC,0x49,0xBF,0xC2,0x7A
+,0xD4,0x23,0x49,0x59,0xD3,0x2A,0x7C,0x68,0x2A,0xD6,0xC1,0xC5,0xCF,0x61,0xC3
+,0xE1,0xEA,0xC0,0x33,0x05,0xCC,0x19,0xB6,0x5F,0x90,0x1F,0x79,0x7B,0xC2,0x34
+,0x4D,0x10,0x12,0x76,0xA6,0xB6,0x4A,0x56,0x7F,0x0D,0xF6,0x91,0xBA,0x0E,0xB2
+,0x03,0x9F,0x63,0xEA,0x13,0x16,0xF6,0x38,0x9C,0x72,0xA1,0x9C,0x78,0x7D,0xAC
+,0x45,0x3F,0xC8,0xBA,0x75,0xE5,0x11,0xF7,0x17,0x66,0x9C,0x86,0xBC,0x9F,0xA9
+,0xBB,0x8F,0xBC,0x2E,0x4B,0x71,0xA7,0x28,0xA4,0xBF,0x48,0x7B,0xA5,0xE6,0x6B
+,0x73,0x2B,0xD8,0xB9,0x34,0x2D,0x71,0xAE,0x8C,0x87,0x88,0xEE,0x0F,0x2F,0x68
+,0x36,0x04,0xF7,0xEB,0x0D,0x5C,0x3E,0x98,0xE0,0x0B,0xFC,0x01,0xC6,0x29,0xF7
+,0xAE,0xC0,0x06,0xDE,0xC3,0x0D,0x34,0xE7,0x70,0x5B,0xF4,0x12,0xEC,0x1D,0xC6
+,0xEA,0xB5,0x09,0x16,0x70,0x05,0x05,0xC9,0xE7,0xC6,0x76,0x6E,0x2C,0xA0,0x94
+,0xEC,0x9E,0x16,0x46,0x2E,0xE9,0x8A,0x7D,0x5D,0x8D,0x9D,0xD3,0xFA,0x2D,0xC2
+,0x0F,0xAE,0x6E,0x07,0x4B,0x73,0x0B,0x37,0x16,0x10,0xE1,0xD7,0xB5,0x31,0xF4
+,0xCD,0x58,0xED,0xE0,0x76,0xFC,0x6E,0x36,0x51,0x95,0x02,0xF2,0xAF,0x69,0xFA
+,0x4F,0x9F,0xDF,0x99,0xF1,0xE7,0xB2,0x5C,0x87,0xD3,0x2F,0xA9,0x69,0x31,0x27
+,0xF1,0x33,0x52,0xFA,0xF7,0x59,0x0F,0x8F,0x84,0x6C,0x13,0x04,0x7C,0xF4,0xFF
+,0x72,0x9C,0x15,0x42,0xB4,0xA5,0xF8,0x34,0x07,0x0B,0xCA,0x84,0x38,0x60,0x97
+,0xBF,0x4E,0x75,0xAA,0x4F,0xB5,0xF1,0xAD,0xC1,0x36,0xA7,0x67,0x12,0x13,0xB8
+,0xC7,0x83,0x23,0xAD,0xE5,0x94,0x2E,0x31,0xAD,0xF4,0x34,0x84,0xBC,0xCE,0xEF
+,0xA2,0x41,0xB1,0xCF,0xEB,0x29,0xB4,0x70,0xAD,0xD6,0xE8,0xD5,0x87,0xF2,0x8F
+,0x7A,0xBD,0x56,0x07,0x79,0x5A,0xE6,0x63,0x17,0x85,0x84,0x8B,0x87,0xEF,0x39
+,0x29,0x84,0x38,0x74,0x79,0x62,0x17,0xAA,0x51,0x3E,0xF4,0x19,0xBB,0x51,0xDB
+,0xA1,0x9B,0xD8,0x55,0x0F,0x98,0xB4,0xCA,0xC8,0xD9,0xA3,0xB3,0x18,0xBC,0xA2
+,0xC8,0xB2,0x2B,0x3E,0x8E,0x9A,0xD2,0xC5,0x11,0x0F,0x42,0x1B,0xFB,0x3D,0xEE
+,0x4B,0x14,0x48,0xBF,0x20,0x48,0x1C,0xE4,0x92,0x33,0x71,0xF3,0xF4,0x67,0xD3
+,0xEA,0x9D,0x4A,0x23,0x2F,0x70,0x88,0xC6,0x46,0xF4,0x6E,0x24,0xF2,0x3E,0x77
+,0xEE,0x0E,0x47,0xEA,0x38,0xC4,0xEF,0xB2,0x8A,0x2B,0x24,0xCA,0xDA,0xE7,0xAD
+,0x17,0x7B,0x08,0x97,0xE9,0xD1,0x03,0x25,0x4E,0x1F,0x87,0x93,0xAC,0x70,0xC8
+,0xC5,0x08,0xD5,0xA4,0x51,0x7B,0xBB,0xBA,0x76,0x94,0x13,0xE6,0x47,0x51,0xEC
+,0xD6,0x95,0x81,0x07,0x91,0x7D,0x94,0x09,0xF6,0x08,0xA9,0x1E,0xF8,0x0A,0x57
+,0xD2,0x7B,0x8F,0x6F,0xB4,0x4C,0x90,0xE4,0x9E,0xFF,0x25,0x49,0xF2,0x8D,0x4A
+,0x75,0x5D,0xCC,0xD6,0x86,0xF5,0x47,0xD5,0x82,0x05,0xA2,0xC8,0xFC,0x82,0x7C
+,0xEC,0xE9,0xA6,0x41,0x6E,0x98,0x50,0x28,0x2E,0x9D,0x66,0x5E,0xA4,0x59,0xB4
+,0x0D,0x8A,0x24,0xAB,0xB7,0x2F,0xC4,0xD2,0x5C,0xC0,0xEF,0xA0,0x84,0x84,0xD4
+,0x0A,0x20,0xDD,0x4A,0xF2,0xB1,0x92,0xEB,0x7D,0xB3,0x27,0xBC,0xEE,0x9E,0xA9
+,0x26,0x85,0x95,0x7C,0x92,0xAE,0xD2,0x0D,0xB0,0x05,0xB3,0x3A,0x5A,0x41,0xD9
+,0xE0,0x9A,0x2D,0xD6,0x2A,0x68,0xDD,0xBD,0xB4,0x79,0x4F,0xB2,0xD4,0x1A,0xA0
+,0x8A,0xDB,0x68,0x1D,0xA7,0xA8,0x6D,0x70,0xAE,0x4E,0x44,0x24,0x67,0xAC,0x02
+,0xA9,0xAA,0xC6,0x42,0x95,0x23,0xEC,0xCC,0xE5,0xD7,0x5D,0x01,0x28,0x23,0x89
+,0xA2,0x44,0x82,0x91,0x4A,0xC7,0x4A,0xAA,0xBF,0x9A,0x7C,0x5F,0xAE,0x1F,0x23
+,0xD7,0x35,0x60,0xE4,0xCD,0xA9,0xDA,0x30,0x71,0x4F,0xC5,0xE3,0x44,0xAC,0xF3
+,0x4C,0xF9,0x50,0x75,0x2D,0x11,0x6A,0x52,0x66,0x4D,0xC7,0x69,0x02,0xC6,0x55
+,0xE7,0xE8,0x3A,0x4D,0xD3,0x5D,0x55,0x2C,0xB9,0xC0,0x77,0x40,0x49,0x93,0x1E
+,0x48,0x6A,0xC3,0xD7,0x61,0x15,0x3E,0x04,0xFA,0xE0,0xC9,0xCF,0x80,0x6E,0x38
+,0x69,0xD5,0xA7,0x66,0xB2,0x63,0x75,0x68,0x1D,0x2D,0x5D,0xC5,0x93,0xDF,0x1E
+,0x3A,0xB8,0xF4,0xFB,0x44,0x42,0xAD,0x1F,0x1F,0x97,0xD6,0xED,0xE0,0x37,0x63
+,0x2C,0x1F,0x0C};
+/* end binary data. size = 933 bytes */
 
 #endif // __SQLITE3_CREATE_SQL_H__
 
@@ -57,11 +57,93 @@
 #define SQLITE3_UPDATE_2_3_2 "CREATE INDEX mt_cds_object_service_id ON mt_cds_object(service_id)"
 #define SQLITE3_UPDATE_2_3_3 "UPDATE \"mt_internal_setting\" SET \"value\"='3' WHERE \"key\"='db_version' AND \"value\"='2'"
 
+// updates 3->4
+#define SQLITE3_UPDATE_3_4_1 "ALTER TABLE \"mt_cds_object\" ADD \"child_containers\" integer NOT NULL default '0'"
+#define SQLITE3_UPDATE_3_4_2 "ALTER TABLE \"mt_cds_object\" ADD \"child_items\" integer NOT NULL default '0'"
+#define SQLITE3_UPDATE_3_4_3 "UPDATE \"mt_cds_object\" SET \"child_containers\"=(SELECT COUNT(*) FROM \"mt_cds_object\" \"c\" WHERE \"c\".\"parent_id\"=\"mt_cds_object\".\"id\" AND \"c\".\"object_type\"=1), \"child_items\"=(SELECT COUNT(*) FROM \"mt_cds_object\" \"c\" WHERE \"c\".\"parent_id\"=\"mt_cds_object\".\"id\" AND (\"c\".\"object_type\" & 2)=2)"
+#define SQLITE3_UPDATE_3_4_4 "UPDATE \"mt_internal_setting\" SET \"value\"='4' WHERE \"key\"='db_version' AND \"value\"='3'"
+
+// updates 4->5; the metadata table is filled by SQLStorage::dbReady()
+#define SQLITE3_UPDATE_4_5_1 "CREATE TABLE \"mt_metadata\" ( \"item_id\" integer NOT NULL, \"property_name\" varchar(255) NOT NULL, \"property_value\" text NOT NULL, CONSTRAINT \"mt_metadata_ibfk_1\" FOREIGN KEY (\"item_id\") REFERENCES \"mt_cds_object\" (\"id\") ON DELETE CASCADE ON UPDATE CASCADE )"
+#define SQLITE3_UPDATE_4_5_2 "CREATE INDEX mt_metadata_item_id ON mt_metadata(item_id)"
+#define SQLITE3_UPDATE_4_5_3 "CREATE INDEX mt_metadata_property ON mt_metadata(property_name,property_value)"
+#define SQLITE3_UPDATE_4_5_4 "INSERT INTO \"mt_internal_setting\" VALUES('metadata_rebuild', '1')"
+#define SQLITE3_UPDATE_4_5_5 "UPDATE \"mt_internal_setting\" SET \"value\"='5' WHERE \"key\"='db_version' AND \"value\"='4'"
+
+// updates 5->6; the sort columns are filled by SQLStorage::dbReady()
+#define SQLITE3_UPDATE_5_6_1 "ALTER TABLE \"mt_cds_object\" ADD \"dc_date\" varchar(255) default NULL"
+#define SQLITE3_UPDATE_5_6_2 "ALTER TABLE \"mt_cds_object\" ADD \"upnp_artist\" varchar(255) default NULL"
+#define SQLITE3_UPDATE_5_6_3 "ALTER TABLE \"mt_cds_object\" ADD \"upnp_album\" varchar(255) default NULL"
+#define SQLITE3_UPDATE_5_6_4 "ALTER TABLE \"mt_cds_object\" ADD \"res_size\" integer default NULL"
+#define SQLITE3_UPDATE_5_6_5 "CREATE INDEX mt_cds_object_sort_title ON mt_cds_object(parent_id,dc_title)"
+#define SQLITE3_UPDATE_5_6_6 "CREATE INDEX mt_cds_object_sort_date ON mt_cds_object(parent_id,dc_date)"
+#define SQLITE3_UPDATE_5_6_7 "CREATE INDEX mt_cds_object_sort_artist ON mt_cds_object(parent_id,upnp_artist)"
+#define SQLITE3_UPDATE_5_6_8 "CREATE INDEX mt_cds_object_sort_album ON mt_cds_object(parent_id,upnp_album)"
+#define SQLITE3_UPDATE_5_6_9 "CREATE INDEX mt_cds_object_sort_track ON mt_cds_object(parent_id,track_number)"
+#define SQLITE3_UPDATE_5_6_10 "CREATE INDEX mt_cds_object_sort_size ON mt_cds_object(parent_id,res_size)"
+#define SQLITE3_UPDATE_5_6_11 "INSERT INTO \"mt_internal_setting\" VALUES('sort_rebuild', '1')"
+#define SQLITE3_UPDATE_5_6_12 "UPDATE \"mt_internal_setting\" SET \"value\"='6' WHERE \"key\"='db_version' AND \"value\"='5'"
+
+// updates 6->7; the object data is converted by SQLStorage::dbReady()
+#define SQLITE3_UPDATE_6_7_1 "INSERT INTO \"mt_internal_setting\" VALUES('pack_rebuild', '1')"
+#define SQLITE3_UPDATE_6_7_2 "UPDATE \"mt_internal_setting\" SET \"value\"='7' WHERE \"key\"='db_version' AND \"value\"='6'"
+
 #define SL3_INITITAL_QUEUE_SIZE 20
 
+// milliseconds a connection waits for a lock held by another connection
+#define SL3_BUSY_TIMEOUT 5000
+
+// tasks waiting longer than this (in milliseconds) are logged
+#define SL3_SLOW_WAIT_MILLIS 100
+
+// maximum number of prepared statements per connection
+#define SL3_MAX_STATEMENTS 64
+#define SL3_STATEMENT_HASH_CAPACITY 149
+
 using namespace zmm;
 using namespace mxml;
 
+/// \brief binds the parameters to a prepared statement
+/// \return SQLITE_OK or the error code of the failed bind
+static int bindParams(sqlite3_stmt *stmt, Ref<SQLParams> params)
+{
+    int ret = sqlite3_clear_bindings(stmt);
+    for (int i = 0; i < params->size() && ret == SQLITE_OK; i++)
+    {
+        // the parameter indices start with 1
+        switch (params->getType(i))
+        {
+            case SQL_PARAM_INT:
+                ret = sqlite3_bind_int(stmt, i + 1, params->getInt(i));
+                break;
+            case SQL_PARAM_UINT:
+                ret = sqlite3_bind_int64(stmt, i + 1, params->getUInt(i));
+                break;
+            case SQL_PARAM_STRING:
+            {
+                String val = params->getString(i);
+                ret = sqlite3_bind_text(stmt, i + 1, val.c_str(), val.length(), SQLITE_STATIC);
+                break;
+            }
+            default:
+                ret = sqlite3_bind_null(stmt, i + 1);
+        }
+    }
+    return ret;
+}
+
+/// \brief removes the WAL files of the database, they must not be applied
+/// to a replaced database file
+static void unlinkWalFiles(String dbFilePath)
+{
+    String walFiles[] = { dbFilePath + "-wal", dbFilePath + "-shm" };
+    for (int i = 0; i < 2; i++)
+    {
+        if (unlink(walFiles[i].c_str()) != 0 && errno != ENOENT)
+            log_warning("could not remove %s: %s\n", walFiles[i].c_str(), mt_strerror(errno).c_str());
+    }
+}
+
 Sqlite3Storage::Sqlite3Storage() : SQLStorage()
 {
     shutdownFlag = false;
@@ -71,7 +153,25 @@ Sqlite3Storage::Sqlite3Storage() : SQLStorage()
     sqliteMutex = Ref<Mutex>(new Mutex());
     cond = Ref<Cond>(new Cond(sqliteMutex));
     insertBuffer = nil;
+    inTransaction = false;
+    transactionID = 0;
+    transactionMutex = Ref<Mutex>(new Mutex());
     dirty = false;
+    writerStatements = Ref<Sqlite3StatementCache>(new Sqlite3StatementCache());
+    readers = NULL;
+    readerStatements = nil;
+    freeReaders = NULL;
+    readerCount = 0;
+    readersFree = 0;
+    readersOpen = false;
+    readerMutex = Ref<Mutex>(new Mutex());
+    readerCond = Ref<Cond>(new Cond(readerMutex));
+    writerTasks = 0;
+    writerWaitTotal = 0;
+    writerWaitMax = 0;
+    readerTasks = 0;
+    readerWaitTotal = 0;
+    readerWaitMax = 0;
 }
 
 void Sqlite3Storage::init()
@@ -80,6 +180,9 @@ void Sqlite3Storage::init()
     
     int ret;
     
+    if (pthread_key_create(&transactionKey, NULL))
+        throw _Exception(_("could not create pthread_key"));
+    
     AUTOLOCK(sqliteMutex);
     /*
     pthread_attr_t attr;
@@ -180,7 +283,33 @@ void Sqlite3Storage::init()
     }
     
     
-    _exec("PRAGMA locking_mode = EXCLUSIVE");
+    int readConnections = ConfigManager::getInstance()->getIntOption(CFG_SERVER_STORAGE_SQLITE_READ_CONNECTIONS);
+#if SQLITE_VERSION_NUMBER < 3007006
+    if (readConnections > 0)
+    {
+        log_warning("sqlite3 library is too old for WAL mode, disabling the read connections\n");
+        readConnections = 0;
+    }
+#endif
+    if (readConnections > 0)
+    {
+        // WAL lets the read-only connections run next to the writer;
+        // sqlite silently keeps the old mode if it can't switch
+        Ref<StringBuffer> walQuery(new StringBuffer());
+        *walQuery << "PRAGMA journal_mode = WAL";
+        Ref<SQLResult> res = SQLStorage::select(walQuery);
+        Ref<SQLRow> row;
+        if (res == nil || (row = res->nextRow()) == nil || row->col(0) != "wal")
+        {
+            log_warning("could not switch the sqlite3 database to WAL mode, disabling the read connections\n");
+            readConnections = 0;
+        }
+    }
+    if (readConnections == 0)
+    {
+        _exec("PRAGMA journal_mode = DELETE");
+        _exec("PRAGMA locking_mode = EXCLUSIVE");
+    }
     int synchronousOption = ConfigManager::getInstance()->getIntOption(CFG_SERVER_STORAGE_SQLITE_SYNCHRONOUS);
     Ref<StringBuffer> buf(new StringBuffer());
     *buf << "PRAGMA synchronous = " << synchronousOption;
@@ -215,9 +344,60 @@ void Sqlite3Storage::init()
         dbVersion = _("3");
     }
     
+    if (dbVersion == "3")
+    {
+        log_info("Doing an automatic database upgrade from database version 3 to version 4...\n");
+        _exec(SQLITE3_UPDATE_3_4_1);
+        _exec(SQLITE3_UPDATE_3_4_2);
+        _exec(SQLITE3_UPDATE_3_4_3);
+        _exec(SQLITE3_UPDATE_3_4_4);
+        log_info("database upgrade successful.\n");
+        dbVersion = _("4");
+    }
+    
+    if (dbVersion == "4")
+    {
+        log_info("Doing an automatic database upgrade from database version 4 to version 5...\n");
+        _exec(SQLITE3_UPDATE_4_5_1);
+        _exec(SQLITE3_UPDATE_4_5_2);
+        _exec(SQLITE3_UPDATE_4_5_3);
+        _exec(SQLITE3_UPDATE_4_5_4);
+        _exec(SQLITE3_UPDATE_4_5_5);
+        log_info("database upgrade successful.\n");
+        dbVersion = _("5");
+    }
+    
+    if (dbVersion == "5")
+    {
+        log_info("Doing an automatic database upgrade from database version 5 to version 6...\n");
+        _exec(SQLITE3_UPDATE_5_6_1);
+        _exec(SQLITE3_UPDATE_5_6_2);
+        _exec(SQLITE3_UPDATE_5_6_3);
+        _exec(SQLITE3_UPDATE_5_6_4);
+        _exec(SQLITE3_UPDATE_5_6_5);
+        _exec(SQLITE3_UPDATE_5_6_6);
+        _exec(SQLITE3_UPDATE_5_6_7);
+        _exec(SQLITE3_UPDATE_5_6_8);
+        _exec(SQLITE3_UPDATE_5_6_9);
+        _exec(SQLITE3_UPDATE_5_6_10);
+        _exec(SQLITE3_UPDATE_5_6_11);
+        _exec(SQLITE3_UPDATE_5_6_12);
+        log_info("database upgrade successful.\n");
+        dbVersion = _("6");
+    }
+    
+    if (dbVersion == "6")
+    {
+        log_info("Doing an automatic database upgrade from database version 6 to version 7...\n");
+        _exec(SQLITE3_UPDATE_6_7_1);
+        _exec(SQLITE3_UPDATE_6_7_2);
+        log_info("database upgrade successful.\n");
+        dbVersion = _("7");
+    }
+    
     /* --- --- ---*/
     
-    if (! string_ok(dbVersion) || dbVersion != "3")
+    if (! string_ok(dbVersion) || dbVersion != "7")
         throw _Exception(_("The database seems to be from a newer version!"));
     
     
@@ -234,12 +414,15 @@ void Sqlite3Storage::init()
         btask->waitForTask();
     }
     
+    if (readConnections > 0)
+        openReaders(readConnections);
+    
     dbReady();
 }
 
 void Sqlite3Storage::_exec(const char *query)
 {
-    exec(query, strlen(query), false);
+    _exec(query, nil, false);
 }
 
 String Sqlite3Storage::quote(String value)
@@ -258,20 +441,60 @@ String Sqlite3Storage::getError(String query, String error, sqlite3 *db)
 }
 
 Ref<SQLResult> Sqlite3Storage::select(const char *query, int length)
+{
+    return _select(query, nil);
+}
+
+Ref<SQLResult> Sqlite3Storage::selectPrepared(const char *query, Ref<SQLParams> params, bool streaming)
+{
+    return _select(query, params);
+}
+
+Ref<SQLResult> Sqlite3Storage::_select(const char *query, Ref<SQLParams> params)
 {
     //fprintf(stdout, "%s\n",query);
     //fflush(stdout);
-    Ref<SLSelectTask> ptask (new SLSelectTask(query));
+    Ref<SLSelectTask> ptask (new SLSelectTask(query, params));
+    
+    // run the select on the calling thread if a read connection is available
+    int reader = (wroteInTransaction() ? -1 : checkoutReader());
+    if (reader >= 0)
+    {
+        try
+        {
+            ptask->setStatementCache(readerStatements->get(reader));
+            ptask->run(&readers[reader], this);
+        }
+        catch (...)
+        {
+            checkinReader(reader);
+            throw;
+        }
+        checkinReader(reader);
+        return ptask->getResult();
+    }
+    
     addTask(RefCast(ptask, SLTask));
     ptask->waitForTask();
     return ptask->getResult();
 }
 
 int Sqlite3Storage::exec(const char *query, int length, bool getLastInsertId)
+{
+    return _exec(query, nil, getLastInsertId);
+}
+
+int Sqlite3Storage::execPrepared(const char *query, Ref<SQLParams> params, bool getLastInsertId)
+{
+    return _exec(query, params, getLastInsertId);
+}
+
+int Sqlite3Storage::_exec(const char *query, Ref<SQLParams> params, bool getLastInsertId)
 {
     //fprintf(stdout, "%s\n",query);
     //fflush(stdout);
-    Ref<SLExecTask> ptask (new SLExecTask(query, getLastInsertId));
+    markTransactionWriter();
+    Ref<SLExecTask> ptask (new SLExecTask(query, getLastInsertId, params));
     addTask(RefCast(ptask, SLTask));
     ptask->waitForTask();
     if (getLastInsertId) return ptask->getLastInsertId();
@@ -302,6 +525,7 @@ void Sqlite3Storage::threadProc()
             dbFilePath;
         return;
     }
+    sqlite3_busy_timeout(db, SL3_BUSY_TIMEOUT);
     AUTOLOCK(sqliteMutex);
     // tell init() that we are ready
     cond->signal();
@@ -314,6 +538,13 @@ void Sqlite3Storage::threadProc()
             cond->wait();
             continue;
         }
+        long wait = task->getQueueWait();
+        writerTasks++;
+        writerWaitTotal += wait;
+        if (wait > writerWaitMax)
+            writerWaitMax = wait;
+        if (wait > SL3_SLOW_WAIT_MILLIS)
+            log_debug("sqlite3 task waited %ld ms for the writer thread\n", wait);
         AUTOUNLOCK();
         try
         {
@@ -336,6 +567,7 @@ void Sqlite3Storage::threadProc()
     {
         task->sendSignal(_("Sorry, sqlite3 thread is shutting down"));
     }
+    writerStatements->clear();
     if (db)
         sqlite3_close(db);
 }
@@ -351,6 +583,7 @@ void Sqlite3Storage::addTask(zmm::Ref<SLTask> task, bool onlyIfDirty)
     }
     if (! onlyIfDirty || dirty)
     {
+        task->setQueued();
         taskQueue->enqueue(task);
         signal();
     }
@@ -359,6 +592,8 @@ void Sqlite3Storage::addTask(zmm::Ref<SLTask> task, bool onlyIfDirty)
 void Sqlite3Storage::shutdownDriver()
 {
     log_debug("start\n");
+    closeReaders();
+    logWaitStats();
     AUTOLOCK(sqliteMutex);
     shutdownFlag = true;
     log_debug("signalling...\n");
@@ -371,6 +606,102 @@ void Sqlite3Storage::shutdownDriver()
     log_debug("end\n");
 }
 
+void Sqlite3Storage::openReaders(int count)
+{
+    String dbFilePath = ConfigManager::getInstance()->getOption(CFG_SERVER_STORAGE_SQLITE_DATABASE_FILE);
+    
+    AUTOLOCK(readerMutex);
+    readers = (sqlite3 **)MALLOC(count * sizeof(sqlite3 *));
+    freeReaders = (int *)MALLOC(count * sizeof(int));
+    readerStatements = Ref<Array<Sqlite3StatementCache> >(new Array<Sqlite3StatementCache>(count));
+    for (int i = 0; i < count; i++)
+    {
+        sqlite3 *db = NULL;
+        int res = sqlite3_open_v2(dbFilePath.c_str(), &db, SQLITE_OPEN_READONLY, NULL);
+        if (res != SQLITE_OK)
+        {
+            log_warning("could not open sqlite3 read connection: %s\n",
+                (db == NULL ? "out of memory" : sqlite3_errmsg(db)));
+            if (db != NULL)
+                sqlite3_close(db);
+            break;
+        }
+        sqlite3_busy_timeout(db, SL3_BUSY_TIMEOUT);
+        readerStatements->append(Ref<Sqlite3StatementCache>(new Sqlite3StatementCache()));
+        freeReaders[readerCount] = readerCount;
+        readers[readerCount++] = db;
+    }
+    readersFree = readerCount;
+    readersOpen = (readerCount > 0);
+    log_debug("opened %d sqlite3 read connections\n", readerCount);
+}
+
+void Sqlite3Storage::closeReaders()
+{
+    AUTOLOCK(readerMutex);
+    readersOpen = false;
+    readerCond->broadcast();
+    // wait for the selects that are still running
+    while (readersFree < readerCount)
+        readerCond->wait();
+    for (int i = 0; i < readerCount; i++)
+    {
+        readerStatements->get(i)->clear();
+        sqlite3_close(readers[i]);
+    }
+    readerCount = 0;
+    readersFree = 0;
+    readerStatements = nil;
+    if (readers != NULL)
+    {
+        FREE(readers);
+        readers = NULL;
+        FREE(freeReaders);
+        freeReaders = NULL;
+    }
+}
+
+int Sqlite3Storage::checkoutReader()
+{
+    if (! readersOpen)
+        return -1;
+    struct timespec start;
+    getTimespecNow(&start);
+    AUTOLOCK(readerMutex);
+    while (readersOpen && readersFree == 0)
+        readerCond->wait();
+    if (! readersOpen)
+        return -1;
+    long wait = getDeltaMillis(&start);
+    readerTasks++;
+    readerWaitTotal += wait;
+    if (wait > readerWaitMax)
+        readerWaitMax = wait;
+    if (wait > SL3_SLOW_WAIT_MILLIS)
+        log_debug("sqlite3 select waited %ld ms for a read connection\n", wait);
+    return freeReaders[--readersFree];
+}
+
+void Sqlite3Storage::checkinReader(int reader)
+{
+    AUTOLOCK(readerMutex);
+    freeReaders[readersFree++] = reader;
+    readerCond->broadcast();
+}
+
+void Sqlite3Storage::logWaitStats()
+{
+    AUTOLOCK(sqliteMutex);
+    if (writerTasks > 0)
+        log_info("sqlite3 writer queue: %d tasks, average wait %ld ms, max wait %ld ms\n",
+            writerTasks, writerWaitTotal / writerTasks, writerWaitMax);
+    AUTOUNLOCK();
+    AUTOLOCK_NO_DEFINE(readerMutex);
+    if (readerTasks > 0)
+        log_info("sqlite3 read connections: %d selects, average wait %ld ms, max wait %ld ms\n",
+            readerTasks, readerWaitTotal / readerTasks, readerWaitMax);
+}
+
 void Sqlite3Storage::storeInternalSetting(String key, String value)
 {
     Ref<StringBuffer> q(new StringBuffer());
@@ -382,22 +713,69 @@ void Sqlite3Storage::storeInternalSetting(String key, String value)
 void Sqlite3Storage::_addToInsertBuffer(Ref<StringBuffer> query)
 {
     if (insertBuffer == nil)
-    {
         insertBuffer = Ref<StringBuffer>(new StringBuffer());
-        *insertBuffer << "BEGIN TRANSACTION;";
-    }
     
     *insertBuffer << query << ';';
 }
 
 void Sqlite3Storage::_flushInsertBuffer()
 {
-    if (insertBuffer == nil)
+    if (insertBuffer == nil || insertBuffer->length() == 0)
         return;
-    *insertBuffer << "COMMIT;";
-    SQLStorage::exec(insertBuffer);
+    // inside of a bulk import transaction the statements are simply executed
+    if (isInTransaction())
+        SQLStorage::exec(insertBuffer);
+    else
+    {
+        Ref<StringBuffer> buf(new StringBuffer(insertBuffer->length() + 32));
+        *buf << "BEGIN TRANSACTION;" << insertBuffer << "COMMIT;";
+        SQLStorage::exec(buf);
+    }
     insertBuffer->clear();
-    *insertBuffer << "BEGIN TRANSACTION;";
+}
+
+void Sqlite3Storage::_beginTransaction()
+{
+    AUTOLOCK(transactionMutex);
+    if (inTransaction)
+        return;
+    // the flag is set first, so no write of the new transaction is missed
+    // by markTransactionWriter()
+    inTransaction = true;
+    transactionID++;
+    AUTOUNLOCK();
+    _exec("BEGIN TRANSACTION");
+}
+
+void Sqlite3Storage::_commitTransaction()
+{
+    AUTOLOCK(transactionMutex);
+    if (! inTransaction)
+        return;
+    AUTOUNLOCK();
+    _exec("COMMIT");
+    AUTORELOCK();
+    inTransaction = false;
+}
+
+bool Sqlite3Storage::isInTransaction()
+{
+    AUTOLOCK(transactionMutex);
+    return inTransaction;
+}
+
+bool Sqlite3Storage::wroteInTransaction()
+{
+    AUTOLOCK(transactionMutex);
+    return inTransaction &&
+        (long)pthread_getspecific(transactionKey) == transactionID;
+}
+
+void Sqlite3Storage::markTransactionWriter()
+{
+    AUTOLOCK(transactionMutex);
+    if (inTransaction)
+        pthread_setspecific(transactionKey, (void *)transactionID);
 }
 
 /* SLTask */
@@ -454,10 +832,12 @@ void SLInitTask::run(sqlite3 **db, Sqlite3Storage *sl)
 {
     String dbFilePath = ConfigManager::getInstance()->getOption(CFG_SERVER_STORAGE_SQLITE_DATABASE_FILE);
     
+    sl->writerStatements->clear();
     sqlite3_close(*db);
     
     if (unlink(dbFilePath.c_str()) != 0)
         throw _StorageException(nil, _("error while autocreating sqlite3 database: could not unlink old database file: ") + mt_strerror(errno));
+    unlinkWalFiles(dbFilePath);
     
     int res = sqlite3_open(dbFilePath.c_str(), db);
     if (res != SQLITE_OK)
@@ -471,7 +851,7 @@ void SLInitTask::run(sqlite3 **db, Sqlite3Storage *sl)
     buf[SL3_CREATE_SQL_INFLATED_SIZE] = '\0';
     
     // Rename PC Directory to Files
-    std::string buf_str = buf;
+    std::string buf_str((const char *)buf);
     size_t f = buf_str.find("PC Directory");
     buf_str.replace(f, std::string("PC Directory").length(), "Files");
     
@@ -500,9 +880,10 @@ void SLInitTask::run(sqlite3 **db, Sqlite3Storage *sl)
 
 /* SLSelectTask */
 
-SLSelectTask::SLSelectTask(const char *query) : SLTask()
+SLSelectTask::SLSelectTask(const char *query, Ref<SQLParams> params) : SLTask()
 {
     this->query = query;
+    this->params = params;
 }
 
 void SLSelectTask::run(sqlite3 **db, Sqlite3Storage *sl)
@@ -510,6 +891,23 @@ void SLSelectTask::run(sqlite3 **db, Sqlite3Storage *sl)
     
     pres = Ref<Sqlite3Result>(new Sqlite3Result());
     
+    if (params != nil)
+    {
+        Ref<Sqlite3StatementCache> cache = (statements != nil ? statements : sl->writerStatements);
+        sqlite3_stmt *stmt = cache->get(*db, query, sl);
+        int ret = bindParams(stmt, params);
+        if (ret == SQLITE_OK)
+            ret = pres->fetch(stmt);
+        if (ret != SQLITE_DONE)
+        {
+            String error = sl->getError(query, nil, *db);
+            sqlite3_reset(stmt);
+            throw _StorageException(nil, error);
+        }
+        sqlite3_reset(stmt);
+        return;
+    }
+    
     char *err;
     int ret = sqlite3_get_table(
         *db,
@@ -536,15 +934,34 @@ void SLSelectTask::run(sqlite3 **db, Sqlite3Storage *sl)
 
 /* SLExecTask */
 
-SLExecTask::SLExecTask(const char *query, bool getLastInsertId) : SLTask()
+SLExecTask::SLExecTask(const char *query, bool getLastInsertId, Ref<SQLParams> params) : SLTask()
 {
     this->query = query;
     this->getLastInsertIdFlag = getLastInsertId;
+    this->params = params;
 }
 
 void SLExecTask::run(sqlite3 **db, Sqlite3Storage *sl)
 {
     //log_debug("%s\n", query);
+    if (params != nil)
+    {
+        sqlite3_stmt *stmt = sl->writerStatements->get(*db, query, sl);
+        int res = bindParams(stmt, params);
+        if (res == SQLITE_OK)
+            res = sqlite3_step(stmt);
+        if (res != SQLITE_DONE && res != SQLITE_ROW)
+        {
+            String error = sl->getError(query, nil, *db);
+            sqlite3_reset(stmt);
+            throw _StorageException(nil, error);
+        }
+        sqlite3_reset(stmt);
+        if (getLastInsertIdFlag)
+            lastInsertId = sqlite3_last_insert_rowid(*db);
+        contamination = true;
+        return;
+    }
     char *err;
     int res = sqlite3_exec(
         *db,
@@ -577,6 +994,24 @@ void SLBackupTask::run(sqlite3 **db, Sqlite3Storage *sl)
     
     if (! restore)
     {
+        // the database file is not consistent while a bulk import
+        // transaction is open; the database stays dirty, so the backup
+        // is tried again next time
+        if (sl->isInTransaction())
+        {
+            log_debug("bulk import running, skipping sqlite3 backup\n");
+            return;
+        }
+#if SQLITE_VERSION_NUMBER >= 3007006
+        // the backup is a plain copy of the database file, so everything
+        // that is still in the WAL has to be written back first
+        int res = sqlite3_wal_checkpoint_v2(*db, NULL, SQLITE_CHECKPOINT_FULL, NULL, NULL);
+        if (res != SQLITE_OK)
+        {
+            log_warning("could not checkpoint sqlite3 WAL, skipping backup: %s\n", sqlite3_errmsg(*db));
+            return;
+        }
+#endif
         try
         {
             copy_file(
@@ -594,7 +1029,9 @@ void SLBackupTask::run(sqlite3 **db, Sqlite3Storage *sl)
     else
     {
         log_info("trying to restore sqlite3 database from backup...\n");
+        sl->writerStatements->clear();
         sqlite3_close(*db);
+        unlinkWalFiles(dbFilePath);
         try
         {
             copy_file(
@@ -618,20 +1055,114 @@ void SLBackupTask::run(sqlite3 **db, Sqlite3Storage *sl)
 }
 
 
+/* Sqlite3StatementCache */
+
+Sqlite3StatementCache::Sqlite3StatementCache() : Object()
+{
+    db = NULL;
+    statements = Ref<DSOHash<Sqlite3Statement> >(new DSOHash<Sqlite3Statement>(SL3_STATEMENT_HASH_CAPACITY));
+}
+
+sqlite3_stmt *Sqlite3StatementCache::get(sqlite3 *db, const char *query, Sqlite3Storage *sl)
+{
+    // the connection was reopened, the old statements are gone
+    if (db != this->db)
+    {
+        clear();
+        this->db = db;
+    }
+    
+    String key(query);
+    Ref<Sqlite3Statement> statement = statements->get(key);
+    if (statement != nil)
+        return statement->stmt;
+    
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(db, query, -1, &stmt, NULL) != SQLITE_OK)
+        throw _StorageException(nil, sl->getError(query, _("could not prepare statement"), db));
+    
+    if (statements->size() >= SL3_MAX_STATEMENTS)
+    {
+        log_debug("sqlite3 statement cache full, clearing it\n");
+        statements->clear();
+    }
+    statements->put(key, Ref<Sqlite3Statement>(new Sqlite3Statement(stmt)));
+    return stmt;
+}
+
+void Sqlite3StatementCache::clear()
+{
+    statements->clear();
+}
+
 /* Sqlite3Result */
 
 Sqlite3Result::Sqlite3Result() : SQLResult()
 {
     table = NULL;
+    fetched = false;
+    nrow = 0;
+    ncolumn = 0;
 }
 Sqlite3Result::~Sqlite3Result()
 {
+    if (table && fetched)
+    {
+        for (int i = 0; i < (nrow + 1) * ncolumn; i++)
+        {
+            if (table[i])
+                FREE(table[i]);
+        }
+        FREE(table);
+        table = NULL;
+    }
     if(table)
     {
         sqlite3_free_table(table);
         table = NULL;
     }
 }
+
+int Sqlite3Result::fetch(sqlite3_stmt *stmt)
+{
+    // the table has the layout of sqlite3_get_table(): the first row
+    // would hold the column names and is left empty here
+    fetched = true;
+    ncolumn = sqlite3_column_count(stmt);
+    nrow = 0;
+    int capacity = 8;
+    table = (char **)MALLOC(capacity * ncolumn * sizeof(char *));
+    for (int i = 0; i < ncolumn; i++)
+        table[i] = NULL;
+    
+    int ret;
+    while ((ret = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        if (nrow + 2 > capacity)
+        {
+            capacity *= 2;
+            table = (char **)REALLOC(table, capacity * ncolumn * sizeof(char *));
+        }
+        char **dest = table + (nrow + 1) * ncolumn;
+        for (int i = 0; i < ncolumn; i++)
+        {
+            const char *text = (const char *)sqlite3_column_text(stmt, i);
+            if (text == NULL)
+            {
+                dest[i] = NULL;
+                continue;
+            }
+            int len = sqlite3_column_bytes(stmt, i);
+            dest[i] = (char *)MALLOC(len + 1);
+            memcpy(dest[i], text, len);
+            dest[i][len] = 0;
+        }
+        nrow++;
+    }
+    row = table;
+    cur_row = 0;
+    return ret;
+}
 Ref<SQLRow> Sqlite3Result::nextRow()
 {
     if(nrow)
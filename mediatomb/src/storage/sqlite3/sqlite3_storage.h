@@ -40,10 +40,40 @@
 #include "storage/sql_storage.h"
 #include "sync.h"
 #include "timer.h"
+#include "tools.h"
 
 class Sqlite3Storage;
 class Sqlite3Result;
 
+/// \brief A prepared sqlite3 statement, finalized when it is released.
+class Sqlite3Statement : public zmm::Object
+{
+public:
+    Sqlite3Statement(sqlite3_stmt *stmt) : Object() { this->stmt = stmt; }
+    virtual ~Sqlite3Statement() { sqlite3_finalize(stmt); }
+    sqlite3_stmt *stmt;
+};
+
+/// \brief The prepared statements of one sqlite3 connection, by query.
+///
+/// A cache may only be used by the thread that is using its connection.
+class Sqlite3StatementCache : public zmm::Object
+{
+public:
+    Sqlite3StatementCache();
+    
+    /// \brief returns the prepared statement for the query, the statement
+    /// is prepared if it is not in the cache yet
+    sqlite3_stmt *get(sqlite3 *db, const char *query, Sqlite3Storage *sl);
+    
+    /// \brief finalizes all statements; has to be called before the
+    /// connection is closed
+    void clear();
+protected:
+    sqlite3 *db;
+    zmm::Ref<DSOHash<Sqlite3Statement> > statements;
+};
+
 /// \brief A virtual class that represents a task to be done by the sqlite3 thread.
 class SLTask : public zmm::Object
 {
@@ -71,6 +101,12 @@ public:
     
     zmm::String getError() { return error; }
     
+    /// \brief remember the time the task was put into the queue
+    void setQueued() { getTimespecNow(&queued); }
+    
+    /// \brief returns the milliseconds the task has spent in the queue
+    long getQueueWait() { return getDeltaMillis(&queued); }
+    
 protected:
     /// \brief true as long as the task is not finished
     ///
@@ -86,6 +122,9 @@ protected:
     zmm::Ref<Cond> cond;
     zmm::Ref<Mutex> mutex;
     zmm::String error;
+    
+    /// \brief the time the task was added to the queue
+    struct timespec queued;
 };
 
 #ifdef AUTO_CREATE_DATABASE
@@ -106,12 +145,19 @@ class SLSelectTask : public SLTask
 public:
     /// \brief Constructor for the sqlite3 select task
     /// \param query The SQL query string
-    SLSelectTask(const char *query);
+    /// \param params parameters of the prepared statement; nil for a plain query
+    SLSelectTask(const char *query, zmm::Ref<SQLParams> params = nil);
     virtual void run(sqlite3 **db, Sqlite3Storage *sl);
     inline zmm::Ref<SQLResult> getResult() { return RefCast(pres, SQLResult); };
+    
+    /// \brief sets the statement cache of the connection the task runs
+    /// on; the cache of the writer connection is used if it is not set
+    void setStatementCache(zmm::Ref<Sqlite3StatementCache> statements) { this->statements = statements; }
 protected:
     /// \brief The SQL query string
     const char *query;
+    zmm::Ref<SQLParams> params;
+    zmm::Ref<Sqlite3StatementCache> statements;
     /// \brief The Sqlite3Result
     zmm::Ref<Sqlite3Result> pres;
 };
@@ -122,12 +168,14 @@ class SLExecTask : public SLTask
 public:
     /// \brief Constructor for the sqlite3 exec task
     /// \param query The SQL query string
-    SLExecTask(const char *query, bool getLastInsertId);
+    /// \param params parameters of the prepared statement; nil for a plain query
+    SLExecTask(const char *query, bool getLastInsertId, zmm::Ref<SQLParams> params = nil);
     virtual void run(sqlite3 **db, Sqlite3Storage *sl);
     inline int getLastInsertId() { return lastInsertId; }
 protected:
     /// \brief The SQL query string
     const char *query;
+    zmm::Ref<SQLParams> params;
     
     int lastInsertId;
     bool getLastInsertIdFlag;
@@ -162,10 +210,18 @@ private:
     virtual inline zmm::String quote(char val) { return quote(zmm::String(val)); }
     virtual zmm::Ref<SQLResult> select(const char *query, int length);
     virtual int exec(const char *query, int length, bool getLastInsertId = false);
+    virtual zmm::Ref<SQLResult> selectPrepared(const char *query, zmm::Ref<SQLParams> params, bool streaming = false);
+    virtual int execPrepared(const char *query, zmm::Ref<SQLParams> params, bool getLastInsertId = false);
     virtual void storeInternalSetting(zmm::String key, zmm::String value);
     
+    zmm::Ref<SQLResult> _select(const char *query, zmm::Ref<SQLParams> params);
+    int _exec(const char *query, zmm::Ref<SQLParams> params, bool getLastInsertId);
     void _exec(const char *query);
     
+    /// \brief prepared statements of the writer connection, only used by
+    /// the sqlite3 thread
+    zmm::Ref<Sqlite3StatementCache> writerStatements;
+    
     zmm::String startupError;
     
     zmm::String getError(zmm::String query, zmm::String error, sqlite3 *db);
@@ -195,11 +251,58 @@ private:
     virtual void _addToInsertBuffer(zmm::Ref<zmm::StringBuffer> query);
     virtual void _flushInsertBuffer();
     
+    /* bulk import transaction; the uncommitted rows are only visible on
+     * the writer connection, so the threads that wrote into the open
+     * transaction run their selects there. All other threads keep using
+     * the read connections and see the last committed batch. */
+    virtual void _beginTransaction();
+    virtual void _commitTransaction();
+    bool isInTransaction();
+    /// \brief true if the calling thread wrote into the open transaction
+    bool wroteInTransaction();
+    void markTransactionWriter();
+    
+    /* protected by transactionMutex */
+    bool inTransaction;
+    /// \brief numbers the transactions, so the marks expire on commit
+    long transactionID;
+    zmm::Ref<Mutex> transactionMutex;
+    /// \brief the transactionID the thread last wrote in
+    pthread_key_t transactionKey;
+    
     bool dirty;
     
+    /* pool of read-only connections, used by select() in WAL mode */
+    void openReaders(int count);
+    void closeReaders();
+    /// \brief returns the index of a free read connection or -1
+    int checkoutReader();
+    void checkinReader(int reader);
+    
+    sqlite3 **readers;
+    zmm::Ref<zmm::Array<Sqlite3StatementCache> > readerStatements;
+    int readerCount;
+    /// \brief stack of the indices of the free read connections
+    int *freeReaders;
+    int readersFree;
+    bool readersOpen;
+    zmm::Ref<Mutex> readerMutex;
+    zmm::Ref<Cond> readerCond;
+    
+    /* queue wait statistics, protected by sqliteMutex and readerMutex */
+    void logWaitStats();
+    int writerTasks;
+    long writerWaitTotal;
+    long writerWaitMax;
+    int readerTasks;
+    long readerWaitTotal;
+    long readerWaitMax;
+    
     friend class SLSelectTask;
     friend class SLExecTask;
     friend class SLInitTask;
+    friend class SLBackupTask;
+    friend class Sqlite3StatementCache;
     friend class Sqlite3BackupTimerSubscriber;
 };
 
@@ -212,6 +315,15 @@ private:
     virtual zmm::Ref<SQLRow> nextRow();
     virtual unsigned long long getNumRows() { return nrow; }
     
+    /// \brief reads all rows of a prepared statement into the table
+    /// \return the result of the last sqlite3_step(); SQLITE_DONE if all
+    /// rows were read
+    int fetch(sqlite3_stmt *stmt);
+    
+    /// \brief true if the table was filled by fetch() and not by
+    /// sqlite3_get_table()
+    bool fetched;
+    
     char **table;
     char **row;
     
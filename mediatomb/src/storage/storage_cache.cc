@@ -37,21 +37,45 @@
 
 using namespace zmm;
 
-StorageCache::StorageCache()
+StorageCache::StorageCache(int capacity)
 {
-    capacity = STORAGE_CACHE_CAPACITY;
-    maxfill = STORAGE_CACHE_MAXFILL;
-    idHash = Ref<DBOHash<int,CacheObject> >(new DBOHash<int,CacheObject>(capacity, INVALID_OBJECT_ID, INVALID_OBJECT_ID_2));
-    locationHash = Ref<DSOHash<Array<CacheObject> > >(new DSOHash<Array<CacheObject> >(capacity));
+    this->capacity = capacity;
+    protectedCapacity = capacity * STORAGE_CACHE_PROTECTED_SHARE / 100;
+    evictCount = capacity * STORAGE_CACHE_EVICT_SHARE / 100;
+    if (evictCount < 1)
+        evictCount = 1;
+    
+    // deleted slots are probed like used ones, so the hashes are sized for
+    // the objects plus the removals that are allowed before a rebuild
+    maxRemovedCount = capacity / 4 + 1;
+    int hashCap = hashCapacity(capacity + maxRemovedCount);
+    idHash = Ref<DBOHash<int,CacheObject> >(new DBOHash<int,CacheObject>(hashCap, INVALID_OBJECT_ID, INVALID_OBJECT_ID_2));
+    locationHash = Ref<DSOHash<Array<CacheObject> > >(new DSOHash<Array<CacheObject> >(hashCap));
     hasBeenFlushed = false;
+    removedCount = 0;
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+    for (int i = 0; i < STORAGE_CACHE_SEGMENTS; i++)
+    {
+        lruHead[i] = NULL;
+        lruTail[i] = NULL;
+        segmentSize[i] = 0;
+    }
     mutex = Ref<Mutex> (new Mutex());
 }
 
 void StorageCache::clear()
 {
     AUTOLOCK(mutex);
+    for (int i = 0; i < STORAGE_CACHE_SEGMENTS; i++)
+    {
+        while (lruHead[i] != NULL)
+            unlink(lruHead[i]);
+    }
     idHash->clear();
     locationHash->clear();
+    removedCount = 0;
 }
 
 Ref<CacheObject> StorageCache::getObject(int id)
@@ -59,7 +83,15 @@ Ref<CacheObject> StorageCache::getObject(int id)
 #ifdef TOMBDEBUG
     assert(mutex->isLocked());
 #endif
-    return idHash->get(id);
+    Ref<CacheObject> obj = idHash->get(id);
+    if (obj == nil)
+    {
+        misses++;
+        return nil;
+    }
+    hits++;
+    touch(obj.getPtr());
+    return obj;
 }
 
 Ref<CacheObject> StorageCache::getObjectDefinitely(int id)
@@ -72,8 +104,12 @@ Ref<CacheObject> StorageCache::getObjectDefinitely(int id)
     {
         ensureFillLevelOk();
         obj = Ref<CacheObject>(new CacheObject());
+        obj->cacheID = id;
         idHash->put(id, obj);
+        link(obj.getPtr(), STORAGE_CACHE_PROBATION);
     }
+    else
+        touch(obj.getPtr());
     return obj;
 }
 
@@ -92,12 +128,16 @@ void StorageCache::addChild(int id)
 bool StorageCache::removeObject(int id)
 {
     AUTOLOCK(mutex);
-    Ref<CacheObject> obj = getObject(id);
+    Ref<CacheObject> obj = idHash->get(id);
     if (obj == nil)
         return false;
-    if (obj->knowsLocation())
-        locationHash->remove(obj->getLocation());
-    return idHash->remove(id);
+    if (obj->knowsLocation() && locationHash->remove(obj->getLocation()))
+        removedCount++;
+    unlink(obj.getPtr());
+    idHash->remove(id);
+    removedCount++;
+    checkHashes();
+    return true;
 }
 
 Ref<Array<CacheObject> > StorageCache::getObjects(String location)
@@ -105,7 +145,16 @@ Ref<Array<CacheObject> > StorageCache::getObjects(String location)
 #ifdef TOMBDEBUG
     assert(mutex->isLocked());
 #endif
-    return locationHash->get(location);
+    Ref<Array<CacheObject> > objects = locationHash->get(location);
+    if (objects == nil)
+    {
+        misses++;
+        return nil;
+    }
+    hits++;
+    for (int i = 0; i < objects->size(); i++)
+        touch(objects->get(i).getPtr());
+    return objects;
 }
 
 void StorageCache::checkLocation(Ref<CacheObject> obj)
@@ -143,17 +192,131 @@ bool StorageCache::flushed()
 
 /* private */
 
+void StorageCache::link(CacheObject *obj, int segment)
+{
+    obj->cacheSegment = segment;
+    obj->lruPrev = NULL;
+    obj->lruNext = lruHead[segment];
+    if (lruHead[segment] != NULL)
+        lruHead[segment]->lruPrev = obj;
+    else
+        lruTail[segment] = obj;
+    lruHead[segment] = obj;
+    segmentSize[segment]++;
+}
+
+void StorageCache::unlink(CacheObject *obj)
+{
+    int segment = obj->cacheSegment;
+    if (obj->lruPrev != NULL)
+        obj->lruPrev->lruNext = obj->lruNext;
+    else
+        lruHead[segment] = obj->lruNext;
+    if (obj->lruNext != NULL)
+        obj->lruNext->lruPrev = obj->lruPrev;
+    else
+        lruTail[segment] = obj->lruPrev;
+    obj->lruPrev = NULL;
+    obj->lruNext = NULL;
+    segmentSize[segment]--;
+}
+
+void StorageCache::touch(CacheObject *obj)
+{
+    if (lruHead[STORAGE_CACHE_PROTECTED] == obj)
+        return;
+    unlink(obj);
+    link(obj, STORAGE_CACHE_PROTECTED);
+    
+    // the least recently used protected objects get another chance in
+    // the probationary segment
+    while (segmentSize[STORAGE_CACHE_PROTECTED] > protectedCapacity)
+    {
+        CacheObject *demoted = lruTail[STORAGE_CACHE_PROTECTED];
+        unlink(demoted);
+        link(demoted, STORAGE_CACHE_PROBATION);
+    }
+}
+
+void StorageCache::removeLocation(CacheObject *obj)
+{
+    if (! obj->knowsLocation())
+        return;
+    String location = obj->getLocation();
+    Ref<Array<CacheObject> > objects = locationHash->get(location);
+    if (objects == nil)
+        return;
+    for (int i = 0; i < objects->size(); i++)
+    {
+        if (objects->get(i).getPtr() == obj)
+        {
+            objects->removeUnordered(i);
+            break;
+        }
+    }
+    if (objects->size() == 0)
+    {
+        locationHash->remove(location);
+        removedCount++;
+    }
+}
+
 void StorageCache::ensureFillLevelOk()
 {
 #ifdef TOMBDEBUG
     assert(mutex->isLocked());
 #endif
-    // TODO - much better...
-    // for now just clear cache if it gets too full
-    if (idHash->size() >= maxfill || locationHash->size() >= maxfill)
+    if (idHash->size() >= capacity)
+        evict();
+    checkHashes();
+}
+
+void StorageCache::evict()
+{
+    int count;
+    for (count = 0; count < evictCount; count++)
+    {
+        CacheObject *victim = lruTail[STORAGE_CACHE_PROBATION];
+        if (victim == NULL)
+            victim = lruTail[STORAGE_CACHE_PROTECTED];
+        if (victim == NULL)
+            break;
+        unlink(victim);
+        removeLocation(victim);
+        // releases the last reference in most cases
+        idHash->remove(victim->cacheID);
+        removedCount++;
+    }
+    evictions += count;
+    hasBeenFlushed = true;
+    log_debug("evicted %d objects; hits: %lu, misses: %lu, evictions: %lu\n",
+            count, hits, misses, evictions);
+}
+
+void StorageCache::checkHashes()
+{
+    // objects whose location changed are not removed from the array of
+    // the old location, so the location hash can contain stale entries
+    if (removedCount >= maxRemovedCount || locationHash->size() >= capacity)
+        rebuildHashes();
+}
+
+void StorageCache::rebuildHashes()
+{
+    Ref<Array<CacheObject> > objects(new Array<CacheObject>(idHash->size() + 1));
+    for (int i = 0; i < STORAGE_CACHE_SEGMENTS; i++)
+    {
+        for (CacheObject *obj = lruHead[i]; obj != NULL; obj = obj->lruNext)
+            objects->append(Ref<CacheObject>(obj));
+    }
+    
+    idHash->clear();
+    locationHash->clear();
+    for (int i = 0; i < objects->size(); i++)
     {
-        hasBeenFlushed = true;
-        idHash->clear();
-        locationHash->clear();
+        Ref<CacheObject> obj = objects->get(i);
+        idHash->put(obj->cacheID, obj);
+        checkLocation(obj);
     }
+    removedCount = 0;
 }
@@ -38,13 +38,28 @@
 #include "sync.h"
 #include "cache_object.h"
 
-#define STORAGE_CACHE_CAPACITY 29989
-#define STORAGE_CACHE_MAXFILL 9973
+/// \brief percentage of the capacity that the protected segment may use
+#define STORAGE_CACHE_PROTECTED_SHARE 80
+/// \brief percentage of the capacity that is evicted at once when the
+/// cache is full
+#define STORAGE_CACHE_EVICT_SHARE 5
 
+#define STORAGE_CACHE_PROBATION 0
+#define STORAGE_CACHE_PROTECTED 1
+#define STORAGE_CACHE_SEGMENTS  2
+
+/// \brief Cache of CacheObjects with segmented LRU eviction.
+///
+/// New objects enter the probationary segment, objects that are used
+/// again move to the protected segment. When the cache is full, the least
+/// recently used objects of the probationary segment are evicted first,
+/// so a single pass over many objects (e.g. an import) can't push out the
+/// objects that are used repeatedly (e.g. the browsed containers).
 class StorageCache : public zmm::Object
 {
 public:
-    StorageCache();
+    /// \param capacity maximum number of cached objects
+    StorageCache(int capacity);
     
     zmm::Ref<CacheObject> getObject(int id);
     zmm::Ref<CacheObject> getObjectDefinitely(int id);
@@ -58,17 +73,49 @@ public:
     // if the object has cached information
     void addChild(int id);
     
+    /// \brief returns true once after objects were dropped from the cache
+    ///
+    /// The dropped objects may describe objects that are still in the
+    /// insert buffer of the storage, so the buffer has to be flushed.
     bool flushed();
     
     zmm::Ref<Mutex> getMutex() { return mutex; }
     
+    unsigned long getHits() { return hits; }
+    unsigned long getMisses() { return misses; }
+    unsigned long getEvictions() { return evictions; }
+    
 private:
     
     int capacity;
-    int maxfill;
+    int protectedCapacity;
+    int evictCount;
     bool hasBeenFlushed;
     
+    /// \brief number of hash entries removed since the hashes were
+    /// rebuilt; removed entries leave deleted slots behind
+    int removedCount;
+    int maxRemovedCount;
+    
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+    
+    /// \brief most recently used object of each segment
+    CacheObject *lruHead[STORAGE_CACHE_SEGMENTS];
+    /// \brief least recently used object of each segment
+    CacheObject *lruTail[STORAGE_CACHE_SEGMENTS];
+    int segmentSize[STORAGE_CACHE_SEGMENTS];
+    
+    void link(CacheObject *obj, int segment);
+    void unlink(CacheObject *obj);
+    void touch(CacheObject *obj);
+    void removeLocation(CacheObject *obj);
+    
     void ensureFillLevelOk();
+    void evict();
+    void checkHashes();
+    void rebuildHashes();
     
     zmm::Ref<DBOHash<int,CacheObject> > idHash;
     zmm::Ref<DSOHash<zmm::Array<CacheObject> > > locationHash;
@@ -0,0 +1,132 @@
+/*MT*
+    
+    MediaTomb - http://www.mediatomb.cc/
+    
+    virtual_container_index.cc - this file is part of MediaTomb.
+    
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+    
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+    
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+    
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+    
+    $Id$
+*/
+
+/// \file virtual_container_index.cc
+
+#ifdef HAVE_CONFIG_H
+    #include "autoconfig.h"
+#endif
+
+#include "virtual_container_index.h"
+
+using namespace zmm;
+
+VirtualContainerIndex::VirtualContainerIndex() : Object()
+{
+    loaded = false;
+    head = NULL;
+    mutex = Ref<Mutex>(new Mutex());
+    rebuildHashes(VIRTUAL_CONTAINER_INDEX_INITIAL_SIZE);
+}
+
+int VirtualContainerIndex::getID(String location)
+{
+#ifdef TOMBDEBUG
+    assert(mutex->isLocked());
+#endif
+    Ref<VirtualContainer> container = locationHash->get(location);
+    if (container == nil)
+        return INVALID_OBJECT_ID;
+    return container->id;
+}
+
+void VirtualContainerIndex::add(int id, String location)
+{
+#ifdef TOMBDEBUG
+    assert(mutex->isLocked());
+#endif
+    Ref<VirtualContainer> container = idHash->get(id);
+    if (container != nil)
+    {
+        if (container->location == location)
+            return;
+        remove(id);
+    }
+    
+    // several containers with the same location should not exist, but if
+    // they do, the first one is used
+    if (locationHash->get(location) != nil)
+        return;
+    
+    if (idHash->size() + removedCount >= maxSize)
+        rebuildHashes(idHash->size() * 2);
+    
+    container = Ref<VirtualContainer>(new VirtualContainer());
+    container->id = id;
+    container->location = location;
+    container->prev = NULL;
+    container->next = head;
+    if (head != NULL)
+        head->prev = container.getPtr();
+    head = container.getPtr();
+    
+    idHash->put(id, container);
+    locationHash->put(location, container);
+}
+
+void VirtualContainerIndex::remove(int id)
+{
+#ifdef TOMBDEBUG
+    assert(mutex->isLocked());
+#endif
+    Ref<VirtualContainer> container = idHash->get(id);
+    if (container == nil)
+        return;
+    
+    if (container->prev != NULL)
+        container->prev->next = container->next;
+    else
+        head = container->next;
+    if (container->next != NULL)
+        container->next->prev = container->prev;
+    
+    locationHash->remove(container->location);
+    idHash->remove(id);
+    removedCount++;
+}
+
+void VirtualContainerIndex::rebuildHashes(int maxSize)
+{
+    if (maxSize < VIRTUAL_CONTAINER_INDEX_INITIAL_SIZE)
+        maxSize = VIRTUAL_CONTAINER_INDEX_INITIAL_SIZE;
+    this->maxSize = maxSize;
+    removedCount = 0;
+    
+    // the new hashes take over the references of the old ones
+    Ref<DBOHash<int, VirtualContainer> > oldIdHash = idHash;
+    int capacity = hashCapacity(maxSize);
+    idHash = Ref<DBOHash<int, VirtualContainer> >(new DBOHash<int, VirtualContainer>(capacity, INVALID_OBJECT_ID, INVALID_OBJECT_ID_2));
+    locationHash = Ref<DSOHash<VirtualContainer> >(new DSOHash<VirtualContainer>(capacity));
+    for (VirtualContainer *container = head; container != NULL; container = container->next)
+    {
+        Ref<VirtualContainer> ref(container);
+        idHash->put(container->id, ref);
+        locationHash->put(container->location, ref);
+    }
+}
@@ -0,0 +1,110 @@
+/*MT*
+    
+    MediaTomb - http://www.mediatomb.cc/
+    
+    virtual_container_index.h - this file is part of MediaTomb.
+    
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+    
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+    
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+    
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+    
+    $Id$
+*/
+
+/// \file virtual_container_index.h
+
+#ifndef __VIRTUAL_CONTAINER_INDEX_H__
+#define __VIRTUAL_CONTAINER_INDEX_H__
+
+#include "zmmf/zmmf.h"
+#include "common.h"
+#include "hash.h"
+#include "sync.h"
+
+/// \brief initial number of containers the VirtualContainerIndex can hold
+/// without growing its hashes
+#define VIRTUAL_CONTAINER_INDEX_INITIAL_SIZE 1000
+
+/// \brief An entry of the VirtualContainerIndex.
+class VirtualContainer : public zmm::Object
+{
+public:
+    int id;
+    
+    /// \brief location of the container in the database, including the
+    /// LOC_VIRT_PREFIX
+    zmm::String location;
+    
+    VirtualContainer *prev;
+    VirtualContainer *next;
+};
+
+/// \brief Maps the locations of all virtual containers to their IDs.
+///
+/// The index is loaded from the database once and then kept in sync by
+/// the storage whenever virtual containers are created, updated or
+/// removed, so resolving the container chains of the layouts does not
+/// need any queries for containers that already exist.
+///
+/// The caller has to hold the mutex of the index for all methods.
+class VirtualContainerIndex : public zmm::Object
+{
+public:
+    VirtualContainerIndex();
+    
+    /// \brief true after the index was filled from the database
+    bool isLoaded() { return loaded; }
+    void setLoaded() { loaded = true; }
+    
+    /// \brief looks up a container by its location
+    /// \param location location including the LOC_VIRT_PREFIX
+    /// \return the ID of the container or INVALID_OBJECT_ID
+    int getID(zmm::String location);
+    
+    /// \brief adds a container or changes its location
+    void add(int id, zmm::String location);
+    
+    /// \brief removes the container with the given ID, if it is in the index
+    void remove(int id);
+    
+    int size() { return idHash->size(); }
+    
+    zmm::Ref<Mutex> getMutex() { return mutex; }
+    
+protected:
+    bool loaded;
+    
+    /// \brief number of entries the hashes can hold before they are grown
+    int maxSize;
+    
+    /// \brief number of hash entries removed since the hashes were
+    /// rebuilt; removed entries leave deleted slots behind
+    int removedCount;
+    
+    /// \brief list of all entries, used to rebuild the hashes
+    VirtualContainer *head;
+    
+    zmm::Ref<DBOHash<int, VirtualContainer> > idHash;
+    zmm::Ref<DSOHash<VirtualContainer> > locationHash;
+    zmm::Ref<Mutex> mutex;
+    
+    void rebuildHashes(int maxSize);
+};
+
+#endif // __VIRTUAL_CONTAINER_INDEX_H__
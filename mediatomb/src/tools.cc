@@ -45,6 +45,7 @@
 #include <netdb.h>
 #include <string.h>
 #include "config_manager.h"
+#include "hash.h"
 
 #ifndef SOLARIS
     #include <net/if.h>
@@ -986,6 +987,30 @@ unsigned int stringHash(String str)
     return hash;
 }
 
+int hashCapacity(int count)
+{
+    // the probing of the hashes requires a prime capacity that is larger
+    // than the maximal probing step
+    int n = count * 3 + 1;
+    if (n <= HASH_PRIME)
+        n = HASH_PRIME + 1;
+    while (true)
+    {
+        bool prime = true;
+        for (int i = 2; i * i <= n; i++)
+        {
+            if (n % i == 0)
+            {
+                prime = false;
+                break;
+            }
+        }
+        if (prime)
+            return n;
+        n++;
+    }
+}
+
 String intArrayToCSV(int *array, int size)
 {
     if (size <= 0)
@@ -260,6 +260,11 @@ zmm::String fallbackString(zmm::String first, zmm::String fallback);
 /// \return return the (unsigned int) hash value
 unsigned int stringHash(zmm::String str);
 
+/// \brief computes a capacity for the direct hashes (see hash.h)
+/// \param count the number of entries the hash has to hold
+/// \return a prime that keeps the hash filled to at most a third
+int hashCapacity(int count);
+
 zmm::String intArrayToCSV(int *array, int size);
 
 //inline void getTimeval(struct timeval *now) { gettimeofday(now, NULL); }
@@ -36,6 +36,7 @@
 #include "singleton.h"
 #include "action_request.h"
 #include "subscription_request.h"
+#include "cds_objects.h"
 
 /// \brief This class is responsible for the UPnP Content Directory Service operations.
 ///
@@ -63,6 +64,22 @@ protected:
     /// ui4 TotalMatches, ui4 UpdateID)
     void upnp_action_Browse(zmm::Ref<ActionRequest> request);
 
+    /// \brief UPnP standard defined action: Search()
+    /// \param request Incoming ActionRequest.
+    ///
+    /// Search(string ContainerID, string SearchCriteria, string Filter,
+    /// ui4 StartingIndex, ui4 RequestedCount, string SortCriteria,
+    /// string Result, ui4 NumberReturned, ui4 TotalMatches, ui4 UpdateID)
+    void upnp_action_Search(zmm::Ref<ActionRequest> request);
+
+    /// \brief Renders the objects of a Browse or Search result as
+    /// DIDL-Lite and sets the response of the action.
+    /// \param request ActionRequest to respond to.
+    /// \param arr Objects to return.
+    /// \param totalMatches Number of matching objects, including the ones
+    /// that are not on this page.
+    void setResultResponse(zmm::Ref<ActionRequest> request, zmm::Ref<zmm::Array<CdsObject> > arr, int totalMatches);
+
     /// \brief UPnP standard defined action: GetSearchCapabilities()
     /// \param request Incoming ActionRequest.
     ///
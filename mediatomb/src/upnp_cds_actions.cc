@@ -41,24 +41,49 @@
 
 #include "metadata_handler.h"
 
+/// \brief estimated size of the DIDL-Lite of one object, used to size the
+/// buffer of a Browse or Search response
+#define BROWSE_DIDL_OBJECT_SIZE 1024
+
 using namespace zmm;
 using namespace mxml;
 
+/// \brief parses the SortCriteria argument and checks that it only uses
+/// properties from the sort capabilities
+static Ref<Array<SortCriterion> > parseSortCriteria(String sortCriteria, String caps)
+{
+    Ref<Array<SortCriterion> > criteria;
+    try
+    {
+        criteria = SortCriterion::parse(sortCriteria);
+    }
+    catch (Exception e)
+    {
+        throw UpnpException(UPNP_E_INVALID_SORT_CRITERIA, e.getMessage());
+    }
+    caps = _(",") + caps + ",";
+    for (int i = 0; i < criteria->size(); i++)
+    {
+        if (caps.find(_(",") + criteria->get(i)->property + ",") < 0)
+            throw UpnpException(UPNP_E_INVALID_SORT_CRITERIA,
+                                _("unsupported sort property: ") + criteria->get(i)->property);
+    }
+    return criteria;
+}
+
 void ContentDirectoryService::upnp_action_Browse(Ref<ActionRequest> request)
 {
     log_debug("start\n");
 
     Ref<Storage> storage = Storage::getInstance();
    
-    Ref<Element> req = request->getRequest();
-   
-    String objID = req->getChildText(_("ObjectID"));
+    String objID = request->getArgument(_("ObjectID"));
     int objectID;
-    String BrowseFlag = req->getChildText(_("BrowseFlag"));
+    String BrowseFlag = request->getArgument(_("BrowseFlag"));
     //String Filter; // not yet supported
-    String StartingIndex = req->getChildText(_("StartingIndex"));
-    String RequestedCount = req->getChildText(_("RequestedCount"));
-    // String SortCriteria; // not yet supported
+    String StartingIndex = request->getArgument(_("StartingIndex"));
+    String RequestedCount = request->getArgument(_("RequestedCount"));
+    String SortCriteria = request->getArgument(_("SortCriteria"));
 
     //log_debug("Browse received parameters: ObjectID [%s] BrowseFlag [%s] StartingIndex [%s] RequestedCount [%s]\n",
 //            ObjectID.c_str(), BrowseFlag.c_str(), StartingIndex.c_str(), RequestedCount.c_str());
@@ -89,6 +114,7 @@ void ContentDirectoryService::upnp_action_Browse(Ref<ActionRequest> request)
 
     param->setStartingIndex(StartingIndex.toInt());
     param->setRequestedCount(RequestedCount.toInt());
+    param->setSortCriteria(parseSortCriteria(SortCriteria, storage->getSortCapabilities()));
     
     Ref<Array<CdsObject> > arr;
    
@@ -101,16 +127,92 @@ void ContentDirectoryService::upnp_action_Browse(Ref<ActionRequest> request)
         throw UpnpException(UPNP_E_NO_SUCH_ID, _("no such object"));
     }
 
-    Ref<Element> didl_lite (new Element(_("DIDL-Lite")));
-    didl_lite->setAttribute(_(XML_NAMESPACE_ATTR), 
-                            _(XML_DIDL_LITE_NAMESPACE));
-    didl_lite->setAttribute(_(XML_DC_NAMESPACE_ATTR), 
-                            _(XML_DC_NAMESPACE));
-    didl_lite->setAttribute(_(XML_UPNP_NAMESPACE_ATTR), 
-                            _(XML_UPNP_NAMESPACE));
+    setResultResponse(request, arr, param->getTotalMatches());
+    log_debug("end\n");
+}
+
+/// \brief checks that the search only uses properties from the search
+/// capabilities
+static void checkSearchProperties(Ref<SearchExpression> exp, String caps)
+{
+    if (exp->type == SEARCH_AND || exp->type == SEARCH_OR)
+    {
+        checkSearchProperties(exp->left, caps);
+        checkSearchProperties(exp->right, caps);
+    }
+    else if (exp->type == SEARCH_RELATION)
+    {
+        if (caps.find(_(",") + exp->property + ",") < 0)
+            throw UpnpException(UPNP_E_INVALID_SEARCH_CRITERIA,
+                                _("unsupported search property: ") + exp->property);
+    }
+}
+
+void ContentDirectoryService::upnp_action_Search(Ref<ActionRequest> request)
+{
+    log_debug("start\n");
+
+    Ref<Storage> storage = Storage::getInstance();
+
+    String containerID = request->getArgument(_("ContainerID"));
+    String searchCriteria = request->getArgument(_("SearchCriteria"));
+    String StartingIndex = request->getArgument(_("StartingIndex"));
+    String RequestedCount = request->getArgument(_("RequestedCount"));
+    String SortCriteria = request->getArgument(_("SortCriteria"));
+    // String Filter; // not yet supported
+
+    if (containerID == nil)
+        throw UpnpException(UPNP_E_NO_SUCH_CONTAINER, _("empty container id"));
+
+    Ref<SearchExpression> criteria;
+    try
+    {
+        criteria = SearchExpression::parse(searchCriteria);
+    }
+    catch (Exception e)
+    {
+        throw UpnpException(UPNP_E_INVALID_SEARCH_CRITERIA, e.getMessage());
+    }
+    checkSearchProperties(criteria, _(",") + storage->getSearchCapabilities() + ",");
+
+    Ref<SearchParam> param(new SearchParam(containerID.toInt(), criteria));
+    param->setRange(StartingIndex.toInt(), RequestedCount.toInt());
+    param->setSortCriteria(parseSortCriteria(SortCriteria, storage->getSortCapabilities()));
+    param->setHideFsRoot(ConfigManager::getInstance()->getBoolOption(CFG_SERVER_HIDE_PC_DIRECTORY));
+
+    Ref<Array<CdsObject> > arr;
+    try
+    {
+        arr = storage->search(param);
+    }
+    catch (ObjectNotFoundException e)
+    {
+        throw UpnpException(UPNP_E_NO_SUCH_CONTAINER, _("no such container"));
+    }
+
+    setResultResponse(request, arr, param->getTotalMatches());
+    log_debug("end\n");
+}
+
+void ContentDirectoryService::setResultResponse(Ref<ActionRequest> request, Ref<Array<CdsObject> > arr, int totalMatches)
+{
+    // the DIDL-Lite is written straight into a buffer, building a DOM for
+    // every object of a large page costs more than the rest of the request
+    Ref<StringBuffer> didl_lite(new StringBuffer(BROWSE_DIDL_OBJECT_SIZE * (arr->size() + 1)));
+    UpnpXML_DIDLStart(didl_lite);
 
     Ref<ConfigManager> cfg = ConfigManager::getInstance();
 
+    // Fetch the first item of every container on this page in one go,
+    // it is used for the album art of the container below
+    Ref<IntArray> containerIDs(new IntArray());
+    for(int i = 0; i < arr->size(); i++)
+    {
+        if (IS_CDS_CONTAINER(arr->get(i)->getObjectType()))
+            containerIDs->append(arr->get(i)->getID());
+    }
+    Ref<DBOHash<int, CdsObject> > firstItems = Storage::getInstance()->getFirstChildItems(containerIDs);
+
     for(int i = 0; i < arr->size(); i++)
     {
         Ref<CdsObject> obj = arr->get(i);
@@ -128,19 +230,20 @@ void ContentDirectoryService::upnp_action_Browse(Ref<ActionRequest> request)
 
         // Set the folder's album art with the art of the first song inside the album (if that song has art)
 
-        // Browse inside the container and get its first object
-        Ref<BrowseParam> param2(new BrowseParam(obj->getID(), BROWSE_DIRECT_CHILDREN | BROWSE_ITEMS));
-        param2->setRange(0, 1);
-        zmm::Ref<zmm::Array<CdsObject> > browseRes = storage->browse(param2);
+        // Get the first item inside the container; items are their own first item
+        Ref<CdsObject> firstItem;
+        if (IS_CDS_CONTAINER(obj->getObjectType()))
+            firstItem = firstItems->get(obj->getID());
+        else
+            firstItem = obj;
 
-        int resSize = browseRes->size();
-        if (resSize)
+        if (firstItem != nil)
         {
             // Check how many resources the object has. If it has more than 1, the second is album art
-            zmm::Ref<zmm::Array<CdsResource> > resources = browseRes->get(0)->getResources();
+            zmm::Ref<zmm::Array<CdsResource> > resources = firstItem->getResources();
             if (resources->size() > 1)
             {
-                Ref<CdsItem> item = RefCast(browseRes->get(0), CdsItem);
+                Ref<CdsItem> item = RefCast(firstItem, CdsItem);
 
                 Ref<Dictionary> dict(new Dictionary());
                 dict->put(_(URL_OBJECT_ID), String::from(item->getID()));
@@ -157,21 +260,20 @@ void ContentDirectoryService::upnp_action_Browse(Ref<ActionRequest> request)
             }
         }
 
-        Ref<Element> didl_object = UpnpXML_DIDLRenderObject(obj, false, stringLimit);
-
-        didl_lite->appendElementChild(didl_object);
+        UpnpXML_DIDLRenderObject(obj, false, stringLimit, didl_lite);
     }
+    UpnpXML_DIDLEnd(didl_lite);
 
-    Ref<Element> response;
-    response = UpnpXML_CreateResponse(request->getActionName(), serviceType);
-
-    response->appendTextChild(_("Result"), didl_lite->print());
-    response->appendTextChild(_("NumberReturned"), String::from(arr->size()));
-    response->appendTextChild(_("TotalMatches"), String::from(param->getTotalMatches()));
-    response->appendTextChild(_("UpdateID"), String::from(systemUpdateID));
+    // the escaped DIDL-Lite grows by about a third
+    Ref<StringBuffer> response(new StringBuffer(didl_lite->length() * 4 / 3 + 256));
+    UpnpXML_StartResponse(response, request->getActionName(), serviceType);
+    UpnpXML_AppendResponseArgument(response, _("Result"), didl_lite->c_str());
+    UpnpXML_AppendResponseArgument(response, _("NumberReturned"), String::from(arr->size()).c_str());
+    UpnpXML_AppendResponseArgument(response, _("TotalMatches"), String::from(totalMatches).c_str());
+    UpnpXML_AppendResponseArgument(response, _("UpdateID"), String::from(systemUpdateID).c_str());
+    UpnpXML_EndResponse(response, request->getActionName());
 
     request->setResponse(response);
-    log_debug("end\n");
 }
 
 void ContentDirectoryService::upnp_action_GetSearchCapabilities(Ref<ActionRequest> request)
@@ -180,7 +282,7 @@ void ContentDirectoryService::upnp_action_GetSearchCapabilities(Ref<ActionReques
 
     Ref<Element> response;
     response = UpnpXML_CreateResponse(request->getActionName(), serviceType);
-    response->appendTextChild(_("SearchCaps"), _(""));
+    response->appendTextChild(_("SearchCaps"), Storage::getInstance()->getSearchCapabilities());
             
     request->setResponse(response);
 
@@ -193,7 +295,7 @@ void ContentDirectoryService::upnp_action_GetSortCapabilities(Ref<ActionRequest>
 
     Ref<Element> response;
     response = UpnpXML_CreateResponse(request->getActionName(), serviceType);
-    response->appendTextChild(_("SortCaps"), _(""));
+    response->appendTextChild(_("SortCaps"), Storage::getInstance()->getSortCapabilities());
             
     request->setResponse(response);
 
@@ -221,6 +323,10 @@ void ContentDirectoryService::process_action_request(Ref<ActionRequest> request)
     {
         upnp_action_Browse(request);
     }
+    else if (request->getActionName() == "Search")
+    {
+        upnp_action_Search(request);
+    }
     else if (request->getActionName() == "GetSearchCapabilities")
     {
         upnp_action_GetSearchCapabilities(request);
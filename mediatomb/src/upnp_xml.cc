@@ -52,27 +52,99 @@ Ref<Element> UpnpXML_CreateResponse(String actionName, String serviceType)
     return response; 
 }
 
-Ref<Element> UpnpXML_DIDLRenderObject(Ref<CdsObject> obj, bool renderActions, int stringLimit)
+void UpnpXML_StartResponse(Ref<StringBuffer> buf, String actionName, String serviceType)
 {
-    Ref<Element> result(new Element(_("")));
-    
-    result->setAttribute(_("id"), String::from(obj->getID()));
-    result->setAttribute(_("parentID"), String::from(obj->getParentID()));
-    result->setAttribute(_("restricted"), obj->isRestricted() ? _("1") : _("0"));
-   
-    String tmp = obj->getTitle();
+    *buf << "<u:" << actionName << "Response xmlns:u=\"";
+    Node::escape(buf, serviceType.c_str());
+    *buf << "\">\r\n";
+}
+
+void UpnpXML_AppendResponseArgument(Ref<StringBuffer> buf, String name, const char *value)
+{
+    *buf << '<' << name << '>';
+    Node::escape(buf, value);
+    *buf << "</" << name << ">\r\n";
+}
+
+void UpnpXML_EndResponse(Ref<StringBuffer> buf, String actionName)
+{
+    *buf << "</u:" << actionName << "Response>\r\n";
+}
+
+void UpnpXML_DIDLStart(Ref<StringBuffer> buf)
+{
+    *buf << "<DIDL-Lite "
+         << XML_NAMESPACE_ATTR << "=\"" << XML_DIDL_LITE_NAMESPACE << "\" "
+         << XML_DC_NAMESPACE_ATTR << "=\"" << XML_DC_NAMESPACE << "\" "
+         << XML_UPNP_NAMESPACE_ATTR << "=\"" << XML_UPNP_NAMESPACE << "\">";
+}
+
+void UpnpXML_DIDLEnd(Ref<StringBuffer> buf)
+{
+    *buf << "</DIDL-Lite>";
+}
+
+void UpnpXML_DIDLAppendElement(Ref<StringBuffer> buf, String name, String text,
+                               Ref<Dictionary> attributes)
+{
+    *buf << '<' << name;
+    if (attributes != nil)
+    {
+        Ref<Array<DictionaryElement> > elements = attributes->getElements();
+        int len = elements->size();
+        for (int i = 0; i < len; i++)
+        {
+            Ref<DictionaryElement> el = elements->get(i);
+            *buf << ' ' << el->getKey() << "=\"";
+            Node::escape(buf, el->getValue().c_str());
+            *buf << '"';
+        }
+    }
+    *buf << '>';
+    Node::escape(buf, text.c_str());
+    *buf << "</" << name << '>';
+}
+
+/// \brief cuts the string to stringLimit bytes, including the "..." that is
+/// appended to shortened strings
+static String limitString(String str, int stringLimit)
+{
+    if ((stringLimit > 0) && (str.length() > stringLimit))
+    {
+        str = str.substring(0, getValidUTF8CutPosition(str, stringLimit-3));
+        str = str + _("...");
+    }
+    return str;
+}
+
+void UpnpXML_DIDLRenderObject(Ref<CdsObject> obj, bool renderActions, int stringLimit, Ref<StringBuffer> buf)
+{
+    int objectType = obj->getObjectType();
+    String name;
+    if (IS_CDS_ITEM(objectType))
+        name = _("item");
+    else if (IS_CDS_CONTAINER(objectType))
+        name = _("container");
+    else
+        name = _("");
 
-    if ((stringLimit > 0) && (tmp.length() > stringLimit))
+    *buf << '<' << name << " id=\"" << obj->getID()
+         << "\" parentID=\"" << obj->getParentID()
+         << "\" restricted=\"" << (obj->isRestricted() ? "1" : "0") << '"';
+    if (IS_CDS_CONTAINER(objectType))
     {
-        tmp = tmp.substring(0, getValidUTF8CutPosition(tmp, stringLimit-3));
-        tmp = tmp + _("...");
+        Ref<CdsContainer> cont = RefCast(obj, CdsContainer);
+        int childCount = cont->getChildCount();
+        if (childCount >= 0)
+            *buf << " childCount=\"" << childCount << '"';
     }
-   
-    result->appendTextChild(_("dc:title"), tmp);
+    *buf << '>';
+
+    UpnpXML_DIDLAppendElement(buf, _("dc:title"),
+                              limitString(obj->getTitle(), stringLimit));
     
-    result->appendTextChild(_("upnp:class"), obj->getClass());
+    UpnpXML_DIDLAppendElement(buf, _("upnp:class"), obj->getClass());
     
-    int objectType = obj->getObjectType();
     if (IS_CDS_ITEM(objectType))
     {
         Ref<CdsItem> item = RefCast(obj, CdsItem);
@@ -90,32 +162,21 @@ Ref<Element> UpnpXML_DIDLRenderObject(Ref<CdsObject> obj, bool renderActions, in
             key = el->getKey();
             if (key == MetadataHandler::getMetaFieldName(M_DESCRIPTION))
             {
-                tmp = el->getValue();
-                if ((stringLimit > 0) && (tmp.length() > stringLimit))
-                {
-                    tmp = tmp.substring(0, 
-                            getValidUTF8CutPosition(tmp, stringLimit-3));
-                    tmp = tmp + _("...");
-                }
-                result->appendTextChild(key, tmp);
+                UpnpXML_DIDLAppendElement(buf, key,
+                        limitString(el->getValue(), stringLimit));
             }
             else if (key == MetadataHandler::getMetaFieldName(M_TRACKNUMBER))
             {
                 if (upnp_class == UPNP_DEFAULT_CLASS_MUSIC_TRACK)
-                    result->appendTextChild(key, el->getValue());
+                    UpnpXML_DIDLAppendElement(buf, key, el->getValue());
             }
             else if ((key != MetadataHandler::getMetaFieldName(M_TITLE)) || 
                     ((key == MetadataHandler::getMetaFieldName(M_TRACKNUMBER)) && 
                      (upnp_class == UPNP_DEFAULT_CLASS_MUSIC_TRACK)))
-                result->appendTextChild(key, el->getValue());
+                UpnpXML_DIDLAppendElement(buf, key, el->getValue());
         }
         
-//        log_debug("ITEM HAS FOLLOWING METADATA: %s\n", item->getMetadata()->encode().c_str());
-        
-        
-        CdsResourceManager::addResources(item, result);
-        
-        result->setName(_("item"));
+        CdsResourceManager::addResources(item, buf);
     }
     else if (IS_CDS_CONTAINER(objectType))
     {
@@ -123,40 +184,34 @@ Ref<Element> UpnpXML_DIDLRenderObject(Ref<CdsObject> obj, bool renderActions, in
         Ref<Array<DictionaryElement> > elements = meta->getElements();
         int len = elements->size();
         
-        String key;
-        String upnp_class = obj->getClass();
-        
         // Check if the container has album art it should show and add it to the DIDL
         for (int i = 0; i < len; i++)
         {
             Ref<DictionaryElement> el = elements->get(i);
-            key = el->getKey();
-            if (key == MetadataHandler::getMetaFieldName(M_ALBUMARTURI))
-            {
-                result->appendTextChild(key, el->getValue());
-            }
+            if (el->getKey() == MetadataHandler::getMetaFieldName(M_ALBUMARTURI))
+                UpnpXML_DIDLAppendElement(buf, el->getKey(), el->getValue());
         }
-
-        Ref<CdsContainer> cont = RefCast(obj, CdsContainer);
-        
-        result->setName(_("container"));
-        int childCount = cont->getChildCount();
-        if (childCount >= 0)
-            result->setAttribute(_("childCount"), String::from(childCount));
     }
     
     if (renderActions && IS_CDS_ACTIVE_ITEM(objectType))
     {
         Ref<CdsActiveItem> aitem = RefCast(obj, CdsActiveItem);
-        result->appendTextChild(_("action"), aitem->getAction());
-        result->appendTextChild(_("state"), aitem->getState());
-        result->appendTextChild(_("location"), aitem->getLocation());
-        result->appendTextChild(_("mime-type"), aitem->getMimeType());
+        UpnpXML_DIDLAppendElement(buf, _("action"), aitem->getAction());
+        UpnpXML_DIDLAppendElement(buf, _("state"), aitem->getState());
+        UpnpXML_DIDLAppendElement(buf, _("location"), aitem->getLocation());
+        UpnpXML_DIDLAppendElement(buf, _("mime-type"), aitem->getMimeType());
     }
-   
-//    log_debug("renderen DIDL: \n%s\n", result->print().c_str());
 
-    return result;
+    *buf << "</" << name << '>';
+}
+
+Ref<Element> UpnpXML_DIDLRenderObject(Ref<CdsObject> obj, bool renderActions, int stringLimit)
+{
+    Ref<StringBuffer> buf(new StringBuffer());
+    UpnpXML_DIDLRenderObject(obj, renderActions, stringLimit, buf);
+
+    Ref<Parser> parser(new Parser());
+    return parser->parseString(buf->toString())->getRoot();
 }
 
 void UpnpXML_DIDLUpdateObject(Ref<CdsObject> obj, String text)
@@ -378,23 +433,7 @@ Ref<Element> UpnpXML_RenderDeviceDescription(String presentationURL)
     return root;
 }
 
-Ref<Element> UpnpXML_DIDLRenderResource(String URL, Ref<Dictionary> attributes)
+void UpnpXML_DIDLRenderResource(String URL, Ref<Dictionary> attributes, Ref<StringBuffer> buf)
 {
-    Ref<Element> res(new Element(_("res")));
-
-    res->setText(URL);
-
-    Ref<Array<DictionaryElement> > elements = attributes->getElements();
-    int len = elements->size();
-
-    String attribute;
-
-    for (int i = 0; i < len; i++)
-    {
-        Ref<DictionaryElement> el = elements->get(i);
-        attribute = el->getKey();
-        res->setAttribute(attribute, el->getValue());
-    }
-
-    return res;
+    UpnpXML_DIDLAppendElement(buf, _("res"), URL, attributes);
 }
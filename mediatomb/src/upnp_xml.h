@@ -47,6 +47,37 @@
 /// whatever can then be adapted to it.
 zmm::Ref<mxml::Element> UpnpXML_CreateResponse(zmm::String actionName, zmm::String serviceType);
 
+/// \brief Starts a serialized action response in the given buffer.
+/// \param buf Buffer the response is appended to.
+/// \param actionName Name of the action.
+/// \param serviceType Type of service.
+///
+/// Counterpart of UpnpXML_CreateResponse() for responses that are handed
+/// to the SDK as text (see ActionRequest::setResponse()). The output is
+/// laid out the way the SDK prints its own DOM, arguments are added with
+/// UpnpXML_AppendResponseArgument() and UpnpXML_EndResponse() closes the
+/// response.
+void UpnpXML_StartResponse(zmm::Ref<zmm::StringBuffer> buf, zmm::String actionName, zmm::String serviceType);
+
+/// \brief Appends an escaped argument to a serialized action response.
+void UpnpXML_AppendResponseArgument(zmm::Ref<zmm::StringBuffer> buf, zmm::String name, const char *value);
+
+/// \brief Closes a response started with UpnpXML_StartResponse().
+void UpnpXML_EndResponse(zmm::Ref<zmm::StringBuffer> buf, zmm::String actionName);
+
+/// \brief Appends the opening DIDL-Lite tag with all namespace declarations.
+void UpnpXML_DIDLStart(zmm::Ref<zmm::StringBuffer> buf);
+
+/// \brief Appends the closing DIDL-Lite tag.
+void UpnpXML_DIDLEnd(zmm::Ref<zmm::StringBuffer> buf);
+
+/// \brief Appends a text element to a DIDL-Lite buffer.
+/// \param buf Buffer the element is appended to.
+/// \param name Name of the element.
+/// \param text Text of the element, it will be escaped.
+/// \param attributes Attributes of the element in the order they are written, may be nil.
+void UpnpXML_DIDLAppendElement(zmm::Ref<zmm::StringBuffer> buf, zmm::String name, zmm::String text, zmm::Ref<Dictionary> attributes = nil);
+
 /// \brief Renders the DIDL-Lite representation of an object in the content directory.
 /// \param obj Object to be rendered as XML.
 /// \param renderActions If true, also render special elements of an active item.
@@ -58,6 +89,16 @@ zmm::Ref<mxml::Element> UpnpXML_CreateResponse(zmm::String actionName, zmm::Stri
 /// providing the XML representation of an active item to a trigger/toggle script.
 zmm::Ref<mxml::Element> UpnpXML_DIDLRenderObject(zmm::Ref<CdsObject> obj, bool renderActions = false, int stringLimit = -1);
 
+/// \brief Appends the DIDL-Lite representation of an object to a buffer.
+/// \param obj Object to be rendered as XML.
+/// \param renderActions If true, also render special elements of an active item.
+/// \param stringLimit Maximum length of the title and description, -1 for no limit.
+/// \param buf Buffer the XML is appended to.
+///
+/// Produces the same XML as the mxml::Element variant above without
+/// building a DOM, this is what the Browse action uses for every object.
+void UpnpXML_DIDLRenderObject(zmm::Ref<CdsObject> obj, bool renderActions, int stringLimit, zmm::Ref<zmm::StringBuffer> buf);
+
 /// \todo change the text string to element, parsing should be done outside
 void UpnpXML_DIDLUpdateObject(zmm::Ref<CdsObject> obj, zmm::String text);
 
@@ -75,5 +116,6 @@ zmm::Ref<mxml::Element> UpnpXML_RenderDeviceDescription(zmm::String presentation
 /// \brief Renders a resource tag (part of DIDL-Lite XML)
 /// \param URL download location of the item (will be child element of the <res> tag)
 /// \param attributes Dictionary containing the <res> tag attributes (like resolution, etc.)
-zmm::Ref<mxml::Element> UpnpXML_DIDLRenderResource(zmm::String URL, zmm::Ref<Dictionary> attributes);
+/// \param buf Buffer the tag is appended to.
+void UpnpXML_DIDLRenderResource(zmm::String URL, zmm::Ref<Dictionary> attributes, zmm::Ref<zmm::StringBuffer> buf);
 #endif // __UPNP_XML_H__
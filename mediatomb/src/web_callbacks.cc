@@ -312,6 +312,30 @@ static int web_close( IN UpnpWebFileHandle f)
     return 0;
 }
 
+/// \brief Returns the file descriptor behind an open file.
+/// \param f IOHandler for that file.
+/// \param offset Will be set to the current position in the file.
+///
+/// This function is called by the web server before it sends the data of
+/// a file, if the IOHandler is backed by a plain file the data is sent
+/// with sendfile() instead of web_read().
+///
+/// \return the file descriptor or -1 if the data has to be read.
+static int web_get_fd(IN UpnpWebFileHandle f, OUT off_t *offset)
+{
+    try
+    {
+        IOHandler *handler = (IOHandler *)f;
+        return handler->getFd(offset);
+    }
+    catch(Exception e)
+    {
+        log_error("web_get_fd(): Exception: %s\n", e.getMessage().c_str());
+        e.printStackTrace();
+        return -1;
+    }
+}
+
 /// \brief Registers callback functions for the internal web server.
 ///
 /// This function registers callbacks for the internal web server.
@@ -322,6 +346,7 @@ static int web_close( IN UpnpWebFileHandle f)
 /// \b web_write Sequentially write to a file (not supported).
 /// \b web_seek Perform a seek on a file.
 /// \b web_close Close file.
+/// \b web_get_fd Get the descriptor of a plain file for sendfile().
 /// 
 /// \return UPNP_E_SUCCESS Callbacks registered successfully, else eror code.
 int register_web_callbacks()
@@ -335,6 +360,7 @@ int register_web_callbacks()
     cb.write = web_write;
     cb.seek = web_seek;
     cb.close = web_close;
+    cb.get_fd = web_get_fd;
 
     ret = UpnpSetVirtualDirCallbacks(&cb);
     return ret;
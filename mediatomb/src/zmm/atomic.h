@@ -32,21 +32,100 @@
 #ifndef __ATOMIC_H__
 #define __ATOMIC_H__
 
-typedef struct { volatile int x; } mt_atomic_t;
-//#define ATOMIC_INIT(y) {(y)}
+// C++11 compilers use std::atomic, older ones the compiler builtins with
+// the same memory ordering
+#if defined(ATOMIC_BUILTIN) && __cplusplus >= 201103L
+    #define ATOMIC_STD
+    #include <atomic>
+#endif
+
+#ifdef ATOMIC_STD
+typedef struct { std::atomic<int> x; } mt_atomic_t;
 
 static inline void atomic_set(mt_atomic_t *at, int val)
 {
-    at->x = val;
+    at->x.store(val, std::memory_order_relaxed);
 }
+#else
+typedef struct { volatile int x; } mt_atomic_t;
+//#define ATOMIC_INIT(y) {(y)}
 
-static inline int atomic_get(mt_atomic_t *at)
+static inline void atomic_set(mt_atomic_t *at, int val)
 {
-    return (at->x);
+    at->x = val;
 }
+#endif
 
 #undef ATOMIC_DEFINED
 
+#ifdef ATOMIC_BUILTIN
+    #if defined(ATOMIC_X86_SMP) || defined(ATOMIC_X86) || defined(ATOMIC_TORTURE)
+        #error ATOMIC_BUILTIN and ATOMIC_X86(_SMP) or ATOMIC_TORTURE are defined at the same time!
+    #endif
+    #define ATOMIC_DEFINED
+#ifdef ATOMIC_STD
+    static inline int atomic_get(mt_atomic_t *at)
+    {
+        return at->x.load(std::memory_order_relaxed);
+    }
+
+    // taking a reference needs no ordering, the caller already holds one
+    static inline void atomic_inc(mt_atomic_t *at)
+    {
+        at->x.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // release orders our writes to the object before the decrement, acquire
+    // makes the writes of the other owners visible to the one deleting it
+    static inline bool atomic_dec(mt_atomic_t *at)
+    {
+        return (at->x.fetch_sub(1, std::memory_order_acq_rel) == 1);
+    }
+
+    // for flags that publish data: whoever sees the value written by
+    // atomic_set_release also sees the writes made before it
+    static inline int atomic_get_acquire(mt_atomic_t *at)
+    {
+        return at->x.load(std::memory_order_acquire);
+    }
+
+    static inline void atomic_set_release(mt_atomic_t *at, int val)
+    {
+        at->x.store(val, std::memory_order_release);
+    }
+#else
+    static inline int atomic_get(mt_atomic_t *at)
+    {
+        return __atomic_load_n(&at->x, __ATOMIC_RELAXED);
+    }
+
+    static inline void atomic_inc(mt_atomic_t *at)
+    {
+        __atomic_add_fetch(&at->x, 1, __ATOMIC_RELAXED);
+    }
+
+    static inline bool atomic_dec(mt_atomic_t *at)
+    {
+        return (__atomic_sub_fetch(&at->x, 1, __ATOMIC_ACQ_REL) == 0);
+    }
+
+    static inline int atomic_get_acquire(mt_atomic_t *at)
+    {
+        return __atomic_load_n(&at->x, __ATOMIC_ACQUIRE);
+    }
+
+    static inline void atomic_set_release(mt_atomic_t *at, int val)
+    {
+        __atomic_store_n(&at->x, val, __ATOMIC_RELEASE);
+    }
+#endif
+#else
+    static inline int atomic_get(mt_atomic_t *at)
+    {
+        return (at->x);
+    }
+#endif
+
 #ifdef ATOMIC_X86_SMP
     #ifdef ATOMIC_X86
         #error ATOMIC_X86_SMP and ATOMIC_X86 are defined at the same time!
@@ -81,6 +160,21 @@ static inline int atomic_get(mt_atomic_t *at)
         );
         return (c!=0);
     }
+
+    // x86 does not reorder loads with later accesses or stores with
+    // earlier ones, only the compiler has to be kept from doing it
+    static inline int atomic_get_acquire(mt_atomic_t *at)
+    {
+        int val = at->x;
+        __asm__ __volatile__("" : : : "memory");
+        return val;
+    }
+
+    static inline void atomic_set_release(mt_atomic_t *at, int val)
+    {
+        __asm__ __volatile__("" : : : "memory");
+        at->x = val;
+    }
 #endif
 
 #ifdef ATOMIC_TORTURE
@@ -100,6 +194,16 @@ static inline int atomic_get(mt_atomic_t *at)
     {
         return ((--at->x) == 0);
     }
+
+    static inline int atomic_get_acquire(mt_atomic_t *at)
+    {
+        return (at->x);
+    }
+
+    static inline void atomic_set_release(mt_atomic_t *at, int val)
+    {
+        at->x = val;
+    }
 #endif
 
 #ifndef ATOMIC_DEFINED
@@ -118,6 +222,19 @@ static inline int atomic_get(mt_atomic_t *at)
         pthread_mutex_unlock(mutex);
         return (newval == 0);
     }
+    static inline int atomic_get_acquire(mt_atomic_t *at, pthread_mutex_t *mutex)
+    {
+        pthread_mutex_lock(mutex);
+        int val = at->x;
+        pthread_mutex_unlock(mutex);
+        return val;
+    }
+    static inline void atomic_set_release(mt_atomic_t *at, int val, pthread_mutex_t *mutex)
+    {
+        pthread_mutex_lock(mutex);
+        at->x = val;
+        pthread_mutex_unlock(mutex);
+    }
 #else
     #undef ATOMIC_DEFINED
 #endif
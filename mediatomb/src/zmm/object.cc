@@ -38,6 +38,7 @@
 
 #include "object.h"
 #include "memory.h"
+#include "pool.h"
 
 using namespace zmm;
 
@@ -55,26 +56,6 @@ Object::~Object()
 #endif
 }
 
-void Object::retain()
-{
-#ifdef ATOMIC_NEED_MUTEX
-    atomic_inc(&_ref_count, &mutex);
-#else
-    atomic_inc(&_ref_count);
-#endif
-}
-void Object::release()
-{
-#ifdef ATOMIC_NEED_MUTEX
-    if(atomic_dec(&_ref_count, &mutex))
-#else
-    if(atomic_dec(&_ref_count))
-#endif
-    {
-        delete this;
-    }
-}
-
 int Object::getRefCount()
 {
     return atomic_get(&_ref_count);
@@ -82,9 +63,10 @@ int Object::getRefCount()
 
 void* Object::operator new (size_t size)
 {
-    return MALLOC(size);
+    return poolAlloc(size);
 }
-void Object::operator delete (void *ptr)
+void Object::operator delete (void *ptr, size_t size)
 {
-    FREE(ptr);
+    // the destructor is virtual, so size is the one of the actual class
+    poolFree(ptr, size);
 }
@@ -45,12 +45,33 @@ class Object
 public:
     Object();
     virtual ~Object();
-    void retain();
-    void release();
+
+    // every Ref<> copy retains and releases, so these are kept inline
+    inline void retain()
+    {
+#ifdef ATOMIC_NEED_MUTEX
+        atomic_inc(&_ref_count, &mutex);
+#else
+        atomic_inc(&_ref_count);
+#endif
+    }
+
+    inline void release()
+    {
+#ifdef ATOMIC_NEED_MUTEX
+        if(atomic_dec(&_ref_count, &mutex))
+#else
+        if(atomic_dec(&_ref_count))
+#endif
+        {
+            delete this;
+        }
+    }
+
     int getRefCount();
 
     static void* operator new (size_t size); 
-    static void operator delete (void *ptr);
+    static void operator delete (void *ptr, size_t size);
 protected:
     mt_atomic_t _ref_count;
 #ifdef ATOMIC_NEED_MUTEX
@@ -0,0 +1,360 @@
+/*MT*
+    
+    MediaTomb - http://www.mediatomb.cc/
+    
+    pool.cc - this file is part of MediaTomb.
+    
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+    
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+    
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+    
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+    
+    $Id$
+*/
+
+/// \file pool.cc
+
+#ifdef HAVE_CONFIG_H
+    #include "autoconfig.h"
+#endif
+
+#include <string.h>
+#include <pthread.h>
+
+#include "pool.h"
+#include "memory.h"
+
+using namespace zmm;
+
+#ifdef ZMM_POOL
+
+/// \brief block sizes are multiples of this
+#define POOL_CLASS_SIZE 16
+#define POOL_CLASSES (POOL_MAX_SIZE / POOL_CLASS_SIZE)
+
+/// \brief size of the chunks the blocks are cut from
+#define POOL_CHUNK_SIZE 32768
+
+/// \brief number of blocks moved between a thread cache and the global
+/// free lists at once
+#define POOL_BATCH 64
+
+/// \brief a thread cache keeps at most this many free blocks per class
+#define POOL_CACHE_MAX (POOL_BATCH * 4)
+
+/// \brief a thread adds its counters to the global ones after this many
+/// small allocations and frees; the peak is exact up to this many blocks
+/// per thread
+#define POOL_STATS_BATCH 256
+
+typedef struct pool_block_t pool_block_t;
+struct pool_block_t
+{
+    pool_block_t *next;
+};
+
+typedef struct pool_cache_t pool_cache_t;
+struct pool_cache_t
+{
+    pool_block_t *blocks[POOL_CLASSES];
+    int count[POOL_CLASSES];
+    /// \brief counter changes that were not added to poolStats yet; only
+    /// used by the owning thread
+    long allocations;
+    long frees;
+    long largeAllocations;
+    long bytes;
+    int pendingOps;
+    pool_cache_t *prev;
+    pool_cache_t *next;
+};
+
+static pthread_mutex_t poolMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t poolOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t poolKey;
+/// \brief the cache of the current thread, poolKey only serves to give
+/// its blocks back when the thread exits
+static __thread pool_cache_t *threadCache = NULL;
+/// \brief set when the cache was destroyed; allocations made by later
+/// thread specific destructors go to malloc, so no new cache is created
+/// that would never be destroyed
+static __thread bool threadExited = false;
+
+// protected by poolMutex
+static pool_block_t *globalBlocks[POOL_CLASSES];
+static pool_cache_t *caches = NULL;
+/// \brief unused rest of the current chunk of each class
+static char *chunkPos[POOL_CLASSES];
+static char *chunkEnd[POOL_CLASSES];
+/// \brief counters of all threads, without the pending changes of the
+/// thread caches
+static pool_stats_t poolStats;
+
+static inline int sizeClass(size_t size)
+{
+    return (size == 0) ? 0 : (int)((size - 1) / POOL_CLASS_SIZE);
+}
+
+/// \brief Adds counter changes to poolStats, poolMutex must be held.
+static void addStats(long allocations, long frees, long largeAllocations, long bytes)
+{
+    poolStats.allocations += allocations;
+    poolStats.frees += frees;
+    poolStats.largeAllocations += largeAllocations;
+    poolStats.bytesInUse += bytes;
+    if (poolStats.bytesInUse > poolStats.peakBytesInUse)
+        poolStats.peakBytesInUse = poolStats.bytesInUse;
+}
+
+/// \brief Adds the pending counters of a cache to poolStats.
+static void flushStats(pool_cache_t *cache)
+{
+    pthread_mutex_lock(&poolMutex);
+    addStats(cache->allocations, cache->frees, cache->largeAllocations, cache->bytes);
+    pthread_mutex_unlock(&poolMutex);
+    cache->allocations = 0;
+    cache->frees = 0;
+    cache->largeAllocations = 0;
+    cache->bytes = 0;
+    cache->pendingOps = 0;
+}
+
+/// \brief Moves up to count free blocks of a class from the cache to the
+/// global free list, poolMutex must be held.
+static void releaseBlocks(pool_cache_t *cache, int cls, int count)
+{
+    while ((count-- > 0) && cache->blocks[cls])
+    {
+        pool_block_t *block = cache->blocks[cls];
+        cache->blocks[cls] = block->next;
+        cache->count[cls]--;
+        block->next = globalBlocks[cls];
+        globalBlocks[cls] = block;
+    }
+}
+
+/// \brief Gives the blocks of an exiting thread back to the global lists.
+static void destroyCache(void *arg)
+{
+    pool_cache_t *cache = (pool_cache_t *)arg;
+    pthread_mutex_lock(&poolMutex);
+    for (int cls = 0; cls < POOL_CLASSES; cls++)
+        releaseBlocks(cache, cls, cache->count[cls]);
+
+    addStats(cache->allocations, cache->frees, cache->largeAllocations, cache->bytes);
+
+    if (cache->prev)
+        cache->prev->next = cache->next;
+    else
+        caches = cache->next;
+    if (cache->next)
+        cache->next->prev = cache->prev;
+    pthread_mutex_unlock(&poolMutex);
+    free(cache);
+    threadCache = NULL;
+    threadExited = true;
+}
+
+static void createKey()
+{
+    pthread_key_create(&poolKey, destroyCache);
+}
+
+static pool_cache_t *createCache()
+{
+    pthread_once(&poolOnce, createKey);
+    pool_cache_t *cache = (pool_cache_t *)calloc(1, sizeof(pool_cache_t));
+    if (! cache)
+        return NULL;
+    pthread_mutex_lock(&poolMutex);
+    cache->next = caches;
+    if (caches)
+        caches->prev = cache;
+    caches = cache;
+    pthread_mutex_unlock(&poolMutex);
+    pthread_setspecific(poolKey, cache);
+    threadCache = cache;
+    return cache;
+}
+
+static inline pool_cache_t *getCache()
+{
+    if (threadCache)
+        return threadCache;
+    if (threadExited)
+        return NULL;
+    return createCache();
+}
+
+/// \brief Fills the empty cache list of a class from the global free list,
+/// or from the current chunk of the class if the global list is empty.
+static void refill(pool_cache_t *cache, int cls)
+{
+    int blockSize = (cls + 1) * POOL_CLASS_SIZE;
+    pthread_mutex_lock(&poolMutex);
+    for (int i = 0; i < POOL_BATCH; i++)
+    {
+        pool_block_t *block = globalBlocks[cls];
+        if (block)
+            globalBlocks[cls] = block->next;
+        else
+        {
+            if (chunkPos[cls] + blockSize > chunkEnd[cls])
+            {
+                // the chunks are never freed, the blocks only move
+                // between the free lists
+                char *chunk = (char *)malloc(POOL_CHUNK_SIZE);
+                if (! chunk)
+                    break;
+                poolStats.bytesReserved += POOL_CHUNK_SIZE;
+                chunkPos[cls] = chunk;
+                chunkEnd[cls] = chunk + POOL_CHUNK_SIZE;
+            }
+            block = (pool_block_t *)chunkPos[cls];
+            chunkPos[cls] += blockSize;
+        }
+        block->next = cache->blocks[cls];
+        cache->blocks[cls] = block;
+        cache->count[cls]++;
+    }
+    pthread_mutex_unlock(&poolMutex);
+}
+
+void *zmm::poolAlloc(size_t size)
+{
+    pool_cache_t *cache = getCache();
+    if (! cache)
+    {
+        pthread_mutex_lock(&poolMutex);
+        addStats(1, 0, (size > POOL_MAX_SIZE ? 1 : 0), size);
+        pthread_mutex_unlock(&poolMutex);
+        // the block may end up in the free lists of its class, so it
+        // needs the full block size
+        if (size > POOL_MAX_SIZE)
+            return MALLOC(size);
+        return MALLOC((sizeClass(size) + 1) * POOL_CLASS_SIZE);
+    }
+
+    cache->allocations++;
+    cache->bytes += size;
+    if (size > POOL_MAX_SIZE)
+    {
+        // large blocks are rare and may be big, they are counted at once
+        cache->largeAllocations++;
+        flushStats(cache);
+        return MALLOC(size);
+    }
+    if (++cache->pendingOps >= POOL_STATS_BATCH)
+        flushStats(cache);
+
+    int cls = sizeClass(size);
+    if (! cache->blocks[cls])
+    {
+        refill(cache, cls);
+        if (! cache->blocks[cls])
+        {
+            cache->allocations--;
+            cache->bytes -= size;
+            return NULL;
+        }
+    }
+    pool_block_t *block = cache->blocks[cls];
+    cache->blocks[cls] = block->next;
+    cache->count[cls]--;
+    return block;
+}
+
+void zmm::poolFree(void *ptr, size_t size)
+{
+    if (! ptr)
+        return;
+
+    pool_cache_t *cache = getCache();
+    if (cache)
+    {
+        cache->frees++;
+        cache->bytes -= size;
+        if (size > POOL_MAX_SIZE || ++cache->pendingOps >= POOL_STATS_BATCH)
+            flushStats(cache);
+    }
+
+    if (size > POOL_MAX_SIZE)
+    {
+        if (! cache)
+        {
+            pthread_mutex_lock(&poolMutex);
+            addStats(0, 1, 0, -(long)size);
+            pthread_mutex_unlock(&poolMutex);
+        }
+        FREE(ptr);
+        return;
+    }
+
+    int cls = sizeClass(size);
+    pool_block_t *block = (pool_block_t *)ptr;
+    if (! cache)
+    {
+        // the block may come from a chunk, so it can't go to free()
+        pthread_mutex_lock(&poolMutex);
+        addStats(0, 1, 0, -(long)size);
+        block->next = globalBlocks[cls];
+        globalBlocks[cls] = block;
+        pthread_mutex_unlock(&poolMutex);
+        return;
+    }
+
+    block->next = cache->blocks[cls];
+    cache->blocks[cls] = block;
+    cache->count[cls]++;
+    // blocks freed by another thread than the one that allocated them
+    // would pile up here otherwise
+    if (cache->count[cls] > POOL_CACHE_MAX)
+    {
+        pthread_mutex_lock(&poolMutex);
+        releaseBlocks(cache, cls, POOL_BATCH);
+        pthread_mutex_unlock(&poolMutex);
+    }
+}
+
+void zmm::poolGetStats(pool_stats_t *stats)
+{
+    // the running threads still hold up to POOL_STATS_BATCH pending small
+    // allocations and frees each
+    pthread_mutex_lock(&poolMutex);
+    *stats = poolStats;
+    pthread_mutex_unlock(&poolMutex);
+}
+
+#else
+
+void *zmm::poolAlloc(size_t size)
+{
+    return MALLOC(size);
+}
+
+void zmm::poolFree(void *ptr, size_t size)
+{
+    FREE(ptr);
+}
+
+void zmm::poolGetStats(pool_stats_t *stats)
+{
+    memset(stats, 0, sizeof(pool_stats_t));
+}
+
+#endif // ZMM_POOL
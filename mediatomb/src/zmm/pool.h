@@ -0,0 +1,81 @@
+/*MT*
+    
+    MediaTomb - http://www.mediatomb.cc/
+    
+    pool.h - this file is part of MediaTomb.
+    
+    Copyright (C) 2005 Gena Batyan <bgeradz@mediatomb.cc>,
+                       Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>
+    
+    Copyright (C) 2006-2010 Gena Batyan <bgeradz@mediatomb.cc>,
+                            Sergey 'Jin' Bostandzhyan <jin@mediatomb.cc>,
+                            Leonhard Wimmer <leo@mediatomb.cc>
+    
+    MediaTomb is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+    
+    MediaTomb is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    version 2 along with MediaTomb; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+    
+    $Id$
+*/
+
+/// \file pool.h
+/// \brief Size class allocator for the small zmm objects and string buffers.
+
+#ifndef __ZMM_POOL_H__
+#define __ZMM_POOL_H__
+
+#include <stdlib.h>
+
+/// \brief blocks up to this size are served from the pool, larger ones
+/// from malloc
+#define POOL_MAX_SIZE 256
+
+namespace zmm
+{
+
+typedef struct pool_stats_t pool_stats_t;
+struct pool_stats_t
+{
+    /// \brief number of poolAlloc() calls
+    long long allocations;
+    /// \brief number of poolFree() calls
+    long long frees;
+    /// \brief number of poolAlloc() calls over POOL_MAX_SIZE, which went
+    /// to malloc
+    long long largeAllocations;
+    /// \brief bytes currently handed out, including the blocks from malloc
+    long long bytesInUse;
+    /// \brief highest bytesInUse so far
+    long long peakBytesInUse;
+    /// \brief memory the pool took from malloc for its blocks; the pool
+    /// never gives it back, so this is also the peak
+    long long bytesReserved;
+};
+
+/// \brief Allocates a block of the given size.
+///
+/// Small blocks come from a per thread cache of free blocks, which is
+/// refilled from a global free list or a new chunk when it runs empty. If
+/// the pool was disabled at configure time this is MALLOC().
+void *poolAlloc(size_t size);
+
+/// \brief Returns a block from poolAlloc(), size must be the same as in
+/// the poolAlloc() call.
+void poolFree(void *ptr, size_t size);
+
+/// \brief Fills in the allocation counters of all threads. Each running
+/// thread may still hold back a few hundred small allocations and frees.
+void poolGetStats(pool_stats_t *stats);
+
+} // namespace
+
+#endif // __ZMM_POOL_H__
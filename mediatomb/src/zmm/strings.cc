@@ -36,6 +36,7 @@
 #include <ctype.h>
 
 #include "memory.h"
+#include "pool.h"
 #include "strings.h"
 
 using namespace zmm;
@@ -43,29 +44,48 @@ using namespace zmm;
 StringBase::StringBase(int capacity) : Object()
 {
     len = capacity;
-    data = (char *)MALLOC((len + 1) * sizeof(char));
-    store = true;
+    allocData();
 }
 StringBase::StringBase(const char *str) : Object()
 {
     len = (int)strlen(str);
-    data = (char *)MALLOC((len + 1) * sizeof(char));
+    allocData();
     strcpy(data, str);
-    store = true;
 }
 StringBase::StringBase(const char *str, int len) : Object()
 {
     this->len = len;
-    data = (char *)MALLOC((len + 1) * sizeof(char));
+    allocData();
     memcpy(data, str, len);
     data[len] = 0;
-    store = true;
 }
 
 StringBase::~StringBase()
 {
     if (store)
-        FREE(data);
+    {
+        if (poolSize)
+            poolFree(data, poolSize);
+        else
+            FREE(data);
+    }
+}
+
+void StringBase::allocData()
+{
+    // len may shrink later, so the size is remembered for poolFree()
+    int size = (len + 1) * sizeof(char);
+    if (size <= POOL_MAX_SIZE)
+    {
+        data = (char *)poolAlloc(size);
+        poolSize = size;
+    }
+    else
+    {
+        data = (char *)MALLOC(size);
+        poolSize = 0;
+    }
+    store = true;
 }
 
 bool StringBase::startsWith(StringBase *other)
@@ -63,6 +63,8 @@ public:
     char *data;
     int len;
     bool store; // if true, the object is responsible for freeing data
+    // size of data if it came from poolAlloc(), 0 if it has to be FREE'd
+    unsigned short poolSize;
     
     StringBase(int capacity);
     StringBase(const char *str);
@@ -70,7 +72,8 @@ public:
     bool startsWith(StringBase *other);
     virtual ~StringBase();
 protected:
-    inline StringBase() : Object() {}
+    inline StringBase() : Object() { poolSize = 0; }
+    void allocData();
     friend class String;
 };
 
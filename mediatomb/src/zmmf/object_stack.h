@@ -59,7 +59,8 @@ namespace zmm
         inline void push(Ref<T> element)
         {
             Object *obj = element.getPtr();
-            obj->retain();
+            if (obj)
+                obj->retain();
             BaseStack<Object *>::push(obj);
         }
         
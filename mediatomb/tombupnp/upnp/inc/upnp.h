@@ -722,6 +722,11 @@ struct Upnp_Action_Request
   /** The DOM document containing the information from the
       the SOAP header. */
   IXML_Document *SoapHeader;
+
+  /** The result of the action as serialized XML, sent instead of
+      {\bf ActionResult} if it is set. It has to be allocated with
+      {\tt malloc}, the SDK frees it after the response was sent. */
+  char *ActionResultString;
 };
 
 struct Upnp_Action_Complete
@@ -1024,6 +1029,20 @@ struct UpnpVirtualDirCallbacks
      IN UpnpWebFileHandle fileHnd   /** The handle of the file to close. */
      );
 
+   /** Called by the web server before it sends a non-chunked response to
+    *  find out if the data of an open file can be sent directly from a file
+    *  descriptor (i.e. with {\tt sendfile}). The callback should return the
+    *  descriptor and store the current position of the handle in 
+    *  {\bf offset}, or return -1 if the handle is not backed by a plain
+    *  file. The web server does not move the position of the descriptor and
+    *  still calls {\bf close} on the handle when it is done. This callback
+    *  is optional and may be {\tt NULL}.
+    */
+   int (*get_fd) (
+     IN UpnpWebFileHandle fileHnd,  /** The handle of the open file. */
+     OUT off_t *offset              /** The current position in the file. */
+     );
+
 };
 
 typedef struct virtual_Dir_List
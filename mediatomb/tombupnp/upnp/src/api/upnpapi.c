@@ -4488,6 +4488,7 @@ UpnpSetVirtualDirCallbacks( IN struct UpnpVirtualDirCallbacks *callbacks )
     pCallback->read = callbacks->read;
     pCallback->write = callbacks->write;
     pCallback->seek = callbacks->seek;
+    pCallback->get_fd = callbacks->get_fd;
 
     return UPNP_E_SUCCESS;
 }
@@ -68,6 +68,9 @@
  #include <sys/wait.h>
  #include <unistd.h>
  #include <sys/time.h>
+ #ifdef HAVE_SYS_EPOLL_H
+  #include <sys/epoll.h>
+ #endif
 #else
  #include <winsock2.h>
 
@@ -78,6 +81,7 @@
 #include "ithread.h"
 
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -96,12 +100,40 @@
 
 #define APPLICATION_LISTENING_PORT 49152
 
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_EPOLL_CREATE)
+ #define MSERV_USE_EPOLL 1
+#endif
+
+// maximum number of events handled per epoll_wait call
+#define MSERV_MAX_EVENTS 64
+
 struct mserv_request_t {
     int connfd;                 // connection handle
     struct in_addr foreign_ip_addr;
     unsigned short foreign_ip_port;
+
+    // set if the request was already read by the event loop, the worker
+    // then only dispatches it
+    int parsed;
+    http_parser_t parser;
+    int http_error_code;        // error to send instead of dispatching
+    xboolean ok_on_close;       // entity is read until the peer closes
+    time_t expires;             // connection is dropped if idle until then
+    struct mserv_request_t *prev,
+     *next;                     // connections owned by the event loop
+
+    // persistent connections
+    int requests;               // number of requests served so far
+    xboolean close_after;       // the connection can't be kept open
+    char *pipelined;            // data of the next request, if the
+    size_t pipelined_length;    // client sent it with the current one
 };
 
+#ifdef MSERV_USE_EPOLL
+static int keep_connection( struct mserv_request_t *request );
+static int wants_keep_alive( http_message_t *hmsg );
+#endif
+
 typedef enum { MSERV_IDLE, MSERV_RUNNING, MSERV_STOPPING } MiniServerState;
 
 unsigned short miniStopSockPort;
@@ -282,6 +314,10 @@ free_handle_request_arg( void *args )
 
     shutdown( request->connfd, SD_BOTH );
     UpnpCloseSocket( request->connfd );
+    if( request->parsed ) {
+        httpmsg_destroy( &request->parser.msg );
+        free( request->pipelined );
+    }
     free( request );
 }
 
@@ -305,10 +341,10 @@ handle_request( void *args )
     int ret_code;
     int major = 1;
     int minor = 1;
-    http_parser_t parser;
     http_message_t *hmsg = NULL;
     int timeout = HTTP_DEFAULT_TIMEOUT;
     struct mserv_request_t *request = ( struct mserv_request_t * )args;
+    http_parser_t *parser = &request->parser;
     int connfd = request->connfd;
 
     DBGONLY( UpnpPrintf
@@ -316,19 +352,43 @@ handle_request( void *args )
                "miniserver %d: READING\n", connfd );
          )
         //parser_request_init( &parser ); ////LEAK_FIX_MK
-        hmsg = &parser.msg;
+        hmsg = &parser->msg;
 
     if( sock_init_with_ip( &info, connfd, request->foreign_ip_addr,
                            request->foreign_ip_port ) != UPNP_E_SUCCESS ) {
+        // hmsg lives inside the request, destroy it before freeing; the
+        // parser is only initialized once the event loop has read into it
+        if( request->parsed ) {
+            httpmsg_destroy( hmsg );
+            free( request->pipelined );
+        }
+        shutdown( connfd, SD_BOTH );
+        UpnpCloseSocket( connfd );
         free( request );
-        httpmsg_destroy( hmsg );
         return;
     }
-    // read
-    ret_code = http_RecvMessage( &info, &parser, HTTPMETHOD_UNKNOWN,
-                                 &timeout, &http_error_code );
-    if( ret_code != 0 ) {
-        goto error_handler;
+
+    if( request->parsed ) {
+        // the event loop has read the whole request already, the 
+        // handlers expect a blocking socket
+        fcntl( connfd, F_SETFL, fcntl( connfd, F_GETFL ) & ~O_NONBLOCK );
+        http_error_code = request->http_error_code;
+        if( http_error_code != 0 ) {
+            goto error_handler;
+        }
+#ifdef MSERV_USE_EPOLL
+        request->requests++;
+        info.keep_alive_allowed = !request->close_after &&
+            ( request->requests < HTTP_KEEPALIVE_MAX_REQUESTS ) &&
+            wants_keep_alive( hmsg );
+#endif
+    } else {
+        // read
+        ret_code = http_RecvMessage( &info, parser, HTTPMETHOD_UNKNOWN,
+                                     &timeout, &http_error_code );
+        if( ret_code != 0 ) {
+            goto error_handler;
+        }
     }
 
     DBGONLY( UpnpPrintf
@@ -336,7 +396,7 @@ handle_request( void *args )
                "miniserver %d: PROCESSING...\n", connfd );
          )
         // dispatch
-        http_error_code = dispatch_request( &info, &parser );
+        http_error_code = dispatch_request( &info, parser );
     if( http_error_code != 0 ) {
         goto error_handler;
     }
@@ -356,9 +416,21 @@ handle_request( void *args )
              ( UPNP_INFO, MSERV, __FILE__, __LINE__,
                "miniserver %d: COMPLETE\n", connfd );
          )
+
+#ifdef MSERV_USE_EPOLL
+    if( info.keep_alive ) {
+        httpmsg_destroy( hmsg );
+        if( keep_connection( request ) ) {
+            return;
+        }
+    }
+#endif
+
         sock_destroy( &info, SD_BOTH ); //should shutdown completely
 
     httpmsg_destroy( hmsg );
+    if( request->parsed )
+        free( request->pipelined );
     free( request );
 }
 
@@ -400,6 +472,7 @@ schedule_request_job( IN int connfd,
     request->connfd = connfd;
     request->foreign_ip_addr = clientAddr->sin_addr;
     request->foreign_ip_port = ntohs( clientAddr->sin_port );
+    request->parsed = FALSE;
 
     TPJobInit( &job, ( start_routine ) handle_request, ( void * )request );
     TPJobSetFreeFunction( &job, free_handle_request_arg );
@@ -418,6 +491,659 @@ schedule_request_job( IN int connfd,
 
 }
 
+#ifdef MSERV_USE_EPOLL
+// connections owned by the event loop
+typedef struct {
+    struct mserv_request_t **conns;     // indexed by descriptor
+    int size;
+    struct mserv_request_t *head;
+} mserv_conn_table;
+
+// state of the event loop; workers hand persistent connections back to
+// it, so the table is guarded by gConnMutex. Workers only add entries,
+// everything else is done by the loop thread
+static int gEpollFd = -1;
+static mserv_conn_table gConnTable;
+static ithread_mutex_t gConnMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/************************************************************************
+*	Function :	read_stop_request
+*
+*	Parameters :
+*		SOCKET miniServStopSock ;	Socket the stop request is sent to
+*
+*	Description :	Reads a datagram from the stop socket
+*
+*	Return :	int ;
+*		TRUE if the miniserver should shut down
+*
+*	Note :
+************************************************************************/
+static int
+read_stop_request( SOCKET miniServStopSock )
+{
+    struct sockaddr_in clientAddr;
+    socklen_t clientLen;
+    int byteReceived;
+    char requestBuf[256];
+
+    clientLen = sizeof( struct sockaddr_in );
+    memset( ( char * )&clientAddr, 0, sizeof( struct sockaddr_in ) );
+    byteReceived = recvfrom( miniServStopSock, requestBuf, 25, 0,
+                             ( struct sockaddr * )&clientAddr,
+                             &clientLen );
+    if( byteReceived > 0 ) {
+        requestBuf[byteReceived] = '\0';
+        DBGONLY( UpnpPrintf
+                 ( UPNP_INFO, MSERV, __FILE__, __LINE__,
+                   "Received response !!!  %s From host %s \n",
+                   requestBuf, inet_ntoa( clientAddr.sin_addr ) );
+             )
+
+            if( NULL != strstr( requestBuf, "ShutDown" ) )
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/************************************************************************
+*	Function :	conn_table_add
+*
+*	Parameters :
+*		mserv_conn_table *table ;	Connections of the event loop
+*		struct mserv_request_t *request ;	Connection to add
+*
+*	Description :	Adds a connection to the table, grows the table if
+*		the descriptor does not fit
+*
+*	Return :	int ;
+*		0 - On Success
+*		-1 - out of memory
+*
+*	Note :
+************************************************************************/
+static int
+conn_table_add( mserv_conn_table * table,
+                struct mserv_request_t *request )
+{
+    if( request->connfd >= table->size ) {
+        int newSize = table->size * 2;
+        struct mserv_request_t **newConns;
+
+        if( newSize <= request->connfd )
+            newSize = request->connfd + 64;
+        newConns = ( struct mserv_request_t ** )
+            realloc( table->conns, newSize * sizeof( *newConns ) );
+        if( newConns == NULL )
+            return -1;
+        memset( newConns + table->size, 0,
+                ( newSize - table->size ) * sizeof( *newConns ) );
+        table->conns = newConns;
+        table->size = newSize;
+    }
+
+    request->prev = NULL;
+    request->next = table->head;
+    if( table->head )
+        table->head->prev = request;
+    table->head = request;
+    table->conns[request->connfd] = request;
+    return 0;
+}
+
+/************************************************************************
+*	Function :	conn_table_remove
+*
+*	Parameters :
+*		mserv_conn_table *table ;	Connections of the event loop
+*		struct mserv_request_t *request ;	Connection to remove
+*
+*	Description :	Removes a connection from the table, the connection
+*		itself is left alone
+*
+*	Return :	void
+*
+*	Note :
+************************************************************************/
+static void
+conn_table_remove( mserv_conn_table * table,
+                   struct mserv_request_t *request )
+{
+    if( request->prev )
+        request->prev->next = request->next;
+    else
+        table->head = request->next;
+    if( request->next )
+        request->next->prev = request->prev;
+    table->conns[request->connfd] = NULL;
+}
+
+/************************************************************************
+*	Function :	free_connection
+*
+*	Parameters :
+*		struct mserv_request_t *request ;	Connection to close
+*
+*	Description :	Closes a connection that is not in the table or in
+*		the thread pool and frees it
+*
+*	Return :	void
+*
+*	Note :
+************************************************************************/
+static void
+free_connection( struct mserv_request_t *request )
+{
+    shutdown( request->connfd, SD_BOTH );
+    UpnpCloseSocket( request->connfd );
+    httpmsg_destroy( &request->parser.msg );
+    free( request->pipelined );
+    free( request );
+}
+
+/************************************************************************
+*	Function :	reset_request
+*
+*	Parameters :
+*		struct mserv_request_t *request ;	Connection
+*
+*	Description :	Prepares the parser of a connection for the next
+*		request; the previous message has to be destroyed already
+*
+*	Return :	void
+*
+*	Note :
+************************************************************************/
+static void
+reset_request( struct mserv_request_t *request )
+{
+    parser_request_init( &request->parser );
+    request->http_error_code = 0;
+    request->ok_on_close = FALSE;
+}
+
+/************************************************************************
+*	Function :	wants_keep_alive
+*
+*	Parameters :
+*		http_message_t *hmsg ;	HTTP request
+*
+*	Description :	Checks if the client asked for a persistent
+*		connection: HTTP/1.1 connections are persistent unless the
+*		request says "Connection: close", HTTP/1.0 ones only with
+*		"Connection: Keep-Alive"
+*
+*	Return :	int ;
+*		TRUE if the connection may be kept open
+*
+*	Note :
+************************************************************************/
+static int
+wants_keep_alive( http_message_t *hmsg )
+{
+    http_header_t *header;
+    char value[64];
+    size_t length;
+    size_t i;
+    int http_1_1 = ( hmsg->major_version > 1 ) ||
+        ( hmsg->major_version == 1 && hmsg->minor_version >= 1 );
+
+    header = httpmsg_find_hdr_str( hmsg, "CONNECTION" );
+    if( header == NULL ) {
+        return http_1_1;
+    }
+
+    length = header->value.length;
+    if( length >= sizeof( value ) )
+        length = sizeof( value ) - 1;
+    for( i = 0; i < length; i++ )
+        value[i] = tolower( header->value.buf[i] );
+    value[length] = '\0';
+
+    if( http_1_1 )
+        return strstr( value, "close" ) == NULL;
+    return strstr( value, "keep-alive" ) != NULL;
+}
+
+/************************************************************************
+*	Function :	append_request_data
+*
+*	Parameters :
+*		struct mserv_request_t *request ;	Connection
+*		char *buf ;	Data received on the connection
+*		size_t length ;	Length of the data
+*
+*	Description :	Feeds data to the request parser. Data behind a
+*		complete request belongs to the next one of a pipelining client,
+*		it is saved in request->pipelined
+*
+*	Return :	int ;
+*		0 - the request is not complete yet
+*		1 - the request is complete or http_error_code is set, it
+*			can be dispatched
+*
+*	Note :
+************************************************************************/
+static int
+append_request_data( struct mserv_request_t *request,
+                     char *buf,
+                     size_t length )
+{
+    http_parser_t *parser = &request->parser;
+    size_t before = parser->msg.msg.length;
+    size_t end;
+    parse_status_t status;
+
+    status = parser_append( parser, buf, length );
+
+    if( status == PARSE_SUCCESS ) {
+        if( parser->content_length > g_maxContentLength ) {
+            request->http_error_code = HTTP_REQ_ENTITY_TOO_LARGE;
+            return 1;
+        }
+        if( parser->ent_position == ENTREAD_USING_CHUNKED ) {
+            // the end of a chunked entity is not known here
+            request->close_after = TRUE;
+            return 1;
+        }
+        end = parser->entity_start_position + parser->msg.entity.length;
+        if( end < parser->msg.msg.length ) {
+            request->pipelined_length = parser->msg.msg.length - end;
+            request->pipelined = ( char * )
+                malloc( request->pipelined_length );
+            if( request->pipelined == NULL ) {
+                request->pipelined_length = 0;
+                request->close_after = TRUE;
+                return 1;
+            }
+            memcpy( request->pipelined, parser->msg.msg.buf + end,
+                    request->pipelined_length );
+            // the parser terminates the entity by overwriting the first
+            // byte behind it
+            if( end >= before )
+                request->pipelined[0] = buf[end - before];
+        }
+        return 1;
+    } else if( status == PARSE_FAILURE ) {
+        request->http_error_code = parser->http_error_code;
+        return 1;
+    } else if( status == PARSE_INCOMPLETE_ENTITY ) {
+        // read until close
+        request->ok_on_close = TRUE;
+        request->close_after = TRUE;
+    } else if( status == PARSE_CONTINUE_1 ) {
+        // web post request, the handler reads the entity itself
+        request->close_after = TRUE;
+        return 1;
+    }
+    return 0;
+}
+
+/************************************************************************
+*	Function :	read_request
+*
+*	Parameters :
+*		struct mserv_request_t *request ;	Connection to read from
+*
+*	Description :	Reads everything that is available on a non-blocking
+*		connection and appends it to the request parser
+*
+*	Return :	int ;
+*		0 - the request is not complete yet
+*		1 - the request is complete or http_error_code is set, it
+*			can be dispatched
+*		-1 - the connection should be closed without a response
+*
+*	Note :
+************************************************************************/
+static int
+read_request( struct mserv_request_t *request )
+{
+    char buf[2 * 1024];
+    int num_read;
+
+    while( TRUE ) {
+        num_read = recv( request->connfd, buf, sizeof( buf ), MSG_NOSIGNAL );
+        if( num_read > 0 ) {
+            request->expires = time( NULL ) + HTTP_DEFAULT_TIMEOUT;
+            if( append_request_data( request, buf, num_read ) ) {
+                return 1;
+            }
+        } else if( num_read == 0 ) {
+            if( request->ok_on_close ) {
+                return 1;
+            }
+            // closed before anything was sent, e.g. an idle persistent
+            // connection
+            if( request->parser.msg.msg.length == 0 ) {
+                return -1;
+            }
+            // partial msg
+            request->http_error_code = HTTP_BAD_REQUEST;
+            request->close_after = TRUE;
+            return 1;
+        } else {
+            if( errno == EINTR )
+                continue;
+            if( errno == EAGAIN || errno == EWOULDBLOCK )
+                return 0;
+            return -1;
+        }
+    }
+}
+
+/************************************************************************
+*	Function :	schedule_parsed_request
+*
+*	Parameters :
+*		struct mserv_request_t *request ;	Connection with a complete
+*			request
+*
+*	Description :	Adds a job to the thread pool that handles a request
+*		read by the event loop
+*
+*	Return :	int ;
+*		0 - On Success
+*		-1 - the job could not be added, the caller still owns the 
+*			connection
+*
+*	Note :
+************************************************************************/
+static int
+schedule_parsed_request( struct mserv_request_t *request )
+{
+    ThreadPoolJob job;
+
+    TPJobInit( &job, ( start_routine ) handle_request, ( void * )request );
+    TPJobSetFreeFunction( &job, free_handle_request_arg );
+    TPJobSetPriority( &job, MED_PRIORITY );
+
+    if( ThreadPoolAdd( &gRecvThreadPool, &job, NULL ) != 0 ) {
+        DBGONLY( UpnpPrintf
+                 ( UPNP_INFO, MSERV, __FILE__, __LINE__,
+                   "mserv %d: cannot schedule request\n",
+                   request->connfd );
+             )
+            return -1;
+    }
+    return 0;
+}
+
+/************************************************************************
+*	Function :	keep_connection
+*
+*	Parameters :
+*		struct mserv_request_t *request ;	Connection that answered 
+*			a request with a persistent response
+*
+*	Description :	Called by a worker after a persistent response. A 
+*		pipelined request that is already complete is scheduled right
+*		away, otherwise the connection goes back to the event loop
+*		and waits there for the next request
+*
+*	Return :	int ;
+*		TRUE if the connection was handed over, FALSE if the caller 
+*			has to close it
+*
+*	Note :	The message of the previous request has to be destroyed
+************************************************************************/
+static int
+keep_connection( struct mserv_request_t *request )
+{
+    struct epoll_event ev;
+    char *data = request->pipelined;
+    size_t length = request->pipelined_length;
+    int complete = 0;
+    int kept = FALSE;
+
+    request->pipelined = NULL;
+    request->pipelined_length = 0;
+    reset_request( request );
+    request->expires = time( NULL ) + HTTP_KEEPALIVE_TIMEOUT;
+
+    if( data != NULL ) {
+        complete = append_request_data( request, data, length );
+        free( data );
+    }
+    if( complete ) {
+        return schedule_parsed_request( request ) == 0;
+    }
+
+    fcntl( request->connfd, F_SETFL,
+           fcntl( request->connfd, F_GETFL ) | O_NONBLOCK );
+
+    ithread_mutex_lock( &gConnMutex );
+    if( gEpollFd >= 0 && conn_table_add( &gConnTable, request ) == 0 ) {
+        memset( &ev, 0, sizeof( ev ) );
+        ev.events = EPOLLIN;
+        ev.data.fd = request->connfd;
+        if( epoll_ctl( gEpollFd, EPOLL_CTL_ADD, request->connfd, &ev ) == 0 )
+            kept = TRUE;
+        else
+            conn_table_remove( &gConnTable, request );
+    }
+    ithread_mutex_unlock( &gConnMutex );
+
+    return kept;
+}
+
+/************************************************************************
+*	Function :	RunEventLoop
+*
+*	Parameters :
+*		MiniServerSockArray *miniSock ;	Socket Array
+*
+*	Description :	epoll based main loop of the miniserver. Accepted 
+*		connections stay in the loop until a complete request has been
+*		read, only then a job is scheduled to handle it, so no thread
+*		of the pool waits for slow or idle clients. Persistent 
+*		connections come back to the loop after the response. 
+*		Connections that do not send a complete request within 
+*		HTTP_DEFAULT_TIMEOUT (HTTP_KEEPALIVE_TIMEOUT between two 
+*		requests) are dropped
+*
+*	Return :	int ;
+*		0 - the miniserver was stopped
+*		-1 - epoll is not available, the caller has to run the select 
+*			loop instead
+*
+*	Note :
+************************************************************************/
+static int
+RunEventLoop( MiniServerSockArray * miniSock )
+{
+    struct epoll_event ev;
+    struct epoll_event events[MSERV_MAX_EVENTS];
+    struct sockaddr_in clientAddr;
+    socklen_t clientLen;
+    SOCKET connectHnd;
+    int epfd;
+    int nfds;
+    int i;
+    int fd;
+    int ret;
+    int stop = FALSE;
+    time_t now;
+    time_t lastSweep = 0;
+    struct mserv_request_t *request;
+    struct mserv_request_t *next;
+    struct mserv_request_t *expired;
+
+    epfd = epoll_create( MSERV_MAX_EVENTS );
+    if( epfd < 0 ) {
+        return -1;
+    }
+
+    memset( &ev, 0, sizeof( ev ) );
+    ev.events = EPOLLIN;
+    ev.data.fd = miniSock->miniServerSock;
+    epoll_ctl( epfd, EPOLL_CTL_ADD, miniSock->miniServerSock, &ev );
+    ev.data.fd = miniSock->miniServerStopSock;
+    epoll_ctl( epfd, EPOLL_CTL_ADD, miniSock->miniServerStopSock, &ev );
+    ev.data.fd = miniSock->ssdpSock;
+    epoll_ctl( epfd, EPOLL_CTL_ADD, miniSock->ssdpSock, &ev );
+    CLIENTONLY( ev.data.fd = miniSock->ssdpReqSock;
+                epoll_ctl( epfd, EPOLL_CTL_ADD, miniSock->ssdpReqSock, &ev );
+         )
+
+    ithread_mutex_lock( &gConnMutex );
+    memset( &gConnTable, 0, sizeof( gConnTable ) );
+    gEpollFd = epfd;
+    ithread_mutex_unlock( &gConnMutex );
+
+    while( !stop ) {
+        nfds = epoll_wait( epfd, events, MSERV_MAX_EVENTS, 1000 );
+        if( nfds < 0 ) {
+            if( errno != EINTR ) {
+                DBGONLY( UpnpPrintf
+                         ( UPNP_CRITICAL, SSDP, __FILE__, __LINE__,
+                           "Error in epoll_wait call !!!\n" );
+                     )
+            }
+            continue;
+        }
+
+        for( i = 0; i < nfds; i++ ) {
+            fd = events[i].data.fd;
+
+            if( fd == miniSock->miniServerSock ) {
+                clientLen = sizeof( struct sockaddr_in );
+                connectHnd = accept( miniSock->miniServerSock,
+                                     ( struct sockaddr * )&clientAddr,
+                                     &clientLen );
+                if( connectHnd == UPNP_INVALID_SOCKET ) {
+                    DBGONLY( UpnpPrintf
+                             ( UPNP_INFO, MSERV, __FILE__, __LINE__,
+                               "miniserver: Error"
+                               " in accepting connection\n" );
+                         )
+                        continue;
+                }
+
+                request = ( struct mserv_request_t * )
+                    malloc( sizeof( struct mserv_request_t ) );
+                if( request == NULL ) {
+                    DBGONLY( UpnpPrintf
+                             ( UPNP_INFO, MSERV, __FILE__, __LINE__,
+                               "mserv %d: out of memory\n", connectHnd );
+                         )
+                        shutdown( connectHnd, SD_BOTH );
+                    UpnpCloseSocket( connectHnd );
+                    continue;
+                }
+
+                request->connfd = connectHnd;
+                request->foreign_ip_addr = clientAddr.sin_addr;
+                request->foreign_ip_port = ntohs( clientAddr.sin_port );
+                request->parsed = TRUE;
+                request->requests = 0;
+                request->close_after = FALSE;
+                request->pipelined = NULL;
+                request->pipelined_length = 0;
+                request->expires = time( NULL ) + HTTP_DEFAULT_TIMEOUT;
+                reset_request( request );
+
+                fcntl( connectHnd, F_SETFL,
+                       fcntl( connectHnd, F_GETFL ) | O_NONBLOCK );
+
+                ithread_mutex_lock( &gConnMutex );
+                ret = conn_table_add( &gConnTable, request );
+                ithread_mutex_unlock( &gConnMutex );
+                if( ret != 0 ) {
+                    free_connection( request );
+                    continue;
+                }
+
+                ev.events = EPOLLIN;
+                ev.data.fd = connectHnd;
+                if( epoll_ctl( epfd, EPOLL_CTL_ADD, connectHnd, &ev ) != 0 ) {
+                    ithread_mutex_lock( &gConnMutex );
+                    conn_table_remove( &gConnTable, request );
+                    ithread_mutex_unlock( &gConnMutex );
+                    free_connection( request );
+                }
+            } else if( fd == miniSock->miniServerStopSock ) {
+                if( read_stop_request( miniSock->miniServerStopSock ) ) {
+                    stop = TRUE;
+                    break;
+                }
+            } else if( fd == miniSock->ssdpSock ) {
+                readFromSSDPSocket( miniSock->ssdpSock );
+            }
+            CLIENTONLY( else if( fd == miniSock->ssdpReqSock ) {
+                        readFromSSDPSocket( miniSock->ssdpReqSock );
+                        }
+             )
+            else {
+                // entries are only removed by this thread, so the 
+                // connection stays valid after the lock is released
+                request = NULL;
+                ithread_mutex_lock( &gConnMutex );
+                if( fd < gConnTable.size )
+                    request = gConnTable.conns[fd];
+                ithread_mutex_unlock( &gConnMutex );
+                if( request == NULL )
+                    continue;
+
+                ret = read_request( request );
+                if( ret != 0 ) {
+                    // the worker owns the connection from now on
+                    epoll_ctl( epfd, EPOLL_CTL_DEL, fd, &ev );
+                    ithread_mutex_lock( &gConnMutex );
+                    conn_table_remove( &gConnTable, request );
+                    ithread_mutex_unlock( &gConnMutex );
+
+                    if( ret < 0 || schedule_parsed_request( request ) != 0 )
+                        free_connection( request );
+                }
+            }
+        }
+
+        // drop connections that did not send a complete request in time
+        now = time( NULL );
+        if( now != lastSweep ) {
+            lastSweep = now;
+            expired = NULL;
+            ithread_mutex_lock( &gConnMutex );
+            for( request = gConnTable.head; request != NULL;
+                 request = next ) {
+                next = request->next;
+                if( request->expires <= now ) {
+                    conn_table_remove( &gConnTable, request );
+                    request->next = expired;
+                    expired = request;
+                }
+            }
+            ithread_mutex_unlock( &gConnMutex );
+
+            while( expired != NULL ) {
+                request = expired;
+                expired = request->next;
+                DBGONLY( UpnpPrintf
+                         ( UPNP_INFO, MSERV, __FILE__, __LINE__,
+                           "miniserver %d: timeout\n", request->connfd );
+                     )
+                    free_connection( request );
+            }
+        }
+    }
+
+    ithread_mutex_lock( &gConnMutex );
+    gEpollFd = -1;
+    while( gConnTable.head != NULL ) {
+        request = gConnTable.head;
+        conn_table_remove( &gConnTable, request );
+        free_connection( request );
+    }
+    free( gConnTable.conns );
+    memset( &gConnTable, 0, sizeof( gConnTable ) );
+    ithread_mutex_unlock( &gConnMutex );
+
+    close( epfd );
+    return 0;
+}
+#endif
+
 /************************************************************************
 *	Function :	RunMiniServer
 *
@@ -469,6 +1195,12 @@ RunMiniServer( MiniServerSockArray * miniSock )
 
     ++maxMiniSock;
 
+#ifdef MSERV_USE_EPOLL
+    if( RunEventLoop( miniSock ) == 0 ) {
+        goto stopped;
+    }
+#endif
+
     while( TRUE ) {
         FD_ZERO( &rdSet );
         FD_ZERO( &expSet );
@@ -545,6 +1277,9 @@ RunMiniServer( MiniServerSockArray * miniSock )
 
     }
 
+#ifdef MSERV_USE_EPOLL
+  stopped:
+#endif
     shutdown( miniServSock, SD_BOTH );
     UpnpCloseSocket( miniServSock );
     shutdown( miniServStopSock, SD_BOTH );
@@ -292,6 +292,27 @@ http_RecvMessage( IN SOCKINFO * info,
     }
 }
 
+/************************************************************************
+* Function: send_error
+*
+* Parameters:
+*	IN off_t num_written ;	result of a short sock_write or sock_sendfile
+*
+* Description: Maps a failed socket write to the error code reported by
+*	http_SendMessage, so callers know the message was not sent completely
+*
+* Returns:
+*	UPNP_E_TIMEDOUT
+*	UPNP_E_SOCKET_WRITE
+************************************************************************/
+static int
+send_error( IN off_t num_written )
+{
+    if( num_written == UPNP_E_TIMEDOUT )
+        return UPNP_E_TIMEDOUT;
+    return UPNP_E_SOCKET_WRITE;
+}
+
 /************************************************************************
 * Function: http_SendMessage											
 *																		
@@ -315,6 +336,8 @@ http_RecvMessage( IN SOCKINFO * info,
 * Returns:																
 *	UPNP_E_OUTOF_MEMORY													
 * 	UPNP_E_FILE_READ_ERROR												
+*	UPNP_E_TIMEDOUT
+*	UPNP_E_SOCKET_WRITE
 *	UPNP_E_SUCCESS														
 ************************************************************************/
 int
@@ -361,14 +384,6 @@ http_SendMessage( IN SOCKINFO * info,
 
             if( amount_to_be_read < WEB_SERVER_BUF_SIZE )
                 Data_Buf_Size = amount_to_be_read;
-
-            ChunkBuf = ( char * )malloc( Data_Buf_Size +
-                                         CHUNK_HEADER_SIZE +
-                                         CHUNK_TAIL_SIZE );
-            if( !ChunkBuf )
-                return UPNP_E_OUTOF_MEMORY;
-
-            file_buf = ChunkBuf + 10;
         }
 
         if( c == 'f' ) {        // file name
@@ -403,6 +418,42 @@ http_SendMessage( IN SOCKINFO * info,
                 }
             }
 
+#ifdef HAVE_SENDFILE
+            // plain files with a known length are sent by the kernel,
+            // chunked responses still need the buffer below
+            if( Instr && Instr->IsVirtualFile && !Instr->IsChunkActive &&
+                ( Instr->ReadSendSize >= 0 ) &&
+                ( virtualDirCallback.get_fd != NULL ) ) {
+                off_t offset;
+                int fd = virtualDirCallback.get_fd( Fh, &offset );
+
+                if( fd >= 0 ) {
+                    num_written = sock_sendfile( info, fd, &offset,
+                                                 amount_to_be_read,
+                                                 TimeOut );
+                    // a short count means the file ended early
+                    if( num_written < 0 ) {
+                        RetVal = send_error( num_written );
+                    } else if( num_written != amount_to_be_read ) {
+                        RetVal = UPNP_E_FILE_READ_ERROR;
+                    }
+                    goto Cleanup_File;
+                }
+            }
+#endif
+
+            if( Instr ) {
+                ChunkBuf = ( char * )malloc( Data_Buf_Size +
+                                             CHUNK_HEADER_SIZE +
+                                             CHUNK_TAIL_SIZE );
+                if( !ChunkBuf ) {
+                    RetVal = UPNP_E_OUTOF_MEMORY;
+                    goto Cleanup_File;
+                }
+
+                file_buf = ChunkBuf + 10;
+            }
+
             while( amount_to_be_read ) {
                 if( Instr ) {
                     if( amount_to_be_read >= Data_Buf_Size ) {
@@ -458,6 +509,8 @@ http_SendMessage( IN SOCKINFO * info,
                         num_written = sock_write( info, "0\r\n\r\n",
                                                   strlen( "0\r\n\r\n" ),
                                                   TimeOut );
+                        if( num_written != ( off_t )strlen( "0\r\n\r\n" ) )
+                            RetVal = send_error( num_written );
                     } else {
                         RetVal = UPNP_E_FILE_READ_ERROR;
                     }
@@ -491,7 +544,8 @@ http_SendMessage( IN SOCKINFO * info,
                     if( num_written !=
                         num_read + ( int )strlen( Chunk_Header )
                         + 2 ) {
-                        goto Cleanup_File;  //Send error nothing we can do.
+                        RetVal = send_error( num_written );
+                        goto Cleanup_File;
                     }
                 } else {
                     // write data
@@ -504,8 +558,8 @@ http_SendMessage( IN SOCKINFO * info,
                                ( int )num_written, file_buf );
                          )
 
-                        //Send error nothing we can do
                         if( num_written != num_read ) {
+                        RetVal = send_error( num_written );
                         goto Cleanup_File;
                     }
                 }
@@ -519,6 +573,8 @@ http_SendMessage( IN SOCKINFO * info,
                                               "0\r\n\r\n",
                                               strlen("0\r\n\r\n"),
                                               TimeOut );
+                    if( num_written != ( off_t )strlen( "0\r\n\r\n" ) )
+                        RetVal = send_error( num_written );
                 } else {
                     RetVal = UPNP_E_FILE_READ_ERROR;
                 }
@@ -540,8 +596,10 @@ http_SendMessage( IN SOCKINFO * info,
             buf_length = ( size_t ) va_arg( argp, size_t );
             if( buf_length > 0 ) {
                 num_written = sock_write( info, buf, buf_length, TimeOut );
-                if( ( size_t ) num_written != buf_length )
+                if( ( size_t ) num_written != buf_length ) {
+                    RetVal = send_error( num_written );
                     goto end;
+                }
                 DBGONLY( UpnpPrintf( UPNP_INFO, HTTP, __FILE__, __LINE__,
                                      ">>> (SENT) >>>\n%.*s\n------------\n",
                                      ( int )buf_length, buf );
@@ -553,7 +611,7 @@ http_SendMessage( IN SOCKINFO * info,
   end:
     va_end( argp );
     free( ChunkBuf );
-    return 0;
+    return RetVal;
 }
 
 /************************************************************************
@@ -1833,6 +1891,8 @@ http_SendStatusResponse( IN SOCKINFO * info,
 *		'U':	(no args) appends HTTP USER-AGENT: header
 *		'C':	(no args) appends a HTTP CONNECTION: close header 
 *				depending on major,minor version
+*		'P':	arg = int keep_alive; same as 'C' if keep_alive is 0,
+*				otherwise appends a CONNECTION: Keep-Alive header
 *		'N':	arg1 = off_t content_length	// content-length header
 *		'Q':	arg1 = http_method_t; arg2 = char* url; 
 *				arg3 = int url_length // start line of request
@@ -2022,6 +2082,21 @@ http_MakeMessage( INOUT membuffer * buf,
             }
         }
 
+        else if( c == 'P' ) {
+            if( ( int )va_arg( argp, int ) ) {
+                // also sent with HTTP/1.1, GET requests of HTTP/1.0 clients
+                // are answered with an HTTP/1.1 status line
+                if( membuffer_append_str
+                    ( buf, "CONNECTION: Keep-Alive\r\n" ) != 0 ) {
+                    goto error_handler;
+                }
+            } else if( http_MakeMessage
+                       ( buf, http_major_version, http_minor_version,
+                         "C" ) != 0 ) {
+                goto error_handler;
+            }
+        }
+
         else if( c == 'N' ) {
             // content-length header
             bignum = ( off_t )va_arg( argp, off_t );
@@ -1474,6 +1474,13 @@ process_request( IN http_message_t * req,
         goto error_handler;
     }
 
+    // only description documents with a known length leave the
+    // connection open
+    if( !using_alias || RespInstr->IsRangeActive ||
+        RespInstr->IsChunkActive || ( RespInstr->ReadSendSize < 0 ) ) {
+        RespInstr->IsKeepAlive = 0;
+    }
+
     if( RespInstr->IsRangeActive && RespInstr->IsChunkActive ) {
                 //Content-Range: bytes 222-3333/4000  HTTP_PARTIAL_CONTENT
         //Transfer-Encoding: chunked
@@ -1531,12 +1538,13 @@ process_request( IN http_message_t * req,
             //Content-Range: bytes 222-3333/4000  HTTP_PARTIAL_CONTENT
             //Transfer-Encoding: chunked
             // K means add chunky header ang G means range header.
-            if( http_MakeMessage( headers, resp_major, resp_minor, "RNTDstcSCAAc", HTTP_OK,   // status code
+            if( http_MakeMessage( headers, resp_major, resp_minor, "RNTDstcSPAAc", HTTP_OK,   // status code
                                   RespInstr->ReadSendSize,  // content length
                                   finfo.content_type,
                                   //content_type.buf,          // content type
                                   "LAST-MODIFIED: ",
                                   &finfo.last_modified,
+                                  RespInstr->IsKeepAlive,
                                   finfo.http_header,
                                   gUserHTTPHeaders.buf
                                   ) != 0 ) {
@@ -1794,6 +1802,7 @@ web_server_callback( IN http_parser_t * parser,
     RespInstr.IsChunkActive = 0;
     RespInstr.IsRangeActive = 0;
     RespInstr.IsTrailers = 0;
+    RespInstr.IsKeepAlive = info->keep_alive_allowed;
     // init
     membuffer_init( &headers );
     membuffer_init( &filename );
@@ -1818,10 +1827,13 @@ web_server_callback( IN http_parser_t * parser,
                 break;
 
             case RESP_XMLDOC:  // send xmldoc , I = further instruction to send data.
-                http_SendMessage( info, &timeout, "Ibb", &RespInstr,
-                                  headers.buf, (size_t)headers.length,
-                                  xmldoc.doc.buf, xmldoc.doc.length );
+                ret = http_SendMessage( info, &timeout, "Ibb", &RespInstr,
+                                        headers.buf, (size_t)headers.length,
+                                        xmldoc.doc.buf, xmldoc.doc.length );
                 alias_release( &xmldoc );
+                // only reuse the connection if the whole response went out
+                if( ret == UPNP_E_SUCCESS )
+                    info->keep_alive = RespInstr.IsKeepAlive;
                 break;
 
             case RESP_WEBDOC:  //, I = further instruction to send data.
@@ -1836,8 +1848,10 @@ web_server_callback( IN http_parser_t * parser,
                 break;
 
             case RESP_HEADERS: // headers only
-                http_SendMessage( info, &timeout, "b",
-                                  headers.buf, (size_t)headers.length );
+                ret = http_SendMessage( info, &timeout, "b",
+                                        headers.buf, (size_t)headers.length );
+                if( ret == UPNP_E_SUCCESS )
+                    info->keep_alive = RespInstr.IsKeepAlive;
 
                 break;
             case RESP_POST:    // headers only
@@ -75,6 +75,9 @@
  #include <sys/socket.h>
  #include <sys/time.h>
  #include <unistd.h>
+ #ifdef HAVE_SYS_SENDFILE_H
+  #include <sys/sendfile.h>
+ #endif
 #else
  #include <winsock2.h>
 #endif
@@ -549,3 +552,115 @@ sock_write( IN SOCKINFO * info,
 
     return num_bytes;
 }
+
+#ifdef HAVE_SENDFILE
+/************************************************************************
+*	Function :	sock_sendfile
+*
+*	Parameters :
+*		IN SOCKINFO *info ;	Socket Information Object
+*		IN int fd ;	File descriptor to send data from
+*		INOUT off_t *offset ;	Position in the file
+*		IN off_t count ;	Number of bytes to send
+*	    IN int *timeoutSecs ;	timeout value
+*
+*	Description :	Same as sock_write, but lets the kernel copy the
+*		data from the file to the socket. The data is sent in pieces 
+*		of WEB_SERVER_BUF_SIZE, so the timeout and the shutdown flag 
+*		are checked as often as in sock_write
+*
+*	Return : off_t;
+*		numBytes - On Success, no of bytes sent		
+*		UPNP_E_TIMEDOUT - Timeout
+*		UPNP_E_SOCKET_ERROR - Error on socket calls
+*
+*	Note :
+************************************************************************/
+off_t
+sock_sendfile( IN SOCKINFO * info,
+               IN int fd,
+               INOUT off_t *offset,
+               IN off_t count,
+               INOUT int *timeoutSecs )
+{
+    int sockfd = info->socket;
+    int retCode;
+    fd_set writeSet;
+    struct timeval timeout;
+    ssize_t bytes_sent = 0;
+    off_t num_bytes = 0;
+    size_t piece;
+    int retry = 0;
+
+    if (*timeoutSecs < 0)
+    {
+        return UPNP_E_TIMEDOUT;
+    }
+
+    while (num_bytes < count)
+    {
+        FD_ZERO(&writeSet);
+        FD_SET(sockfd, &writeSet);
+
+        timeout.tv_sec = *timeoutSecs;
+        timeout.tv_usec = 0;
+
+        if (*timeoutSecs == 0)
+        {
+            timeout.tv_sec = WEB_SERVER_BLOCK_TIMEOUT;
+        }
+        
+        retCode = select(sockfd + 1, NULL, &writeSet, NULL, &timeout);
+
+        if (gUpnpSdkShutdown)
+            return UPNP_E_TIMEDOUT;
+
+        if (retCode == 0)
+        {
+            if (*timeoutSecs != 0)
+                return UPNP_E_TIMEDOUT;
+
+            if (gMaxHTTPTimeoutRetries > 0)
+            {
+                retry++;
+                if (retry >= gMaxHTTPTimeoutRetries)
+                    return UPNP_E_TIMEDOUT;
+            }
+
+            continue;
+        }
+
+        if (retCode == -1)
+        {
+            if(errno == EINTR)
+                continue;
+
+            return UPNP_E_SOCKET_ERROR;
+        }
+
+        if (FD_ISSET(sockfd, &writeSet))
+        {
+            piece = WEB_SERVER_BUF_SIZE;
+            if (count - num_bytes < (off_t)piece)
+                piece = (size_t)(count - num_bytes);
+
+            bytes_sent = sendfile(sockfd, fd, offset, piece);
+            if (bytes_sent < 0)
+            {
+                if (errno == EINTR || errno == EAGAIN)
+                    continue;
+
+                return UPNP_E_SOCKET_ERROR;
+            }
+
+            // end of file
+            if (bytes_sent == 0)
+                break;
+
+            num_bytes = num_bytes + bytes_sent;
+        }
+    }
+
+    return num_bytes;
+}
+#endif
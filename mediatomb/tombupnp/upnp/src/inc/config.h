@@ -246,6 +246,25 @@
 #define WEB_SERVER_BLOCK_TIMEOUT 3
 //@}
 
+/** @name HTTP_KEEPALIVE_TIMEOUT
+ *  Number of seconds a persistent connection may stay idle between two
+ *  requests before the miniserver closes it. 
+ *  The default time is 15 seconds.
+ */
+
+//@{
+#define HTTP_KEEPALIVE_TIMEOUT 15
+//@}
+
+/** @name HTTP_KEEPALIVE_MAX_REQUESTS
+ *  Maximum number of requests that are served on one persistent 
+ *  connection, the response to the last one closes it.
+ */
+
+//@{
+#define HTTP_KEEPALIVE_MAX_REQUESTS 100
+//@}
+
 /** @name Module Exclusion
  *  Depending on the requirements, the user can selectively discard any of 
  *  the major modules like SOAP, GENA, SSDP or the Internal web server. By 
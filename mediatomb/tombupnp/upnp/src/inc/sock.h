@@ -53,6 +53,11 @@ typedef struct
     // the following two fields are filled only in incoming requests;
     struct in_addr foreign_ip_addr;
     unsigned short foreign_ip_port;
+
+    // set by the miniserver if the connection may stay open after the
+    // response; a handler that sends a persistent response sets keep_alive
+    int keep_alive_allowed;
+    int keep_alive;
     
 } SOCKINFO;
 
@@ -147,6 +152,33 @@ int sock_check_w( IN SOCKINFO * info );
 int sock_write( IN SOCKINFO *info, IN char* buffer, IN size_t bufsize,
 		    		 INOUT int *timeoutSecs );
 
+#ifdef HAVE_SENDFILE
+/************************************************************************
+*	Function :	sock_sendfile
+*
+*	Parameters :
+*		IN SOCKINFO *info ;	Socket Information Object
+*		IN int fd ;	File descriptor to send data from
+*		INOUT off_t *offset ;	Position in the file, advanced by
+*			the number of bytes sent
+*		IN off_t count ;	Number of bytes to send
+*	    IN int *timeoutSecs ;	timeout value
+*
+*	Description :	Sends data from a file on the socket in sockinfo
+*		without copying it through user space
+*
+*	Return : off_t;
+*		numBytes - On Success, no of bytes sent, less than count
+*			if the end of the file was reached
+*		UPNP_E_TIMEDOUT - Timeout
+*		UPNP_E_SOCKET_ERROR - Error on socket calls
+*
+*	Note :
+************************************************************************/
+off_t sock_sendfile( IN SOCKINFO *info, IN int fd, INOUT off_t *offset,
+                     IN off_t count, INOUT int *timeoutSecs );
+#endif
+
 /************************************************************************
 *	Function :	sock_destroy
 *
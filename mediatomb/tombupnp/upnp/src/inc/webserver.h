@@ -68,6 +68,7 @@ struct SendInstruction
    int  IsChunkActive;
    int  IsRangeActive;
    int  IsTrailers;
+   int  IsKeepAlive;   // the response leaves the connection open
    char RangeHeader[200];
    off_t RangeOffset;
    off_t ReadSendSize;  // Read from local source and send on the network.
@@ -218,6 +218,7 @@ send_error_response( IN SOCKINFO * info,
     int timeout_secs = SOAP_TIMEOUT;
     int major,
       minor;
+    int ret_code;
     const char *start_body =
 //		"<?xml version=\"1.0\"?>\n" required??
         "<s:Envelope "
@@ -254,11 +255,12 @@ send_error_response( IN SOCKINFO * info,
     // make headers
     membuffer_init( &headers );
     if( http_MakeMessage( &headers, major, minor,
-                          "RNsDsSCAc" "sssss",
+                          "RNsDsSPAc" "sssss",
                           500,
                           content_length,
                           ContentTypeHeader,
                           "EXT:\r\n",
+                          info->keep_alive_allowed,
                           gUserHTTPHeaders.buf,
                           start_body, err_code_str, mid_body, err_msg,
                           end_body ) != 0 ) {
@@ -266,8 +268,11 @@ send_error_response( IN SOCKINFO * info,
         return;                 // out of mem
     }
     // send err msg
-    http_SendMessage( info, &timeout_secs, "b",
-                      headers.buf, (size_t)headers.length );
+    ret_code = http_SendMessage( info, &timeout_secs, "b",
+                                 headers.buf, (size_t)headers.length );
+    // a partly sent response leaves the connection in an unknown state
+    if( ret_code == UPNP_E_SUCCESS )
+        info->keep_alive = info->keep_alive_allowed;
 
     membuffer_destroy( &headers );
 }
@@ -295,6 +300,7 @@ send_var_query_response( IN SOCKINFO * info,
     int timeout_secs = SOAP_TIMEOUT;
     int major;
     int minor;
+    int ret_code;
     const char *start_body =
         "<s:Envelope "
         "xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" "
@@ -319,19 +325,22 @@ send_var_query_response( IN SOCKINFO * info,
     // make headers
     membuffer_init( &response );
     if( http_MakeMessage( &response, major, minor,
-                          "RNsDsSCAc" "sss",
+                          "RNsDsSPAc" "sss",
                           HTTP_OK,
                           content_length,
                           ContentTypeHeader,
                           "EXT:\r\n",
+                          info->keep_alive_allowed,
                           gUserHTTPHeaders.buf,
                           start_body, var_value, end_body ) != 0 ) {
         membuffer_destroy( &response );
         return;                 // out of mem
     }
     // send msg
-    http_SendMessage( info, &timeout_secs, "b",
-                      response.buf, (size_t)response.length );
+    ret_code = http_SendMessage( info, &timeout_secs, "b",
+                                 response.buf, (size_t)response.length );
+    if( ret_code == UPNP_E_SUCCESS )
+        info->keep_alive = info->keep_alive_allowed;
 
     membuffer_destroy( &response );
 }
@@ -695,6 +704,8 @@ get_device_info( IN http_message_t * request,
 *	Parameters :
 *		IN SOCKINFO *info :	socket info
 *		IN IXML_Document *action_resp : The response document	
+*		IN char *action_resp_str : The serialized response, used instead
+*			of action_resp if it is not NULL
 *		IN http_message_t* request :	action request document
 *
 *	Description :	This function sends the SOAP response 
@@ -706,9 +717,11 @@ get_device_info( IN http_message_t * request,
 static XINLINE void
 send_action_response( IN SOCKINFO * info,
                       IN IXML_Document * action_resp,
+                      IN char *action_resp_str,
                       IN http_message_t * request )
 {
     char *xml_response = NULL;
+    char *xml_body;
     membuffer headers;
     int major,
       minor;
@@ -730,21 +743,27 @@ send_action_response( IN SOCKINFO * info,
     err_code = UPNP_E_OUTOF_MEMORY; // one error only
 
     // get xml
-    xml_response = ixmlPrintNode( ( IXML_Node * ) action_resp );
-    if( xml_response == NULL ) {
-        goto error_handler;
+    if( action_resp_str != NULL ) {
+        xml_body = action_resp_str;
+    } else {
+        xml_response = ixmlPrintNode( ( IXML_Node * ) action_resp );
+        if( xml_response == NULL ) {
+            goto error_handler;
+        }
+        xml_body = xml_response;
     }
 
-    content_length = strlen( start_body ) + strlen( xml_response ) +
+    content_length = strlen( start_body ) + strlen( xml_body ) +
         strlen( end_body );
 
     // make headers
     if( http_MakeMessage( &headers, major, minor,
-        "RNsDsSCAc", 
+        "RNsDsSPAc", 
         HTTP_OK,   // status code
         content_length,
         ContentTypeHeader, 
         "EXT:\r\n",// EXT header
+        info->keep_alive_allowed,
         gUserHTTPHeaders.buf
          ) != 0 ) {
         goto error_handler;
@@ -753,8 +772,10 @@ send_action_response( IN SOCKINFO * info,
     ret_code = http_SendMessage( info, &timeout_secs, "bbbb",
                                  headers.buf, (size_t)headers.length,
                                  start_body, strlen( start_body ),
-                                 xml_response, strlen( xml_response ),
+                                 xml_body, strlen( xml_body ),
                                  end_body, strlen( end_body ) );
+    if( ret_code == UPNP_E_SUCCESS )
+        info->keep_alive = info->keep_alive_allowed;
 
     DBGONLY( if( ret_code != 0 ) {
              UpnpPrintf( UPNP_INFO, SOAP, __FILE__, __LINE__,
@@ -957,6 +978,7 @@ handle_invoke_action( IN SOCKINFO * info,
     const char *err_str;
 
     action.ActionResult = NULL;
+    action.ActionResultString = NULL;
 
     // null-terminate
     save_char = action_name.buf[action_name.length];
@@ -983,6 +1005,7 @@ handle_invoke_action( IN SOCKINFO * info,
     linecopy( action.ErrStr, "" );
     action.ActionRequest = resp_node;
     action.ActionResult = NULL;
+    action.ActionResultString = NULL;
     action.ErrCode = UPNP_E_SUCCESS;
     action.CtrlPtIPAddr = info->foreign_ip_addr;
 
@@ -1002,19 +1025,21 @@ handle_invoke_action( IN SOCKINFO * info,
         goto error_handler;
     }
     // validate, and handle action error
-    if( action.ActionResult == NULL ) {
+    if( action.ActionResult == NULL && action.ActionResultString == NULL ) {
         err_code = SOAP_ACTION_FAILED;
         err_str = Soap_Action_Failed;
         goto error_handler;
     }
     // send response
-    send_action_response( info, action.ActionResult, request );
+    send_action_response( info, action.ActionResult,
+                          action.ActionResultString, request );
 
     err_code = 0;
 
     // error handling and cleanup
   error_handler:
     ixmlDocument_free( action.ActionResult );
+    free( action.ActionResultString );
     ixmlDocument_free( resp_node );
     action_name.buf[action_name.length] = save_char;    // restore
     if( err_code != 0 ) {